@@ -0,0 +1,207 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+/**
+ * @file
+ * @brief Subset of the Arduino-ESP32 core used by the firmware, implemented on the simulated
+ * board of NativeHal.h.
+ *
+ * Pins keep their level in memory, the ADC returns values set by the simulation, and millis(),
+ * micros() and delay() run on the board clock, which is either the host clock or a virtual one.
+ * ARDUINO is left undefined on purpose, so host-only code such as MappedFileJournalStorage is
+ * compiled in.
+ */
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+
+#define digitalPinToInterrupt(pin) (pin)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+/**
+ * @brief Minimal Arduino String, enough for the few library calls that return one.
+ */
+class String {
+public:
+    String() {}
+    String(const char* text) : text(text != nullptr ? text : "") {}
+    String(const std::string& text) : text(text) {}
+    explicit String(char value) : text(1, value) {}
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char other) { text += other; return *this; }
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == other; }
+    bool operator!=(const String& other) const { return text != other.text; }
+
+    friend String operator+(const String& left, const String& right) { String result(left); result += right; return result; }
+    friend String operator+(const String& left, const char* right) { String result(left); result += right; return result; }
+    friend String operator+(const char* left, const String& right) { String result(left); result += right; return result; }
+
+private:
+    std::string text;
+};
+
+/**
+ * @brief IPv4 address.
+ */
+class IPAddress {
+public:
+    IPAddress() : bytes() {}
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) : bytes() {
+        bytes[0] = first;
+        bytes[1] = second;
+        bytes[2] = third;
+        bytes[3] = fourth;
+    }
+
+    uint8_t operator[](int index) const { return bytes[index]; }
+    String toString() const;
+
+private:
+    uint8_t bytes[4];
+};
+
+/**
+ * @brief Byte sink with the Arduino print helpers.
+ */
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t write(const char* text) { return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char value) { return write((uint8_t)value); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+    size_t print(const IPAddress& address) { return print(address.toString()); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t count = print(value); return count + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t count = print(value, format); return count + println(); }
+};
+
+/**
+ * @brief Readable byte stream.
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+
+protected:
+    unsigned long timeout = 1000;
+};
+
+/**
+ * @brief UART 0, written to the host's standard output.
+ *
+ * Every byte is counted; NativeHal::setSerialEcho(false) keeps the count but stops the output,
+ * which the benchmark uses so the terminal does not weigh on the loop.
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+
+    size_t write(uint8_t value) override { return write(&value, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+
+    operator bool() const { return true; }
+
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+/**
+ * @brief Chip information, as on the ESP32.
+ */
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
+
+// Entry points of the sketch, called by the runtime in NativeMain.cpp
+void setup();
+void loop();
+
+#endif // ARDUINO_H
@@ -0,0 +1,18 @@
+#ifndef BOARD_WIRING_H
+#define BOARD_WIRING_H
+
+#include <stdint.h>
+
+/**
+ * @brief Pins of the SmartSuite board that the simulations drive, as in the README pin table,
+ * and the MQ2 scale used to turn PPM back into ADC counts.
+ */
+struct BoardWiring {
+    static const uint8_t DHT_PIN = 4;
+    static const uint8_t PIR_PIN = 13;
+    static const uint8_t MQ2_PIN = 34;
+    static const int ADC_MAX = 4095;
+    static const int PPM_FULL_SCALE = 1000; ///< Same scale as Mq2Sensor.
+};
+
+#endif // BOARD_WIRING_H
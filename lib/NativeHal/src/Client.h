@@ -0,0 +1,21 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Network connection as seen by the Arduino libraries.
+ */
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+
+    using Stream::read;
+};
+
+#endif // CLIENT_H
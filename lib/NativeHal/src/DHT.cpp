@@ -0,0 +1,31 @@
+#include "DHT.h"
+#include "NativeHal.h"
+
+DHT::DHT(uint8_t pin, uint8_t type, uint8_t count) : pin(pin) {
+    (void)count;
+    NativeHal::attachDht(pin, type);
+}
+
+void DHT::begin(uint8_t usec) {
+    (void)usec;
+}
+
+float DHT::readTemperature(bool fahrenheit, bool force) {
+    (void)force;
+    float temperature;
+    float humidity;
+    if (!NativeHal::readDht(pin, temperature, humidity)) {
+        return NAN;
+    }
+    return fahrenheit ? temperature * 1.8f + 32.0f : temperature;
+}
+
+float DHT::readHumidity(bool force) {
+    (void)force;
+    float temperature;
+    float humidity;
+    if (!NativeHal::readDht(pin, temperature, humidity)) {
+        return NAN;
+    }
+    return humidity;
+}
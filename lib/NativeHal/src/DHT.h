@@ -0,0 +1,29 @@
+#ifndef DHT_H
+#define DHT_H
+
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT12 12
+#define DHT21 21
+#define DHT22 22
+#define AM2301 21
+
+/**
+ * @brief DHT library stand-in. Constructing it puts a simulated sensor on the pin, which also
+ * answers the interrupt-driven capture of DhtSensor; its values are set with
+ * NativeHal::setDhtReading().
+ */
+class DHT {
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6);
+
+    void begin(uint8_t usec = 55);
+    float readTemperature(bool fahrenheit = false, bool force = false);
+    float readHumidity(bool force = false);
+
+private:
+    uint8_t pin;
+};
+
+#endif // DHT_H
@@ -0,0 +1,41 @@
+#include "ESP32Servo.h"
+#include "NativeHal.h"
+
+int Servo::attach(int pin) {
+    this->pin = pin;
+    NativeHal::setServoAngle(pin, angle);
+    return 1;
+}
+
+int Servo::attach(int pin, int min, int max) {
+    (void)min;
+    (void)max;
+    return attach(pin);
+}
+
+void Servo::detach() {
+    if (pin >= 0) {
+        NativeHal::setServoAngle(pin, -1);
+    }
+    pin = -1;
+}
+
+void Servo::write(int value) {
+    // Like ESP32Servo, values from 500 up are pulse widths in microseconds
+    if (value >= 500) {
+        writeMicroseconds(value);
+        return;
+    }
+    angle = value < 0 ? 0 : (value > 180 ? 180 : value);
+    if (pin >= 0) {
+        NativeHal::setServoAngle(pin, angle);
+    }
+}
+
+void Servo::writeMicroseconds(int value) {
+    value = value < 500 ? 500 : (value > 2500 ? 2500 : value);
+    angle = (value - 500) * 180 / 2000;
+    if (pin >= 0) {
+        NativeHal::setServoAngle(pin, angle);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef ESP32SERVO_H
+#define ESP32SERVO_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Servo stand-in. The commanded angle is readable with NativeHal::getServoAngle().
+ */
+class Servo {
+public:
+    int attach(int pin);
+    int attach(int pin, int min, int max);
+    void detach();
+    bool attached() const { return pin >= 0; }
+
+    void write(int value);
+    void writeMicroseconds(int value);
+    int read() const { return angle; }
+
+private:
+    int pin = -1;
+    int angle = 90;
+};
+
+#endif // ESP32SERVO_H
@@ -0,0 +1,82 @@
+#include "FanoutBenchmark.h"
+#include <chrono>
+
+const unsigned long FanoutBenchmark::DEFAULT_EVENTS;
+
+static const int FIRST_EVENT_ID = 100; ///< Filtered subscriber i takes FIRST_EVENT_ID + i.
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FanoutBenchmark::CountingHandler::on(Event event) {
+    count++;
+    sum += event.value;
+}
+
+int FanoutBenchmark::run(unsigned long events, FILE* output) {
+    fprintf(output, "=== Fan-out: %lu events per case ===\n", events);
+    fprintf(output, "%-16s %11s %11s %10s %13s\n", "case", "subscribers", "deliveries", "ns/event", "ns/delivery");
+    bool correct = true;
+
+    // Reference: one handler called through its interface
+    reset();
+    EventHandler* direct = &handlers[0];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < events; i++) {
+        direct->on(Event(FIRST_EVENT_ID, (float)(i & 0xFF)));
+    }
+    correct &= report("direct call", 1, events, secondsSince(start), events, output);
+
+    for (int subscriberCount = 0; subscriberCount <= Sensor::MAX_SUBSCRIBERS; subscriberCount++) {
+        Sensor sensor(0);
+        for (int i = 0; i < subscriberCount; i++) {
+            sensor.subscribe(&handlers[i]);
+        }
+        reset();
+        start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < events; i++) {
+            sensor.on(Event(FIRST_EVENT_ID, (float)(i & 0xFF)));
+        }
+        correct &= report("all events", subscriberCount, events, secondsSince(start), events * subscriberCount, output);
+    }
+
+    // Each event matches the filter of one subscriber only
+    Sensor sensor(0);
+    for (int i = 0; i < Sensor::MAX_SUBSCRIBERS; i++) {
+        sensor.subscribe(&handlers[i], FIRST_EVENT_ID + i);
+    }
+    reset();
+    start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < events; i++) {
+        sensor.on(Event(FIRST_EVENT_ID + (int)(i % Sensor::MAX_SUBSCRIBERS), (float)(i & 0xFF)));
+    }
+    correct &= report("filtered by ID", Sensor::MAX_SUBSCRIBERS, events, secondsSince(start), events, output);
+    return correct ? 0 : 1;
+}
+
+unsigned long FanoutBenchmark::delivered() const {
+    unsigned long total = 0;
+    for (int i = 0; i < Sensor::MAX_SUBSCRIBERS; i++) {
+        total += handlers[i].count;
+    }
+    return total;
+}
+
+void FanoutBenchmark::reset() {
+    for (int i = 0; i < Sensor::MAX_SUBSCRIBERS; i++) {
+        handlers[i] = CountingHandler();
+    }
+}
+
+bool FanoutBenchmark::report(const char* name, int subscriberCount, unsigned long events, double seconds,
+                             unsigned long expected, FILE* output) {
+    unsigned long deliveries = delivered();
+    fprintf(output, "%-16s %11d %11lu %10.2f %13.2f\n", name, subscriberCount, deliveries,
+            events > 0 ? seconds * 1e9 / events : 0.0, deliveries > 0 ? seconds * 1e9 / deliveries : 0.0);
+    if (deliveries != expected) {
+        fprintf(output, "%-16s expected %lu deliveries\n", "", expected);
+        return false;
+    }
+    return true;
+}
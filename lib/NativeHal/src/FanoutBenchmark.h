@@ -0,0 +1,48 @@
+#ifndef FANOUT_BENCHMARK_H
+#define FANOUT_BENCHMARK_H
+
+#include <stdio.h>
+#include "Sensor.h"
+
+/**
+ * @brief Host measurement of the cost of propagating a sensor event to its subscribers.
+ *
+ * Events are raised on a Sensor with from none up to MAX_SUBSCRIBERS subscribers receiving
+ * every event, then with each subscriber filtering on its own event ID, so every event reaches
+ * a single one of them. A direct virtual call to one handler, which is what a sensor did
+ * before it held a list, is the reference.
+ */
+class FanoutBenchmark {
+public:
+    static const unsigned long DEFAULT_EVENTS = 10000000;
+
+    /**
+     * @brief Runs every case and prints a table of the results.
+     * @param events Events raised per case.
+     * @param output Where to print.
+     * @return 0 if every subscriber received the events it should have, 1 otherwise.
+     */
+    int run(unsigned long events, FILE* output);
+
+private:
+    /**
+     * @brief Counts and sums the events it receives.
+     */
+    class CountingHandler : public EventHandler {
+    public:
+        unsigned long count;
+        float sum;
+
+        CountingHandler() : count(0), sum(0) {}
+        void on(Event event) override;
+    };
+
+    CountingHandler handlers[Sensor::MAX_SUBSCRIBERS];
+
+    unsigned long delivered() const;
+    void reset();
+    bool report(const char* name, int subscriberCount, unsigned long events, double seconds,
+                unsigned long expected, FILE* output);
+};
+
+#endif // FANOUT_BENCHMARK_H
@@ -0,0 +1,283 @@
+#include "FleetSimulator.h"
+#include <Arduino.h>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include "BoardWiring.h"
+
+const int FleetSimulator::MAX_UPDATES_PER_WAKE;
+const int FleetSimulator::WorkerStats::LAG_BUCKETS;
+
+/**
+ * @brief What happens in every room, each with its own offset into the cycle.
+ */
+struct RoomScenario {
+    static const unsigned long MOTION_PERIOD = 30000;  ///< Someone walks by every 30 s...
+    static const unsigned long MOTION_LENGTH = 5000;   ///< ...and stays in view for 5 s.
+    static const unsigned long SMOKE_PERIOD = 600000;  ///< Smoke every 10 min...
+    static const unsigned long SMOKE_LENGTH = 20000;   ///< ...for 20 s.
+    static const unsigned long COMMAND_PERIOD = 10000; ///< A servo command arrives every 10 s.
+    static const uint16_t GAS_LEVEL = 400;             ///< Clean-air ADC reading, with some noise.
+    static const uint16_t SMOKE_LEVEL = 2000;          ///< About 490 ppm, over the alert threshold.
+};
+
+static FleetFactory factory = nullptr;
+
+bool FleetSimulator::setFactory(FleetFactory fleetFactory) {
+    factory = fleetFactory;
+    return true;
+}
+
+bool FleetSimulator::hasFactory() {
+    return factory != nullptr;
+}
+
+FleetSimulator::FleetSimulator() : running(false), beginSeconds(0), runSeconds(0), threads(0) {}
+
+bool FleetSimulator::begin(int deviceCount) {
+    if (factory == nullptr) {
+        return false;
+    }
+    NativeHal::setRealTime(true);
+    {
+        HalAllocationScope scope;
+        members.resize(deviceCount);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < deviceCount; i++) {
+        Member& member = members[i];
+        FleetRoom& room = member.room;
+        room.index = i;
+        snprintf(room.clientId, sizeof(room.clientId), "SmartSuite_%04d", i + 1);
+        snprintf(room.dataTopic, sizeof(room.dataTopic), "smartsuite/room-%04d/sensors/data", i + 1);
+        snprintf(room.commandTopic, sizeof(room.commandTopic), "smartsuite/room-%04d/servo/command", i + 1);
+        snprintf(room.responseTopic, sizeof(room.responseTopic), "smartsuite/room-%04d/servo/response", i + 1);
+        snprintf(room.alertTopic, sizeof(room.alertTopic), "smartsuite/room-%04d/alerts", i + 1);
+        snprintf(room.rulesTopic, sizeof(room.rulesTopic), "smartsuite/room-%04d/config/rules", i + 1);
+        snprintf(room.metricsTopic, sizeof(room.metricsTopic), "smartsuite/room-%04d/metrics", i + 1);
+
+        // Knuth's multiplicative hash spreads the rooms over the scenario cycle
+        member.offset = (unsigned long)(((uint32_t)i * 2654435761u) % RoomScenario::SMOKE_PERIOD);
+        member.commandCount = 0;
+        member.noiseState = (uint32_t)i + 1;
+        member.board = NativeHal::createBoard((uint32_t)i + 1);
+
+        NativeHal::selectBoard(member.board);
+        member.nextCommand = millis() + member.offset % RoomScenario::COMMAND_PERIOD;
+        WorkerStats unused = WorkerStats();
+        applyScenario(member, millis(), unused);
+        member.device = factory(room);
+        member.device->begin();
+        member.heapAfterBegin = NativeHal::getHeapInUse(member.board);
+        NativeHal::selectBoard(nullptr);
+    }
+    beginSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    HalAllocationScope scope;
+    uint64_t now = NativeHal::getTime();
+    for (int i = 0; i < deviceCount; i++) {
+        Timer timer = {now, i};
+        timers.push(timer);
+    }
+    return true;
+}
+
+void FleetSimulator::run(int threadCount, double seconds) {
+    HalAllocationScope scope;
+    threads = threadCount;
+    workerStats.assign(threadCount, WorkerStats());
+    running = true;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&FleetSimulator::work, this, std::ref(workerStats[i])));
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)(seconds * 1000000)));
+    {
+        std::lock_guard<std::mutex> guard(timerLock);
+        running = false;
+    }
+    timerReady.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FleetSimulator::work(WorkerStats& stats) {
+    std::unique_lock<std::mutex> lock(timerLock);
+    while (running) {
+        if (timers.empty()) {
+            timerReady.wait(lock);
+            continue;
+        }
+        Timer timer = timers.top();
+        uint64_t now = NativeHal::getTime();
+        if (timer.due > now) {
+            timerReady.wait_for(lock, std::chrono::microseconds(timer.due - now));
+            continue;
+        }
+        timers.pop();
+        lock.unlock();
+
+        uint64_t lag = now - timer.due;
+        int bucket = 0;
+        while (bucket < WorkerStats::LAG_BUCKETS - 1 && lag >= ((uint64_t)1 << bucket)) {
+            bucket++;
+        }
+        stats.lag[bucket]++;
+        if (lag > stats.maxLag) {
+            stats.maxLag = lag;
+        }
+        stats.wakeUps++;
+        unsigned long wait = service(members[timer.member], stats);
+
+        lock.lock();
+        timer.due = NativeHal::getTime() + wait * 1000ULL;
+        timers.push(timer);
+        // Only a sleeper waiting for a later device needs to hear about this one
+        if (timers.top().member == timer.member) {
+            timerReady.notify_one();
+        }
+    }
+}
+
+unsigned long FleetSimulator::service(Member& member, WorkerStats& stats) {
+    NativeHal::selectBoard(member.board);
+    applyScenario(member, millis(), stats);
+    unsigned long wait = 0;
+    for (int i = 0; i < MAX_UPDATES_PER_WAKE && wait == 0; i++) {
+        member.device->update();
+        stats.updates++;
+        wait = member.device->timeUntilNextTask();
+    }
+    NativeHal::selectBoard(nullptr);
+    return wait;
+}
+
+void FleetSimulator::applyScenario(Member& member, unsigned long now, WorkerStats& stats) {
+    unsigned long cycle = now + member.offset;
+    float hours = cycle / 3600000.0f;
+    NativeHal::setDhtReading(BoardWiring::DHT_PIN, 24.0f + 2.0f * sinf(hours * 6.2832f * 6),
+                             50.0f + 5.0f * cosf(hours * 6.2832f * 4));
+
+    member.noiseState = member.noiseState * 1103515245 + 12345;
+    int noise = (int)((member.noiseState >> 16) % 17) - 8;
+    bool smoke = cycle % RoomScenario::SMOKE_PERIOD >= RoomScenario::SMOKE_PERIOD - RoomScenario::SMOKE_LENGTH;
+    NativeHal::setAnalogInput(BoardWiring::MQ2_PIN, (smoke ? RoomScenario::SMOKE_LEVEL : RoomScenario::GAS_LEVEL) + noise);
+    NativeHal::setDigitalInput(BoardWiring::PIR_PIN,
+                               cycle % RoomScenario::MOTION_PERIOD >= RoomScenario::MOTION_PERIOD - RoomScenario::MOTION_LENGTH);
+
+    if ((long)(now - member.nextCommand) >= 0) {
+        char payload[48];
+        static const int POSITIONS[] = {0, 90, 180, 90};
+        int length = snprintf(payload, sizeof(payload), "{\"servo\":%d,\"position\":%d}",
+                              1 + member.commandCount % 2, POSITIONS[member.commandCount % 4]);
+        NativeHal::publish(member.room.commandTopic, (const uint8_t*)payload, length);
+        member.commandCount++;
+        member.nextCommand += RoomScenario::COMMAND_PERIOD;
+        stats.commands++;
+    }
+}
+
+uint64_t FleetSimulator::lagPercentile(const unsigned long* buckets, unsigned long total, int percent) {
+    unsigned long rank = (total * (unsigned long)percent + 99) / 100;
+    unsigned long seen = 0;
+    for (int i = 0; i < WorkerStats::LAG_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0) {
+            return (uint64_t)1 << i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Traffic of one kind of topic, summed over the rooms.
+ */
+struct TopicKind {
+    std::string name;
+    unsigned long messages;
+    unsigned long bytes;
+};
+
+void FleetSimulator::report(FILE* output) const {
+    HalAllocationScope scope;
+    WorkerStats total = WorkerStats();
+    for (size_t i = 0; i < workerStats.size(); i++) {
+        const WorkerStats& stats = workerStats[i];
+        total.wakeUps += stats.wakeUps;
+        total.updates += stats.updates;
+        total.commands += stats.commands;
+        for (int j = 0; j < WorkerStats::LAG_BUCKETS; j++) {
+            total.lag[j] += stats.lag[j];
+        }
+        if (stats.maxLag > total.maxLag) {
+            total.maxLag = stats.maxLag;
+        }
+    }
+
+    // smartsuite/room-0001/sensors/data counts as sensors/data
+    std::vector<TopicKind> kinds;
+    unsigned long messages = 0;
+    unsigned long bytes = 0;
+    for (int i = 0; i < NativeHal::getTopicCount(); i++) {
+        TopicStats stats;
+        NativeHal::getTopicStats(i, stats);
+        const char* name = stats.topic;
+        if (strncmp(name, "smartsuite/room-", 16) == 0 && strchr(name + 16, '/') != nullptr) {
+            name = strchr(name + 16, '/') + 1;
+        }
+        size_t k = 0;
+        while (k < kinds.size() && kinds[k].name != name) {
+            k++;
+        }
+        if (k == kinds.size()) {
+            TopicKind kind = {name, 0, 0};
+            kinds.push_back(kind);
+        }
+        kinds[k].messages += stats.messages;
+        kinds[k].bytes += stats.bytes;
+        messages += stats.messages;
+        bytes += stats.bytes;
+    }
+
+    double seconds = runSeconds > 0 ? runSeconds : 1;
+    fprintf(output, "=== Fleet: %lu devices on %d threads, %.1f s ===\n", (unsigned long)members.size(), threads, runSeconds);
+    fprintf(output, "begin()        %.2f s for all devices\n", beginSeconds);
+    fprintf(output, "MQTT           %lu messages (%.1f/s), %lu bytes (%.1f kB/s)\n", messages, messages / seconds,
+            bytes, bytes / seconds / 1000);
+    fprintf(output, "               %-24s %10s %10s %12s\n", "topic", "messages", "per s", "bytes");
+    for (size_t i = 0; i < kinds.size(); i++) {
+        fprintf(output, "               %-24s %10lu %10.1f %12lu\n", kinds[i].name.c_str(), kinds[i].messages,
+                kinds[i].messages / seconds, kinds[i].bytes);
+    }
+    fprintf(output, "Commands       %lu servo commands sent\n", total.commands);
+    fprintf(output, "HTTP           %lu requests (%.1f/s)\n", NativeHal::getHttpRequestCount(),
+            NativeHal::getHttpRequestCount() / seconds);
+    fprintf(output, "Scheduling     %lu wake-ups, %lu update() calls, timer lag us p50 <%llu p99 <%llu max %llu\n",
+            total.wakeUps, total.updates, (unsigned long long)lagPercentile(total.lag, total.wakeUps, 50),
+            (unsigned long long)lagPercentile(total.lag, total.wakeUps, 99), (unsigned long long)total.maxLag);
+
+    if (members.empty()) {
+        return;
+    }
+    long minHeap = NativeHal::getHeapInUse(members[0].board);
+    long maxHeap = minHeap;
+    double sumBegin = 0;
+    double sumEnd = 0;
+    for (size_t i = 0; i < members.size(); i++) {
+        long heap = NativeHal::getHeapInUse(members[i].board);
+        minHeap = heap < minHeap ? heap : minHeap;
+        maxHeap = heap > maxHeap ? heap : maxHeap;
+        sumBegin += members[i].heapAfterBegin;
+        sumEnd += heap;
+    }
+    fprintf(output, "Memory         %lu bytes of device object; heap per device, object included: %.0f bytes after begin(),\n",
+            (unsigned long)members[0].device->getSize(), sumBegin / members.size());
+    fprintf(output, "               %.0f bytes at the end (min %ld, max %ld)\n", sumEnd / members.size(), minHeap, maxHeap);
+}
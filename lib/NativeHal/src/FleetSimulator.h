@@ -0,0 +1,169 @@
+#ifndef FLEET_SIMULATOR_H
+#define FLEET_SIMULATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include "NativeHal.h"
+
+/**
+ * @brief Client ID and topics of one device of a fleet, all under smartsuite/<room>/.
+ */
+struct FleetRoom {
+    static const size_t MAX_NAME = 64;
+
+    int index;
+    char clientId[MAX_NAME];
+    char dataTopic[MAX_NAME];
+    char commandTopic[MAX_NAME];
+    char responseTopic[MAX_NAME];
+    char alertTopic[MAX_NAME];
+    char rulesTopic[MAX_NAME];
+    char metricsTopic[MAX_NAME];
+};
+
+/**
+ * @brief A device the fleet simulator can run: the three calls it needs from the firmware.
+ */
+class VirtualDevice {
+public:
+    virtual ~VirtualDevice() {}
+    virtual void begin() = 0;
+    virtual void update() = 0;
+
+    /**
+     * @brief Milliseconds until the device has work to do, 0 if it has some now.
+     */
+    virtual unsigned long timeUntilNextTask() const = 0;
+
+    /**
+     * @brief Size of the device object itself.
+     */
+    virtual size_t getSize() const = 0;
+};
+
+/**
+ * @brief Adapts any device class with begin(), update() and timeUntilNextTask() to the
+ * fleet simulator. get() gives the device for configuration before begin().
+ */
+template <typename T>
+class FleetDevice : public VirtualDevice {
+public:
+    T& get() { return device; }
+
+    void begin() override { device.begin(); }
+    void update() override { device.update(); }
+    unsigned long timeUntilNextTask() const override { return device.timeUntilNextTask(); }
+    size_t getSize() const override { return sizeof(T); }
+
+private:
+    T device;
+};
+
+/**
+ * @brief Creates the device of a room, configured for its client ID and topics.
+ */
+typedef VirtualDevice* (*FleetFactory)(const FleetRoom& room);
+
+/**
+ * @brief Runs many devices in one process, each on its own simulated board, against the
+ * in-memory broker, to load the backend side and to size the device.
+ *
+ * The devices are not given a thread each: a small pool of worker threads takes them from a
+ * timer queue ordered by when each one next has work, as told by timeUntilNextTask(). A worker
+ * selects the device's board, feeds it the room's scenario (temperature and humidity drifting,
+ * people walking by, a smoke event now and then, servo commands on its command topic, which
+ * the device answers on its response topic), runs
+ * update() until the device is idle and puts it back in the queue. Rooms are offset in time,
+ * so the fleet does not pulse in step.
+ *
+ * The clock is the host clock, so the message rate is the one a real fleet of that size
+ * produces. How late devices are taken from the queue shows whether the pool keeps up.
+ */
+class FleetSimulator {
+public:
+    static const int MAX_UPDATES_PER_WAKE = 16; ///< A busy device goes back in the queue after this many.
+
+    /**
+     * @brief Registers how devices are created. Called by the sketch, before main() runs.
+     * @return Always true, so it can initialize a static.
+     */
+    static bool setFactory(FleetFactory factory);
+    static bool hasFactory();
+
+    FleetSimulator();
+
+    /**
+     * @brief Creates the devices and runs their begin(), one board each.
+     * @return False if no factory is registered.
+     */
+    bool begin(int deviceCount);
+
+    /**
+     * @brief Runs the fleet on a pool of threads for a number of seconds.
+     */
+    void run(int threadCount, double seconds);
+
+    /**
+     * @brief Prints the traffic, the scheduling lag and the memory used per device.
+     */
+    void report(FILE* output) const;
+
+private:
+    /**
+     * @brief One entry of the timer queue: a device and when it next has work, in host us.
+     */
+    struct Timer {
+        uint64_t due;
+        int member;
+
+        bool operator>(const Timer& other) const { return due > other.due; }
+    };
+
+    struct Member {
+        FleetRoom room;
+        VirtualDevice* device;
+        BoardState* board;
+        unsigned long offset;      ///< Where in the scenario the room starts, in ms.
+        unsigned long nextCommand;
+        int commandCount;
+        uint32_t noiseState;
+        long heapAfterBegin;
+    };
+
+    /**
+     * @brief Counters of one worker, merged after the run.
+     */
+    struct WorkerStats {
+        static const int LAG_BUCKETS = 24; ///< Bucket i counts lags under 2^i us.
+
+        unsigned long wakeUps;
+        unsigned long updates;
+        unsigned long commands;
+        unsigned long lag[LAG_BUCKETS];
+        uint64_t maxLag;
+    };
+
+    std::vector<Member> members;
+    std::vector<WorkerStats> workerStats;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer> > timers;
+    std::mutex timerLock;
+    std::condition_variable timerReady;
+    std::atomic<bool> running;
+    double beginSeconds;
+    double runSeconds;
+    int threads;
+
+    void work(WorkerStats& stats);
+    unsigned long service(Member& member, WorkerStats& stats);
+    void applyScenario(Member& member, unsigned long now, WorkerStats& stats);
+    static uint64_t lagPercentile(const unsigned long* buckets, unsigned long total, int percent);
+};
+
+#endif // FLEET_SIMULATOR_H
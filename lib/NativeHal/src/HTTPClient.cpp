@@ -0,0 +1,227 @@
+#include "HTTPClient.h"
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "NativeHal.h"
+
+/**
+ * @brief Splits a plain `http://` URL on a loopback host into its port and path.
+ * @return True if the URL names a server on this host.
+ */
+static bool parseLoopbackUrl(const char* url, std::string& host, uint16_t& port, std::string& path) {
+    const char scheme[] = "http://";
+    if (url == nullptr || strncmp(url, scheme, sizeof(scheme) - 1) != 0) {
+        return false;
+    }
+    const char* start = url + sizeof(scheme) - 1;
+    const char* end = start + strcspn(start, ":/");
+    host.assign(start, end - start);
+    if (host != "127.0.0.1" && host != "localhost") {
+        return false;
+    }
+    port = 80;
+    if (*end == ':') {
+        port = (uint16_t)strtoul(end + 1, nullptr, 10);
+        end += 1 + strcspn(end + 1, "/");
+    }
+    path = *end == '/' ? end : "/";
+    return true;
+}
+
+HTTPClient::~HTTPClient() {
+    closeSocket();
+}
+
+bool HTTPClient::begin(const char* url) {
+    client = nullptr;
+    started = true;
+    loopback = parseLoopbackUrl(url, host, port, path);
+    headers.clear();
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const char* url) {
+    this->client = &client;
+    started = true;
+    loopback = parseLoopbackUrl(url, host, port, path);
+    headers.clear();
+    return true;
+}
+
+void HTTPClient::end() {
+    // Reuse is assumed: the connection stays open for the next request
+    started = false;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+    (void)first;
+    (void)replace;
+    headers += name.c_str();
+    headers += ": ";
+    headers += value.c_str();
+    headers += "\r\n";
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+    if (!started) {
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+    if (client != nullptr && !client->connected() && !client->connect("server", 443)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    if (client == nullptr && WiFi.status() != WL_CONNECTED) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    NativeHal::recordHttpRequest(payload, size);
+    if (loopback) {
+        return postLoopback(payload, size);
+    }
+    return NativeHal::getHttpResponse();
+}
+
+int HTTPClient::POST(const String& payload) {
+    return POST((uint8_t*)payload.c_str(), payload.length());
+}
+
+bool HTTPClient::connected() {
+    if (loopback) {
+        return socketFd >= 0;
+    }
+    return client != nullptr && client->connected();
+}
+
+int HTTPClient::postLoopback(const uint8_t* payload, size_t size) {
+    if (socketFd >= 0) {
+        // The server may have closed the idle connection; a readable socket means it did
+        char probe;
+        ssize_t peeked = recv(socketFd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (peeked >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeSocket();
+        }
+    }
+    if (socketFd < 0 && !openSocket()) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    char head[256];
+    snprintf(head, sizeof(head), "POST %s HTTP/1.1\r\nHost: %s:%u\r\nConnection: keep-alive\r\nContent-Length: %zu\r\n",
+             path.c_str(), host.c_str(), (unsigned)port, size);
+    std::string request = head;
+    request += headers;
+    request += "\r\n";
+    request.append((const char*)payload, size);
+    if (!sendAll(request.data(), request.size())) {
+        closeSocket();
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    return readResponse();
+}
+
+bool HTTPClient::openSocket() {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", (unsigned)port);
+    addrinfo* address = nullptr;
+    if (getaddrinfo(host.c_str(), service, &hints, &address) != 0) {
+        return false;
+    }
+    socketFd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (socketFd >= 0 && connect(socketFd, address->ai_addr, address->ai_addrlen) != 0) {
+        closeSocket();
+    }
+    freeaddrinfo(address);
+    if (socketFd < 0) {
+        return false;
+    }
+    timeval limit;
+    limit.tv_sec = timeout / 1000;
+    limit.tv_usec = (timeout % 1000) * 1000;
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+    setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+    return true;
+}
+
+void HTTPClient::closeSocket() {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+}
+
+bool HTTPClient::sendAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(socketFd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+int HTTPClient::readResponse() {
+    std::string response;
+    size_t headerEnd;
+    char chunk[512];
+    while ((headerEnd = response.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t received = recv(socketFd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            closeSocket();
+            return HTTPC_ERROR_CONNECTION_LOST;
+        }
+        response.append(chunk, received);
+    }
+
+    int status = 0;
+    if (sscanf(response.c_str(), "HTTP/%*d.%*d %d", &status) != 1) {
+        closeSocket();
+        return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    std::string header = response.substr(0, headerEnd);
+    for (size_t i = 0; i < header.size(); i++) {
+        header[i] = tolower((unsigned char)header[i]);
+    }
+    size_t bodyLength = 0;
+    size_t field = header.find("\r\ncontent-length:");
+    if (field != std::string::npos) {
+        bodyLength = strtoul(header.c_str() + field + 17, nullptr, 10);
+    }
+
+    // Drain the body so the connection can carry the next request
+    size_t received = response.size() - (headerEnd + 4);
+    while (received < bodyLength) {
+        ssize_t count = recv(socketFd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            closeSocket();
+            return HTTPC_ERROR_CONNECTION_LOST;
+        }
+        received += count;
+    }
+    if (header.find("\r\nconnection: close") != std::string::npos) {
+        closeSocket();
+    }
+    return status;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:
+            return String("connection refused");
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+            return String("send payload failed");
+        case HTTPC_ERROR_NOT_CONNECTED:
+            return String("not connected");
+        case HTTPC_ERROR_CONNECTION_LOST:
+            return String("connection lost");
+        default:
+            return String();
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+
+/**
+ * @brief HTTP client. Every request is counted by NativeHal and answered with the status code it
+ * holds and an empty body; with the link down, requests fail to connect.
+ *
+ * A plain `http://` URL on 127.0.0.1 or localhost is sent instead to a real server on the host,
+ * over a socket kept open between requests as setReuse(true) does on the board, so the uploader
+ * can be tested end to end against a stand-in server. The response body is read and discarded.
+ */
+class HTTPClient {
+public:
+    bool begin(const char* url);
+    bool begin(const String& url) { return begin(url.c_str()); }
+    bool begin(WiFiClient& client, const char* url);
+    bool begin(WiFiClient& client, const String& url) { return begin(client, url.c_str()); }
+    void end();
+
+    void setReuse(bool reuse) { (void)reuse; }
+    void setTimeout(uint16_t timeout) { this->timeout = timeout; }
+    void setConnectTimeout(int32_t timeout) { (void)timeout; }
+    void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+
+    int POST(uint8_t* payload, size_t size);
+    int POST(const String& payload);
+
+    int getSize() { return 0; }
+    String getString() { return String(); }
+    int writeToStream(Stream* stream) { (void)stream; return 0; }
+    WiFiClient* getStreamPtr() { return client; }
+    bool connected();
+
+    static String errorToString(int error);
+
+    ~HTTPClient();
+
+private:
+    WiFiClient* client = nullptr;
+    bool started = false;
+    uint16_t timeout = 5000;
+
+    // Loopback server, when the URL names one
+    bool loopback = false;
+    std::string host;
+    uint16_t port = 0;
+    std::string path;
+    std::string headers;  ///< Lines added by addHeader() since begin().
+    int socketFd = -1;    ///< Connection kept across requests.
+
+    int postLoopback(const uint8_t* payload, size_t size);
+    bool openSocket();
+    void closeSocket();
+    bool sendAll(const char* data, size_t size);
+    int readResponse();
+};
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,798 @@
+#include "MicroBenchmarks.h"
+#include <ArduinoJson.h>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <string>
+#include <string.h>
+#include <thread>
+#include "BinaryTelemetryEncoder.h"
+#include "ColumnarBatchEncoder.h"
+#include "CommandParser.h"
+#include "Led.h"
+#include "Logger.h"
+#include "MotionProfile.h"
+#include "NativeHal.h"
+#include "PipelineRecords.h"
+#include "Profiler.h"
+#include "RuleEngine.h"
+#include "SmartSuiteDevice.h"
+#include "StaticGraph.h"
+#include "TelemetryDecoder.h"
+#include "TelemetryEncoder.h"
+#include "TopicRouter.h"
+
+/**
+ * @brief One entry of the benchmark table.
+ */
+struct MicroBenchmark {
+    const char* name;
+    const char* description;
+    bool (*function)(FILE* output); ///< Prints its results; false if a check failed.
+};
+
+static volatile uint32_t sink; ///< Results are folded in here so the optimizer keeps the work.
+
+/**
+ * @brief Times `iterations` calls of `body(i)`.
+ * @return Nanoseconds per call.
+ */
+template <typename Body>
+static double nanosPerCall(unsigned long iterations, Body body) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < iterations; i++) {
+        body(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void makeSample(uint32_t index, SensorSample& sample) {
+    // Slowly drifting readings with some jitter, like a room over a day
+    sample.sequence = index + 1;
+    sample.timestamp = index * 2000;
+    sample.temperature = 22.0f + (index % 80) * 0.1f;
+    sample.humidity = 45.0f + (index % 23) * 0.5f;
+    sample.smokeLevel = 300.0f + (index * 7 % 41);
+    sample.servoPosition = (int16_t)(index / 50 % 2 * 90);
+    sample.servo2Position = (int16_t)(index / 70 % 3 * 90);
+    sample.motionDetected = index % 15 < 3;
+}
+
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// encode: the MQTT and HTTP bodies of one sample
+
+static const unsigned long ENCODE_SAMPLES = 200000;
+
+/**
+ * @brief The bodies as sendSensorData() and sendSensorDataHTTP() used to build them: one 1 KB
+ * DynamicJsonDocument each, serialized into a growing string.
+ */
+static size_t encodeWithArduinoJson(const SensorSample& sample, std::string& mqttBody, std::string& httpBody) {
+    DynamicJsonDocument mqttDocument(1024);
+    mqttDocument["temperature"] = sample.temperature;
+    mqttDocument["humidity"] = sample.humidity;
+    mqttDocument["motionDetected"] = sample.motionDetected;
+    mqttDocument["smokeLevel"] = sample.smokeLevel;
+    mqttDocument["servoPosition"] = sample.servoPosition;
+    mqttDocument["servo2Position"] = sample.servo2Position;
+    mqttDocument["timestamp"] = sample.timestamp;
+    mqttBody.clear();
+    serializeJson(mqttDocument, mqttBody);
+
+    DynamicJsonDocument httpDocument(1024);
+    httpDocument["temperature"] = sample.temperature;
+    httpDocument["humidity"] = sample.humidity;
+    httpDocument["motionDetected"] = sample.motionDetected;
+    httpDocument["smokeLevel"] = sample.smokeLevel;
+    httpDocument["servoPosition"] = sample.servoPosition;
+    httpDocument["servo2Position"] = sample.servo2Position;
+    httpDocument["timestamp"] = sample.timestamp;
+    httpDocument["deviceId"] = "SmartSuite_ESP32";
+    httpDocument["source"] = "smartsuite-esp32";
+    httpBody.clear();
+    serializeJson(httpDocument, httpBody);
+    return mqttBody.size() + httpBody.size();
+}
+
+static bool benchmarkEncode(FILE* output) {
+    static TelemetryEncoder encoder;
+    encoder.setSourceInfo("SmartSuite_ESP32", "smartsuite-esp32");
+    std::string mqttBody;
+    std::string httpBody;
+    SensorSample sample;
+    bool encoded = true;
+
+    size_t jsonBytes = 0;
+    double jsonNanos = nanosPerCall(ENCODE_SAMPLES, [&](unsigned long i) {
+        makeSample(i, sample);
+        jsonBytes += encodeWithArduinoJson(sample, mqttBody, httpBody);
+    });
+
+    size_t onceBytes = 0;
+    double onceNanos = nanosPerCall(ENCODE_SAMPLES, [&](unsigned long i) {
+        makeSample(i, sample);
+        size_t mqttLength = 0;
+        size_t httpLength = 0;
+        encoded &= encoder.encode(sample);
+        const char* mqtt = encoder.mqttPayload(mqttLength);
+        const char* http = encoder.httpPayload(httpLength);
+        sink += mqtt[mqttLength - 1] + http[httpLength - 1];
+        onceBytes += mqttLength + httpLength;
+    });
+
+    fprintf(output, "=== encode: MQTT and HTTP JSON bodies of %lu samples ===\n", ENCODE_SAMPLES);
+    fprintf(output, "%-34s %10s %14s\n", "", "ns/sample", "bytes/sample");
+    fprintf(output, "%-34s %10.1f %14.1f\n", "ArduinoJson, two documents", jsonNanos, (double)jsonBytes / ENCODE_SAMPLES);
+    fprintf(output, "%-34s %10.1f %14.1f\n", "TelemetryEncoder, encoded once", onceNanos, (double)onceBytes / ENCODE_SAMPLES);
+    return encoded;
+}
+
+// cbor: size and cost of one sample on the data topic
+
+static const unsigned long CBOR_SAMPLES = 500000;
+
+static bool benchmarkCbor(FILE* output) {
+    static TelemetryEncoder jsonEncoder;
+    static BinaryTelemetryEncoder cborEncoder;
+    SensorSample sample;
+    bool encoded = true;
+
+    size_t jsonBytes = 0;
+    double jsonNanos = nanosPerCall(CBOR_SAMPLES, [&](unsigned long i) {
+        makeSample(i, sample);
+        size_t length = 0;
+        encoded &= jsonEncoder.encode(sample);
+        sink += jsonEncoder.mqttPayload(length)[0];
+        jsonBytes += length;
+    });
+
+    size_t cborBytes = 0;
+    double cborNanos = nanosPerCall(CBOR_SAMPLES, [&](unsigned long i) {
+        makeSample(i, sample);
+        size_t length = 0;
+        encoded &= cborEncoder.encode(sample);
+        sink += cborEncoder.payload(length)[0];
+        cborBytes += length;
+    });
+
+    // Decoding, as a gateway would, checks the round trip on a spread of samples
+    static const unsigned long DECODE_SET = 1024;
+    static uint8_t payloads[DECODE_SET][64];
+    static size_t lengths[DECODE_SET];
+    for (unsigned long i = 0; i < DECODE_SET; i++) {
+        makeSample(i * 37, sample);
+        cborEncoder.encode(sample);
+        const uint8_t* payload = cborEncoder.payload(lengths[i]);
+        encoded &= lengths[i] <= sizeof(payloads[i]);
+        memcpy(payloads[i], payload, lengths[i] <= sizeof(payloads[i]) ? lengths[i] : 0);
+    }
+    bool matched = true;
+    double decodeNanos = nanosPerCall(CBOR_SAMPLES, [&](unsigned long i) {
+        SensorSample decoded;
+        unsigned long index = i % DECODE_SET;
+        if (!TelemetryDecoder::decode(payloads[index], lengths[index], decoded)) {
+            matched = false;
+            return;
+        }
+        if (i < DECODE_SET) {
+            makeSample(index * 37, sample);
+            matched &= decoded.timestamp == sample.timestamp && decoded.motionDetected == sample.motionDetected
+                && decoded.servoPosition == sample.servoPosition && decoded.servo2Position == sample.servo2Position
+                && fabsf(decoded.temperature - sample.temperature) < 0.01f
+                && fabsf(decoded.humidity - sample.humidity) < 0.01f
+                && fabsf(decoded.smokeLevel - sample.smokeLevel) < 0.01f;
+        }
+        sink += decoded.timestamp;
+    });
+
+    fprintf(output, "=== cbor: one sample on the data topic, %lu samples ===\n", CBOR_SAMPLES);
+    fprintf(output, "%-34s %10s %14s\n", "", "ns/sample", "bytes/sample");
+    fprintf(output, "%-34s %10.1f %14.1f\n", "JSON encode", jsonNanos, (double)jsonBytes / CBOR_SAMPLES);
+    fprintf(output, "%-34s %10.1f %14.1f\n", "CBOR encode", cborNanos, (double)cborBytes / CBOR_SAMPLES);
+    fprintf(output, "%-34s %10.1f\n", "CBOR decode (TelemetryDecoder)", decodeNanos);
+    return encoded && matched;
+}
+
+// batch: column-wise batches in the 1 KB PubSubClient buffer
+
+static const unsigned long BATCH_SAMPLES = 200000;
+static const size_t BATCH_PAYLOAD_LIMIT = 1024; ///< SmartSuiteDevice::MQTT_BATCH_BUFFER_SIZE.
+
+/**
+ * @brief A random 10 Hz trace: jittered sampling times, random walks on the readings, motion
+ * and servos changing now and then.
+ */
+static void makeTraceSample(uint32_t& state, SensorSample& sample) {
+    sample.sequence++;
+    sample.timestamp += 95 + nextRandom(state) % 11;
+    sample.temperature = roundf((sample.temperature + (int)(nextRandom(state) % 21 - 10) * 0.01f) * 100) / 100;
+    sample.humidity = roundf((sample.humidity + (int)(nextRandom(state) % 21 - 10) * 0.05f) * 100) / 100;
+    sample.smokeLevel = roundf((sample.smokeLevel + (int)(nextRandom(state) % 41 - 20) * 0.25f) * 100) / 100;
+    if (nextRandom(state) % 50 == 0) {
+        sample.motionDetected = !sample.motionDetected;
+    }
+    if (nextRandom(state) % 200 == 0) {
+        sample.servoPosition = (int16_t)(nextRandom(state) % 181);
+    }
+}
+
+static bool runBatchFormat(const char* name, PayloadFormat format, FILE* output) {
+    static ColumnarBatchEncoder batch;
+    static SensorSample decoded[ColumnarBatchEncoder::MAX_SAMPLES];
+    batch.configure(format, BATCH_PAYLOAD_LIMIT);
+
+    uint32_t state = 7;
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.temperature = 23.0f;
+    sample.humidity = 45.0f;
+    sample.smokeLevel = 310.0f;
+
+    unsigned long messages = 0;
+    size_t bytes = 0;
+    bool exact = true;
+    bool decodedAll = true;
+    // Flushes the batch, checking the size it predicted and, for CBOR, the decoded samples
+    auto flush = [&]() {
+        size_t predicted = batch.getEncodedSize();
+        size_t length = 0;
+        const uint8_t* payload = batch.encode(length);
+        exact &= length > 0 && length == predicted && length <= BATCH_PAYLOAD_LIMIT;
+        if (format == PAYLOAD_CBOR && messages % 64 == 0) {
+            int count = TelemetryDecoder::decodeBatch(payload, length, decoded, ColumnarBatchEncoder::MAX_SAMPLES);
+            decodedAll &= count == batch.getCount();
+            for (int i = 0; i < count && decodedAll; i++) {
+                decodedAll &= decoded[i].timestamp == batch.getSample(i).timestamp
+                    && fabsf(decoded[i].smokeLevel - batch.getSample(i).smokeLevel) < 0.01f;
+            }
+        }
+        sink += payload[length - 1];
+        bytes += length;
+        messages++;
+        batch.clear();
+    };
+
+    double nanos = nanosPerCall(BATCH_SAMPLES, [&](unsigned long) {
+        makeTraceSample(state, sample);
+        if (!batch.add(sample)) {
+            flush();
+            batch.add(sample);
+        }
+    });
+    if (!batch.isEmpty()) {
+        flush();
+    }
+
+    fprintf(output, "%-12s %10.1f %14.1f %16.1f\n", name, nanos, (double)bytes / BATCH_SAMPLES,
+            messages > 0 ? (double)BATCH_SAMPLES / messages : 0.0);
+    return exact && decodedAll;
+}
+
+static bool benchmarkBatch(FILE* output) {
+    fprintf(output, "=== batch: random 10 Hz trace of %lu samples, %u-byte messages ===\n", BATCH_SAMPLES,
+            (unsigned)BATCH_PAYLOAD_LIMIT);
+    fprintf(output, "%-12s %10s %14s %16s\n", "", "ns/sample", "bytes/sample", "samples/message");
+    bool passed = runBatchFormat("JSON batch", PAYLOAD_JSON, output);
+    passed &= runBatchFormat("CBOR batch", PAYLOAD_CBOR, output);
+
+    // One message per sample, for comparison
+    static TelemetryEncoder jsonEncoder;
+    static BinaryTelemetryEncoder cborEncoder;
+    uint32_t state = 7;
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    size_t jsonBytes = 0;
+    size_t cborBytes = 0;
+    for (unsigned long i = 0; i < BATCH_SAMPLES; i++) {
+        makeTraceSample(state, sample);
+        size_t length = 0;
+        passed &= jsonEncoder.encode(sample) && cborEncoder.encode(sample);
+        jsonEncoder.mqttPayload(length);
+        jsonBytes += length;
+        cborEncoder.payload(length);
+        cborBytes += length;
+    }
+    fprintf(output, "%-12s %10s %14.1f %16d\n", "JSON single", "", (double)jsonBytes / BATCH_SAMPLES, 1);
+    fprintf(output, "%-12s %10s %14.1f %16d\n", "CBOR single", "", (double)cborBytes / BATCH_SAMPLES, 1);
+    return passed;
+}
+
+// dispatch: routing an event to its handler in SmartSuiteDevice::on()
+
+static const unsigned long DISPATCH_EVENTS = 20000000;
+
+/**
+ * @brief Handlers with the device's event layout, routed by the same if/else chain as on().
+ */
+class DispatchTarget {
+public:
+    uint32_t calls[8];
+
+    DispatchTarget() {
+        memset(calls, 0, sizeof(calls));
+    }
+
+    void dispatch(const Event& event) {
+        if (event.id >= SmartSuiteDevice::MQTT_KEEPALIVE_TASK_ID && event.id <= SmartSuiteDevice::METRICS_TASK_ID) {
+            onTask(event);
+        } else if (event.id >= ConnectionManager::WIFI_CONNECTED_EVENT_ID &&
+                   event.id <= ConnectionManager::MQTT_DISCONNECTED_EVENT_ID) {
+            onConnection(event);
+        } else if (event == DhtSensor::TEMPERATURE_READ_EVENT) {
+        } else if (event == DhtSensor::HUMIDITY_READ_EVENT) {
+            onClimateRead(event);
+        } else if (event == PirSensor::MOTION_DETECTED_EVENT) {
+            onMotionDetected(event);
+        } else if (event == PirSensor::MOTION_STOPPED_EVENT) {
+            onMotionStopped(event);
+        } else if (event == Mq2Sensor::GAS_MEDIUM_EVENT || event == Mq2Sensor::GAS_HIGH_EVENT) {
+            onGasDetected(event);
+        } else if (event == Mq2Sensor::GAS_CLEAR_EVENT) {
+            onGasClear(event);
+        } else if (event == ServoActuator::POSITION_EVENT || event == ServoActuator::ARRIVED_EVENT) {
+            onServoMoved(event);
+        }
+    }
+
+private:
+    void onTask(const Event& event) { calls[0] += event.id; }
+    void onConnection(const Event&) { calls[1]++; }
+    void onClimateRead(const Event&) { calls[2]++; }
+    void onMotionDetected(const Event&) { calls[3]++; }
+    void onMotionStopped(const Event&) { calls[4]++; }
+    void onGasDetected(const Event& event) { calls[5] += (uint32_t)event.value; }
+    void onGasClear(const Event&) { calls[6]++; }
+    void onServoMoved(const Event& event) { calls[7] += event.sourceId; }
+};
+
+static bool benchmarkDispatch(FILE* output) {
+    // Mostly scheduler jobs, as on the device, then sensor and servo events
+    static const int MIX[] = {
+        SmartSuiteDevice::MQTT_KEEPALIVE_TASK_ID, SmartSuiteDevice::PIR_POLL_TASK_ID,
+        SmartSuiteDevice::MQ2_ACQUIRE_TASK_ID, SmartSuiteDevice::SERVO_MOTION_TASK_ID,
+        SmartSuiteDevice::MQTT_KEEPALIVE_TASK_ID, SmartSuiteDevice::PIR_POLL_TASK_ID,
+        SmartSuiteDevice::MQ2_SAMPLE_TASK_ID, SmartSuiteDevice::TELEMETRY_TASK_ID,
+        DhtSensor::TEMPERATURE_READ_EVENT_ID, DhtSensor::HUMIDITY_READ_EVENT_ID,
+        PirSensor::MOTION_DETECTED_EVENT_ID, PirSensor::MOTION_STOPPED_EVENT_ID,
+        Mq2Sensor::GAS_MEDIUM_EVENT_ID, Mq2Sensor::GAS_CLEAR_EVENT_ID,
+        ServoActuator::POSITION_EVENT_ID, ConnectionManager::MQTT_CONNECTED_EVENT_ID,
+    };
+    static const unsigned long MIX_SIZE = sizeof(MIX) / sizeof(MIX[0]);
+    static const unsigned long POOL_SIZE = 1024; ///< Power of two, indexed with a mask.
+    static int ids[POOL_SIZE];
+    uint32_t state = 11;
+    for (unsigned long i = 0; i < POOL_SIZE; i++) {
+        ids[i] = MIX[nextRandom(state) % MIX_SIZE];
+    }
+    const unsigned long mask = POOL_SIZE - 1;
+
+    DispatchTarget target;
+    double nanos = nanosPerCall(DISPATCH_EVENTS, [&](unsigned long i) {
+        // Payload carried by value, as the sensors send it
+        target.dispatch(Event(ids[i & mask], 350.0f, 18, i));
+    });
+    uint32_t routed = 0;
+    for (int i = 0; i < 8; i++) {
+        routed += target.calls[i];
+        sink += target.calls[i];
+    }
+
+    fprintf(output, "=== dispatch: %lu events in the device's mix of jobs and sensor events ===\n", DISPATCH_EVENTS);
+    fprintf(output, "%-34s %10s %14s\n", "", "ns/event", "Mevents/s");
+    fprintf(output, "%-34s %10.2f %14.1f\n", "if/else chain of on()", nanos, 1000.0 / nanos);
+    return routed > 0;
+}
+
+// graph: handler pointers and virtual calls vs the static wiring of SmartSuiteDevice
+
+static const unsigned long GRAPH_POLLS = 2000000;
+static const unsigned long GRAPH_COMMANDS = 2000000;
+static const uint8_t GRAPH_PIR_PIN = 40;
+static const int GRAPH_LED_PIN = 41; ///< First of three LED pins.
+
+/**
+ * @brief Event receiver reached through an EventHandler pointer.
+ */
+class CountingHandler : public EventHandler {
+public:
+    unsigned long detected = 0;
+    unsigned long stopped = 0;
+
+    void on(Event event) override {
+        if (event == PirSensor::MOTION_DETECTED_EVENT) {
+            detected++;
+        } else {
+            stopped++;
+        }
+    }
+};
+
+/**
+ * @brief The same receiver as a concrete sink, as SmartSuiteDevice is for its sensors.
+ */
+class CountingSink final : public CountingHandler {
+};
+
+static bool benchmarkGraph(FILE* output) {
+    // Motion toggles on every other poll, so half of the polls emit an event
+    CountingHandler handler;
+    PirSensor dynamicPir(GRAPH_PIR_PIN, &handler);
+    double dynamicPollNanos = nanosPerCall(GRAPH_POLLS, [&](unsigned long i) {
+        NativeHal::setDigitalInput(GRAPH_PIR_PIN, (i >> 1) & 1);
+        dynamicPir.readMotion();
+    });
+    NativeHal::setDigitalInput(GRAPH_PIR_PIN, LOW);
+    dynamicPir.readMotion();
+
+    CountingSink sensorSink;
+    PirSensor staticPir(GRAPH_PIR_PIN);
+    double staticPollNanos = nanosPerCall(GRAPH_POLLS, [&](unsigned long i) {
+        NativeHal::setDigitalInput(GRAPH_PIR_PIN, (i >> 1) & 1);
+        staticPir.readMotion(sensorSink);
+    });
+    NativeHal::setDigitalInput(GRAPH_PIR_PIN, LOW);
+    staticPir.readMotion(sensorSink);
+
+    // One command fanned out to three LEDs: virtual handle() per actuator vs ComponentList
+    static const Command COMMANDS[] = {Led::TOGGLE_LED_COMMAND, Led::TURN_ON_COMMAND,
+        Led::TOGGLE_LED_COMMAND, Led::TURN_OFF_COMMAND, Led::TOGGLE_LED_COMMAND};
+    static const unsigned long COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+    Led dynamicLeds[] = {Led(GRAPH_LED_PIN), Led(GRAPH_LED_PIN + 1), Led(GRAPH_LED_PIN + 2, true)};
+    CommandHandler* handlers[] = {&dynamicLeds[0], &dynamicLeds[1], &dynamicLeds[2]};
+    double dynamicCommandNanos = nanosPerCall(GRAPH_COMMANDS, [&](unsigned long i) {
+        for (CommandHandler* target : handlers) {
+            target->handle(COMMANDS[i % COMMAND_COUNT]);
+        }
+    });
+
+    Led first(GRAPH_LED_PIN);
+    Led second(GRAPH_LED_PIN + 1);
+    Led third(GRAPH_LED_PIN + 2, true);
+    ComponentList<Led, Led, Led> staticLeds = makeComponentList(first, second, third);
+    double staticCommandNanos = nanosPerCall(GRAPH_COMMANDS, [&](unsigned long i) {
+        staticLeds.forEach(ApplyCommand(COMMANDS[i % COMMAND_COUNT]));
+    });
+    sink += handler.detected + sensorSink.detected + first.getState();
+
+    fprintf(output, "=== graph: %lu PIR polls, %lu commands to 3 LEDs ===\n", GRAPH_POLLS, GRAPH_COMMANDS);
+    fprintf(output, "%-34s %10s %10s\n", "", "ns/poll", "ns/cmd");
+    fprintf(output, "%-34s %10.2f %10.2f\n", "handler pointers, virtual calls", dynamicPollNanos, dynamicCommandNanos);
+    fprintf(output, "%-34s %10.2f %10.2f\n", "static sink, ComponentList", staticPollNanos, staticCommandNanos);
+    return handler.detected == GRAPH_POLLS / 4 && handler.stopped == GRAPH_POLLS / 4
+        && sensorSink.detected == handler.detected && sensorSink.stopped == handler.stopped
+        && first.getState() == dynamicLeds[0].getState() && second.getState() == dynamicLeds[1].getState()
+        && third.getState() == dynamicLeds[2].getState();
+}
+
+// rules: incremental evaluation of a full rule table. The table has the device's capacity;
+// build with PLATFORMIO_BUILD_FLAGS=-DRULE_ENGINE_MAX_RULES=512 to measure a large one.
+
+static const unsigned long RULE_EVALUATIONS = 200000;
+
+/**
+ * @brief Counts the outputs of the rule engine.
+ */
+class CountingRuleHandler : public RuleActionHandler {
+public:
+    unsigned long actions = 0;
+
+    void applyRuleAction(const RuleAction& action) override {
+        actions += action.value + 1;
+    }
+
+    void raiseRuleAlert(const RuleAlert&, float) override {}
+};
+
+static bool benchmarkRules(FILE* output) {
+    // A full table spread evenly over the four fields, one comparison and one LED action each
+    static RuleEngine engine;
+    const int fieldCount = RULE_FIELD_COUNT;
+    const int readersPerField = RuleEngine::MAX_RULES / fieldCount;
+    for (int i = 0; i < RuleEngine::MAX_RULES; i++) {
+        Rule rule;
+        memset(&rule, 0, sizeof(rule));
+        rule.termCount = 1;
+        rule.terms[0].field = (uint8_t)(i % fieldCount);
+        rule.terms[0].op = RULE_GREATER;
+        rule.terms[0].threshold = (float)(i / fieldCount);
+        rule.activeActionCount = 1;
+        rule.activeActions[0].type = RULE_ACTION_LED;
+        rule.activeActions[0].value = 1;
+        rule.inactiveActionCount = 1;
+        rule.inactiveActions[0].type = RULE_ACTION_LED;
+        if (!engine.addRule(rule)) {
+            return false;
+        }
+    }
+    CountingRuleHandler handler;
+    for (int field = 0; field < fieldCount; field++) {
+        engine.setField((RuleField)field, 0);
+    }
+    engine.evaluate(0, handler);
+
+    // One field moving back and forth across a few thresholds on every evaluation
+    unsigned long checksBefore = engine.getCheckCount();
+    double changedNanos = nanosPerCall(RULE_EVALUATIONS, [&](unsigned long i) {
+        engine.setField(RULE_FIELD_TEMPERATURE, (i & 1) ? readersPerField / 2 + 3.5f : readersPerField / 2 - 0.5f);
+        engine.evaluate((uint32_t)i, handler);
+    });
+    unsigned long changedChecks = engine.getCheckCount() - checksBefore;
+
+    checksBefore = engine.getCheckCount();
+    double idleNanos = nanosPerCall(RULE_EVALUATIONS, [&](unsigned long i) {
+        engine.evaluate((uint32_t)i, handler);
+    });
+    unsigned long idleChecks = engine.getCheckCount() - checksBefore;
+    sink += handler.actions;
+
+    fprintf(output, "=== rules: %d rules, %lu evaluations ===\n", RuleEngine::MAX_RULES, RULE_EVALUATIONS);
+    fprintf(output, "%-34s %10s %10s\n", "", "ns/eval", "checks");
+    fprintf(output, "%-34s %10.2f %10lu\n", "one field changed", changedNanos, changedChecks / RULE_EVALUATIONS);
+    fprintf(output, "%-34s %10.2f %10lu\n", "nothing changed", idleNanos, idleChecks / RULE_EVALUATIONS);
+    return changedChecks == RULE_EVALUATIONS * readersPerField && idleChecks == 0;
+}
+
+// parser: routing and decoding an incoming servo command, as handleMQTTMessage() does
+
+static const unsigned long PARSER_MESSAGES = 2000000;
+
+static bool benchmarkParser(FILE* output) {
+    static const char* const PAYLOADS[] = {
+        "{\"servo\": 1, \"position\": 90}",
+        "{\"servo\": 2, \"position\": 0}",
+        "{\"position\": 180, \"source\": \"dashboard\", \"user\": {\"id\": 42}}",
+        "{\"servo\": 2, \"position\": 45.5}",
+    };
+    static const int PAYLOAD_COUNT = sizeof(PAYLOADS) / sizeof(PAYLOADS[0]);
+    size_t lengths[PAYLOAD_COUNT];
+    for (int i = 0; i < PAYLOAD_COUNT; i++) {
+        lengths[i] = strlen(PAYLOADS[i]);
+    }
+    // The device's subscriptions, with the servo topic last
+    TopicRouter router;
+    router.add("smartsuite/config/rules", SmartSuiteDevice::RULES_TOPIC_ID);
+    router.add("smartsuite/servo/command", SmartSuiteDevice::SERVO_COMMAND_TOPIC_ID);
+
+    unsigned long accepted = 0;
+    unsigned long positions = 0;
+    unsigned long allocations = NativeHal::getAllocationCount();
+    double nanos = nanosPerCall(PARSER_MESSAGES, [&](unsigned long i) {
+        int payload = i % PAYLOAD_COUNT;
+        ServoCommandRecord command;
+        if (router.route("smartsuite/servo/command") == SmartSuiteDevice::SERVO_COMMAND_TOPIC_ID
+            && CommandParser::parseServoCommand((const uint8_t*)PAYLOADS[payload], lengths[payload], command) == COMMAND_PARSE_OK) {
+            accepted++;
+            positions += command.position;
+        }
+    });
+    allocations = NativeHal::getAllocationCount() - allocations;
+    sink += positions;
+
+    fprintf(output, "=== parser: %lu servo commands routed and parsed ===\n", PARSER_MESSAGES);
+    fprintf(output, "%-34s %10.2f\n", "ns/message", nanos);
+    fprintf(output, "%-34s %10.2f\n", "million messages/s", 1000.0 / nanos);
+    fprintf(output, "%-34s %10lu\n", "allocations", allocations);
+    return accepted == PARSER_MESSAGES && allocations == 0;
+}
+
+// motion: stepping many servo profiles, as the 20 ms servo task does for two
+
+static const int MOTION_SERVOS = 10000;
+static const int MOTION_ROUNDS = 500;
+static const float MOTION_STEP = 0.02f;
+
+static bool benchmarkMotion(FILE* output) {
+    static MotionProfile profiles[MOTION_SERVOS];
+    uint32_t state = 17;
+    for (int i = 0; i < MOTION_SERVOS; i++) {
+        profiles[i].setTarget((float)(nextRandom(state) % 181));
+    }
+    // Each servo gets a new target when it arrives, so most of them are moving at any time
+    unsigned long arrivals = 0;
+    bool inRange = true;
+    double nanos = nanosPerCall(MOTION_ROUNDS, [&](unsigned long) {
+        for (int i = 0; i < MOTION_SERVOS; i++) {
+            if (profiles[i].advance(MOTION_STEP)) {
+                arrivals++;
+                profiles[i].setTarget((float)(nextRandom(state) % 181));
+            }
+            inRange = inRange && profiles[i].getPosition() > -0.5f && profiles[i].getPosition() < 180.5f;
+        }
+    }) / MOTION_SERVOS;
+    sink += arrivals;
+
+    MotionProfile single;
+    single.setTarget(90);
+    int steps = 0;
+    float highest = 0;
+    while (steps < 1000 && !single.advance(MOTION_STEP)) {
+        steps++;
+        highest = single.getPosition() > highest ? single.getPosition() : highest;
+    }
+    steps++;
+
+    fprintf(output, "=== motion: %d servos, %d steps of %.0f ms each ===\n", MOTION_SERVOS, MOTION_ROUNDS, MOTION_STEP * 1000);
+    fprintf(output, "%-34s %10.2f\n", "ns/servo-step", nanos);
+    fprintf(output, "%-34s %10.2f\n", "million servo-steps/s", 1000.0 / nanos);
+    fprintf(output, "%-34s %10lu\n", "arrivals", arrivals);
+    fprintf(output, "%-34s %10.2f\n", "0 -> 90 deg, s", steps * MOTION_STEP);
+    fprintf(output, "%-34s %10.5f\n", "0 -> 90 deg, highest position", highest);
+    return inRange && arrivals > 0 && single.getPosition() == 90.0f && highest < 90.001f;
+}
+
+// logger: cost of a LOG_INFO call, with and without writing the records out
+
+static const unsigned long LOG_MESSAGES = 1000000;
+static const unsigned long LOG_DRAIN_EVERY = 16; ///< Records per drain; they fit in the ring.
+static const int LOG_PRODUCERS = 2; ///< Threads queueing at once in the shared case.
+static const long LOG_STALL_MICROS = 10;
+
+static bool benchmarkLogger(FILE* output) {
+    // A typical status line: an integer, a float and a short string
+    uint32_t packedBytes = 0;
+    double packNanos = nanosPerCall(LOG_MESSAGES, [&](unsigned long i) {
+        LogRecord record(LOG_LEVEL_INFO, (uint32_t)i, "Servo %d at %f deg, %s");
+        record.add((int)(i & 1) + 1);
+        record.add(90.5 + (i & 7));
+        record.add("moving");
+        packedBytes += record.size();
+    });
+    sink += packedBytes;
+
+    unsigned long droppedBefore = Logger::getDroppedCount();
+    unsigned long serialBefore = NativeHal::getSerialBytes();
+    Logger::setTextOutput(false);
+    double binaryNanos = nanosPerCall(LOG_MESSAGES, [&](unsigned long i) {
+        LOG_INFO("Servo %d at %f deg, %s", (int)(i & 1) + 1, 90.5 + (i & 7), "moving");
+        if (i % LOG_DRAIN_EVERY == LOG_DRAIN_EVERY - 1) {
+            Logger::drain();
+        }
+    });
+    unsigned long binaryBytes = NativeHal::getSerialBytes() - serialBefore;
+
+    Logger::setTextOutput(true);
+    serialBefore = NativeHal::getSerialBytes();
+    double textNanos = nanosPerCall(LOG_MESSAGES, [&](unsigned long i) {
+        LOG_INFO("Servo %d at %f deg, %s", (int)(i & 1) + 1, 90.5 + (i & 7), "moving");
+        if (i % LOG_DRAIN_EVERY == LOG_DRAIN_EVERY - 1) {
+            Logger::drain();
+        }
+    });
+    unsigned long textBytes = NativeHal::getSerialBytes() - serialBefore;
+    unsigned long dropped = Logger::getDroppedCount() - droppedBefore;
+
+    // Two producers at once while a third thread drains, as the control and network tasks do
+    Logger::setTextOutput(false);
+    droppedBefore = Logger::getDroppedCount();
+    std::atomic<int> producing(LOG_PRODUCERS);
+    unsigned long stalls[LOG_PRODUCERS] = {0};
+    double sharedNanos = nanosPerCall(1, [&](unsigned long) {
+        std::thread drainer([&producing]() {
+            while (producing.load() > 0) {
+                Logger::drain();
+            }
+            Logger::drain();
+        });
+        std::thread producers[LOG_PRODUCERS];
+        for (int p = 0; p < LOG_PRODUCERS; p++) {
+            producers[p] = std::thread([&producing, &stalls, p]() {
+                for (unsigned long i = 0; i < LOG_MESSAGES; i++) {
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    LOG_INFO("Servo %d at %f deg, %s", (int)(i & 1) + 1, 90.5 + (i & 7), "moving");
+                    if (std::chrono::steady_clock::now() - start > std::chrono::microseconds(LOG_STALL_MICROS)) {
+                        stalls[p]++;
+                    }
+                }
+                producing--;
+            });
+        }
+        for (int p = 0; p < LOG_PRODUCERS; p++) {
+            producers[p].join();
+        }
+        drainer.join();
+    }) / (LOG_PRODUCERS * LOG_MESSAGES);
+    unsigned long sharedDropped = Logger::getDroppedCount() - droppedBefore;
+    Logger::setTextOutput(true);
+
+    fprintf(output, "=== logger: %lu LOG_INFO calls with 3 arguments, drained every %lu ===\n", LOG_MESSAGES, LOG_DRAIN_EVERY);
+    fprintf(output, "%-34s %10s %10s\n", "", "ns/call", "bytes/call");
+    fprintf(output, "%-34s %10.2f %10.2f\n", "packing only", packNanos, (double)packedBytes / LOG_MESSAGES);
+    fprintf(output, "%-34s %10.2f %10.2f\n", "queue + drain, binary frames", binaryNanos, (double)binaryBytes / LOG_MESSAGES);
+    fprintf(output, "%-34s %10.2f %10.2f\n", "queue + drain, text", textNanos, (double)textBytes / LOG_MESSAGES);
+    fprintf(output, "%-34s %10.2f\n", "two threads queueing, one draining", sharedNanos);
+    fprintf(output, "%-34s %10lu\n", "  calls over 10 us", stalls[0] + stalls[1]);
+    fprintf(output, "%-34s %10lu\n", "dropped", dropped);
+    fprintf(output, "%-34s %10lu\n", "dropped, two threads", sharedDropped);
+    return dropped == 0 && binaryBytes == (unsigned long)packedBytes + 3 * LOG_MESSAGES;
+}
+
+// span: cost of an empty PROFILE_SPAN scope, alone and with two threads recording at once into
+// one profiler, and with no profiler selected
+
+static const unsigned long SPAN_RUNS = 2000000;
+
+static void runSpans(unsigned long runs) {
+    for (unsigned long i = 0; i < runs; i++) {
+        PROFILE_SPAN("microSpan");
+    }
+}
+
+static bool benchmarkSpan(FILE* output) {
+    double clockNanos = nanosPerCall(SPAN_RUNS, [&](unsigned long) {
+        sink += Profiler::now();
+    });
+    double idleNanos = nanosPerCall(SPAN_RUNS, [&](unsigned long) {
+        runSpans(1);
+    });
+    int span = Profiler::registerSpan("microSpan");
+    Profiler profiler;
+    Profiler::select(&profiler);
+    double spanNanos = nanosPerCall(SPAN_RUNS, [&](unsigned long) {
+        runSpans(1);
+    });
+    double sharedNanos = nanosPerCall(1, [&](unsigned long) {
+        std::thread other([&profiler]() {
+            ProfilerSelection selection(profiler);
+            runSpans(SPAN_RUNS);
+        });
+        runSpans(SPAN_RUNS);
+        other.join();
+    }) / SPAN_RUNS;
+    Profiler::select(nullptr);
+    SpanStats stats;
+    bool found = profiler.getStats(span, stats);
+
+    fprintf(output, "=== span: %lu empty PROFILE_SPAN scopes ===\n", SPAN_RUNS);
+    fprintf(output, "%-34s %10s\n", "", "ns/span");
+    fprintf(output, "%-34s %10.2f\n", "clock read alone", clockNanos);
+    fprintf(output, "%-34s %10.2f\n", "no profiler selected", idleNanos);
+    fprintf(output, "%-34s %10.2f\n", "one thread", spanNanos);
+    fprintf(output, "%-34s %10.2f\n", "two threads, same span", sharedNanos);
+    return found && stats.count == 3 * SPAN_RUNS;
+}
+
+static const MicroBenchmark BENCHMARKS[] = {
+    {"encode", "Telemetry JSON: encode-once buffer vs two ArduinoJson documents", benchmarkEncode},
+    {"cbor", "Data topic payload: JSON vs CBOR size and encode time, CBOR decode", benchmarkCbor},
+    {"batch", "Column-wise batches of a 10 Hz trace in 1 KB messages vs one message per sample", benchmarkBatch},
+    {"dispatch", "Event routing through the if/else chain of SmartSuiteDevice::on()", benchmarkDispatch},
+    {"graph", "Sensor polls and LED commands: handler pointers vs the static component wiring", benchmarkGraph},
+    {"rules", "Rule table evaluation with one field changed and with nothing changed", benchmarkRules},
+    {"parser", "MQTT servo commands: topic routing plus in-place parsing, and allocations", benchmarkParser},
+    {"motion", "Trapezoidal servo profiles: steps per second and a 0 to 90 degree move", benchmarkMotion},
+    {"logger", "LOG_INFO: packing a record, and queueing plus draining it as binary or text", benchmarkLogger},
+    {"span", "Profiler: cost of a PROFILE_SPAN, alone, with two threads recording, and unselected", benchmarkSpan},
+};
+static const int BENCHMARK_COUNT = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+int MicroBenchmarks::run(const char* name, FILE* output) {
+    bool found = false;
+    bool passed = true;
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        if (name != nullptr && strcmp(name, BENCHMARKS[i].name) != 0) {
+            continue;
+        }
+        if (found) {
+            fprintf(output, "\n");
+        }
+        found = true;
+        if (!BENCHMARKS[i].function(output)) {
+            fprintf(output, "%s: check failed\n", BENCHMARKS[i].name);
+            passed = false;
+        }
+    }
+    if (!found) {
+        return 2;
+    }
+    return passed ? 0 : 1;
+}
+
+void MicroBenchmarks::list(FILE* output) {
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        fprintf(output, "  %-10s %s\n", BENCHMARKS[i].name, BENCHMARKS[i].description);
+    }
+}
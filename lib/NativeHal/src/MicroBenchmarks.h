@@ -0,0 +1,31 @@
+#ifndef MICRO_BENCHMARKS_H
+#define MICRO_BENCHMARKS_H
+
+#include <stdio.h>
+
+/**
+ * @brief Host microbenchmarks of the firmware's hot paths.
+ *
+ * Each benchmark times one component on its own, with no board or loop around it, usually
+ * next to the code it replaced, and checks that both produce the same result. Run them with
+ * `program --micro [NAME]`. The figures are host time: they rank implementations and show
+ * how costs scale, but are not ESP32 timings.
+ */
+class MicroBenchmarks {
+public:
+    /**
+     * @brief Runs one benchmark, or all of them.
+     * @param name Benchmark to run, or nullptr for all.
+     * @param output Where to print the results.
+     * @return 0 on success, 1 if a benchmark's check failed, 2 if no benchmark has that name.
+     */
+    static int run(const char* name, FILE* output);
+
+    /**
+     * @brief Prints the name and description of every benchmark.
+     * @param output Where to print.
+     */
+    static void list(FILE* output);
+};
+
+#endif // MICRO_BENCHMARKS_H
@@ -0,0 +1,746 @@
+#include "NativeHal.h"
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <stdarg.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "DHT.h"
+#include "PubSubClient.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+/**
+ * @brief Everything the board knows about one pin.
+ */
+struct PinState {
+    uint8_t mode = INPUT;
+    uint8_t output = LOW;   ///< Level written by the firmware.
+    uint8_t input = LOW;    ///< Level driven from outside.
+    uint16_t analog = 0;
+    void (*handler)(void*) = nullptr;
+    void (*plainHandler)() = nullptr;
+    void* arg = nullptr;
+    int interruptMode = 0;
+    uint8_t dhtType = 0;    ///< 0 when no DHT sensor is on the pin.
+    float dhtTemperature = 24.0f;
+    float dhtHumidity = 50.0f;
+    int servoAngle = -1;
+};
+
+/**
+ * @brief Counters of one MQTT topic. Kept in a deque so the topic strings never move.
+ */
+struct TopicRecord {
+    std::string topic;
+    unsigned long messages;
+    unsigned long bytes;
+};
+
+/**
+ * @brief What belongs to one board rather than to the world around it.
+ */
+struct BoardState {
+    PinState pins[NativeHal::PIN_COUNT];
+    PinState unusedPin;
+    int64_t edgeTime = -1; ///< What micros() returns while a simulated edge is being delivered.
+    uint32_t randomState = 0x2545F491;
+    bool wifiStarted = false;
+    std::atomic<long> heapInUse{0};
+};
+
+/**
+ * @brief Put in front of every heap block, so a block freed on another board is still
+ * subtracted from the board that allocated it.
+ */
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+    size_t size;
+    BoardState* owner; ///< nullptr for blocks left out of the counters.
+};
+
+static BoardState mainBoard;
+static thread_local BoardState* board = &mainBoard;
+
+static std::atomic<bool> realTime(true);
+static std::atomic<uint64_t> virtualTime(0);
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static std::atomic<bool> serialEcho(true);
+static std::atomic<unsigned long> serialBytes(0);
+
+static std::atomic<unsigned long> allocationCount(0);
+static std::atomic<unsigned long> allocatedBytes(0);
+static thread_local int allocationPause = 0;
+
+static unsigned long (*idleHint)() = nullptr;
+static std::atomic<BoardObserver*> observer(nullptr); ///< Read by the log drain thread too.
+static const char* journalPath = "journal.bin";
+
+static std::atomic<bool> wifiAvailable(true);
+static std::atomic<int> httpResponse(200);
+static std::atomic<unsigned long> httpRequests(0);
+static std::atomic<unsigned long> httpBytes(0);
+
+// The broker: clients, their subscriptions and the topic counters, shared by every board
+static std::mutex brokerLock;
+
+// Built on first use: PubSubClient instances register from static constructors in other files
+static std::vector<PubSubClient*>& clients() {
+    static std::vector<PubSubClient*> list;
+    return list;
+}
+
+static std::deque<TopicRecord>& topics() {
+    static std::deque<TopicRecord> list;
+    return list;
+}
+
+static std::unordered_map<std::string, size_t>& topicIndex() {
+    static std::unordered_map<std::string, size_t> index;
+    return index;
+}
+
+/**
+ * @brief Clients by the exact topics they subscribed to, so a publish only reaches the
+ * clients that asked for it instead of every client of the fleet.
+ */
+static std::unordered_map<std::string, std::vector<PubSubClient*> >& subscribers() {
+    static std::unordered_map<std::string, std::vector<PubSubClient*> > map;
+    return map;
+}
+
+/**
+ * @brief Clients with + or # filters and how many they have; they are offered every message.
+ */
+static std::unordered_map<PubSubClient*, int>& wildcardSubscribers() {
+    static std::unordered_map<PubSubClient*, int> map;
+    return map;
+}
+
+static bool isWildcard(const char* filter) {
+    return strpbrk(filter, "+#") != nullptr;
+}
+
+static PinState& pinAt(uint8_t pin) {
+    return pin < NativeHal::PIN_COUNT ? board->pins[pin] : board->unusedPin;
+}
+
+static uint64_t hostTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+static void raiseEdge(PinState& state, uint8_t level) {
+    state.input = level;
+    bool triggered = state.interruptMode == CHANGE ||
+                     (state.interruptMode == RISING && level == HIGH) ||
+                     (state.interruptMode == FALLING && level == LOW);
+    if (!triggered) {
+        return;
+    }
+    if (state.handler != nullptr) {
+        state.handler(state.arg);
+    } else if (state.plainHandler != nullptr) {
+        state.plainHandler();
+    }
+}
+
+/**
+ * @brief Plays the answer of a DHT sensor to a start signal: 80 us low, 80 us high, then per bit
+ * 50 us low and 26 us (0) or 70 us (1) high, and the line released.
+ */
+static void sendDhtFrame(PinState& state) {
+    uint8_t data[5];
+    float humidity = state.dhtHumidity;
+    float temperature = state.dhtTemperature;
+    if (state.dhtType == DHT21 || state.dhtType == DHT22) {
+        uint16_t rawHumidity = (uint16_t)lroundf(humidity * 10.0f);
+        uint16_t rawTemperature = (uint16_t)lroundf(fabsf(temperature) * 10.0f);
+        data[0] = rawHumidity >> 8;
+        data[1] = rawHumidity & 0xFF;
+        data[2] = ((rawTemperature >> 8) & 0x7F) | (temperature < 0 ? 0x80 : 0);
+        data[3] = rawTemperature & 0xFF;
+    } else {
+        long tenthsHumidity = lroundf(humidity * 10.0f);
+        long tenthsTemperature = lroundf(fabsf(temperature) * 10.0f);
+        data[0] = tenthsHumidity / 10;
+        data[1] = tenthsHumidity % 10;
+        data[2] = tenthsTemperature / 10;
+        data[3] = (tenthsTemperature % 10) | (temperature < 0 ? 0x80 : 0);
+    }
+    data[4] = data[0] + data[1] + data[2] + data[3];
+
+    uint64_t time = NativeHal::getTime();
+    struct Step {
+        uint16_t after;
+        uint8_t level;
+    };
+    Step steps[3 + 80 + 1];
+    int count = 0;
+    steps[count++] = {30, LOW};
+    steps[count++] = {80, HIGH};
+    steps[count++] = {80, LOW};
+    for (int bit = 0; bit < 40; bit++) {
+        bool one = (data[bit / 8] >> (7 - bit % 8)) & 1;
+        steps[count++] = {50, HIGH};
+        steps[count++] = {(uint16_t)(one ? 70 : 26), LOW};
+    }
+    steps[count++] = {50, HIGH};
+
+    for (int i = 0; i < count; i++) {
+        time += steps[i].after;
+        board->edgeTime = (int64_t)time;
+        raiseEdge(state, steps[i].level);
+    }
+    board->edgeTime = -1;
+}
+
+// Arduino core
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    PinState& state = pinAt(pin);
+    bool startSignal = state.dhtType != 0 && state.mode == OUTPUT && state.output == LOW && mode != OUTPUT;
+    state.mode = mode;
+    if (startSignal) {
+        sendDhtFrame(state);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    PinState& state = pinAt(pin);
+    uint8_t level = value ? HIGH : LOW;
+    if (state.output == level) {
+        return;
+    }
+    state.output = level;
+    BoardObserver* current = observer;
+    if (current != nullptr) {
+        current->onDigitalWrite(pin, level);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    PinState& state = pinAt(pin);
+    return state.mode == OUTPUT ? state.output : state.input;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return pinAt(pin).analog;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    PinState& state = pinAt(pin);
+    state.handler = nullptr;
+    state.plainHandler = handler;
+    state.arg = nullptr;
+    state.interruptMode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    PinState& state = pinAt(pin);
+    state.handler = handler;
+    state.plainHandler = nullptr;
+    state.arg = arg;
+    state.interruptMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    PinState& state = pinAt(pin);
+    state.handler = nullptr;
+    state.plainHandler = nullptr;
+    state.interruptMode = 0;
+}
+
+unsigned long millis() {
+    return (unsigned long)(NativeHal::getTime() / 1000);
+}
+
+unsigned long micros() {
+    return board->edgeTime >= 0 ? (unsigned long)board->edgeTime : (unsigned long)NativeHal::getTime();
+}
+
+void delay(uint32_t ms) {
+    delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (realTime) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    } else {
+        virtualTime += us;
+    }
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+// xorshift32: the same sequence on every run, so virtual-time runs are reproducible
+long random(long max) {
+    return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    board->randomState = seed != 0 ? (uint32_t)seed : 0x2545F491;
+}
+
+uint32_t esp_random() {
+    uint32_t& state = board->randomState;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static String formatNumber(const char* format, unsigned char base, long long value) {
+    char text[32];
+    if (base == HEX) {
+        snprintf(text, sizeof(text), "%llx", (unsigned long long)value);
+    } else {
+        snprintf(text, sizeof(text), format, value);
+    }
+    return String(text);
+}
+
+String::String(int value, unsigned char base) : String(formatNumber("%lld", base, value)) {}
+String::String(unsigned int value, unsigned char base) : String(formatNumber("%llu", base, value)) {}
+String::String(long value, unsigned char base) : String(formatNumber("%lld", base, value)) {}
+String::String(unsigned long value, unsigned char base) : String(formatNumber("%llu", base, (long long)value)) {}
+
+String::String(double value, unsigned int decimals) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    text = buffer;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t count = 0;
+    while (count < size && write(buffer[count])) {
+        count++;
+    }
+    return count;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write((const uint8_t*)text, (size_t)length < sizeof(text) ? length : sizeof(text) - 1);
+}
+
+size_t Print::print(long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int decimals) {
+    return print(String(value, (unsigned int)decimals));
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    serialBytes += size;
+    BoardObserver* current = observer;
+    if (current != nullptr) {
+        current->onSerialWrite(buffer, size);
+    }
+    if (serialEcho) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(hostTime() * getCpuFreqMHz());
+}
+
+// Heap: count every allocation made outside a HalAllocationScope, and charge it to the board
+
+static void* allocate(size_t size) {
+    BlockHeader* header = (BlockHeader*)malloc(sizeof(BlockHeader) + size);
+    if (header == nullptr) {
+        return nullptr;
+    }
+    header->size = size;
+    header->owner = nullptr;
+    if (allocationPause == 0) {
+        allocationCount++;
+        allocatedBytes += size;
+        header->owner = board;
+        board->heapInUse += (long)size;
+    }
+    return header + 1;
+}
+
+static void release(void* block) {
+    if (block == nullptr) {
+        return;
+    }
+    BlockHeader* header = (BlockHeader*)block - 1;
+    if (header->owner != nullptr) {
+        header->owner->heapInUse -= (long)header->size;
+    }
+    free(header);
+}
+
+void* operator new(size_t size) {
+    void* block = allocate(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block) noexcept {
+    release(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    release(block);
+}
+
+HalAllocationScope::HalAllocationScope() {
+    allocationPause++;
+}
+
+HalAllocationScope::~HalAllocationScope() {
+    allocationPause--;
+}
+
+// Control panel
+
+void NativeHal::setRealTime(bool enabled) {
+    if (!enabled && realTime) {
+        virtualTime = hostTime();
+    }
+    realTime = enabled;
+}
+
+bool NativeHal::isRealTime() {
+    return realTime;
+}
+
+uint64_t NativeHal::getTime() {
+    return realTime ? hostTime() : virtualTime.load();
+}
+
+void NativeHal::advance(uint64_t micros) {
+    if (!realTime) {
+        virtualTime += micros;
+    }
+}
+
+void NativeHal::setIdleHint(unsigned long (*hint)()) {
+    idleHint = hint;
+}
+
+unsigned long NativeHal::getIdleTime() {
+    return idleHint != nullptr ? idleHint() : 0;
+}
+
+void NativeHal::setObserver(BoardObserver* boardObserver) {
+    observer = boardObserver;
+}
+
+void NativeHal::setJournalPath(const char* path) {
+    journalPath = path;
+}
+
+const char* NativeHal::getJournalPath() {
+    return journalPath;
+}
+
+BoardState* NativeHal::createBoard(uint32_t seed) {
+    HalAllocationScope scope;
+    BoardState* created = new BoardState();
+    created->randomState = seed != 0 ? seed : 0x2545F491;
+    return created;
+}
+
+void NativeHal::selectBoard(BoardState* selected) {
+    board = selected != nullptr ? selected : &mainBoard;
+}
+
+long NativeHal::getHeapInUse(BoardState* selected) {
+    return (selected != nullptr ? selected : &mainBoard)->heapInUse;
+}
+
+void NativeHal::setDigitalInput(uint8_t pin, int level) {
+    PinState& state = pinAt(pin);
+    uint8_t value = level ? HIGH : LOW;
+    if (state.input != value) {
+        raiseEdge(state, value);
+    }
+}
+
+int NativeHal::getDigitalInput(uint8_t pin) {
+    return pinAt(pin).input;
+}
+
+int NativeHal::getDigitalOutput(uint8_t pin) {
+    return pinAt(pin).output;
+}
+
+void NativeHal::setAnalogInput(uint8_t pin, uint16_t value) {
+    pinAt(pin).analog = value > 4095 ? 4095 : value;
+}
+
+void NativeHal::setDhtReading(uint8_t pin, float temperature, float humidity) {
+    PinState& state = pinAt(pin);
+    state.dhtTemperature = temperature;
+    state.dhtHumidity = humidity;
+}
+
+int NativeHal::getServoAngle(uint8_t pin) {
+    return pinAt(pin).servoAngle;
+}
+
+void NativeHal::setSerialEcho(bool enabled) {
+    serialEcho = enabled;
+}
+
+unsigned long NativeHal::getSerialBytes() {
+    return serialBytes;
+}
+
+unsigned long NativeHal::getAllocationCount() {
+    return allocationCount;
+}
+
+unsigned long NativeHal::getAllocatedBytes() {
+    return allocatedBytes;
+}
+
+void NativeHal::setWiFiAvailable(bool available) {
+    wifiAvailable = available;
+    if (!available) {
+        std::lock_guard<std::mutex> guard(brokerLock);
+        for (size_t i = 0; i < clients().size(); i++) {
+            clients()[i]->dropConnection();
+        }
+    }
+}
+
+bool NativeHal::isWiFiAvailable() {
+    return wifiAvailable;
+}
+
+// Called with brokerLock held
+static void deliver(const char* topic, const uint8_t* payload, size_t length) {
+    HalAllocationScope scope;
+    std::unordered_map<PubSubClient*, int>& wildcards = wildcardSubscribers();
+    std::unordered_map<std::string, std::vector<PubSubClient*> >::iterator exact = subscribers().find(topic);
+    if (exact != subscribers().end()) {
+        for (size_t i = 0; i < exact->second.size(); i++) {
+            if (wildcards.count(exact->second[i]) == 0) {
+                exact->second[i]->offer(topic, payload, length);
+            }
+        }
+    }
+    for (std::unordered_map<PubSubClient*, int>::iterator it = wildcards.begin(); it != wildcards.end(); ++it) {
+        it->first->offer(topic, payload, length);
+    }
+}
+
+void NativeHal::publish(const char* topic, const uint8_t* payload, size_t length) {
+    std::lock_guard<std::mutex> guard(brokerLock);
+    deliver(topic, payload, length);
+}
+
+int NativeHal::getTopicCount() {
+    std::lock_guard<std::mutex> guard(brokerLock);
+    return (int)topics().size();
+}
+
+bool NativeHal::getTopicStats(int index, TopicStats& stats) {
+    std::lock_guard<std::mutex> guard(brokerLock);
+    if (index < 0 || index >= (int)topics().size()) {
+        return false;
+    }
+    const TopicRecord& record = topics()[index];
+    stats.topic = record.topic.c_str();
+    stats.messages = record.messages;
+    stats.bytes = record.bytes;
+    return true;
+}
+
+void NativeHal::setHttpResponse(int code) {
+    httpResponse = code;
+}
+
+int NativeHal::getHttpResponse() {
+    return httpResponse;
+}
+
+unsigned long NativeHal::getHttpRequestCount() {
+    return httpRequests;
+}
+
+unsigned long NativeHal::getHttpRequestBytes() {
+    return httpBytes;
+}
+
+void NativeHal::recordPublish(const char* topic, const uint8_t* payload, size_t length) {
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(brokerLock);
+    std::deque<TopicRecord>& list = topics();
+    std::pair<std::unordered_map<std::string, size_t>::iterator, bool> entry =
+        topicIndex().insert(std::make_pair(std::string(topic), list.size()));
+    if (entry.second) {
+        TopicRecord record = {topic, 0, 0};
+        list.push_back(record);
+    }
+    TopicRecord& record = list[entry.first->second];
+    record.messages++;
+    record.bytes += length;
+    BoardObserver* current = observer;
+    if (current != nullptr) {
+        current->onPublish(topic, payload, length);
+    }
+    deliver(topic, payload, length);
+}
+
+void NativeHal::recordHttpRequest(const uint8_t* body, size_t length) {
+    httpRequests++;
+    httpBytes += length;
+    BoardObserver* current = observer;
+    if (current != nullptr) {
+        current->onHttpRequest(body, length);
+    }
+}
+
+void NativeHal::setServoAngle(uint8_t pin, int angle) {
+    PinState& state = pinAt(pin);
+    if (state.servoAngle == angle) {
+        return;
+    }
+    state.servoAngle = angle;
+    BoardObserver* current = observer;
+    if (current != nullptr && angle >= 0) {
+        current->onServoWrite(pin, angle);
+    }
+}
+
+void NativeHal::setWiFiStarted(bool started) {
+    board->wifiStarted = started;
+}
+
+bool NativeHal::isWiFiStarted() {
+    return board->wifiStarted;
+}
+
+void NativeHal::attachDht(uint8_t pin, uint8_t type) {
+    PinState& state = pinAt(pin);
+    state.dhtType = type;
+    state.input = HIGH; // Idle line, held up by the pull-up
+}
+
+bool NativeHal::readDht(uint8_t pin, float& temperature, float& humidity) {
+    PinState& state = pinAt(pin);
+    if (state.dhtType == 0) {
+        return false;
+    }
+    temperature = state.dhtTemperature;
+    humidity = state.dhtHumidity;
+    return true;
+}
+
+void NativeHal::addClient(PubSubClient* client) {
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(brokerLock);
+    clients().push_back(client);
+}
+
+void NativeHal::removeClient(PubSubClient* client) {
+    std::lock_guard<std::mutex> guard(brokerLock);
+    std::vector<PubSubClient*>& list = clients();
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i] == client) {
+            list.erase(list.begin() + i);
+            return;
+        }
+    }
+}
+
+void NativeHal::addSubscription(PubSubClient* client, const char* filter) {
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(brokerLock);
+    if (isWildcard(filter)) {
+        wildcardSubscribers()[client]++;
+    } else {
+        subscribers()[filter].push_back(client);
+    }
+}
+
+void NativeHal::removeSubscription(PubSubClient* client, const char* filter) {
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(brokerLock);
+    if (isWildcard(filter)) {
+        std::unordered_map<PubSubClient*, int>::iterator it = wildcardSubscribers().find(client);
+        if (it != wildcardSubscribers().end() && --it->second == 0) {
+            wildcardSubscribers().erase(it);
+        }
+        return;
+    }
+    std::unordered_map<std::string, std::vector<PubSubClient*> >::iterator it = subscribers().find(filter);
+    if (it == subscribers().end()) {
+        return;
+    }
+    std::vector<PubSubClient*>& list = it->second;
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i] == client) {
+            list.erase(list.begin() + i);
+            break;
+        }
+    }
+    if (list.empty()) {
+        subscribers().erase(it);
+    }
+}
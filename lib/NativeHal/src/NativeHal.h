@@ -0,0 +1,242 @@
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class PubSubClient;
+struct BoardState;
+
+/**
+ * @brief Message count and volume of one MQTT topic.
+ */
+struct TopicStats {
+    const char* topic;
+    unsigned long messages;
+    unsigned long bytes;
+};
+
+/**
+ * @brief Receives what the firmware does to the outside world, as it happens.
+ */
+class BoardObserver {
+public:
+    virtual ~BoardObserver() {}
+
+    /**
+     * @brief An output pin changed level.
+     */
+    virtual void onDigitalWrite(uint8_t, int) {}
+
+    /**
+     * @brief A servo was commanded to a new angle.
+     */
+    virtual void onServoWrite(uint8_t, int) {}
+
+    /**
+     * @brief An MQTT client published a message.
+     */
+    virtual void onPublish(const char*, const uint8_t*, size_t) {}
+
+    /**
+     * @brief An HTTP request with a body was sent.
+     */
+    virtual void onHttpRequest(const uint8_t*, size_t) {}
+
+    /**
+     * @brief Bytes were written to Serial.
+     */
+    virtual void onSerialWrite(const uint8_t*, size_t) {}
+};
+
+/**
+ * @brief Control panel of the simulated board: what the outside world does to the pins and the
+ * network, and what the firmware did in return.
+ *
+ * The board has a single virtual clock. In real-time mode it follows the host clock and delay()
+ * sleeps; otherwise it only moves through advance() and delay(), so a run is deterministic and
+ * can go much faster than real time. Everything here is meant for the main thread, between
+ * calls to loop().
+ *
+ * More boards can be created to run several devices in one process. Each has its own pins,
+ * DHT sensors, servos, WiFi station and random sequence; the clock, the access point, the
+ * broker, the HTTP server and NVS are shared. A thread acts on one board at a time, the main board
+ * unless it selects another, so pin calls from the firmware reach the right one.
+ */
+class NativeHal {
+public:
+    static const int PIN_COUNT = 40;
+
+    // Time
+
+    /**
+     * @brief Selects whether the clock follows the host clock. Defaults to true.
+     */
+    static void setRealTime(bool enabled);
+    static bool isRealTime();
+
+    /**
+     * @brief Gets the clock in microseconds since the board started.
+     */
+    static uint64_t getTime();
+
+    /**
+     * @brief Moves the virtual clock forward. Ignored in real-time mode.
+     */
+    static void advance(uint64_t micros);
+
+    /**
+     * @brief Registers how the sketch tells how long it has nothing to do, in milliseconds.
+     */
+    static void setIdleHint(unsigned long (*hint)());
+
+    /**
+     * @brief Gets how long the firmware can be left alone, or 0 if no hint is registered.
+     */
+    static unsigned long getIdleTime();
+
+    /**
+     * @brief Registers the observer of pin, servo, MQTT and HTTP activity. nullptr removes it.
+     */
+    static void setObserver(BoardObserver* observer);
+
+    /**
+     * @brief Sets the file the sketch keeps its telemetry journal in. Defaults to journal.bin.
+     */
+    static void setJournalPath(const char* path);
+    static const char* getJournalPath();
+
+    // Boards
+
+    /**
+     * @brief Creates a board, seeding its random sequence. Boards live until the process ends.
+     */
+    static BoardState* createBoard(uint32_t seed);
+
+    /**
+     * @brief Makes the calling thread act on a board, nullptr for the main board. A board must
+     * not be selected by two threads at once.
+     */
+    static void selectBoard(BoardState* board);
+
+    /**
+     * @brief Gets the heap bytes the firmware allocated while a board was selected and has not
+     * freed yet. nullptr is the main board.
+     */
+    static long getHeapInUse(BoardState* board);
+
+    // Pins
+
+    /**
+     * @brief Drives an input pin from outside, as a sensor would. Interrupts attached to the pin
+     * run before this returns.
+     */
+    static void setDigitalInput(uint8_t pin, int level);
+
+    /**
+     * @brief Gets the level an input pin is driven to from outside.
+     */
+    static int getDigitalInput(uint8_t pin);
+
+    /**
+     * @brief Gets the level the firmware last wrote to a pin.
+     */
+    static int getDigitalOutput(uint8_t pin);
+
+    /**
+     * @brief Sets the raw value analogRead() returns for a pin, 0 to 4095.
+     */
+    static void setAnalogInput(uint8_t pin, uint16_t value);
+
+    /**
+     * @brief Sets what the DHT sensor on a pin measures. The DHT stand-in answers a start signal
+     * on the pin with a full 40-bit frame of these values, edge by edge.
+     */
+    static void setDhtReading(uint8_t pin, float temperature, float humidity);
+
+    /**
+     * @brief Gets the angle last written to the servo on a pin, or -1 if none is attached.
+     */
+    static int getServoAngle(uint8_t pin);
+
+    // Serial
+
+    /**
+     * @brief Selects whether Serial output reaches stdout. Bytes are counted either way.
+     */
+    static void setSerialEcho(bool enabled);
+    static unsigned long getSerialBytes();
+
+    // Heap
+
+    /**
+     * @brief Gets the number of operator new calls made by the firmware since start. Calls made
+     * by the stand-ins themselves are left out.
+     */
+    static unsigned long getAllocationCount();
+    static unsigned long getAllocatedBytes();
+
+    // Network
+
+    /**
+     * @brief Makes the access point reachable or not. Defaults to reachable. Dropping it also
+     * drops every MQTT session.
+     */
+    static void setWiFiAvailable(bool available);
+    static bool isWiFiAvailable();
+
+    /**
+     * @brief Publishes a message on the in-memory broker, as another client would. Subscribed
+     * clients receive it in their next loop().
+     */
+    static void publish(const char* topic, const uint8_t* payload, size_t length);
+
+    /**
+     * @brief Gets the number of topics published to so far.
+     */
+    static int getTopicCount();
+
+    /**
+     * @brief Gets the counters of a topic, in order of first publish.
+     * @return False if the index is out of range.
+     */
+    static bool getTopicStats(int index, TopicStats& stats);
+
+    /**
+     * @brief Sets the status code every HTTP request gets. Defaults to 200.
+     */
+    static void setHttpResponse(int code);
+    static int getHttpResponse();
+    static unsigned long getHttpRequestCount();
+    static unsigned long getHttpRequestBytes();
+
+    // Used by the stand-ins
+
+    static void recordPublish(const char* topic, const uint8_t* payload, size_t length);
+    static void recordHttpRequest(const uint8_t* body, size_t length);
+    static void setServoAngle(uint8_t pin, int angle);
+    static void setWiFiStarted(bool started);
+    static bool isWiFiStarted();
+    static void attachDht(uint8_t pin, uint8_t type);
+    static bool readDht(uint8_t pin, float& temperature, float& humidity);
+    static void addClient(PubSubClient* client);
+    static void removeClient(PubSubClient* client);
+    static void addSubscription(PubSubClient* client, const char* filter);
+    static void removeSubscription(PubSubClient* client, const char* filter);
+};
+
+/**
+ * @brief Leaves the allocations made during its lifetime out of the heap counters. The stand-ins
+ * use it around their own bookkeeping.
+ */
+class HalAllocationScope {
+public:
+    HalAllocationScope();
+    ~HalAllocationScope();
+
+private:
+    HalAllocationScope(const HalAllocationScope&);
+    HalAllocationScope& operator=(const HalAllocationScope&);
+};
+
+#endif // NATIVE_HAL_H
@@ -0,0 +1,414 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoardWiring.h"
+#include "FanoutBenchmark.h"
+#include "FleetSimulator.h"
+#include "MicroBenchmarks.h"
+#include "NativeHal.h"
+#include "PipelineBenchmark.h"
+#include "ReplayRecorder.h"
+#include "TraceReader.h"
+
+/**
+ * @brief What happens around the board during a benchmark run.
+ */
+struct Scenario {
+    static const unsigned long MOTION_PERIOD = 30000;  ///< Someone walks by every 30 s...
+    static const unsigned long MOTION_LENGTH = 5000;   ///< ...and stays in view for 5 s.
+    static const unsigned long COMMAND_PERIOD = 10000; ///< A servo command arrives every 10 s.
+    static const uint16_t GAS_LEVEL = 400;             ///< Clean-air ADC reading, with some noise.
+};
+
+static const char* COMMAND_TOPIC = "smartsuite/servo/command";
+static const unsigned long BENCH_STEP = 1000;     ///< Board time per loop() call, in microseconds.
+static const unsigned long WARMUP_MS = 10000;     ///< Left out of the steady-state heap figures.
+static const double DEFAULT_BENCH_SECONDS = 600;
+static const double DEFAULT_REPLAY_TAIL = 60;     ///< Board time kept running after the last row.
+static const double DEFAULT_FLEET_SECONDS = 60;
+static const unsigned long DEFAULT_PIPELINE_SAMPLES = 200000;
+static const unsigned long DEFAULT_FANOUT_EVENTS = 10000000;
+
+static uint32_t noiseState = 12345; ///< Kept apart from esp_random() so the firmware sees the same sequence.
+
+static int noise(int amplitude) {
+    noiseState = noiseState * 1103515245 + 12345;
+    return (int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static void applyScenario(unsigned long now, unsigned long& nextCommand, int& commandCount) {
+    float hours = now / 3600000.0f;
+    NativeHal::setDhtReading(BoardWiring::DHT_PIN, 24.0f + 2.0f * sinf(hours * 6.2832f * 6), 50.0f + 5.0f * cosf(hours * 6.2832f * 4));
+    NativeHal::setAnalogInput(BoardWiring::MQ2_PIN, Scenario::GAS_LEVEL + noise(8));
+    NativeHal::setDigitalInput(BoardWiring::PIR_PIN, now % Scenario::MOTION_PERIOD >= Scenario::MOTION_PERIOD - Scenario::MOTION_LENGTH);
+
+    if ((long)(now - nextCommand) >= 0) {
+        char payload[48];
+        static const int POSITIONS[] = {0, 90, 180, 90};
+        int length = snprintf(payload, sizeof(payload), "{\"servo\":%d,\"position\":%d}",
+                              1 + commandCount % 2, POSITIONS[commandCount % 4]);
+        NativeHal::publish(COMMAND_TOPIC, (const uint8_t*)payload, length);
+        commandCount++;
+        nextCommand += Scenario::COMMAND_PERIOD;
+    }
+}
+
+static double percentile(const std::vector<uint32_t>& sorted, double percent) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(percent / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+/**
+ * @brief Runs setup() and loop() on the virtual clock, one millisecond of board time per loop,
+ * and prints per-loop latency, heap allocations and the traffic the firmware produced.
+ */
+static int runBenchmark(double seconds) {
+    NativeHal::setRealTime(false);
+    NativeHal::setSerialEcho(false);
+
+    unsigned long loops = (unsigned long)(seconds * 1000000 / BENCH_STEP);
+    std::vector<uint32_t> latencies;
+    {
+        HalAllocationScope scope;
+        latencies.reserve(loops);
+    }
+
+    unsigned long nextCommand = millis() + Scenario::COMMAND_PERIOD;
+    int commandCount = 0;
+    applyScenario(millis(), nextCommand, commandCount);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    setup();
+    double setupMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count();
+    unsigned long setupAllocations = NativeHal::getAllocationCount();
+
+    unsigned long benchStart = millis();
+    unsigned long steadyAllocations = 0;
+    unsigned long steadyBytes = 0;
+    unsigned long steadyLoops = 0;
+    uint64_t busyNanos = 0;
+    for (unsigned long i = 0; i < loops; i++) {
+        unsigned long now = millis();
+        applyScenario(now, nextCommand, commandCount);
+
+        bool steady = now - benchStart >= WARMUP_MS;
+        unsigned long allocationsBefore = NativeHal::getAllocationCount();
+        unsigned long bytesBefore = NativeHal::getAllocatedBytes();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        loop();
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (steady) {
+            steadyAllocations += NativeHal::getAllocationCount() - allocationsBefore;
+            steadyBytes += NativeHal::getAllocatedBytes() - bytesBefore;
+            steadyLoops++;
+        }
+
+        latencies.push_back(elapsed > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)elapsed);
+        busyNanos += elapsed;
+        NativeHal::advance(BENCH_STEP);
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double boardSeconds = (millis() - benchStart) / 1000.0;
+
+    HalAllocationScope scope;
+    std::sort(latencies.begin(), latencies.end());
+    printf("=== Loop benchmark: %.0f s of board time, %lu loops, %d servo commands ===\n",
+           boardSeconds, loops, commandCount);
+    printf("setup()        %.1f ms, %lu allocations\n", setupMicros / 1000.0, setupAllocations);
+    printf("loop() us      mean %.2f  p50 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+           loops > 0 ? busyNanos / 1000.0 / loops : 0.0, percentile(latencies, 50), percentile(latencies, 99),
+           percentile(latencies, 99.9), latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+    printf("CPU            %.3f %% of board time\n", boardSeconds > 0 ? busyNanos / 1e7 / boardSeconds : 0.0);
+    printf("Heap           %lu allocations (%lu bytes) after warm-up, %.4f per loop\n",
+           steadyAllocations, steadyBytes, steadyLoops > 0 ? (double)steadyAllocations / steadyLoops : 0.0);
+    printf("Serial         %lu bytes\n", NativeHal::getSerialBytes());
+    printf("HTTP           %lu requests, %lu bytes\n", NativeHal::getHttpRequestCount(), NativeHal::getHttpRequestBytes());
+    printf("MQTT           %-32s %10s %12s %10s\n", "topic", "messages", "bytes", "per min");
+    for (int i = 0; i < NativeHal::getTopicCount(); i++) {
+        TopicStats stats;
+        NativeHal::getTopicStats(i, stats);
+        printf("               %-32s %10lu %12lu %10.1f\n", stats.topic, stats.messages, stats.bytes,
+               boardSeconds > 0 ? stats.messages * 60.0 / boardSeconds : 0.0);
+    }
+    printf("Wall time      %.2f s (%.0fx real time)\n", wallSeconds, wallSeconds > 0 ? boardSeconds / wallSeconds : 0.0);
+    return 0;
+}
+
+static void applyRow(const TraceRow& row, ReplayRecorder& recorder) {
+    float temperature;
+    float humidity;
+    NativeHal::readDht(BoardWiring::DHT_PIN, temperature, humidity);
+    NativeHal::setDhtReading(BoardWiring::DHT_PIN, isnan(row.temperature) ? temperature : row.temperature,
+                             isnan(row.humidity) ? humidity : row.humidity);
+    if (!isnan(row.smoke)) {
+        float counts = row.smoke * BoardWiring::ADC_MAX / BoardWiring::PPM_FULL_SCALE;
+        NativeHal::setAnalogInput(BoardWiring::MQ2_PIN, counts < 0 ? 0 : (uint16_t)lroundf(counts));
+    }
+    if (row.motion >= 0) {
+        // A person walking in is an expected motion alert in every trace
+        if (row.motion == 1 && NativeHal::getDigitalInput(BoardWiring::PIR_PIN) == LOW) {
+            recorder.expect("motion");
+        }
+        NativeHal::setDigitalInput(BoardWiring::PIR_PIN, row.motion);
+    }
+    if (row.expect[0] != '\0') {
+        recorder.expect(row.expect);
+    }
+}
+
+/**
+ * @brief Replays a sensor trace through the firmware as fast as the host allows.
+ *
+ * Time jumps straight to whichever comes first, the next trace row or the next job the device
+ * has scheduled, so idle stretches cost nothing. After the last row the board keeps running
+ * for `tail` seconds, long enough for suppression windows to close and their alerts to go out.
+ */
+static int runReplay(const char* tracePath, const char* capturePath, const char* alertTopic, double tail) {
+    TraceReader reader;
+    if (!reader.open(tracePath)) {
+        fprintf(stderr, "%s: %s\n", tracePath, reader.getError());
+        return 1;
+    }
+    ReplayRecorder recorder(alertTopic);
+    if (capturePath != nullptr && !recorder.openCapture(capturePath)) {
+        fprintf(stderr, "%s: cannot create the capture file\n", capturePath);
+        return 1;
+    }
+
+    NativeHal::setRealTime(false);
+    NativeHal::setSerialEcho(false);
+    NativeHal::setObserver(&recorder);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    setup();
+    unsigned long start = millis();
+    unsigned long loops = 0;
+    TraceRow row;
+    bool hasRow = reader.next(row);
+    unsigned long end = 0;
+    bool failed = false;
+    for (;;) {
+        unsigned long elapsed = millis() - start;
+        while (hasRow && row.time <= elapsed) {
+            applyRow(row, recorder);
+            hasRow = reader.next(row);
+        }
+        if (!hasRow) {
+            if (reader.getError() != nullptr) {
+                fprintf(stderr, "%s: %s\n", tracePath, reader.getError());
+                failed = true;
+                break;
+            }
+            if (end == 0) {
+                end = elapsed + (unsigned long)(tail * 1000);
+            }
+            if (elapsed >= end) {
+                break;
+            }
+        }
+
+        loop();
+        loops++;
+
+        unsigned long wait = NativeHal::getIdleTime();
+        unsigned long limit = hasRow ? row.time - elapsed : end - elapsed;
+        if (wait > limit) {
+            wait = limit;
+        }
+        NativeHal::advance((wait > 0 ? wait : 1) * 1000ULL);
+    }
+    NativeHal::setObserver(nullptr);
+    if (failed) {
+        return 1;
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double boardSeconds = (millis() - start) / 1000.0;
+
+    unsigned long hours = (unsigned long)boardSeconds / 3600;
+    unsigned long minutes = (unsigned long)boardSeconds / 60 % 60;
+    printf("=== Replay: %s, %lu rows, %lu:%02lu:%02lu of board time ===\n", tracePath, reader.getRowCount(),
+           hours, minutes, (unsigned long)boardSeconds % 60);
+    printf("Throughput     %.2f s wall, %.0fx real time, %lu loop() calls, %.0f rows/s\n", wallSeconds,
+           wallSeconds > 0 ? boardSeconds / wallSeconds : 0.0, loops,
+           wallSeconds > 0 ? reader.getRowCount() / wallSeconds : 0.0);
+    recorder.report(stdout);
+    return 0;
+}
+
+/**
+ * @brief Runs a fleet of devices in real time and prints what it achieved.
+ */
+static int runFleet(int devices, int threads, double seconds) {
+    NativeHal::setSerialEcho(false);
+    FleetSimulator fleet;
+    if (!fleet.begin(devices)) {
+        fprintf(stderr, "The sketch registers no fleet device factory\n");
+        return 1;
+    }
+    fleet.run(threads, seconds);
+    fleet.report(stdout);
+    return 0;
+}
+
+/**
+ * @brief Measures the encode and publish path on the host, with no board or broker involved.
+ */
+static int runPipeline(unsigned long samples) {
+    NativeHal::setSerialEcho(false);
+    PipelineBenchmark benchmark;
+    return benchmark.run(samples, stdout);
+}
+
+/**
+ * @brief Measures how the cost of raising a sensor event grows with its subscribers.
+ */
+static int runFanout(unsigned long events) {
+    NativeHal::setSerialEcho(false);
+    FanoutBenchmark benchmark;
+    return benchmark.run(events, stdout);
+}
+
+/**
+ * @brief Runs one host microbenchmark, or all of them.
+ */
+static int runMicro(const char* name) {
+    NativeHal::setSerialEcho(false);
+    int result = MicroBenchmarks::run(name, stdout);
+    if (result == 2) {
+        fprintf(stderr, "No microbenchmark is called %s\n", name);
+    }
+    return result;
+}
+
+/**
+ * @brief Ends the process without running static destructors: the detached log drain thread
+ * may still be writing to Serial.
+ */
+static int finish(int code) {
+    fflush(stdout);
+    fflush(stderr);
+    _Exit(code);
+}
+
+// A file next to the program, so that runs from any directory share it
+static std::string besideProgram(const char* program, const char* name) {
+    const char* slash = strrchr(program, '/');
+    if (slash == nullptr) {
+        return name;
+    }
+    return std::string(program, slash + 1 - program) + name;
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [--journal FILE] [--bench [SECONDS] | --replay TRACE [--capture FILE] [--alert-topic TOPIC]\n", program);
+    printf("       [--tail SECONDS] | --fleet DEVICES [SECONDS] [--threads THREADS] | --pipeline [SAMPLES]\n");
+    printf("       | --fanout [EVENTS] | --micro [NAME]]\n");
+    printf("  Without options, runs the firmware in real time with its logs on stdout.\n");
+    printf("  --journal Keeps the telemetry journal in FILE (default: journal.bin next to the program).\n");
+    printf("  --bench   Runs SECONDS of board time (default %.0f) on the virtual clock and prints\n", DEFAULT_BENCH_SECONDS);
+    printf("            loop latency, heap allocations and the messages produced.\n");
+    printf("  --replay  Feeds a recorded sensor trace (.csv, or binary records) to the firmware on the\n");
+    printf("            virtual clock and prints throughput and time to alert. --capture writes every\n");
+    printf("            pin, servo, MQTT and HTTP output to FILE; --tail (default %.0f) keeps the board\n", DEFAULT_REPLAY_TAIL);
+    printf("            running after the last row; alerts are read on TOPIC (default smartsuite/alerts).\n");
+    printf("  --fleet   Runs DEVICES devices, each on its own board, for SECONDS (default %.0f) in real\n", DEFAULT_FLEET_SECONDS);
+    printf("            time on THREADS worker threads (default: one per core) and prints the message\n");
+    printf("            rate, scheduling lag and memory per device.\n");
+    printf("  --pipeline Encodes SAMPLES synthetic samples (default %lu) in every payload format,\n", DEFAULT_PIPELINE_SAMPLES);
+    printf("             publishes them to an in-memory loopback transport and prints the throughput.\n");
+    printf("  --fanout  Raises EVENTS sensor events (default %lu) with more and more subscribers and\n", DEFAULT_FANOUT_EVENTS);
+    printf("            prints the cost per event and per delivery.\n");
+    printf("  --micro   Runs the host microbenchmark NAME, or all of them:\n");
+    MicroBenchmarks::list(stdout);
+}
+
+int main(int argc, char** argv) {
+    const char* tracePath = nullptr;
+    const char* capturePath = nullptr;
+    const char* alertTopic = "smartsuite/alerts";
+    double tail = DEFAULT_REPLAY_TAIL;
+    int fleetSize = 0;
+    double fleetSeconds = DEFAULT_FLEET_SECONDS;
+    int threads = (int)std::thread::hardware_concurrency();
+    double benchSeconds = 0;
+    std::string journalPath = besideProgram(argv[0], "journal.bin");
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0;
+        if (strcmp(argv[i], "--bench") == 0) {
+            benchSeconds = hasValue ? atof(argv[++i]) : DEFAULT_BENCH_SECONDS;
+            if (benchSeconds <= 0) {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--journal") == 0 && hasValue) {
+            journalPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0 && hasValue) {
+            capturePath = argv[++i];
+        } else if (strcmp(argv[i], "--alert-topic") == 0 && hasValue) {
+            alertTopic = argv[++i];
+        } else if (strcmp(argv[i], "--tail") == 0 && hasValue) {
+            tail = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fleet") == 0 && hasValue) {
+            fleetSize = atoi(argv[++i]);
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                fleetSeconds = atof(argv[++i]);
+            }
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            long samples = hasValue ? atol(argv[++i]) : (long)DEFAULT_PIPELINE_SAMPLES;
+            if (samples <= 0) {
+                printUsage(argv[0]);
+                return 2;
+            }
+            return finish(runPipeline((unsigned long)samples));
+        } else if (strcmp(argv[i], "--fanout") == 0) {
+            long events = hasValue ? atol(argv[++i]) : (long)DEFAULT_FANOUT_EVENTS;
+            if (events <= 0) {
+                printUsage(argv[0]);
+                return 2;
+            }
+            return finish(runFanout((unsigned long)events));
+        } else if (strcmp(argv[i], "--micro") == 0) {
+            return finish(runMicro(hasValue ? argv[++i] : nullptr));
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+    NativeHal::setJournalPath(journalPath.c_str());
+    if (benchSeconds > 0) {
+        return finish(runBenchmark(benchSeconds));
+    }
+    if (tracePath != nullptr) {
+        return finish(runReplay(tracePath, capturePath, alertTopic, tail < 0 ? 0 : tail));
+    }
+    if (fleetSize > 0) {
+        if (fleetSeconds <= 0) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        return finish(runFleet(fleetSize, threads > 0 ? threads : 1, fleetSeconds));
+    }
+
+    // Logs must show up as they happen, even through a pipe
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    setup();
+    for (;;) {
+        loop();
+        // The ESP32 loop task spins; here a short sleep keeps a host core free
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
@@ -0,0 +1,113 @@
+#include "PipelineBenchmark.h"
+#include <chrono>
+#include "BinaryTelemetryEncoder.h"
+#include "ColumnarBatchEncoder.h"
+#include "TelemetryEncoder.h"
+
+static const char* const PIPELINE_TOPIC = "smartsuite/sensors/data";
+
+const unsigned long PipelineBenchmark::DEFAULT_SAMPLES;
+
+PipelineBenchmark::PipelineBenchmark() : checksum(0) {
+    transport.setHandler(this);
+    transport.subscribe(PIPELINE_TOPIC);
+}
+
+int PipelineBenchmark::run(unsigned long samples, FILE* output) {
+    fprintf(output, "=== Pipeline: %lu samples per format through the loopback transport ===\n", samples);
+    fprintf(output, "%-14s %12s %9s %13s %10s\n", "format", "samples/s", "MB/s", "bytes/sample", "messages");
+    bool delivered = runFormat("JSON", PAYLOAD_JSON, false, samples, output);
+    delivered &= runFormat("CBOR", PAYLOAD_CBOR, false, samples, output);
+    delivered &= runFormat("JSON batch", PAYLOAD_JSON, true, samples, output);
+    delivered &= runFormat("CBOR batch", PAYLOAD_CBOR, true, samples, output);
+    return delivered ? 0 : 1;
+}
+
+void PipelineBenchmark::onMessage(char*, uint8_t* payload, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        checksum = checksum * 31 + payload[i];
+    }
+}
+
+bool PipelineBenchmark::runFormat(const char* name, PayloadFormat format, bool batched, unsigned long samples,
+                                  FILE* output) {
+    // Encoders are large; keep them off the stack
+    static TelemetryEncoder jsonEncoder;
+    static BinaryTelemetryEncoder binaryEncoder;
+    static ColumnarBatchEncoder batch;
+    batch.configure(format, LoopbackTransport::MAX_PAYLOAD);
+    transport.resetStats();
+
+    bool failed = false;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < samples && !failed; i++) {
+        SensorSample sample;
+        makeSample(i, sample);
+        size_t length = 0;
+        const uint8_t* payload = nullptr;
+        if (batched) {
+            if (!batch.add(sample)) {
+                payload = batch.encode(length);
+                failed = !publish(payload, length);
+                batch.clear();
+                batch.add(sample);
+            }
+            if (batch.getCount() >= BATCH_SIZE) {
+                payload = batch.encode(length);
+                failed |= !publish(payload, length);
+                batch.clear();
+            }
+        } else if (format == PAYLOAD_CBOR) {
+            if (binaryEncoder.encode(sample)) {
+                payload = binaryEncoder.payload(length);
+            }
+            failed = !publish(payload, length);
+        } else {
+            if (jsonEncoder.encode(sample)) {
+                payload = (const uint8_t*)jsonEncoder.mqttPayload(length);
+            }
+            failed = !publish(payload, length);
+        }
+    }
+    if (batched && !batch.isEmpty()) {
+        size_t length;
+        const uint8_t* payload = batch.encode(length);
+        failed |= !publish(payload, length);
+        batch.clear();
+    }
+    transport.loop();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LoopbackTransport::Stats stats = transport.getStats();
+    fprintf(output, "%-14s %12.0f %9.1f %13.1f %10lu\n", name, seconds > 0 ? samples / seconds : 0.0,
+            seconds > 0 ? stats.bytesDelivered / seconds / 1e6 : 0.0,
+            samples > 0 ? (double)stats.bytesDelivered / samples : 0.0, (unsigned long)stats.delivered);
+    if (failed || stats.dropped > 0 || stats.delivered != stats.committed) {
+        fprintf(output, "%-14s stopped: a message could not be encoded or was dropped\n", "");
+        return false;
+    }
+    return true;
+}
+
+bool PipelineBenchmark::publish(const uint8_t* payload, size_t length) {
+    if (length == 0) {
+        return false;
+    }
+    // The consumer runs whenever the queue is full, as a subscriber task would
+    if (transport.pending() == LoopbackTransport::SLOT_COUNT) {
+        transport.loop();
+    }
+    return transport.publish(PIPELINE_TOPIC, payload, length);
+}
+
+void PipelineBenchmark::makeSample(uint32_t index, SensorSample& sample) {
+    // Slowly drifting readings with some jitter, like a room over a day
+    sample.sequence = index + 1;
+    sample.timestamp = index * 2000;
+    sample.temperature = 22.0f + (index % 80) * 0.1f;
+    sample.humidity = 45.0f + (index % 23) * 0.5f;
+    sample.smokeLevel = 300.0f + (index * 7 % 41);
+    sample.servoPosition = (int16_t)(index / 50 % 2 * 90);
+    sample.servo2Position = (int16_t)(index / 70 % 3 * 90);
+    sample.motionDetected = index % 15 < 3;
+}
@@ -0,0 +1,43 @@
+#ifndef PIPELINE_BENCHMARK_H
+#define PIPELINE_BENCHMARK_H
+
+#include <stdio.h>
+#include "LoopbackTransport.h"
+#include "PipelineRecords.h"
+#include "TelemetrySchema.h"
+
+/**
+ * @brief Host measurement of the publish path without a network: synthetic samples are
+ * encoded, published to a LoopbackTransport and delivered to a consumer that reads every byte.
+ *
+ * Each format the device can publish in runs over the same samples: one message per sample in
+ * JSON and CBOR, and column-wise batches in both. The result is the throughput of the encoders
+ * and the transport hand-off alone, as samples and bytes per second of host time.
+ */
+class PipelineBenchmark : public MessageHandler {
+public:
+    static const unsigned long DEFAULT_SAMPLES = 200000;
+    static const int BATCH_SIZE = 20; ///< Samples per batch, as in the device's batching mode.
+
+    PipelineBenchmark();
+
+    /**
+     * @brief Runs every format and prints a table of the results.
+     * @param samples Samples per format.
+     * @param output Where to print.
+     * @return 0 if every message reached the consumer, 1 otherwise.
+     */
+    int run(unsigned long samples, FILE* output);
+
+    void onMessage(char* topic, uint8_t* payload, size_t length) override;
+
+private:
+    LoopbackTransport transport;
+    uint32_t checksum; ///< Keeps the consumer's reads from being optimized away.
+
+    bool runFormat(const char* name, PayloadFormat format, bool batched, unsigned long samples, FILE* output);
+    bool publish(const uint8_t* payload, size_t length);
+    static void makeSample(uint32_t index, SensorSample& sample);
+};
+
+#endif // PIPELINE_BENCHMARK_H
@@ -0,0 +1,100 @@
+#include "Preferences.h"
+#include <map>
+#include <mutex>
+#include <string.h>
+#include "NativeHal.h"
+
+// One NVS for every board, so devices running side by side see the same stored settings
+static std::mutex storageLock;
+
+static std::map<std::string, std::string>& storage() {
+    static std::map<std::string, std::string> values;
+    return values;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (opened || name == nullptr) {
+        return false;
+    }
+    HalAllocationScope scope;
+    space = name;
+    this->readOnly = readOnly;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) {
+        return false;
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(storageLock);
+    std::string prefix = space + '/';
+    std::map<std::string, std::string>& values = storage();
+    for (std::map<std::string, std::string>::iterator it = values.begin(); it != values.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = values.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly) {
+        return false;
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(storageLock);
+    return storage().erase(fullKey(key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!opened) {
+        return false;
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(storageLock);
+    return storage().count(fullKey(key)) > 0;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    if (!opened || readOnly || key == nullptr || value == nullptr) {
+        return 0;
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(storageLock);
+    storage()[fullKey(key)] = value;
+    return strlen(value);
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    if (!opened || key == nullptr) {
+        return 0;
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(storageLock);
+    std::map<std::string, std::string>::const_iterator it = storage().find(fullKey(key));
+    if (it == storage().end()) {
+        return 0;
+    }
+    // Like NVS: the length includes the terminator, and a buffer too small gets nothing
+    size_t length = it->second.size() + 1;
+    if (value != nullptr) {
+        if (length > maxLen) {
+            return 0;
+        }
+        memcpy(value, it->second.c_str(), length);
+    }
+    return length;
+}
+
+std::string Preferences::fullKey(const char* key) const {
+    return space + '/' + key;
+}
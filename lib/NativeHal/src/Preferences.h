@@ -0,0 +1,31 @@
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief Non-volatile storage in host memory. Values survive end() and begin(), not the process.
+ */
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putString(const char* key, const char* value);
+    size_t getString(const char* key, char* value, size_t maxLen);
+
+private:
+    std::string space;
+    bool opened = false;
+    bool readOnly = false;
+
+    std::string fullKey(const char* key) const;
+};
+
+#endif // PREFERENCES_H
@@ -0,0 +1,285 @@
+#include "PubSubClient.h"
+#include "NativeHal.h"
+
+PubSubClient::PubSubClient()
+    : buffer(MQTT_MAX_PACKET_SIZE), currentState(MQTT_DISCONNECTED), streamLength(0), streaming(false) {
+    NativeHal::addClient(this);
+}
+
+PubSubClient::PubSubClient(Client& client) : PubSubClient() {
+    (void)client;
+}
+
+PubSubClient::~PubSubClient() {
+    clearSubscriptions();
+    NativeHal::removeClient(this);
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+    (void)domain;
+    (void)port;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ip, uint16_t port) {
+    (void)ip;
+    (void)port;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& client) {
+    (void)client;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
+    (void)keepAlive;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
+    (void)timeout;
+    return *this;
+}
+
+boolean PubSubClient::setBufferSize(uint16_t size) {
+    if (size == 0) {
+        return false;
+    }
+    buffer.resize(size);
+    return true;
+}
+
+uint16_t PubSubClient::getBufferSize() {
+    return (uint16_t)buffer.size();
+}
+
+boolean PubSubClient::connect(const char* id) {
+    (void)id;
+    if (!NativeHal::isWiFiAvailable()) {
+        currentState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    // Clean session: subscriptions and pending messages do not survive a reconnect
+    clearSubscriptions();
+    currentState = MQTT_CONNECTED;
+    return true;
+}
+
+boolean PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    (void)user;
+    (void)pass;
+    return connect(id);
+}
+
+void PubSubClient::disconnect() {
+    currentState = MQTT_DISCONNECTED;
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload) {
+    return publish(topic, (const uint8_t*)payload, payload != nullptr ? strlen(payload) : 0, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const char* payload, boolean retained) {
+    return publish(topic, (const uint8_t*)payload, payload != nullptr ? strlen(payload) : 0, retained);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+    return publish(topic, payload, plength, false);
+}
+
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    (void)retained;
+    if (!connected()) {
+        return false;
+    }
+    size_t topicLength = strlen(topic);
+    if (MQTT_MAX_HEADER_SIZE + 2 + topicLength + plength > buffer.size()) {
+        return false;
+    }
+    // The real client assembles the packet in its buffer before writing it out
+    memcpy(buffer.data() + MQTT_MAX_HEADER_SIZE + 2, topic, topicLength);
+    if (plength > 0) {
+        memcpy(buffer.data() + MQTT_MAX_HEADER_SIZE + 2 + topicLength, payload, plength);
+    }
+    NativeHal::recordPublish(topic, payload, plength);
+    return true;
+}
+
+boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, boolean retained) {
+    (void)retained;
+    if (!connected()) {
+        return false;
+    }
+    HalAllocationScope scope;
+    streamTopic = topic;
+    streamPayload.clear();
+    streamPayload.reserve(plength);
+    streamLength = plength;
+    streaming = true;
+    return true;
+}
+
+size_t PubSubClient::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+size_t PubSubClient::write(const uint8_t* data, size_t size) {
+    if (!streaming || !connected()) {
+        return 0;
+    }
+    HalAllocationScope scope;
+    streamPayload.insert(streamPayload.end(), data, data + size);
+    return size;
+}
+
+int PubSubClient::endPublish() {
+    if (!streaming) {
+        return 0;
+    }
+    streaming = false;
+    // A short or long stream corrupts the packet on a real connection; here it is just lost
+    if (!connected() || streamPayload.size() != streamLength) {
+        return 0;
+    }
+    NativeHal::recordPublish(streamTopic.c_str(), streamPayload.data(), streamPayload.size());
+    return 1;
+}
+
+boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    (void)qos;
+    if (!connected() || MQTT_MAX_HEADER_SIZE + 4 + strlen(topic) > buffer.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        if (subscriptions[i] == topic) {
+            return true;
+        }
+    }
+    {
+        HalAllocationScope scope;
+        std::lock_guard<std::mutex> guard(inboxLock);
+        subscriptions.push_back(topic);
+    }
+    NativeHal::addSubscription(this, topic);
+    return true;
+}
+
+boolean PubSubClient::unsubscribe(const char* topic) {
+    if (!connected()) {
+        return false;
+    }
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        if (subscriptions[i] == topic) {
+            NativeHal::removeSubscription(this, topic);
+            std::lock_guard<std::mutex> guard(inboxLock);
+            subscriptions.erase(subscriptions.begin() + i);
+            break;
+        }
+    }
+    return true;
+}
+
+boolean PubSubClient::loop() {
+    if (!connected()) {
+        return false;
+    }
+
+    // Topic and payload are handed over from the client buffer, like the real client does
+    size_t topicLength;
+    size_t payloadLength;
+    {
+        HalAllocationScope scope;
+        std::lock_guard<std::mutex> guard(inboxLock);
+        if (inbox.empty()) {
+            return true;
+        }
+        Message& message = inbox.front();
+        topicLength = message.topic.size();
+        payloadLength = message.payload.size();
+        bool fits = MQTT_MAX_HEADER_SIZE + 2 + topicLength + 1 + payloadLength <= buffer.size();
+        if (fits) {
+            memcpy(buffer.data(), message.topic.c_str(), topicLength + 1);
+            if (payloadLength > 0) {
+                memcpy(buffer.data() + topicLength + 1, message.payload.data(), payloadLength);
+            }
+        }
+        inbox.pop_front();
+        if (!fits) {
+            return true;
+        }
+    }
+    if (callback) {
+        callback((char*)buffer.data(), buffer.data() + topicLength + 1, (unsigned int)payloadLength);
+    }
+    return true;
+}
+
+boolean PubSubClient::connected() {
+    return currentState == MQTT_CONNECTED;
+}
+
+int PubSubClient::state() {
+    return currentState;
+}
+
+void PubSubClient::offer(const char* topic, const uint8_t* payload, size_t length) {
+    if (!connected()) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(inboxLock);
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        if (matches(subscriptions[i], topic)) {
+            HalAllocationScope scope;
+            Message message;
+            message.topic = topic;
+            message.payload.assign(payload, payload + length);
+            inbox.push_back(message);
+            return;
+        }
+    }
+}
+
+void PubSubClient::dropConnection() {
+    if (currentState == MQTT_CONNECTED) {
+        currentState = MQTT_CONNECTION_LOST;
+    }
+}
+
+void PubSubClient::clearSubscriptions() {
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        NativeHal::removeSubscription(this, subscriptions[i].c_str());
+    }
+    HalAllocationScope scope;
+    std::lock_guard<std::mutex> guard(inboxLock);
+    subscriptions.clear();
+    inbox.clear();
+}
+
+bool PubSubClient::matches(const std::string& filter, const char* topic) {
+    size_t position = 0;
+    while (position < filter.size()) {
+        char wildcard = filter[position];
+        if (wildcard == '#') {
+            return true;
+        }
+        if (wildcard == '+') {
+            while (*topic != '\0' && *topic != '/') {
+                topic++;
+            }
+            position++;
+            continue;
+        }
+        if (*topic != wildcard) {
+            return false;
+        }
+        topic++;
+        position++;
+    }
+    return *topic == '\0';
+}
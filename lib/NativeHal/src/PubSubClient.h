@@ -0,0 +1,104 @@
+#ifndef PUBSUBCLIENT_H
+#define PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Client.h"
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+/**
+ * @brief PubSubClient stand-in connected to the in-memory broker of NativeHal.
+ *
+ * Keeps the limits of the real client that the firmware depends on: a publish longer than the
+ * buffer fails, an incoming message is handed over from the client's own buffer, and loop()
+ * delivers at most one message per call. Topic filters support the + and # wildcards. A message
+ * streamed with beginPublish() bypasses the buffer, as on the real client, and reaches the
+ * broker at endPublish() if exactly the announced number of bytes was written.
+ *
+ * Messages may be offered from any thread; everything else belongs to the thread running the
+ * client's device.
+ */
+class PubSubClient {
+public:
+    PubSubClient();
+    explicit PubSubClient(Client& client);
+    ~PubSubClient();
+
+    PubSubClient& setServer(const char* domain, uint16_t port);
+    PubSubClient& setServer(IPAddress ip, uint16_t port);
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+    PubSubClient& setClient(Client& client);
+    PubSubClient& setKeepAlive(uint16_t keepAlive);
+    PubSubClient& setSocketTimeout(uint16_t timeout);
+
+    boolean setBufferSize(uint16_t size);
+    uint16_t getBufferSize();
+
+    boolean connect(const char* id);
+    boolean connect(const char* id, const char* user, const char* pass);
+    void disconnect();
+
+    boolean publish(const char* topic, const char* payload);
+    boolean publish(const char* topic, const char* payload, boolean retained);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength);
+    boolean publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained);
+
+    boolean beginPublish(const char* topic, unsigned int plength, boolean retained);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t size);
+    int endPublish();
+
+    boolean subscribe(const char* topic, uint8_t qos = 0);
+    boolean unsubscribe(const char* topic);
+
+    boolean loop();
+    boolean connected();
+    int state();
+
+    /**
+     * @brief Queues a broker message if one of the subscriptions matches its topic.
+     */
+    void offer(const char* topic, const uint8_t* payload, size_t length);
+
+    /**
+     * @brief Drops the session, as when the network goes away.
+     */
+    void dropConnection();
+
+private:
+    struct Message {
+        std::string topic;
+        std::vector<uint8_t> payload;
+    };
+
+    MQTT_CALLBACK_SIGNATURE;
+    std::vector<uint8_t> buffer;
+    std::vector<std::string> subscriptions; ///< Read by offer() under inboxLock.
+    std::deque<Message> inbox;
+    std::mutex inboxLock;
+    std::atomic<int> currentState;
+    std::string streamTopic;             ///< Topic between beginPublish() and endPublish().
+    std::vector<uint8_t> streamPayload;
+    size_t streamLength;
+    bool streaming;
+
+    void clearSubscriptions();
+    static bool matches(const std::string& filter, const char* topic);
+};
+
+#endif // PUBSUBCLIENT_H
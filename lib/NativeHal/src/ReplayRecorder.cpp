@@ -0,0 +1,182 @@
+#include "ReplayRecorder.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <string.h>
+
+ReplayRecorder::ReplayRecorder(const char* alertTopic)
+    : alertTopic(alertTopic), capture(nullptr), pinChanges(0), servoMoves(0), messages(0), messageBytes(0),
+      httpRequests(0), unreadableAlerts(0) {}
+
+ReplayRecorder::~ReplayRecorder() {
+    if (capture != nullptr) {
+        fclose(capture);
+    }
+}
+
+bool ReplayRecorder::openCapture(const char* path) {
+    capture = fopen(path, "w");
+    if (capture == nullptr) {
+        return false;
+    }
+    fputs("time_ms,kind,target,value\n", capture);
+    return true;
+}
+
+void ReplayRecorder::expect(const char* type) {
+    HalAllocationScope scope;
+    AlertLatency& entry = find(type);
+    entry.expected++;
+    entry.pending.push_back(millis());
+}
+
+void ReplayRecorder::onDigitalWrite(uint8_t pin, int level) {
+    pinChanges++;
+    if (capture != nullptr) {
+        fprintf(capture, "%lu,pin,%u,%d\n", millis(), pin, level);
+    }
+}
+
+void ReplayRecorder::onServoWrite(uint8_t pin, int angle) {
+    servoMoves++;
+    if (capture != nullptr) {
+        fprintf(capture, "%lu,servo,%u,%d\n", millis(), pin, angle);
+    }
+}
+
+void ReplayRecorder::onPublish(const char* topic, const uint8_t* payload, size_t length) {
+    HalAllocationScope scope;
+    messages++;
+    messageBytes += length;
+    if (capture != nullptr) {
+        fprintf(capture, "%lu,mqtt,%s,", millis(), topic);
+        writePayload(payload, length);
+    }
+    if (alertTopic != topic) {
+        return;
+    }
+
+    std::string type;
+    if (!alertType(payload, length, type)) {
+        unreadableAlerts++;
+        return;
+    }
+    AlertLatency& entry = find(type);
+    entry.alerts++;
+    uint32_t now = millis();
+    for (size_t i = 0; i < entry.pending.size(); i++) {
+        entry.latencies.push_back(now - entry.pending[i]);
+    }
+    entry.answered += entry.pending.size();
+    entry.pending.clear();
+}
+
+void ReplayRecorder::onHttpRequest(const uint8_t* body, size_t length) {
+    httpRequests++;
+    if (capture != nullptr) {
+        fprintf(capture, "%lu,http,POST,", millis());
+        writePayload(body, length);
+    }
+}
+
+void ReplayRecorder::report(FILE* output) const {
+    fprintf(output, "Outputs        %lu pin changes, %lu servo moves, %lu MQTT messages (%lu bytes), %lu HTTP requests\n",
+            pinChanges, servoMoves, messages, messageBytes, httpRequests);
+    if (latencies.empty()) {
+        fprintf(output, "Time to alert  no alerts expected or published\n");
+        return;
+    }
+    fprintf(output, "Time to alert  %-12s %8s %8s %8s %8s %9s %9s %9s %9s\n", "type", "expected", "answered",
+            "missed", "alerts", "min ms", "mean ms", "p95 ms", "max ms");
+    for (size_t i = 0; i < latencies.size(); i++) {
+        const AlertLatency& entry = latencies[i];
+        std::vector<uint32_t> sorted(entry.latencies);
+        std::sort(sorted.begin(), sorted.end());
+        double mean = 0;
+        for (size_t j = 0; j < sorted.size(); j++) {
+            mean += sorted[j];
+        }
+        if (!sorted.empty()) {
+            mean /= sorted.size();
+        }
+        fprintf(output, "               %-12s %8lu %8lu %8lu %8lu", entry.type.c_str(), entry.expected, entry.answered,
+                (unsigned long)entry.pending.size(), entry.alerts);
+        if (sorted.empty()) {
+            fprintf(output, " %9s %9s %9s %9s\n", "-", "-", "-", "-");
+        } else {
+            fprintf(output, " %9lu %9.0f %9lu %9lu\n", (unsigned long)sorted.front(), mean,
+                    (unsigned long)sorted[(sorted.size() - 1) * 95 / 100], (unsigned long)sorted.back());
+        }
+    }
+    if (unreadableAlerts > 0) {
+        fprintf(output, "               %lu alerts without a readable type\n", unreadableAlerts);
+    }
+}
+
+AlertLatency& ReplayRecorder::find(const std::string& type) {
+    for (size_t i = 0; i < latencies.size(); i++) {
+        if (latencies[i].type == type) {
+            return latencies[i];
+        }
+    }
+    AlertLatency entry;
+    entry.type = type;
+    entry.expected = 0;
+    entry.answered = 0;
+    entry.alerts = 0;
+    latencies.push_back(entry);
+    return latencies.back();
+}
+
+void ReplayRecorder::writePayload(const uint8_t* payload, size_t length) {
+    bool printable = true;
+    for (size_t i = 0; i < length && printable; i++) {
+        printable = payload[i] >= 0x20 && payload[i] < 0x7F;
+    }
+    if (printable) {
+        fputc('"', capture);
+        for (size_t i = 0; i < length; i++) {
+            if (payload[i] == '"') {
+                fputc('"', capture);
+            }
+            fputc(payload[i], capture);
+        }
+        fputs("\"\n", capture);
+        return;
+    }
+    for (size_t i = 0; i < length; i++) {
+        fprintf(capture, "%02x", payload[i]);
+    }
+    fputc('\n', capture);
+}
+
+bool ReplayRecorder::alertType(const uint8_t* payload, size_t length, std::string& type) {
+    const char* text = (const char*)payload;
+    static const char JSON_KEY[] = "\"type\":\"";
+    static const uint8_t CBOR_KEY[] = {0x64, 't', 'y', 'p', 'e'};
+
+    for (size_t i = 0; i + sizeof(JSON_KEY) - 1 <= length; i++) {
+        if (memcmp(text + i, JSON_KEY, sizeof(JSON_KEY) - 1) == 0) {
+            size_t start = i + sizeof(JSON_KEY) - 1;
+            const void* end = memchr(text + start, '"', length - start);
+            if (end == nullptr) {
+                return false;
+            }
+            type.assign(text + start, (const char*)end - (text + start));
+            return true;
+        }
+    }
+    // CBOR: the text key "type" followed by a short text string
+    for (size_t i = 0; i + sizeof(CBOR_KEY) < length; i++) {
+        if (memcmp(payload + i, CBOR_KEY, sizeof(CBOR_KEY)) == 0) {
+            uint8_t header = payload[i + sizeof(CBOR_KEY)];
+            size_t count = header - 0x60;
+            size_t start = i + sizeof(CBOR_KEY) + 1;
+            if (header < 0x60 || header > 0x77 || start + count > length) {
+                return false;
+            }
+            type.assign(text + start, count);
+            return true;
+        }
+    }
+    return false;
+}
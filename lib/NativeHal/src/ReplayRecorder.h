@@ -0,0 +1,77 @@
+#ifndef REPLAY_RECORDER_H
+#define REPLAY_RECORDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "NativeHal.h"
+
+/**
+ * @brief Time-to-alert results of one alert type.
+ */
+struct AlertLatency {
+    std::string type;
+    unsigned long expected;       ///< Trace rows that should cause this alert.
+    unsigned long answered;       ///< Of those, rows an alert followed.
+    unsigned long alerts;         ///< Alerts of this type published.
+    std::vector<uint32_t> pending; ///< Times of the expectations still waiting for an alert.
+    std::vector<uint32_t> latencies; ///< Milliseconds from each answered row to its alert.
+};
+
+/**
+ * @brief Observes a replay: writes every LED and servo transition and every MQTT and HTTP
+ * payload to a capture file, and matches published alerts against the expectations of the
+ * trace to measure time to alert.
+ *
+ * Capture lines are `time_ms,kind,target,value`, with kind `pin`, `servo`, `mqtt` or `http`.
+ * Payloads are quoted as CSV text, or written as hex when they are not printable. An alert
+ * answers every pending expectation of its type, so an alert that summarizes a suppression
+ * window reports the wait of each event it covers.
+ */
+class ReplayRecorder : public BoardObserver {
+public:
+    /**
+     * @param alertTopic Topic the alerts are published on.
+     */
+    explicit ReplayRecorder(const char* alertTopic);
+    ~ReplayRecorder();
+
+    /**
+     * @brief Starts writing the capture file.
+     * @return False if the file cannot be created.
+     */
+    bool openCapture(const char* path);
+
+    /**
+     * @brief Records that an alert of a type is expected from now on.
+     */
+    void expect(const char* type);
+
+    void onDigitalWrite(uint8_t pin, int level) override;
+    void onServoWrite(uint8_t pin, int angle) override;
+    void onPublish(const char* topic, const uint8_t* payload, size_t length) override;
+    void onHttpRequest(const uint8_t* body, size_t length) override;
+
+    /**
+     * @brief Prints the output counts and the time-to-alert table.
+     */
+    void report(FILE* output) const;
+
+private:
+    std::string alertTopic;
+    FILE* capture;
+    unsigned long pinChanges;
+    unsigned long servoMoves;
+    unsigned long messages;
+    unsigned long messageBytes;
+    unsigned long httpRequests;
+    unsigned long unreadableAlerts;
+    std::vector<AlertLatency> latencies;
+
+    AlertLatency& find(const std::string& type);
+    void writePayload(const uint8_t* payload, size_t length);
+    static bool alertType(const uint8_t* payload, size_t length, std::string& type);
+};
+
+#endif // REPLAY_RECORDER_H
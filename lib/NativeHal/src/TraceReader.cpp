@@ -0,0 +1,176 @@
+#include "TraceReader.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t TraceRow::MAX_EXPECT;
+const size_t TraceReader::RECORD_SIZE;
+
+TraceReader::TraceReader() : file(nullptr), binary(false), columnCount(0), rowCount(0), lastTime(0) {
+    error[0] = '\0';
+}
+
+TraceReader::~TraceReader() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool TraceReader::open(const char* path) {
+    size_t length = strlen(path);
+    binary = length < 4 || strcmp(path + length - 4, ".csv") != 0;
+    file = fopen(path, binary ? "rb" : "r");
+    if (file == nullptr) {
+        return fail("cannot open the trace");
+    }
+    if (binary) {
+        return true;
+    }
+
+    char line[MAX_LINE];
+    if (fgets(line, sizeof(line), file) == nullptr) {
+        return fail("empty trace");
+    }
+    bool hasTime = false;
+    char* cursor = line;
+    while (columnCount < MAX_COLUMNS) {
+        size_t span = strcspn(cursor, ",\r\n");
+        char separator = cursor[span];
+        cursor[span] = '\0';
+        Column column = COLUMN_IGNORED;
+        if (strcmp(cursor, "time_ms") == 0) {
+            column = COLUMN_TIME;
+            hasTime = true;
+        } else if (strcmp(cursor, "temperature") == 0) {
+            column = COLUMN_TEMPERATURE;
+        } else if (strcmp(cursor, "humidity") == 0) {
+            column = COLUMN_HUMIDITY;
+        } else if (strcmp(cursor, "smoke") == 0) {
+            column = COLUMN_SMOKE;
+        } else if (strcmp(cursor, "motion") == 0) {
+            column = COLUMN_MOTION;
+        } else if (strcmp(cursor, "expect") == 0) {
+            column = COLUMN_EXPECT;
+        }
+        columns[columnCount++] = column;
+        if (separator != ',') {
+            break;
+        }
+        cursor += span + 1;
+    }
+    return hasTime ? true : fail("the header has no time_ms column");
+}
+
+bool TraceReader::next(TraceRow& row) {
+    if (file == nullptr) {
+        return false;
+    }
+    row.temperature = NAN;
+    row.humidity = NAN;
+    row.smoke = NAN;
+    row.motion = -1;
+    row.expect[0] = '\0';
+    if (!(binary ? nextBinary(row) : nextCsv(row))) {
+        return false;
+    }
+    if (row.time < lastTime) {
+        return fail("rows out of time order");
+    }
+    lastTime = row.time;
+    rowCount++;
+    return true;
+}
+
+const char* TraceReader::getError() const {
+    return error[0] != '\0' ? error : nullptr;
+}
+
+unsigned long TraceReader::getRowCount() const {
+    return rowCount;
+}
+
+bool TraceReader::nextCsv(TraceRow& row) {
+    char line[MAX_LINE];
+    do {
+        if (fgets(line, sizeof(line), file) == nullptr) {
+            return false;
+        }
+    } while (line[strspn(line, " \t\r\n")] == '\0' || line[0] == '#');
+
+    bool hasTime = false;
+    char* cursor = line;
+    for (int i = 0; i < columnCount; i++) {
+        size_t span = strcspn(cursor, ",\r\n");
+        char separator = cursor[span];
+        cursor[span] = '\0';
+        if (span > 0) {
+            char* end;
+            switch (columns[i]) {
+                case COLUMN_TIME:
+                    row.time = (uint32_t)strtoul(cursor, &end, 10);
+                    hasTime = *end == '\0';
+                    break;
+                case COLUMN_TEMPERATURE:
+                    row.temperature = strtof(cursor, &end);
+                    break;
+                case COLUMN_HUMIDITY:
+                    row.humidity = strtof(cursor, &end);
+                    break;
+                case COLUMN_SMOKE:
+                    row.smoke = strtof(cursor, &end);
+                    break;
+                case COLUMN_MOTION:
+                    row.motion = atoi(cursor) != 0 ? 1 : 0;
+                    break;
+                case COLUMN_EXPECT:
+                    strncpy(row.expect, cursor, TraceRow::MAX_EXPECT - 1);
+                    row.expect[TraceRow::MAX_EXPECT - 1] = '\0';
+                    break;
+                case COLUMN_IGNORED:
+                    break;
+            }
+        }
+        if (separator != ',') {
+            break;
+        }
+        cursor += span + 1;
+    }
+    if (!hasTime) {
+        snprintf(error, sizeof(error), "row %lu has no valid time_ms", rowCount + 1);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t readWord(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static float readFloat(const uint8_t* bytes) {
+    uint32_t word = readWord(bytes);
+    float value;
+    memcpy(&value, &word, sizeof(value));
+    return value;
+}
+
+bool TraceReader::nextBinary(TraceRow& row) {
+    uint8_t record[RECORD_SIZE];
+    size_t count = fread(record, 1, sizeof(record), file);
+    if (count == 0) {
+        return false;
+    }
+    if (count < sizeof(record)) {
+        return fail("truncated record at the end of the trace");
+    }
+    row.time = readWord(record);
+    row.temperature = readFloat(record + 4);
+    row.humidity = readFloat(record + 8);
+    row.smoke = readFloat(record + 12);
+    row.motion = record[16] == 0xFF ? -1 : (record[16] != 0 ? 1 : 0);
+    return true;
+}
+
+bool TraceReader::fail(const char* message) {
+    snprintf(error, sizeof(error), "%s", message);
+    return false;
+}
@@ -0,0 +1,88 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief One row of a sensor trace. Channels left unchanged are NaN, or -1 for motion.
+ */
+struct TraceRow {
+    static const size_t MAX_EXPECT = 16;
+
+    uint32_t time;           ///< Milliseconds from the start of the replay.
+    float temperature;       ///< Celsius.
+    float humidity;          ///< Percent.
+    float smoke;             ///< PPM, as in the smokeLevel telemetry field.
+    int motion;              ///< 1 for motion, 0 for none.
+    char expect[MAX_EXPECT]; ///< Alert type the row should cause, empty if none.
+};
+
+/**
+ * @brief Reads recorded sensor traces row by row, in CSV or binary form.
+ *
+ * CSV (files ending in .csv): a header line naming the columns, then one row per line. `time_ms`
+ * is required; `temperature`, `humidity`, `smoke`, `motion` and `expect` are optional and may
+ * come in any order, unknown columns are ignored, and an empty cell keeps the previous value.
+ * Binary (any other file): packed little-endian records of 20 bytes, time_ms (uint32),
+ * temperature, humidity and smoke (float32, NaN to keep), motion (uint8, 0xFF to keep) and three
+ * padding bytes; binary traces carry no expectations. Rows must come in time order.
+ */
+class TraceReader {
+public:
+    static const size_t RECORD_SIZE = 20;
+
+    TraceReader();
+    ~TraceReader();
+
+    /**
+     * @brief Opens a trace, reading the header of a CSV file.
+     * @return False if the file cannot be read or the header has no time_ms column.
+     */
+    bool open(const char* path);
+
+    /**
+     * @brief Reads the next row.
+     * @return False at the end of the trace, or on a malformed row (see getError()).
+     */
+    bool next(TraceRow& row);
+
+    /**
+     * @brief Gets what went wrong, or nullptr if the trace ended normally.
+     */
+    const char* getError() const;
+
+    /**
+     * @brief Gets the number of rows read so far.
+     */
+    unsigned long getRowCount() const;
+
+private:
+    enum Column {
+        COLUMN_IGNORED,
+        COLUMN_TIME,
+        COLUMN_TEMPERATURE,
+        COLUMN_HUMIDITY,
+        COLUMN_SMOKE,
+        COLUMN_MOTION,
+        COLUMN_EXPECT
+    };
+
+    static const int MAX_COLUMNS = 16;
+    static const size_t MAX_LINE = 256;
+
+    FILE* file;
+    bool binary;
+    Column columns[MAX_COLUMNS];
+    int columnCount;
+    unsigned long rowCount;
+    uint32_t lastTime;
+    char error[96];
+
+    bool nextCsv(TraceRow& row);
+    bool nextBinary(TraceRow& row);
+    bool fail(const char* message);
+};
+
+#endif // TRACE_READER_H
@@ -0,0 +1,88 @@
+#include "WiFi.h"
+#include "NativeHal.h"
+
+WiFiClass WiFi;
+
+static uint8_t accessPoint[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid, bool connect) {
+    (void)ssid;
+    (void)passphrase;
+    (void)bssid;
+    if (channel > 0) {
+        currentChannel = channel;
+    }
+    NativeHal::setWiFiStarted(connect);
+    return status();
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    NativeHal::setWiFiStarted(false);
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    if (!NativeHal::isWiFiStarted()) {
+        return WL_DISCONNECTED;
+    }
+    return NativeHal::isWiFiAvailable() ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    (void)mode;
+    return true;
+}
+
+bool WiFiClass::setAutoReconnect(bool autoReconnect) {
+    (void)autoReconnect;
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 0, 50) : IPAddress();
+}
+
+uint8_t* WiFiClass::BSSID() {
+    return status() == WL_CONNECTED ? accessPoint : nullptr;
+}
+
+int32_t WiFiClass::channel() {
+    return currentChannel;
+}
+
+int8_t WiFiClass::RSSI() {
+    return status() == WL_CONNECTED ? -55 : 0;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    (void)ip;
+    (void)port;
+    open = WiFi.status() == WL_CONNECTED;
+    return open ? 1 : 0;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    (void)host;
+    (void)port;
+    open = WiFi.status() == WL_CONNECTED;
+    return open ? 1 : 0;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    (void)buffer;
+    return connected() ? size : 0;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    (void)buffer;
+    (void)size;
+    return -1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (open && WiFi.status() != WL_CONNECTED) {
+        open = false;
+    }
+    return open;
+}
@@ -0,0 +1,74 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+/**
+ * @brief Station interface. Associates at once when NativeHal says the access point is
+ * reachable, and loses the link when it stops being so.
+ */
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    bool disconnect(bool wifiOff = false);
+    wl_status_t status();
+
+    bool mode(wifi_mode_t mode);
+    bool setAutoReconnect(bool autoReconnect);
+
+    IPAddress localIP();
+    uint8_t* BSSID();
+    int32_t channel();
+    int8_t RSSI();
+
+private:
+    int32_t currentChannel = 6;
+};
+
+extern WiFiClass WiFi;
+
+/**
+ * @brief TCP client. Connects whenever the link is up; the server never sends anything.
+ */
+class WiFiClient : public Client {
+public:
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t value) override { return write(&value, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { open = false; }
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    using Print::write;
+
+private:
+    bool open = false;
+};
+
+#endif // WIFI_H
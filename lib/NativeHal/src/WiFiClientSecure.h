@@ -0,0 +1,15 @@
+#ifndef WIFICLIENTSECURE_H
+#define WIFICLIENTSECURE_H
+
+#include <WiFi.h>
+
+/**
+ * @brief TLS client. There is no TLS on the simulated network; it behaves as a WiFiClient.
+ */
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) { (void)rootCA; }
+};
+
+#endif // WIFICLIENTSECURE_H
@@ -1,14 +1,27 @@
 #include "Actuator.h"
 
+const int Actuator::ANY_COMMAND;
+
 Actuator::Actuator(int pin, CommandHandler* commandHandler)
-    : pin(pin), handler(commandHandler) {}
+    : pin(pin), handler(commandHandler) {
+    subscribers.subscribe(commandHandler);
+}
 
 void Actuator::handle(Command command) {
-    if (handler != nullptr) {
-        handler->handle(command);
-    }
+    subscribers.dispatch(&CommandHandler::handle, command);
 }
 
 void Actuator::setHandler(CommandHandler* commandHandler) {
+    // Only the catch-all entry; per-ID subscriptions of the same receiver stay
+    subscribers.unsubscribeFilter(handler, ANY_COMMAND);
     handler = commandHandler;
+    subscribers.subscribe(commandHandler);
+}
+
+bool Actuator::subscribe(CommandHandler* subscriber, int commandId) {
+    return subscribers.subscribe(subscriber, commandId);
+}
+
+bool Actuator::unsubscribe(CommandHandler* subscriber, int commandId) {
+    return subscribers.unsubscribe(subscriber, commandId);
 }
\ No newline at end of file
@@ -2,11 +2,17 @@
 #define ACTUATOR_H
 
 #include "CommandHandler.h"
+#include "SubscriberList.h"
 
 class Actuator : public CommandHandler {
+public:
+    static const int MAX_SUBSCRIBERS = 4; ///< Subscriptions per actuator, the handler included.
+    static const int ANY_COMMAND = SubscriberList<CommandHandler, MAX_SUBSCRIBERS>::ANY_ID;
+
 protected:
     int pin; ///< GPIO pin assigned to the actuator.
-    CommandHandler* handler; ///< Optional handler to receive propagated commands.
+    CommandHandler* handler; ///< Optional handler to receive propagated commands, also in `subscribers`.
+    SubscriberList<CommandHandler, MAX_SUBSCRIBERS> subscribers; ///< Receivers of propagated commands.
 
 public:
     /**
@@ -17,16 +23,35 @@ public:
     Actuator(int pin, CommandHandler* commandHandler = nullptr);
 
     /**
-     * @brief Handles a command by propagating it to the assigned handler.
+     * @brief Handles a command by propagating it to the subscribers whose filter accepts it.
      * @param command The command to handle.
      */
     void handle(Command command) override;
 
     /**
-     * @brief Sets or updates the command handler for this actuator.
+     * @brief Sets or updates the command handler for this actuator, which receives every
+     * command. Other subscribers are kept.
      * @param commandHandler Pointer to the new CommandHandler.
      */
     void setHandler(CommandHandler* commandHandler);
+
+    /**
+     * @brief Adds a receiver of this actuator's commands, alongside the handler. Allowed while
+     * a command is being propagated; the new subscriber starts with the next one.
+     * @param subscriber Receiver of the commands.
+     * @param commandId Command ID to receive, or ANY_COMMAND for all of them (default).
+     * @return False if MAX_SUBSCRIBERS subscriptions exist already.
+     */
+    bool subscribe(CommandHandler* subscriber, int commandId = ANY_COMMAND);
+
+    /**
+     * @brief Removes subscriptions added with subscribe(). Allowed while a command is being
+     * propagated; the subscriber is not called again.
+     * @param subscriber Receiver to remove.
+     * @param commandId Filter to remove, or ANY_COMMAND for every subscription of the receiver.
+     * @return True if a subscription was removed.
+     */
+    bool unsubscribe(CommandHandler* subscriber, int commandId = ANY_COMMAND);
 };
 
-#endif // ACTUATOR_H
\ No newline at end of file
+#endif // ACTUATOR_H
@@ -0,0 +1,197 @@
+#include "AlertAggregator.h"
+#include <stdio.h>
+#include <string.h>
+
+AlertAggregator::AlertAggregator() : windowCount(0), queueCount(0), nextOrder(0), head(-1), stats() {
+    for (int i = 0; i < MAX_KEYS; i++) {
+        keys[i].used = false;
+    }
+}
+
+bool AlertAggregator::setWindow(const char* type, uint32_t window) {
+    for (int i = 0; i < windowCount; i++) {
+        if (strcmp(windows[i].type, type) == 0) {
+            windows[i].length = window;
+            return true;
+        }
+    }
+    if (windowCount >= MAX_WINDOWS) {
+        return false;
+    }
+    windows[windowCount].type = type;
+    windows[windowCount].length = window;
+    windowCount++;
+    return true;
+}
+
+void AlertAggregator::submit(const AlertRecord& alert, uint32_t now) {
+    stats.received++;
+    uint32_t window = windowFor(alert.type);
+    if (window == 0) {
+        enqueue(alert, nextOrder++);
+        return;
+    }
+
+    Key* key = findKey(alert, now);
+    if (key->used) {
+        expire(*key, now); // Window ended without an update() in between
+    }
+    if (key->used) {
+        // Repeat inside the window: fold it into the summary
+        key->repeats++;
+        key->latest = alert;
+        stats.suppressed++;
+        return;
+    }
+
+    // First of its kind, or a quiet window is over: publish and open a window
+    key->used = true;
+    strncpy(key->type, alert.type, sizeof(key->type));
+    strncpy(key->severity, alert.severity, sizeof(key->severity));
+    key->windowStart = now;
+    key->windowLength = window;
+    key->repeats = 0;
+    enqueue(alert, nextOrder++);
+}
+
+void AlertAggregator::update(uint32_t now) {
+    for (int i = 0; i < MAX_KEYS; i++) {
+        if (keys[i].used) {
+            expire(keys[i], now);
+        }
+    }
+}
+
+const AlertRecord* AlertAggregator::peek() {
+    if (queueCount == 0) {
+        return nullptr;
+    }
+    if (head < 0) {
+        head = 0;
+        for (int i = 1; i < queueCount; i++) {
+            if (queue[i].rank > queue[head].rank ||
+                (queue[i].rank == queue[head].rank && (int32_t)(queue[i].order - queue[head].order) < 0)) {
+                head = i;
+            }
+        }
+    }
+    return &queue[head].alert;
+}
+
+void AlertAggregator::pop() {
+    if (peek() == nullptr) {
+        return;
+    }
+    queue[head] = queue[--queueCount];
+    head = -1;
+}
+
+bool AlertAggregator::isEmpty() const {
+    return queueCount == 0;
+}
+
+int AlertAggregator::getQueuedCount() const {
+    return queueCount;
+}
+
+AlertStats AlertAggregator::getStats() const {
+    return stats;
+}
+
+int AlertAggregator::severityRank(const char* severity) {
+    static const char* const SEVERITIES[] = {"low", "medium", "high"};
+    for (int i = 2; i > 0; i--) {
+        if (strcmp(severity, SEVERITIES[i]) == 0) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+uint32_t AlertAggregator::windowFor(const char* type) const {
+    for (int i = 0; i < windowCount; i++) {
+        if (strcmp(windows[i].type, type) == 0) {
+            return windows[i].length;
+        }
+    }
+    return DEFAULT_WINDOW;
+}
+
+AlertAggregator::Key* AlertAggregator::findKey(const AlertRecord& alert, uint32_t now) {
+    Key* freeKey = nullptr;
+    Key* oldest = nullptr;
+    for (int i = 0; i < MAX_KEYS; i++) {
+        Key& key = keys[i];
+        if (!key.used) {
+            if (freeKey == nullptr) {
+                freeKey = &key;
+            }
+            continue;
+        }
+        if (strncmp(key.type, alert.type, sizeof(key.type)) == 0 &&
+            strncmp(key.severity, alert.severity, sizeof(key.severity)) == 0) {
+            return &key;
+        }
+        if (oldest == nullptr || now - key.windowStart > now - oldest->windowStart) {
+            oldest = &key;
+        }
+    }
+    if (freeKey != nullptr) {
+        return freeKey;
+    }
+    // All pairs tracked: give up the window that has run longest, flushing its summary
+    closeWindow(*oldest);
+    return oldest;
+}
+
+void AlertAggregator::expire(Key& key, uint32_t now) {
+    if (now - key.windowStart < key.windowLength) {
+        return;
+    }
+    bool repeated = key.repeats > 0;
+    closeWindow(key);
+    if (repeated) {
+        // Repeats kept coming: keep suppressing from here
+        key.used = true;
+        key.windowStart = now;
+        key.repeats = 0;
+    }
+}
+
+void AlertAggregator::closeWindow(Key& key) {
+    if (key.repeats > 0) {
+        AlertRecord summary = key.latest;
+        char suffix[40];
+        snprintf(suffix, sizeof(suffix), " (x%lu in %lu s)", key.repeats, (unsigned long)(key.windowLength / 1000));
+        size_t room = sizeof(summary.message) - strlen(suffix) - 1;
+        summary.message[room < strlen(summary.message) ? room : strlen(summary.message)] = '\0';
+        strncat(summary.message, suffix, sizeof(summary.message) - strlen(summary.message) - 1);
+        enqueue(summary, nextOrder++);
+    }
+    key.used = false;
+}
+
+void AlertAggregator::enqueue(const AlertRecord& alert, uint32_t order) {
+    uint8_t rank = severityRank(alert.severity);
+    if (queueCount == QUEUE_CAPACITY) {
+        // Shed the least urgent, newest alert, unless the new one is less urgent still
+        int worst = 0;
+        for (int i = 1; i < queueCount; i++) {
+            if (queue[i].rank < queue[worst].rank ||
+                (queue[i].rank == queue[worst].rank && (int32_t)(queue[i].order - queue[worst].order) > 0)) {
+                worst = i;
+            }
+        }
+        stats.dropped++;
+        if (rank <= queue[worst].rank) {
+            return;
+        }
+        queue[worst] = queue[--queueCount];
+    }
+    head = -1;
+    queue[queueCount].alert = alert;
+    queue[queueCount].rank = rank;
+    queue[queueCount].order = order;
+    queueCount++;
+    stats.queued++;
+}
@@ -0,0 +1,116 @@
+#ifndef ALERT_AGGREGATOR_H
+#define ALERT_AGGREGATOR_H
+
+#include <stdint.h>
+#include "PipelineRecords.h"
+
+/**
+ * @brief Publishing statistics of the AlertAggregator.
+ */
+struct AlertStats {
+    unsigned long received;   ///< Alerts submitted.
+    unsigned long queued;     ///< Alerts and summaries handed to the queue.
+    unsigned long suppressed; ///< Repeats folded into a summary.
+    unsigned long dropped;    ///< Alerts lost because the queue was full of more urgent ones.
+};
+
+/**
+ * @brief Deduplicates, rate-limits and prioritizes alerts before they are published.
+ *
+ * The first alert of a (type, severity) pair is queued at once and opens a suppression window
+ * for that pair. Repeats inside the window are only counted; when the window closes, one
+ * summary is queued with the count and the latest message ("... (x14 in 60 s)"), and a new
+ * window opens if repeats continue. Windows are per pair, so an alert escalating to a higher
+ * severity is never held back by the window of a lower one. Queued alerts are released by
+ * severity, then in arrival order, from a bounded queue that sheds the least urgent alert when
+ * full. Pure logic over timestamps, without hardware access.
+ */
+class AlertAggregator {
+public:
+    static const int QUEUE_CAPACITY = 8;
+    static const int MAX_KEYS = 8;          ///< (type, severity) pairs tracked at once.
+    static const int MAX_WINDOWS = 4;       ///< Types with their own suppression window.
+    static const uint32_t DEFAULT_WINDOW = 60000; ///< Milliseconds, for types without their own.
+
+    AlertAggregator();
+
+    /**
+     * @brief Sets the suppression window of an alert type.
+     * @param type Alert type, e.g. "motion". Must outlive the aggregator.
+     * @param window Window in milliseconds, 0 to publish every alert.
+     * @return False if MAX_WINDOWS types are configured already.
+     */
+    bool setWindow(const char* type, uint32_t window);
+
+    /**
+     * @brief Submits an alert.
+     * @param alert The alert; its timestamp is the time it was raised.
+     * @param now Current time in milliseconds.
+     */
+    void submit(const AlertRecord& alert, uint32_t now);
+
+    /**
+     * @brief Closes the windows that have ended, queueing their summaries.
+     * @param now Current time in milliseconds.
+     */
+    void update(uint32_t now);
+
+    /**
+     * @brief Gets the most urgent queued alert without removing it.
+     * @return The alert, or nullptr if the queue is empty. Valid until the next call that changes the queue.
+     */
+    const AlertRecord* peek();
+
+    /**
+     * @brief Removes the alert returned by peek(), once it has been published.
+     */
+    void pop();
+
+    bool isEmpty() const;
+    int getQueuedCount() const;
+    AlertStats getStats() const;
+
+    /**
+     * @brief Ranks a severity: low 0, medium 1, high 2; unknown ones count as low.
+     */
+    static int severityRank(const char* severity);
+
+private:
+    struct Window {
+        const char* type;
+        uint32_t length;
+    };
+
+    struct Key {
+        bool used;
+        char type[AlertRecord::TYPE_SIZE];
+        char severity[AlertRecord::SEVERITY_SIZE];
+        uint32_t windowStart;
+        uint32_t windowLength;
+        unsigned long repeats;   ///< Alerts counted since the window opened.
+        AlertRecord latest;      ///< Newest repeat, the base of the summary.
+    };
+
+    struct Entry {
+        AlertRecord alert;
+        uint8_t rank;
+        uint32_t order;
+    };
+
+    Window windows[MAX_WINDOWS];
+    int windowCount;
+    Key keys[MAX_KEYS];
+    Entry queue[QUEUE_CAPACITY];
+    int queueCount;
+    uint32_t nextOrder;
+    int head;               ///< Index of the most urgent entry, -1 when unknown.
+    AlertStats stats;
+
+    uint32_t windowFor(const char* type) const;
+    Key* findKey(const AlertRecord& alert, uint32_t now);
+    void expire(Key& key, uint32_t now);
+    void closeWindow(Key& key);
+    void enqueue(const AlertRecord& alert, uint32_t order);
+};
+
+#endif // ALERT_AGGREGATOR_H
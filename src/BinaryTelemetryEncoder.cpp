@@ -0,0 +1,34 @@
+#include "BinaryTelemetryEncoder.h"
+#include "CborWriter.h"
+
+BinaryTelemetryEncoder::BinaryTelemetryEncoder() : length(0) {}
+
+bool BinaryTelemetryEncoder::encode(const SensorSample& sample) {
+    CborWriter writer(buffer, BUFFER_SIZE);
+    bool ok = writer.putByte(TelemetrySchema::VERSION) && writer.putMap(7) &&
+              writer.putUnsigned(TelemetrySchema::KEY_TIMESTAMP) && writer.putUnsigned(sample.timestamp) &&
+              writer.putUnsigned(TelemetrySchema::KEY_TEMPERATURE) && writer.putReading(sample.temperature) &&
+              writer.putUnsigned(TelemetrySchema::KEY_HUMIDITY) && writer.putReading(sample.humidity) &&
+              writer.putUnsigned(TelemetrySchema::KEY_MOTION) && writer.putBool(sample.motionDetected) &&
+              writer.putUnsigned(TelemetrySchema::KEY_SMOKE) && writer.putReading(sample.smokeLevel) &&
+              writer.putUnsigned(TelemetrySchema::KEY_SERVO) && writer.putInt(sample.servoPosition) &&
+              writer.putUnsigned(TelemetrySchema::KEY_SERVO2) && writer.putInt(sample.servo2Position);
+    length = ok ? writer.getLength() : 0;
+    return ok;
+}
+
+bool BinaryTelemetryEncoder::encode(const AlertRecord& alert) {
+    CborWriter writer(buffer, BUFFER_SIZE);
+    bool ok = writer.putByte(TelemetrySchema::VERSION) && writer.putMap(4) &&
+              writer.putUnsigned(TelemetrySchema::KEY_TIMESTAMP) && writer.putUnsigned(alert.timestamp) &&
+              writer.putUnsigned(TelemetrySchema::KEY_ALERT_TYPE) && writer.putText(alert.type) &&
+              writer.putUnsigned(TelemetrySchema::KEY_ALERT_SEVERITY) && writer.putText(alert.severity) &&
+              writer.putUnsigned(TelemetrySchema::KEY_ALERT_MESSAGE) && writer.putText(alert.message);
+    length = ok ? writer.getLength() : 0;
+    return ok;
+}
+
+const uint8_t* BinaryTelemetryEncoder::payload(size_t& length) const {
+    length = this->length;
+    return buffer;
+}
@@ -0,0 +1,47 @@
+#ifndef BINARY_TELEMETRY_ENCODER_H
+#define BINARY_TELEMETRY_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PipelineRecords.h"
+#include "TelemetrySchema.h"
+
+/**
+ * @brief CBOR encoder for samples and alerts following TelemetrySchema.
+ *
+ * A sample takes about 30 bytes instead of about 150 in JSON. Like TelemetryEncoder it writes
+ * into a fixed buffer it owns and never allocates.
+ */
+class BinaryTelemetryEncoder {
+public:
+    static const size_t BUFFER_SIZE = 160; ///< Room for the largest alert.
+
+    BinaryTelemetryEncoder();
+
+    /**
+     * @brief Encodes a sensor sample.
+     * @param sample The sample to encode.
+     * @return True if the buffer holds the encoding.
+     */
+    bool encode(const SensorSample& sample);
+
+    /**
+     * @brief Encodes an alert.
+     * @param alert The alert to encode.
+     * @return True if the buffer holds the encoding.
+     */
+    bool encode(const AlertRecord& alert);
+
+    /**
+     * @brief Gets the last encoding. Valid until the next call to encode().
+     * @param length Receives the payload length, 0 if the last encoding failed.
+     * @return Pointer to the payload.
+     */
+    const uint8_t* payload(size_t& length) const;
+
+private:
+    uint8_t buffer[BUFFER_SIZE];
+    size_t length;
+};
+
+#endif // BINARY_TELEMETRY_ENCODER_H
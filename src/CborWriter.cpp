@@ -0,0 +1,115 @@
+#include "CborWriter.h"
+#include <math.h>
+#include <string.h>
+
+// CBOR major types and simple values
+static const uint8_t MAJOR_UNSIGNED = 0;
+static const uint8_t MAJOR_NEGATIVE = 1;
+static const uint8_t MAJOR_TEXT = 3;
+static const uint8_t MAJOR_ARRAY = 4;
+static const uint8_t MAJOR_MAP = 5;
+static const uint8_t CBOR_FALSE = 0xF4;
+static const uint8_t CBOR_TRUE = 0xF5;
+static const uint8_t CBOR_NULL = 0xF6;
+
+// Largest reading magnitude written: times 100 it still fits an int32_t
+static const float READING_LIMIT = 10000000.0f;
+
+/**
+ * @brief Scales a finite reading by 100, clamping it first since lroundf() is undefined out of range.
+ */
+static int32_t scaleReading(float value) {
+    if (value > READING_LIMIT) {
+        value = READING_LIMIT;
+    } else if (value < -READING_LIMIT) {
+        value = -READING_LIMIT;
+    }
+    return (int32_t)lroundf(value * 100.0f);
+}
+
+CborWriter::CborWriter(uint8_t* buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity), length(0) {}
+
+bool CborWriter::putByte(uint8_t value) {
+    if (length >= capacity) {
+        return false;
+    }
+    buffer[length++] = value;
+    return true;
+}
+
+bool CborWriter::putUnsigned(uint32_t value) {
+    return putHead(MAJOR_UNSIGNED, value);
+}
+
+bool CborWriter::putInt(int32_t value) {
+    if (value >= 0) {
+        return putHead(MAJOR_UNSIGNED, (uint32_t)value);
+    }
+    return putHead(MAJOR_NEGATIVE, (uint32_t)(-(value + 1)));
+}
+
+bool CborWriter::putBool(bool value) {
+    return putByte(value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+bool CborWriter::putNull() {
+    return putByte(CBOR_NULL);
+}
+
+bool CborWriter::putText(const char* text) {
+    size_t size = strlen(text);
+    if (!putHead(MAJOR_TEXT, size) || length + size > capacity) {
+        return false;
+    }
+    memcpy(buffer + length, text, size);
+    length += size;
+    return true;
+}
+
+bool CborWriter::putArray(uint32_t count) {
+    return putHead(MAJOR_ARRAY, count);
+}
+
+bool CborWriter::putMap(uint32_t entries) {
+    return putHead(MAJOR_MAP, entries);
+}
+
+bool CborWriter::putReading(float value) {
+    if (!isfinite(value)) {
+        return putNull();
+    }
+    return putInt(scaleReading(value));
+}
+
+size_t CborWriter::getLength() const {
+    return length;
+}
+
+size_t CborWriter::measureUnsigned(uint32_t value) {
+    return value < 24 ? 1 : value <= 0xFF ? 2 : value <= 0xFFFF ? 3 : 5;
+}
+
+size_t CborWriter::measureInt(int32_t value) {
+    return measureUnsigned(value >= 0 ? (uint32_t)value : (uint32_t)(-(value + 1)));
+}
+
+size_t CborWriter::measureReading(float value) {
+    return isfinite(value) ? measureInt(scaleReading(value)) : 1;
+}
+
+bool CborWriter::putHead(uint8_t majorType, uint32_t value) {
+    // Shortest form, as required for deterministic CBOR
+    uint8_t type = majorType << 5;
+    if (value < 24) {
+        return putByte(type | value);
+    }
+    if (value <= 0xFF) {
+        return putByte(type | 24) && putByte(value);
+    }
+    if (value <= 0xFFFF) {
+        return putByte(type | 25) && putByte(value >> 8) && putByte(value & 0xFF);
+    }
+    return putByte(type | 26) && putByte(value >> 24) && putByte((value >> 16) & 0xFF) &&
+           putByte((value >> 8) & 0xFF) && putByte(value & 0xFF);
+}
@@ -0,0 +1,54 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Minimal CBOR (RFC 8949) writer over a caller-provided buffer.
+ *
+ * Covers what the telemetry schema needs: integers, booleans, null, text, arrays and maps of
+ * known length, always in the shortest form. Every put returns false once the buffer is full,
+ * so a chain of puts can be checked once at the end.
+ */
+class CborWriter {
+public:
+    /**
+     * @brief Constructs a CborWriter.
+     * @param buffer Destination buffer.
+     * @param capacity Size of the buffer in bytes.
+     */
+    CborWriter(uint8_t* buffer, size_t capacity);
+
+    bool putByte(uint8_t value);    ///< Raw byte, outside of the CBOR structure.
+    bool putUnsigned(uint32_t value);
+    bool putInt(int32_t value);
+    bool putBool(bool value);
+    bool putNull();
+    bool putText(const char* text);
+    bool putArray(uint32_t count);  ///< Array header, followed by `count` items.
+    bool putMap(uint32_t entries);  ///< Map header, followed by `entries` key/value pairs.
+
+    /**
+     * @brief Writes a reading scaled by 100 as an integer, or null if it is not finite.
+     *
+     * Readings beyond ±10000000 are clamped to it.
+     * @param value Reading.
+     */
+    bool putReading(float value);
+
+    size_t getLength() const; ///< Bytes written so far.
+
+    static size_t measureUnsigned(uint32_t value); ///< Encoded size of putUnsigned(value).
+    static size_t measureInt(int32_t value);       ///< Encoded size of putInt(value).
+    static size_t measureReading(float value);     ///< Encoded size of putReading(value).
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+
+    bool putHead(uint8_t majorType, uint32_t value);
+};
+
+#endif // CBOR_WRITER_H
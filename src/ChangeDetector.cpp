@@ -0,0 +1,60 @@
+#include "ChangeDetector.h"
+#include <math.h>
+
+const unsigned long ChangeDetector::DEFAULT_MAX_SILENCE;
+
+ChangeDetector::ChangeDetector()
+    : maxSilence(DEFAULT_MAX_SILENCE), reported(), reportedAt(0), hasReported(false) {
+    // DHT11 resolves 1 °C and 1 %; MQ2 estimates are noisy, so use a relative band with a floor
+    setDeadband(TEMPERATURE, 0.5f, 0.0f);
+    setDeadband(HUMIDITY, 2.0f, 0.0f);
+    setDeadband(SMOKE, 10.0f, 10.0f);
+}
+
+void ChangeDetector::setDeadband(Field field, float absolute, float percent) {
+    if (field < 0 || field >= FIELD_COUNT) {
+        return;
+    }
+    deadbands[field].absolute = absolute;
+    deadbands[field].percent = percent;
+}
+
+void ChangeDetector::setMaxSilence(unsigned long maxSilence) {
+    this->maxSilence = maxSilence;
+}
+
+bool ChangeDetector::shouldReport(const SensorSample& sample, unsigned long now) const {
+    if (!hasReported || now - reportedAt >= maxSilence) {
+        return true;
+    }
+    if (sample.motionDetected != reported.motionDetected ||
+        sample.servoPosition != reported.servoPosition ||
+        sample.servo2Position != reported.servo2Position) {
+        return true;
+    }
+    return exceeds(TEMPERATURE, sample.temperature, reported.temperature) ||
+           exceeds(HUMIDITY, sample.humidity, reported.humidity) ||
+           exceeds(SMOKE, sample.smokeLevel, reported.smokeLevel);
+}
+
+void ChangeDetector::markReported(const SensorSample& sample, unsigned long now) {
+    reported = sample;
+    reportedAt = now;
+    hasReported = true;
+}
+
+void ChangeDetector::reset() {
+    hasReported = false;
+}
+
+bool ChangeDetector::exceeds(Field field, float value, float reference) const {
+    if (isnan(value) || isnan(reference)) {
+        return isnan(value) != isnan(reference); // Sensor failed or recovered
+    }
+    // The wider band applies, so an absolute band keeps a relative one from collapsing near zero
+    const Deadband& band = deadbands[field];
+    float relative = fabsf(reference) * band.percent / 100.0f;
+    float threshold = band.absolute > relative ? band.absolute : relative;
+    float change = fabsf(value - reference);
+    return change > 0 && change >= threshold;
+}
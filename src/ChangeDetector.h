@@ -0,0 +1,81 @@
+#ifndef CHANGE_DETECTOR_H
+#define CHANGE_DETECTOR_H
+
+#include "PipelineRecords.h"
+
+/**
+ * @brief Report-by-exception filter deciding which samples are worth publishing.
+ *
+ * Analog readings are compared with the last reported sample against a deadband, absolute,
+ * relative to the reported value, or both (the wider one applies, so the absolute band acts as
+ * a floor for readings near zero). Motion and servo changes, and a DHT reading appearing or
+ * disappearing, are always reported. A heartbeat
+ * reports an unchanged sample once the maximum silence has elapsed, so subscribers can tell
+ * a quiet device from a dead one.
+ */
+class ChangeDetector {
+public:
+    enum Field {
+        TEMPERATURE, ///< Celsius.
+        HUMIDITY,    ///< Percent.
+        SMOKE,       ///< PPM.
+        FIELD_COUNT
+    };
+
+    static const unsigned long DEFAULT_MAX_SILENCE = 60000; ///< Heartbeat in milliseconds.
+
+    /**
+     * @brief Constructs a ChangeDetector with deadbands matching the DHT11 and MQ2 resolution.
+     */
+    ChangeDetector();
+
+    /**
+     * @brief Sets the deadband of an analog field.
+     * @param field Field to configure.
+     * @param absolute Change in field units that triggers a report, 0 for none.
+     * @param percent Change in percent of the reported value that triggers a report, 0 for none.
+     */
+    void setDeadband(Field field, float absolute, float percent);
+
+    /**
+     * @brief Sets the heartbeat interval.
+     * @param maxSilence Longest time without a report in milliseconds.
+     */
+    void setMaxSilence(unsigned long maxSilence);
+
+    /**
+     * @brief Checks whether a sample differs enough from the last reported one.
+     * @param sample Candidate sample.
+     * @param now Current time in milliseconds.
+     * @return True if the sample should be published.
+     */
+    bool shouldReport(const SensorSample& sample, unsigned long now) const;
+
+    /**
+     * @brief Records a sample as reported. Call after a successful publish.
+     * @param sample The published sample.
+     * @param now Current time in milliseconds.
+     */
+    void markReported(const SensorSample& sample, unsigned long now);
+
+    /**
+     * @brief Forgets the last report, so the next sample is always reported.
+     */
+    void reset();
+
+private:
+    struct Deadband {
+        float absolute;
+        float percent;
+    };
+
+    Deadband deadbands[FIELD_COUNT];
+    unsigned long maxSilence;
+    SensorSample reported;
+    unsigned long reportedAt;
+    bool hasReported;
+
+    bool exceeds(Field field, float value, float reference) const;
+};
+
+#endif // CHANGE_DETECTOR_H
@@ -0,0 +1,232 @@
+#include "ColumnarBatchEncoder.h"
+#include "CborWriter.h"
+#include "TelemetryEncoder.h"
+#include <string.h>
+
+static const char JSON_KEYS[] = "{\"t0\":,\"dt\":[],\"temperature\":[],\"humidity\":[],\"motionDetected\":[],"
+                                "\"smokeLevel\":[],\"servoPosition\":[],\"servo2Position\":[]}";
+static const int COLUMN_COUNT = 7; // dt and the six fields
+
+static size_t jsonInt(long value) {
+    char text[TelemetryEncoder::NUMBER_SIZE];
+    return TelemetryEncoder::formatInt(text, value);
+}
+
+static size_t jsonReading(float value) {
+    char text[TelemetryEncoder::NUMBER_SIZE];
+    return TelemetryEncoder::formatFloat(text, value);
+}
+
+/**
+ * @brief Appends text to a fixed buffer, remembering overflow.
+ */
+class TextWriter {
+public:
+    TextWriter(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity), length(0), ok(true) {}
+
+    void literal(const char* text) {
+        size_t size = strlen(text);
+        if (length + size > capacity) {
+            ok = false;
+            return;
+        }
+        memcpy(buffer + length, text, size);
+        length += size;
+    }
+
+    void integer(long value) {
+        char text[TelemetryEncoder::NUMBER_SIZE];
+        TelemetryEncoder::formatInt(text, value);
+        literal(text);
+    }
+
+    void reading(float value) {
+        char text[TelemetryEncoder::NUMBER_SIZE];
+        TelemetryEncoder::formatFloat(text, value);
+        literal(text);
+    }
+
+    size_t result() const { return ok ? length : 0; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t length;
+    bool ok;
+};
+
+ColumnarBatchEncoder::ColumnarBatchEncoder()
+    : count(0), encodedSize(0), format(PAYLOAD_JSON), payloadLimit(0) {
+    configure(PAYLOAD_JSON, 1024);
+}
+
+void ColumnarBatchEncoder::configure(PayloadFormat format, size_t payloadLimit) {
+    this->format = format;
+    this->payloadLimit = payloadLimit < BUFFER_SIZE ? payloadLimit : BUFFER_SIZE;
+    clear();
+}
+
+bool ColumnarBatchEncoder::add(const SensorSample& sample) {
+    size_t size = measure(sample);
+    if (count >= MAX_SAMPLES || encodedSize + size > payloadLimit) {
+        return false;
+    }
+    samples[count++] = sample;
+    encodedSize += size;
+    return true;
+}
+
+bool ColumnarBatchEncoder::isEmpty() const {
+    return count == 0;
+}
+
+int ColumnarBatchEncoder::getCount() const {
+    return count;
+}
+
+size_t ColumnarBatchEncoder::getEncodedSize() const {
+    return encodedSize;
+}
+
+const SensorSample& ColumnarBatchEncoder::getSample(int index) const {
+    return samples[index];
+}
+
+const uint8_t* ColumnarBatchEncoder::encode(size_t& length) {
+    length = 0;
+    if (count > 0) {
+        length = format == PAYLOAD_CBOR ? encodeCbor() : encodeJson();
+    }
+    return buffer;
+}
+
+void ColumnarBatchEncoder::clear() {
+    count = 0;
+    encodedSize = 0;
+}
+
+size_t ColumnarBatchEncoder::measure(const SensorSample& sample) const {
+    // Bytes the sample adds to the encoding, including the header when it is the first one
+    uint32_t delta = count > 0 ? sample.timestamp - samples[count - 1].timestamp : 0;
+    if (format == PAYLOAD_CBOR) {
+        size_t size = CborWriter::measureUnsigned(delta) + CborWriter::measureReading(sample.temperature) +
+                      CborWriter::measureReading(sample.humidity) + 1 +
+                      CborWriter::measureReading(sample.smokeLevel) +
+                      CborWriter::measureInt(sample.servoPosition) + CborWriter::measureInt(sample.servo2Position);
+        if (count == 0) {
+            // Version byte, map header, the t0 entry and the key and array header of each field
+            size += 2 + 1 + CborWriter::measureUnsigned(sample.timestamp) + COLUMN_COUNT * 2;
+        } else if (count + 1 == 24) {
+            size += COLUMN_COUNT; // Array headers take a length byte from 24 items on
+        }
+        return size;
+    }
+
+    size_t size = jsonInt(delta) + jsonReading(sample.temperature) + jsonReading(sample.humidity) +
+                  (sample.motionDetected ? 4 : 5) + jsonReading(sample.smokeLevel) +
+                  jsonInt(sample.servoPosition) + jsonInt(sample.servo2Position);
+    if (count == 0) {
+        size += sizeof(JSON_KEYS) - 1 + jsonInt(sample.timestamp);
+    } else {
+        size += COLUMN_COUNT; // Separating commas
+    }
+    return size;
+}
+
+size_t ColumnarBatchEncoder::encodeJson() {
+    TextWriter out(buffer, payloadLimit);
+    out.literal("{\"t0\":");
+    out.integer(samples[0].timestamp);
+
+    out.literal(",\"dt\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.integer(i > 0 ? (long)(samples[i].timestamp - samples[i - 1].timestamp) : 0);
+    }
+
+    out.literal("],\"temperature\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.reading(samples[i].temperature);
+    }
+
+    out.literal("],\"humidity\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.reading(samples[i].humidity);
+    }
+
+    out.literal("],\"motionDetected\":[");
+    for (int i = 0; i < count; i++) {
+        out.literal(i > 0 ? (samples[i].motionDetected ? ",true" : ",false")
+                          : (samples[i].motionDetected ? "true" : "false"));
+    }
+
+    out.literal("],\"smokeLevel\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.reading(samples[i].smokeLevel);
+    }
+
+    out.literal("],\"servoPosition\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.integer(samples[i].servoPosition);
+    }
+
+    out.literal("],\"servo2Position\":[");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            out.literal(",");
+        }
+        out.integer(samples[i].servo2Position);
+    }
+    out.literal("]}");
+    return out.result();
+}
+
+size_t ColumnarBatchEncoder::encodeCbor() {
+    CborWriter out(buffer, payloadLimit);
+    bool ok = out.putByte(TelemetrySchema::VERSION) && out.putMap(COLUMN_COUNT + 1) &&
+              out.putUnsigned(TelemetrySchema::KEY_TIMESTAMP) && out.putUnsigned(samples[0].timestamp);
+
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_TIME_DELTAS) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putUnsigned(i > 0 ? samples[i].timestamp - samples[i - 1].timestamp : 0);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_TEMPERATURE) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putReading(samples[i].temperature);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_HUMIDITY) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putReading(samples[i].humidity);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_MOTION) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putBool(samples[i].motionDetected);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_SMOKE) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putReading(samples[i].smokeLevel);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_SERVO) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putInt(samples[i].servoPosition);
+    }
+    ok = ok && out.putUnsigned(TelemetrySchema::KEY_SERVO2) && out.putArray(count);
+    for (int i = 0; ok && i < count; i++) {
+        ok = out.putInt(samples[i].servo2Position);
+    }
+    return ok ? out.getLength() : 0;
+}
@@ -0,0 +1,81 @@
+#ifndef COLUMNAR_BATCH_ENCODER_H
+#define COLUMNAR_BATCH_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PipelineRecords.h"
+#include "TelemetrySchema.h"
+
+/**
+ * @brief Accumulates samples and encodes them column-wise into a single message.
+ *
+ * The first timestamp is sent once and every later one as the delta to the previous sample,
+ * followed by one array per field, so keys are sent once per batch instead of once per sample
+ * and similar values sit next to each other. JSON layout:
+ *
+ * `{"t0":..,"dt":[..],"temperature":[..],"humidity":[..],"motionDetected":[..],`
+ * `"smokeLevel":[..],"servoPosition":[..],"servo2Position":[..]}`
+ *
+ * The CBOR layout uses the TelemetrySchema keys, with KEY_TIMESTAMP for t0 and
+ * KEY_TIME_DELTAS for dt. The encoded size is tracked exactly as samples are added, so a batch
+ * never outgrows the payload limit.
+ */
+class ColumnarBatchEncoder {
+public:
+    static const int MAX_SAMPLES = 64;
+    static const size_t BUFFER_SIZE = 2048; ///< Upper bound of the payload limit.
+
+    ColumnarBatchEncoder();
+
+    /**
+     * @brief Sets the encoding and the largest payload the transport accepts.
+     *
+     * Drops any samples accumulated so far.
+     * @param format Encoding of the batch.
+     * @param payloadLimit Largest payload in bytes, capped at BUFFER_SIZE.
+     */
+    void configure(PayloadFormat format, size_t payloadLimit);
+
+    /**
+     * @brief Adds a sample to the batch.
+     * @param sample The sample to add.
+     * @return False if the sample would not fit; encode and clear the batch, then add it again.
+     */
+    bool add(const SensorSample& sample);
+
+    bool isEmpty() const;
+    int getCount() const;
+    size_t getEncodedSize() const; ///< Size the batch will have once encoded.
+
+    /**
+     * @brief Gets an accumulated sample.
+     * @param index Index from 0 (oldest) to getCount() - 1.
+     */
+    const SensorSample& getSample(int index) const;
+
+    /**
+     * @brief Encodes the accumulated samples.
+     * @param length Receives the payload length, 0 if the batch is empty or does not fit.
+     * @return Pointer to the payload, valid until the next call to encode().
+     */
+    const uint8_t* encode(size_t& length);
+
+    /**
+     * @brief Discards the accumulated samples.
+     */
+    void clear();
+
+private:
+    SensorSample samples[MAX_SAMPLES];
+    int count;
+    size_t encodedSize;
+    PayloadFormat format;
+    size_t payloadLimit;
+    uint8_t buffer[BUFFER_SIZE];
+
+    size_t measure(const SensorSample& sample) const;
+    size_t encodeJson();
+    size_t encodeCbor();
+};
+
+#endif // COLUMNAR_BATCH_ENCODER_H
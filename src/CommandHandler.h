@@ -2,15 +2,25 @@
 #define COMMAND_HANDLER_H
 
 /**
- * @brief Represents a command with a unique identifier.
+ * @brief Represents a command with a unique identifier and an optional argument.
  * 
  * Commands are lightweight structs used to instruct devices or actuators to perform actions.
- * Define custom commands by assigning unique IDs in your application.
+ * Define custom commands by assigning unique IDs in your application. Two commands compare
+ * equal when their IDs match, whatever their arguments.
  */
 struct Command {
     int id; ///< Unique identifier for the command type.
+    float value;   ///< Argument of the command, e.g. a servo angle.
+    bool hasValue; ///< True if `value` was set.
+
+    explicit Command(int commandId) : id(commandId), value(0), hasValue(false) {}
+    Command(int commandId, float commandValue) : id(commandId), value(commandValue), hasValue(true) {}
+
+    /**
+     * @brief Copies the command with an argument, e.g. `MOVE_TO_POSITION_COMMAND.withValue(45)`.
+     */
+    Command withValue(float commandValue) const { return Command(id, commandValue); }
 
-    explicit Command(int commandId) : id(commandId) {}
     bool operator==(const Command& other) const { return id == other.id; }
 };
 
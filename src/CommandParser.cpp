@@ -0,0 +1,213 @@
+#include "CommandParser.h"
+#include <string.h>
+
+CommandParseResult CommandParser::parseServoCommand(const uint8_t* payload, size_t length,
+                                                    ServoCommandRecord& command) {
+    Cursor cursor = {payload, payload + length};
+    long servo = 1;
+    long position = 0;
+    bool hasPosition = false;
+    bool servoIsNumber = true;
+
+    skipSpace(cursor);
+    if (!consume(cursor, '{')) {
+        return COMMAND_PARSE_MALFORMED;
+    }
+    skipSpace(cursor);
+    if (!consume(cursor, '}')) {
+        for (;;) {
+            const uint8_t* key;
+            size_t keyLength;
+            skipSpace(cursor);
+            if (!readString(cursor, key, keyLength)) {
+                return COMMAND_PARSE_MALFORMED;
+            }
+            skipSpace(cursor);
+            if (!consume(cursor, ':')) {
+                return COMMAND_PARSE_MALFORMED;
+            }
+            skipSpace(cursor);
+
+            // Decode the members we know; a non-numeric value leaves them unset
+            long value = 0;
+            if (keyEquals(key, keyLength, "position") || keyEquals(key, keyLength, "servo")) {
+                bool isNumber = readNumber(cursor, value);
+                if (!isNumber && !skipValue(cursor)) {
+                    return COMMAND_PARSE_MALFORMED;
+                }
+                if (keyEquals(key, keyLength, "position")) {
+                    hasPosition = isNumber;
+                    position = value;
+                } else {
+                    servoIsNumber = isNumber;
+                    servo = value;
+                }
+            } else if (!skipValue(cursor)) {
+                return COMMAND_PARSE_MALFORMED;
+            }
+
+            skipSpace(cursor);
+            if (consume(cursor, '}')) {
+                break;
+            }
+            if (!consume(cursor, ',')) {
+                return COMMAND_PARSE_MALFORMED;
+            }
+        }
+    }
+
+    if (!hasPosition || !servoIsNumber) {
+        return COMMAND_PARSE_MISSING_FIELD;
+    }
+    if ((servo != 1 && servo != 2) || position < 0 || position > 180) {
+        return COMMAND_PARSE_OUT_OF_RANGE;
+    }
+    command.servo = servo;
+    command.position = position;
+    return COMMAND_PARSE_OK;
+}
+
+void CommandParser::skipSpace(Cursor& cursor) {
+    while (cursor.position < cursor.end &&
+           (*cursor.position == ' ' || *cursor.position == '\t' || *cursor.position == '\n' || *cursor.position == '\r')) {
+        cursor.position++;
+    }
+}
+
+bool CommandParser::consume(Cursor& cursor, uint8_t character) {
+    if (cursor.position < cursor.end && *cursor.position == character) {
+        cursor.position++;
+        return true;
+    }
+    return false;
+}
+
+bool CommandParser::readString(Cursor& cursor, const uint8_t*& start, size_t& length) {
+    if (!consume(cursor, '"')) {
+        return false;
+    }
+    // The raw bytes are returned; escapes are only stepped over
+    start = cursor.position;
+    while (cursor.position < cursor.end) {
+        uint8_t character = *cursor.position++;
+        if (character == '"') {
+            length = cursor.position - 1 - start;
+            return true;
+        }
+        if (character == '\\') {
+            if (cursor.position == cursor.end) {
+                return false;
+            }
+            cursor.position++;
+        }
+    }
+    return false;
+}
+
+bool CommandParser::readNumber(Cursor& cursor, long& value) {
+    const uint8_t* start = cursor.position;
+    bool negative = consume(cursor, '-');
+    long magnitude = 0;
+    int digits = 0;
+    while (cursor.position < cursor.end && *cursor.position >= '0' && *cursor.position <= '9') {
+        if (magnitude < NUMBER_LIMIT) {
+            magnitude = magnitude * 10 + (*cursor.position - '0');
+        }
+        cursor.position++;
+        digits++;
+    }
+    if (digits == 0) {
+        cursor.position = start;
+        return false;
+    }
+    // Fraction: truncated, like an integer conversion
+    if (consume(cursor, '.')) {
+        digits = 0;
+        while (cursor.position < cursor.end && *cursor.position >= '0' && *cursor.position <= '9') {
+            cursor.position++;
+            digits++;
+        }
+        if (digits == 0) {
+            cursor.position = start;
+            return false;
+        }
+    }
+    // Exponent: applied to the integer part
+    if (consume(cursor, 'e') || consume(cursor, 'E')) {
+        bool negativeExponent = consume(cursor, '-');
+        if (!negativeExponent) {
+            consume(cursor, '+');
+        }
+        long exponent = 0;
+        digits = 0;
+        while (cursor.position < cursor.end && *cursor.position >= '0' && *cursor.position <= '9') {
+            if (exponent < 100) {
+                exponent = exponent * 10 + (*cursor.position - '0');
+            }
+            cursor.position++;
+            digits++;
+        }
+        if (digits == 0) {
+            cursor.position = start;
+            return false;
+        }
+        for (long i = 0; i < exponent && magnitude != 0; i++) {
+            magnitude = negativeExponent ? magnitude / 10 : (magnitude < NUMBER_LIMIT ? magnitude * 10 : magnitude);
+        }
+    }
+    value = negative ? -magnitude : magnitude;
+    return true;
+}
+
+bool CommandParser::skipValue(Cursor& cursor) {
+    if (cursor.position == cursor.end) {
+        return false;
+    }
+    uint8_t first = *cursor.position;
+    if (first == '"') {
+        const uint8_t* start;
+        size_t length;
+        return readString(cursor, start, length);
+    }
+    if (first == '{' || first == '[') {
+        // Bracket matching only; strings are stepped over so their brackets do not count
+        int depth = 0;
+        while (cursor.position < cursor.end) {
+            uint8_t character = *cursor.position;
+            if (character == '"') {
+                const uint8_t* start;
+                size_t length;
+                if (!readString(cursor, start, length)) {
+                    return false;
+                }
+                continue;
+            }
+            cursor.position++;
+            if (character == '{' || character == '[') {
+                depth++;
+            } else if (character == '}' || character == ']') {
+                if (--depth == 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    long value;
+    if (readNumber(cursor, value)) {
+        return true;
+    }
+    static const char* const LITERALS[] = {"true", "false", "null"};
+    for (int i = 0; i < 3; i++) {
+        size_t length = strlen(LITERALS[i]);
+        if ((size_t)(cursor.end - cursor.position) >= length && memcmp(cursor.position, LITERALS[i], length) == 0) {
+            cursor.position += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandParser::keyEquals(const uint8_t* key, size_t length, const char* name) {
+    return strlen(name) == length && memcmp(key, name, length) == 0;
+}
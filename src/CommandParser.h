@@ -0,0 +1,55 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PipelineRecords.h"
+
+/**
+ * @brief Outcome of parsing a command payload.
+ */
+enum CommandParseResult {
+    COMMAND_PARSE_OK,           ///< Command decoded.
+    COMMAND_PARSE_MALFORMED,    ///< Not a JSON object, or truncated.
+    COMMAND_PARSE_MISSING_FIELD, ///< A required member is absent or not a number.
+    COMMAND_PARSE_OUT_OF_RANGE  ///< A member holds a value the command does not accept.
+};
+
+/**
+ * @brief In-place parser for the JSON commands received over MQTT.
+ *
+ * Reads the payload buffer directly, without copying it, building a document or allocating:
+ * members of interest are decoded as they are met and everything else is skipped. Only the
+ * top-level object is validated; nested values are skipped by bracket matching. Every read is
+ * bounds-checked, so arbitrary bytes are safe input.
+ */
+class CommandParser {
+public:
+    /**
+     * @brief Decodes a servo command, e.g. `{"servo": 2, "position": 90}`.
+     *
+     * "position" (0 to 180) is required; "servo" (1 or 2) defaults to 1. Fractions are truncated.
+     * @param payload Payload bytes, not NUL-terminated.
+     * @param length Payload length.
+     * @param command Receives the command when the result is COMMAND_PARSE_OK.
+     * @return Parse result.
+     */
+    static CommandParseResult parseServoCommand(const uint8_t* payload, size_t length, ServoCommandRecord& command);
+
+private:
+    struct Cursor {
+        const uint8_t* position;
+        const uint8_t* end;
+    };
+
+    static const long NUMBER_LIMIT = 1000000; ///< Magnitudes are clamped here; no command accepts more.
+
+    static void skipSpace(Cursor& cursor);
+    static bool consume(Cursor& cursor, uint8_t character);
+    static bool readString(Cursor& cursor, const uint8_t*& start, size_t& length);
+    static bool readNumber(Cursor& cursor, long& value);
+    static bool skipValue(Cursor& cursor);
+    static bool keyEquals(const uint8_t* key, size_t length, const char* name);
+};
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,167 @@
+#include "ConnectionManager.h"
+
+const Event ConnectionManager::WIFI_CONNECTED_EVENT = Event(WIFI_CONNECTED_EVENT_ID);
+const Event ConnectionManager::WIFI_DISCONNECTED_EVENT = Event(WIFI_DISCONNECTED_EVENT_ID);
+const Event ConnectionManager::MQTT_CONNECTED_EVENT = Event(MQTT_CONNECTED_EVENT_ID);
+const Event ConnectionManager::MQTT_DISCONNECTED_EVENT = Event(MQTT_DISCONNECTED_EVENT_ID);
+const unsigned long ConnectionManager::WIFI_CONNECT_TIMEOUT;
+const unsigned long ConnectionManager::WIFI_FAST_CONNECT_TIMEOUT;
+
+ConnectionManager::ConnectionManager(ConnectionTransport* transport, EventHandler* eventHandler,
+                                     ClockFunction clock, RandomFunction random)
+    : transport(transport), handler(eventHandler), clock(clock), randomSource(random),
+      state(WIFI_BACKOFF), stateStartTime(0), retryAt(0), baseDelay(1000), maxDelay(60000),
+      failedAttempts(0), cachedChannel(0), hasCachedAccessPoint(false), usingCachedAccessPoint(false) {}
+
+void ConnectionManager::begin() {
+    startWiFi(clock != nullptr ? clock() : 0);
+}
+
+void ConnectionManager::update() {
+    if (transport == nullptr || clock == nullptr) {
+        return;
+    }
+
+    unsigned long now = clock();
+
+    switch (state) {
+        case WIFI_CONNECTING:
+            if (transport->isWiFiConnected()) {
+                hasCachedAccessPoint = transport->getWiFiInfo(cachedBssid, cachedChannel);
+                failedAttempts = 0;
+                state = MQTT_CONNECTING;
+                emit(WIFI_CONNECTED_EVENT);
+            } else if (now - stateStartTime >= (usingCachedAccessPoint ? WIFI_FAST_CONNECT_TIMEOUT : WIFI_CONNECT_TIMEOUT)) {
+                transport->disconnectWiFi();
+                if (usingCachedAccessPoint) {
+                    // The access point may have moved channel or gone away; scan on the next attempt
+                    hasCachedAccessPoint = false;
+                }
+                scheduleRetry(WIFI_BACKOFF, now);
+            }
+            break;
+
+        case WIFI_BACKOFF:
+            if ((long)(now - retryAt) >= 0) {
+                startWiFi(now);
+            }
+            break;
+
+        case MQTT_CONNECTING:
+            if (!transport->isWiFiConnected()) {
+                handleWiFiLost(now);
+            } else {
+                ConnectionTransport::MqttAttempt attempt = transport->connectMqtt();
+                if (attempt == ConnectionTransport::MQTT_ATTEMPT_ACCEPTED) {
+                    failedAttempts = 0;
+                    state = CONNECTED;
+                    emit(MQTT_CONNECTED_EVENT);
+                } else if (attempt == ConnectionTransport::MQTT_ATTEMPT_FAILED) {
+                    scheduleRetry(MQTT_BACKOFF, now);
+                }
+            }
+            break;
+
+        case MQTT_BACKOFF:
+            if (!transport->isWiFiConnected()) {
+                handleWiFiLost(now);
+            } else if ((long)(now - retryAt) >= 0) {
+                state = MQTT_CONNECTING;
+            }
+            break;
+
+        case CONNECTED:
+            if (!transport->isWiFiConnected()) {
+                emit(MQTT_DISCONNECTED_EVENT);
+                handleWiFiLost(now);
+            } else if (!transport->isMqttConnected()) {
+                emit(MQTT_DISCONNECTED_EVENT);
+                scheduleRetry(MQTT_BACKOFF, now);
+            } else {
+                transport->loopMqtt();
+            }
+            break;
+    }
+}
+
+void ConnectionManager::setBackoff(unsigned long baseDelay, unsigned long maxDelay) {
+    this->baseDelay = baseDelay;
+    this->maxDelay = maxDelay;
+}
+
+ConnectionManager::State ConnectionManager::getState() const {
+    return state;
+}
+
+bool ConnectionManager::isWiFiConnected() const {
+    return state == MQTT_CONNECTING || state == MQTT_BACKOFF || state == CONNECTED;
+}
+
+bool ConnectionManager::isConnected() const {
+    return state == CONNECTED;
+}
+
+unsigned int ConnectionManager::getFailedAttempts() const {
+    return failedAttempts;
+}
+
+unsigned long ConnectionManager::getRetryDelay() const {
+    if ((state != WIFI_BACKOFF && state != MQTT_BACKOFF) || clock == nullptr) {
+        return 0;
+    }
+    long remaining = (long)(retryAt - clock());
+    return remaining > 0 ? remaining : 0;
+}
+
+void ConnectionManager::clearCachedAccessPoint() {
+    hasCachedAccessPoint = false;
+}
+
+void ConnectionManager::setHandler(EventHandler* eventHandler) {
+    handler = eventHandler;
+}
+
+void ConnectionManager::startWiFi(unsigned long now) {
+    usingCachedAccessPoint = hasCachedAccessPoint;
+    if (usingCachedAccessPoint) {
+        transport->beginWiFi(cachedBssid, cachedChannel);
+    } else {
+        transport->beginWiFi(nullptr, 0);
+    }
+    stateStartTime = now;
+    state = WIFI_CONNECTING;
+}
+
+void ConnectionManager::scheduleRetry(State backoffState, unsigned long now) {
+    // Exponential backoff capped at maxDelay, then "equal jitter": half fixed, half random
+    unsigned long ceiling = baseDelay;
+    for (unsigned int i = 0; i < failedAttempts && ceiling < maxDelay; i++) {
+        ceiling *= 2;
+    }
+    if (ceiling > maxDelay) {
+        ceiling = maxDelay;
+    }
+
+    unsigned long wait = ceiling / 2;
+    if (randomSource != nullptr) {
+        wait += randomSource() % (ceiling / 2 + 1);
+    } else {
+        wait += ceiling / 2;
+    }
+
+    failedAttempts++;
+    retryAt = now + wait;
+    state = backoffState;
+}
+
+void ConnectionManager::handleWiFiLost(unsigned long now) {
+    emit(WIFI_DISCONNECTED_EVENT);
+    failedAttempts = 0;
+    startWiFi(now);
+}
+
+void ConnectionManager::emit(const Event& event) {
+    if (handler != nullptr) {
+        handler->on(event);
+    }
+}
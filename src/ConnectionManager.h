@@ -0,0 +1,122 @@
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include "EventHandler.h"
+#include "ConnectionTransport.h"
+#include "Scheduler.h"
+
+/**
+ * @brief Function returning a uniformly distributed 32-bit random number.
+ */
+typedef uint32_t (*RandomFunction)();
+
+/**
+ * @brief Non-blocking WiFi/MQTT connection state machine.
+ *
+ * Each call to `update()` performs at most one step: start an association, check for its
+ * completion, start or check on an MQTT attempt, or service the session. Failed attempts are retried after an
+ * exponential backoff with jitter, so a fleet does not reconnect to a restarted broker in
+ * lockstep. The BSSID and channel of the last successful association are reused for a fast
+ * reconnect, falling back to a full scan if that fails. State changes are raised as events.
+ */
+class ConnectionManager {
+public:
+    enum State {
+        WIFI_CONNECTING, ///< Association in progress.
+        WIFI_BACKOFF,    ///< Waiting before the next association attempt.
+        MQTT_CONNECTING, ///< WiFi is up, an MQTT attempt is due or in progress.
+        MQTT_BACKOFF,    ///< Waiting before the next MQTT attempt.
+        CONNECTED        ///< WiFi and MQTT are up.
+    };
+
+    static const int WIFI_CONNECTED_EVENT_ID = 400;
+    static const int WIFI_DISCONNECTED_EVENT_ID = 401;
+    static const int MQTT_CONNECTED_EVENT_ID = 402;
+    static const int MQTT_DISCONNECTED_EVENT_ID = 403;
+    static const Event WIFI_CONNECTED_EVENT;
+    static const Event WIFI_DISCONNECTED_EVENT;
+    static const Event MQTT_CONNECTED_EVENT;
+    static const Event MQTT_DISCONNECTED_EVENT;
+
+    static const unsigned long WIFI_CONNECT_TIMEOUT = 15000; ///< Full scan association timeout.
+    static const unsigned long WIFI_FAST_CONNECT_TIMEOUT = 3000; ///< Cached BSSID association timeout.
+
+    /**
+     * @brief Constructs a ConnectionManager.
+     * @param transport Link layer to drive.
+     * @param eventHandler Optional handler receiving connection state events (default: nullptr).
+     * @param clock Time source in milliseconds (default: nullptr, must be set before update()).
+     * @param random Random source for the backoff jitter (default: nullptr, no jitter).
+     */
+    ConnectionManager(ConnectionTransport* transport, EventHandler* eventHandler = nullptr,
+                      ClockFunction clock = nullptr, RandomFunction random = nullptr);
+
+    /**
+     * @brief Starts connecting. Returns immediately.
+     */
+    void begin();
+
+    /**
+     * @brief Advances the state machine by one step. Never waits, unless the transport has to
+     * make its MQTT attempts on the calling task.
+     */
+    void update();
+
+    /**
+     * @brief Sets the backoff range used for WiFi and MQTT retries.
+     * @param baseDelay Backoff after the first failure in milliseconds.
+     * @param maxDelay Upper bound of the backoff in milliseconds.
+     */
+    void setBackoff(unsigned long baseDelay, unsigned long maxDelay);
+
+    State getState() const;
+    bool isWiFiConnected() const; ///< True once WiFi is up, whatever the MQTT state.
+    bool isConnected() const;     ///< True when WiFi and MQTT are up.
+
+    /**
+     * @brief Gets the number of failed attempts since the last successful connection.
+     */
+    unsigned int getFailedAttempts() const;
+
+    /**
+     * @brief Gets the time left before the next retry.
+     * @return Milliseconds to wait, 0 if not backing off.
+     */
+    unsigned long getRetryDelay() const;
+
+    /**
+     * @brief Forgets the cached access point so the next association scans again.
+     */
+    void clearCachedAccessPoint();
+
+    /**
+     * @brief Sets or updates the handler receiving connection state events.
+     * @param eventHandler Pointer to the new EventHandler.
+     */
+    void setHandler(EventHandler* eventHandler);
+
+private:
+    ConnectionTransport* transport;
+    EventHandler* handler;
+    ClockFunction clock;
+    RandomFunction randomSource;
+
+    State state;
+    unsigned long stateStartTime;
+    unsigned long retryAt;
+    unsigned long baseDelay;
+    unsigned long maxDelay;
+    unsigned int failedAttempts;
+
+    uint8_t cachedBssid[6];
+    int32_t cachedChannel;
+    bool hasCachedAccessPoint;
+    bool usingCachedAccessPoint;
+
+    void startWiFi(unsigned long now);
+    void scheduleRetry(State backoffState, unsigned long now);
+    void handleWiFiLost(unsigned long now);
+    void emit(const Event& event);
+};
+
+#endif // CONNECTION_MANAGER_H
@@ -0,0 +1,65 @@
+#ifndef CONNECTION_TRANSPORT_H
+#define CONNECTION_TRANSPORT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Abstract link layer driven by the ConnectionManager.
+ *
+ * Implement this interface over the real WiFi and MQTT clients, or over a fake in host builds
+ * to exercise connection state transitions without a network. Every method should return
+ * without waiting; `connectMqtt` may instead block for one attempt when it has nowhere else
+ * to run it.
+ */
+class ConnectionTransport {
+public:
+    /**
+     * @brief Outcome of connectMqtt().
+     */
+    enum MqttAttempt {
+        MQTT_ATTEMPT_PENDING,  ///< The attempt runs in the background; call again later.
+        MQTT_ATTEMPT_ACCEPTED, ///< The broker accepted the connection.
+        MQTT_ATTEMPT_FAILED    ///< The attempt failed.
+    };
+
+    /**
+     * @brief Starts associating with the access point.
+     *
+     * Also discards the outcome of any MQTT attempt made over the previous link, including
+     * one still in flight, so a later connectMqtt() never reports it.
+     * @param bssid Access point to join directly, or nullptr to scan for the SSID.
+     * @param channel WiFi channel of `bssid`, or 0 to scan.
+     */
+    virtual void beginWiFi(const uint8_t* bssid, int32_t channel) = 0;
+
+    virtual void disconnectWiFi() = 0; ///< Aborts the association in progress.
+    virtual bool isWiFiConnected() = 0; ///< Checks whether the station has an IP address.
+
+    /**
+     * @brief Reads the access point the station is associated with.
+     * @param bssid Receives the 6-byte BSSID.
+     * @param channel Receives the channel.
+     * @return True if the information is available.
+     */
+    virtual bool getWiFiInfo(uint8_t* bssid, int32_t& channel) = 0;
+
+    /**
+     * @brief Starts one MQTT connection attempt, or checks on the one in progress.
+     *
+     * An implementation able to run the attempt on another task returns MQTT_ATTEMPT_PENDING
+     * until it completes, then its outcome once. Otherwise it makes the attempt on the spot,
+     * blocking up to the client's socket timeout.
+     * @return Outcome of the attempt.
+     */
+    virtual MqttAttempt connectMqtt() = 0;
+
+    /**
+     * @brief Checks whether the MQTT session is up. False while an attempt is pending.
+     */
+    virtual bool isMqttConnected() = 0;
+    virtual void loopMqtt() = 0;        ///< Services the MQTT session (keepalive, incoming data).
+
+    virtual ~ConnectionTransport() = default; ///< Virtual destructor for safe inheritance.
+};
+
+#endif // CONNECTION_TRANSPORT_H
@@ -0,0 +1,60 @@
+#include "DhtFrameDecoder.h"
+
+int DhtFrameDecoder::highPulsesFromEdges(const uint32_t* edgeTimes, const uint8_t* edgeLevels, int edgeCount,
+                                         uint16_t* pulses, int maxPulses) {
+    int pulseCount = 0;
+    for (int i = 0; i + 1 < edgeCount && pulseCount < maxPulses; i++) {
+        // A high phase starts on a rising transition and ends on the next falling one
+        if (edgeLevels[i] != 0 && edgeLevels[i + 1] == 0) {
+            uint32_t width = edgeTimes[i + 1] - edgeTimes[i];
+            pulses[pulseCount++] = width > 0xFFFF ? 0xFFFF : (uint16_t)width;
+        }
+    }
+    return pulseCount;
+}
+
+DhtDecodeResult DhtFrameDecoder::decodeBytes(const uint16_t* pulses, int pulseCount, uint8_t data[5]) {
+    if (pulseCount < FRAME_BITS) {
+        return DHT_DECODE_TIMEOUT;
+    }
+
+    // The sensor's 80 us response pulse (and any glitch before it) precedes the data bits
+    const uint16_t* bits = pulses + (pulseCount - FRAME_BITS);
+    for (int i = 0; i < 5; i++) {
+        data[i] = 0;
+    }
+    for (int i = 0; i < FRAME_BITS; i++) {
+        data[i / 8] <<= 1;
+        if (bits[i] > ONE_THRESHOLD_US) {
+            data[i / 8] |= 1;
+        }
+    }
+
+    uint8_t checksum = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    return checksum == data[4] ? DHT_DECODE_OK : DHT_DECODE_CHECKSUM_ERROR;
+}
+
+DhtDecodeResult DhtFrameDecoder::decode(const uint16_t* pulses, int pulseCount, uint8_t dhtType, DhtReading& reading) {
+    uint8_t data[5];
+    DhtDecodeResult result = decodeBytes(pulses, pulseCount, data);
+    if (result != DHT_DECODE_OK) {
+        return result;
+    }
+
+    if (dhtType == 21 || dhtType == 22) {
+        // DHT21/DHT22: 16-bit values in tenths, temperature sign in the top bit
+        reading.humidity = (((uint16_t)data[0] << 8) | data[1]) * 0.1f;
+        reading.temperature = ((((uint16_t)data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+        if (data[2] & 0x80) {
+            reading.temperature = -reading.temperature;
+        }
+    } else {
+        // DHT11/DHT12: integral and decimal bytes, temperature sign in the decimal byte
+        reading.humidity = data[0] + data[1] * 0.1f;
+        reading.temperature = data[2] + (data[3] & 0x0F) * 0.1f;
+        if (data[3] & 0x80) {
+            reading.temperature = -reading.temperature;
+        }
+    }
+    return DHT_DECODE_OK;
+}
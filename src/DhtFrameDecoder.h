@@ -0,0 +1,67 @@
+#ifndef DHT_FRAME_DECODER_H
+#define DHT_FRAME_DECODER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Temperature and humidity decoded from one DHT frame.
+ */
+struct DhtReading {
+    float temperature; ///< Temperature in Celsius.
+    float humidity;    ///< Relative humidity in percent.
+};
+
+/**
+ * @brief Outcome of decoding a DHT frame.
+ */
+enum DhtDecodeResult {
+    DHT_DECODE_OK,             ///< Frame complete and checksum valid.
+    DHT_DECODE_TIMEOUT,        ///< Fewer than 40 data bits were captured.
+    DHT_DECODE_CHECKSUM_ERROR  ///< All bits captured but the checksum does not match.
+};
+
+/**
+ * @brief Pure decoder for DHT11/DHT22 frames captured as pulse widths.
+ *
+ * The sensor sends 40 bits, each a ~50 us low phase followed by a high phase of ~27 us (0)
+ * or ~70 us (1). The decoder works only on captured timings, with no access to pins or
+ * clocks, so recorded waveforms can be replayed through it on the host.
+ */
+class DhtFrameDecoder {
+public:
+    static const int FRAME_BITS = 40;          ///< Data bits in a frame.
+    static const uint16_t ONE_THRESHOLD_US = 48; ///< High phases longer than this are 1 bits.
+
+    /**
+     * @brief Extracts the high-phase widths from a list of line transitions.
+     * @param edgeTimes Timestamp of each transition in microseconds.
+     * @param edgeLevels Line level right after each transition (0 or 1).
+     * @param edgeCount Number of transitions.
+     * @param pulses Receives the width of each complete high phase in microseconds.
+     * @param maxPulses Capacity of `pulses`.
+     * @return Number of widths written.
+     */
+    static int highPulsesFromEdges(const uint32_t* edgeTimes, const uint8_t* edgeLevels, int edgeCount,
+                                   uint16_t* pulses, int maxPulses);
+
+    /**
+     * @brief Decodes the last 40 high-phase widths into the five frame bytes.
+     * @param pulses High-phase widths in microseconds; leading response pulses are ignored.
+     * @param pulseCount Number of widths.
+     * @param data Receives humidity, temperature and checksum bytes.
+     * @return Decode result.
+     */
+    static DhtDecodeResult decodeBytes(const uint16_t* pulses, int pulseCount, uint8_t data[5]);
+
+    /**
+     * @brief Decodes high-phase widths into a reading.
+     * @param pulses High-phase widths in microseconds.
+     * @param pulseCount Number of widths.
+     * @param dhtType Sensor type as defined by the DHT library (11, 12, 21, 22).
+     * @param reading Receives the reading when the result is DHT_DECODE_OK.
+     * @return Decode result.
+     */
+    static DhtDecodeResult decode(const uint16_t* pulses, int pulseCount, uint8_t dhtType, DhtReading& reading);
+};
+
+#endif // DHT_FRAME_DECODER_H
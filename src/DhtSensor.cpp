@@ -4,13 +4,22 @@ const Event DhtSensor::TEMPERATURE_READ_EVENT = Event(TEMPERATURE_READ_EVENT_ID)
 const Event DhtSensor::HUMIDITY_READ_EVENT = Event(HUMIDITY_READ_EVENT_ID);
 
 DhtSensor::DhtSensor(int pin, uint8_t dhtType, EventHandler* eventHandler)
-    : Sensor(pin, eventHandler), dht(pin, dhtType), lastTemperature(NAN), lastHumidity(NAN) {}
+    : Sensor(pin, eventHandler), dht(pin, dhtType), dhtType(dhtType), lastTemperature(NAN), lastHumidity(NAN),
+      asyncMode(false), asyncState(ASYNC_IDLE), stateStartTime(0), lastConversionStart(0),
+      nextConversionAllowed(0), edgeCount(0), readCount(0), checksumErrorCount(0), timeoutCount(0) {}
 
 void DhtSensor::begin() {
     dht.begin();
     
+    if (asyncMode) {
+        // Let the sensor stabilize without blocking; the first conversion waits for it instead
+        nextConversionAllowed = millis() + 2000;
+        LOG_INFO("DHT11: Async mode, first reading in 2 seconds");
+        return;
+    }
+    
     // Give the sensor time to stabilize (DHT11 needs at least 1 second)
-    Serial.println("DHT11: Initializing sensor, please wait...");
+    LOG_INFO("DHT11: Initializing sensor, please wait...");
     delay(2000);  // 2 second warm-up period
     
     // Try an initial reading to verify sensor is working
@@ -18,10 +27,10 @@ void DhtSensor::begin() {
     float testHum = dht.readHumidity();
     
     if (!isnan(testTemp) && !isnan(testHum)) {
-        Serial.println("DHT11: Sensor initialized successfully");
-        Serial.println("Initial readings - T:" + String(testTemp) + "°C, H:" + String(testHum) + "%");
+        LOG_INFO("DHT11: Sensor initialized successfully");
+        LOG_INFO("Initial readings - T:%.2f°C, H:%.2f%%", testTemp, testHum);
     } else {
-        Serial.println("DHT11: Warning - Initial sensor test failed. Check connections.");
+        LOG_WARN("DHT11: Initial sensor test failed. Check connections.");
     }
 }
 
@@ -34,26 +43,138 @@ bool DhtSensor::readSensor() {
     
     // Check if readings are valid (not NaN)
     if (!isnan(temp) && !isnan(hum)) {
-        // Additional validation - reasonable ranges for DHT11
-        if (temp >= -40 && temp <= 80 && hum >= 0 && hum <= 100) {
-            lastTemperature = temp;
-            lastHumidity = hum;
-            
-            // Trigger events for successful readings
-            on(TEMPERATURE_READ_EVENT);
-            on(HUMIDITY_READ_EVENT);
-            
-            return true;
-        } else {
-            Serial.println("DHT11: Values out of range - T:" + String(temp) + "°C, H:" + String(hum) + "%");
-        }
+        return acceptReading(temp, hum);
     } else {
-        Serial.println("DHT11: Failed to read sensor - check wiring and power");
+        LOG_WARN("DHT11: Failed to read sensor - check wiring and power");
+    }
+    
+    return false;
+}
+
+bool DhtSensor::acceptReading(float temp, float hum) {
+    // Additional validation - reasonable ranges for DHT11
+    if (temp >= -40 && temp <= 80 && hum >= 0 && hum <= 100) {
+        lastTemperature = temp;
+        lastHumidity = hum;
+        
+        // Trigger events for successful readings
+        uint32_t now = millis();
+        on(TEMPERATURE_READ_EVENT.withPayload(temp, pin, now));
+        on(HUMIDITY_READ_EVENT.withPayload(hum, pin, now));
+        
+        return true;
     }
     
+    LOG_WARN("DHT11: Values out of range - T:%.2f°C, H:%.2f%%", temp, hum);
     return false;
 }
 
+void DhtSensor::setAsyncMode(bool enabled) {
+    asyncMode = enabled;
+}
+
+bool DhtSensor::startConversion() {
+    unsigned long now = millis();
+    if (!asyncMode || asyncState != ASYNC_IDLE || (long)(now - nextConversionAllowed) < 0) {
+        return false;
+    }
+    
+    // Host start signal: hold the line low, update() releases it once long enough
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    lastConversionStart = now;
+    nextConversionAllowed = now + getMinimumInterval();
+    stateStartTime = now;
+    asyncState = ASYNC_START_SIGNAL;
+    return true;
+}
+
+void DhtSensor::update() {
+    unsigned long now = millis();
+    
+    switch (asyncState) {
+        case ASYNC_IDLE:
+            break;
+        case ASYNC_START_SIGNAL: {
+            // DHT11 needs at least 18 ms of low level, DHT21/DHT22 about 1 ms
+            unsigned long startLow = (dhtType == DHT21 || dhtType == DHT22) ? 2 : 20;
+            if (now - stateStartTime >= startLow) {
+                edgeCount = 0;
+                attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+                pinMode(pin, INPUT_PULLUP);
+                stateStartTime = now;
+                asyncState = ASYNC_CAPTURING;
+            }
+            break;
+        }
+        case ASYNC_CAPTURING:
+            if (edgeCount >= EXPECTED_EDGES || now - stateStartTime > CAPTURE_TIMEOUT_MS) {
+                detachInterrupt(digitalPinToInterrupt(pin));
+                asyncState = ASYNC_IDLE;
+                finishConversion();
+            }
+            break;
+    }
+}
+
+void DhtSensor::finishConversion() {
+    uint32_t times[MAX_EDGES];
+    uint8_t levels[MAX_EDGES];
+    int count = edgeCount;
+    for (int i = 0; i < count; i++) {
+        times[i] = edgeTimes[i];
+        levels[i] = edgeLevels[i];
+    }
+    
+    uint16_t pulses[MAX_EDGES / 2];
+    int pulseCount = DhtFrameDecoder::highPulsesFromEdges(times, levels, count, pulses, MAX_EDGES / 2);
+    
+    DhtReading reading;
+    switch (DhtFrameDecoder::decode(pulses, pulseCount, dhtType, reading)) {
+        case DHT_DECODE_OK:
+            readCount++;
+            acceptReading(reading.temperature, reading.humidity);
+            break;
+        case DHT_DECODE_CHECKSUM_ERROR:
+            checksumErrorCount++;
+            break;
+        case DHT_DECODE_TIMEOUT:
+            timeoutCount++;
+            break;
+    }
+}
+
+void IRAM_ATTR DhtSensor::onEdge(void* arg) {
+    DhtSensor* sensor = static_cast<DhtSensor*>(arg);
+    int index = sensor->edgeCount;
+    if (index < MAX_EDGES) {
+        sensor->edgeTimes[index] = micros();
+        sensor->edgeLevels[index] = digitalRead(sensor->pin);
+        sensor->edgeCount = index + 1;
+    }
+}
+
+bool DhtSensor::isBusy() const {
+    return asyncState != ASYNC_IDLE;
+}
+
+unsigned long DhtSensor::getMinimumInterval() const {
+    // DHT11 can be sampled once per second, DHT21/DHT22 every two seconds
+    return (dhtType == DHT21 || dhtType == DHT22) ? 2000 : 1000;
+}
+
+unsigned long DhtSensor::getReadCount() const {
+    return readCount;
+}
+
+unsigned long DhtSensor::getChecksumErrorCount() const {
+    return checksumErrorCount;
+}
+
+unsigned long DhtSensor::getTimeoutCount() const {
+    return timeoutCount;
+}
+
 float DhtSensor::getTemperature() const {
     return lastTemperature;
 }
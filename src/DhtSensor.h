@@ -2,14 +2,44 @@
 #define DHT_SENSOR_H
 
 #include "Sensor.h"
+#include "DhtFrameDecoder.h"
+#include "Logger.h"
 #include <DHT.h>
 
 class DhtSensor : public Sensor {
 private:
+    enum AsyncState {
+        ASYNC_IDLE,         ///< No conversion in progress.
+        ASYNC_START_SIGNAL, ///< Host is holding the line low to wake the sensor.
+        ASYNC_CAPTURING     ///< Line released, edges are being timestamped by the ISR.
+    };
+
+    static const int MAX_EDGES = 96;               ///< Response + 40 bits need 84 transitions.
+    static const int EXPECTED_EDGES = 84;
+    static const unsigned long CAPTURE_TIMEOUT_MS = 10; ///< A full frame takes under 5 ms.
+
     DHT dht;
+    uint8_t dhtType;
     float lastTemperature;
     float lastHumidity;
 
+    // Non-blocking acquisition
+    bool asyncMode;
+    AsyncState asyncState;
+    unsigned long stateStartTime;
+    unsigned long lastConversionStart;
+    unsigned long nextConversionAllowed;
+    volatile uint32_t edgeTimes[MAX_EDGES];
+    volatile uint8_t edgeLevels[MAX_EDGES];
+    volatile int edgeCount;
+    unsigned long readCount;
+    unsigned long checksumErrorCount;
+    unsigned long timeoutCount;
+
+    static void onEdge(void* arg);
+    void finishConversion();
+    bool acceptReading(float temp, float hum);
+
 public:
     static const int TEMPERATURE_READ_EVENT_ID = 100;
     static const int HUMIDITY_READ_EVENT_ID = 101;
@@ -26,15 +56,64 @@ public:
 
     /**
      * @brief Initializes the DHT sensor.
+     *
+     * In blocking mode waits for the sensor to stabilize and performs a test read. In async mode
+     * returns immediately and defers the first conversion until the warm-up time has elapsed.
      */
     void begin();
 
     /**
-     * @brief Reads temperature and humidity from the sensor.
+     * @brief Reads temperature and humidity from the sensor, blocking until done.
      * @return True if reading was successful, false otherwise.
      */
     bool readSensor();
 
+    /**
+     * @brief Selects non-blocking acquisition. Must be called before begin().
+     * @param enabled True to use startConversion()/update(), false to use readSensor().
+     */
+    void setAsyncMode(bool enabled);
+
+    /**
+     * @brief Starts a non-blocking conversion and returns immediately.
+     *
+     * The result is delivered by update() as TEMPERATURE_READ_EVENT and HUMIDITY_READ_EVENT.
+     * Requests made before the sensor's minimum sampling interval has elapsed are refused.
+     * @return True if a conversion was started.
+     */
+    bool startConversion();
+
+    /**
+     * @brief Advances a conversion in progress. Call frequently (every loop pass); never blocks.
+     */
+    void update();
+
+    /**
+     * @brief Checks whether a non-blocking conversion is in progress.
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Gets the minimum time between two conversions for this sensor type.
+     * @return Interval in milliseconds.
+     */
+    unsigned long getMinimumInterval() const;
+
+    /**
+     * @brief Gets the number of frames decoded successfully in async mode.
+     */
+    unsigned long getReadCount() const;
+
+    /**
+     * @brief Gets the number of frames rejected because of a bad checksum in async mode.
+     */
+    unsigned long getChecksumErrorCount() const;
+
+    /**
+     * @brief Gets the number of conversions that did not deliver a complete frame in async mode.
+     */
+    unsigned long getTimeoutCount() const;
+
     /**
      * @brief Gets the last temperature reading.
      * @return Temperature in Celsius.
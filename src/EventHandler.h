@@ -1,16 +1,33 @@
 #ifndef EVENT_HANDLER_H
 #define EVENT_HANDLER_H
 
+#include <stdint.h>
+
 /**
- * @brief Represents an event with a unique identifier.
+ * @brief Represents an event with a unique identifier and a small payload.
  * 
  * Events are lightweight structs used to signal occurrences (e.g., sensor triggers) within
- * the framework. Define custom events by assigning unique IDs in your application.
+ * the framework. Define custom events by assigning unique IDs in your application. The payload
+ * travels by value, so handlers do not need to call back into the emitter; two events compare
+ * equal when their IDs match, whatever their payloads.
  */
 struct Event {
     int id; ///< Unique identifier for the event type.
+    float value;        ///< Reading or state carried by the event (0 if none).
+    uint16_t sourceId;  ///< Emitter of the event, by convention its GPIO pin (0 if unspecified).
+    uint32_t timestamp; ///< Time the event was raised in milliseconds (0 if unspecified).
+
+    explicit Event(int eventId) : id(eventId), value(0), sourceId(0), timestamp(0) {}
+    Event(int eventId, float eventValue, uint16_t eventSourceId = 0, uint32_t eventTimestamp = 0)
+        : id(eventId), value(eventValue), sourceId(eventSourceId), timestamp(eventTimestamp) {}
+
+    /**
+     * @brief Copies the event with a payload, e.g. `on(GAS_HIGH_EVENT.withPayload(ppm, pin, millis()))`.
+     */
+    Event withPayload(float eventValue, uint16_t eventSourceId, uint32_t eventTimestamp) const {
+        return Event(id, eventValue, eventSourceId, eventTimestamp);
+    }
 
-    explicit Event(int eventId) : id(eventId) {}
     bool operator==(const Event& other) const { return id == other.id; }
 };
 
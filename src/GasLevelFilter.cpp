@@ -0,0 +1,116 @@
+#include "GasLevelFilter.h"
+
+GasLevelFilter::GasLevelFilter(uint8_t emaShift)
+    : windowCount(0), windowIndex(0), emaShift(0), ema(0) {
+    setEmaShift(emaShift);
+}
+
+void GasLevelFilter::setEmaShift(uint8_t emaShift) {
+    this->emaShift = emaShift > 15 ? 15 : emaShift;
+}
+
+void GasLevelFilter::reset() {
+    windowCount = 0;
+    windowIndex = 0;
+    ema = 0;
+}
+
+uint16_t GasLevelFilter::push(uint16_t value) {
+    window[windowIndex] = value;
+    windowIndex = (windowIndex + 1) % MEDIAN_WINDOW;
+    if (windowCount < MEDIAN_WINDOW) {
+        windowCount++;
+    }
+
+    int32_t target = (int32_t)median() << EMA_FRACTION_BITS;
+    if (windowCount == 1) {
+        ema = target; // Prime with the first block instead of ramping up from zero
+    } else {
+        // Round the step away from zero so the average settles exactly on a steady input
+        int32_t difference = target - ema;
+        if (difference > 0) {
+            ema += (difference + (1 << emaShift) - 1) >> emaShift;
+        } else {
+            ema += difference >> emaShift;
+        }
+    }
+    return getValue();
+}
+
+uint16_t GasLevelFilter::pushBlock(const uint16_t* samples, int count) {
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return push((uint16_t)((sum + count / 2) / count));
+}
+
+uint16_t GasLevelFilter::getValue() const {
+    return (uint16_t)((ema + (1 << (EMA_FRACTION_BITS - 1))) >> EMA_FRACTION_BITS);
+}
+
+bool GasLevelFilter::isPrimed() const {
+    return windowCount > 0;
+}
+
+uint16_t GasLevelFilter::median() const {
+    // Insertion sort of at most MEDIAN_WINDOW values; until the window fills, the lower middle
+    uint16_t sorted[MEDIAN_WINDOW];
+    for (int i = 0; i < windowCount; i++) {
+        uint16_t value = window[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    return sorted[(windowCount - 1) / 2];
+}
+
+GasLevelClassifier::GasLevelClassifier(uint16_t mediumThreshold, uint16_t highThreshold, uint16_t band)
+    : mediumThreshold(mediumThreshold), highThreshold(highThreshold), band(band), level(GAS_LEVEL_NONE) {}
+
+void GasLevelClassifier::setThresholds(uint16_t mediumThreshold, uint16_t highThreshold) {
+    this->mediumThreshold = mediumThreshold;
+    this->highThreshold = highThreshold;
+}
+
+void GasLevelClassifier::setBand(uint16_t band) {
+    this->band = band;
+}
+
+void GasLevelClassifier::reset() {
+    level = GAS_LEVEL_NONE;
+}
+
+bool GasLevelClassifier::update(uint16_t value) {
+    GasLevel target;
+    if (value >= highThreshold) {
+        target = GAS_LEVEL_HIGH;
+    } else if (value >= mediumThreshold) {
+        target = GAS_LEVEL_MEDIUM;
+    } else if (value > 0) {
+        target = GAS_LEVEL_PRESENT;
+    } else {
+        target = GAS_LEVEL_NONE;
+    }
+
+    // Rising takes effect at once; falling only once the reading leaves the band of each level
+    GasLevel previous = level;
+    uint32_t raised = (uint32_t)value + band;
+    if (target >= level) {
+        level = target;
+    } else if (level == GAS_LEVEL_HIGH && raised >= highThreshold) {
+        // Still within the high band
+    } else if (level >= GAS_LEVEL_MEDIUM && raised >= mediumThreshold) {
+        level = GAS_LEVEL_MEDIUM;
+    } else {
+        level = target;
+    }
+    return level != previous;
+}
+
+GasLevel GasLevelClassifier::getLevel() const {
+    return level;
+}
@@ -0,0 +1,123 @@
+#ifndef GAS_LEVEL_FILTER_H
+#define GAS_LEVEL_FILTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Fixed-point smoothing filter for oversampled ADC readings.
+ *
+ * Each input is the mean of a block of raw conversions. A median over the last
+ * MEDIAN_WINDOW blocks removes isolated spikes. An exponential moving average with a weight
+ * of 2^-emaShift then smooths the residual noise. Everything is integer arithmetic in ADC
+ * counts, with EMA_FRACTION_BITS of fraction kept in the accumulator. The filter has no
+ * access to pins or clocks, so recorded traces can be replayed through it on the host.
+ */
+class GasLevelFilter {
+public:
+    static const int MEDIAN_WINDOW = 5;
+    static const int EMA_FRACTION_BITS = 8;
+
+    /**
+     * @brief Constructs a GasLevelFilter.
+     * @param emaShift EMA weight as a power of two: 0 disables smoothing, 3 weighs each block 1/8 (default).
+     */
+    explicit GasLevelFilter(uint8_t emaShift = 3);
+
+    /**
+     * @brief Sets the EMA weight. Keeps the current value.
+     * @param emaShift EMA weight as a power of two, at most 15.
+     */
+    void setEmaShift(uint8_t emaShift);
+
+    /**
+     * @brief Forgets the history; the next input primes the filter.
+     */
+    void reset();
+
+    /**
+     * @brief Feeds the mean of one block of conversions.
+     * @param value Block mean in ADC counts.
+     * @return Filtered value in ADC counts.
+     */
+    uint16_t push(uint16_t value);
+
+    /**
+     * @brief Averages a block of raw conversions and feeds the mean.
+     * @param samples Raw conversions in ADC counts.
+     * @param count Number of conversions, at least 1.
+     * @return Filtered value in ADC counts.
+     */
+    uint16_t pushBlock(const uint16_t* samples, int count);
+
+    /**
+     * @brief Gets the filtered value in ADC counts, rounded.
+     */
+    uint16_t getValue() const;
+
+    /**
+     * @brief Checks whether at least one block was fed since the last reset.
+     */
+    bool isPrimed() const;
+
+private:
+    uint16_t window[MEDIAN_WINDOW];
+    uint8_t windowCount;
+    uint8_t windowIndex;
+    uint8_t emaShift;
+    int32_t ema; ///< Filtered value with EMA_FRACTION_BITS of fraction.
+
+    uint16_t median() const;
+};
+
+/**
+ * @brief Gas level bands, from lowest to highest.
+ */
+enum GasLevel {
+    GAS_LEVEL_NONE,    ///< Reading is zero.
+    GAS_LEVEL_PRESENT, ///< Non-zero reading below the medium threshold.
+    GAS_LEVEL_MEDIUM,  ///< At or above the medium threshold.
+    GAS_LEVEL_HIGH     ///< At or above the high threshold.
+};
+
+/**
+ * @brief Classifies filtered readings into gas level bands with hysteresis.
+ *
+ * A level is entered when the reading reaches its threshold. It is left only once the reading
+ * falls more than the hysteresis band below it, so noise around a threshold produces a single
+ * transition.
+ */
+class GasLevelClassifier {
+public:
+    /**
+     * @brief Constructs a GasLevelClassifier.
+     * @param mediumThreshold Medium threshold, in the same unit as the readings.
+     * @param highThreshold High threshold.
+     * @param band Hysteresis band below each threshold.
+     */
+    GasLevelClassifier(uint16_t mediumThreshold, uint16_t highThreshold, uint16_t band);
+
+    void setThresholds(uint16_t mediumThreshold, uint16_t highThreshold);
+    void setBand(uint16_t band);
+
+    /**
+     * @brief Returns to GAS_LEVEL_NONE.
+     */
+    void reset();
+
+    /**
+     * @brief Classifies a reading.
+     * @param value Filtered reading.
+     * @return True if the level changed.
+     */
+    bool update(uint16_t value);
+
+    GasLevel getLevel() const;
+
+private:
+    uint16_t mediumThreshold;
+    uint16_t highThreshold;
+    uint16_t band;
+    GasLevel level;
+};
+
+#endif // GAS_LEVEL_FILTER_H
@@ -0,0 +1,119 @@
+#include "HttpMessageTransport.h"
+#include <WiFi.h>
+#include "Profiler.h"
+
+/**
+ * @brief Stream sink that accepts and forgets everything written to it.
+ */
+class DiscardStream : public Stream {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override {}
+};
+
+HttpMessageTransport::HttpMessageTransport(uint8_t* buffer, size_t size)
+    : buffer(buffer), bufferSize(size), lent(false), endpoint(""), lastStatus(0) {
+    httpClient.setReuse(true);
+    httpClient.setTimeout(REQUEST_TIMEOUT);
+    // Same trust model as HTTPClient::begin(url): encrypted but the server is not verified
+    secureClient.setInsecure();
+}
+
+void HttpMessageTransport::setEndpoint(const char* endpoint) {
+    this->endpoint = endpoint;
+}
+
+int HttpMessageTransport::getLastStatus() const {
+    return lastStatus;
+}
+
+uint8_t* HttpMessageTransport::acquire(size_t& capacity) {
+    if (lent) {
+        return nullptr;
+    }
+    lent = true;
+    capacity = bufferSize;
+    return buffer;
+}
+
+bool HttpMessageTransport::commit(const char*, size_t length) {
+    lent = false;
+    return length <= bufferSize && post(buffer, length);
+}
+
+void HttpMessageTransport::release() {
+    lent = false;
+}
+
+bool HttpMessageTransport::publish(const char*, const uint8_t* payload, size_t length) {
+    return post(payload, length);
+}
+
+bool HttpMessageTransport::subscribe(const char*) {
+    return false;
+}
+
+void HttpMessageTransport::setHandler(MessageHandler*) {}
+
+bool HttpMessageTransport::isConnected() {
+    return WiFi.status() == WL_CONNECTED;
+}
+
+void HttpMessageTransport::loop() {}
+
+bool HttpMessageTransport::post(const uint8_t* body, size_t length) {
+    PROFILE_SPAN("httpPost");
+    // begin() only parses the URL; with reuse enabled the open connection is kept across requests
+    bool secure = strncmp(endpoint, "https", 5) == 0;
+    if (secure) {
+        httpClient.begin(secureClient, endpoint);
+    } else {
+        httpClient.begin(plainClient, endpoint);
+    }
+    httpClient.addHeader("Content-Type", "application/json");
+    httpClient.addHeader("User-Agent", "SmartSuite-ESP32/1.0");
+
+    lastStatus = httpClient.POST(const_cast<uint8_t*>(body), length);
+    if (lastStatus > 0) {
+        discardResponse();
+    }
+    httpClient.end();
+    return lastStatus >= 200 && lastStatus < 300;
+}
+
+void HttpMessageTransport::discardResponse() {
+    // The body must be consumed for the connection to be reusable; read it without a String
+    int remaining = httpClient.getSize();
+    if (remaining < 0) {
+        // Chunked or unknown length: let HTTPClient decode it into a sink
+        DiscardStream sink;
+        httpClient.writeToStream(&sink);
+        return;
+    }
+
+    WiFiClient* stream = httpClient.getStreamPtr();
+    uint8_t scratch[64];
+    unsigned long start = millis();
+    while (stream != nullptr && remaining > 0 && millis() - start < REQUEST_TIMEOUT) {
+        int available = stream->available();
+        if (available <= 0) {
+            if (!httpClient.connected()) {
+                break;
+            }
+            delay(1);
+            continue;
+        }
+        int chunk = available < (int)sizeof(scratch) ? available : (int)sizeof(scratch);
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        int read = stream->read(scratch, chunk);
+        if (read > 0) {
+            remaining -= read;
+        }
+    }
+}
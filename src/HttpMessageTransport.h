@@ -0,0 +1,62 @@
+#ifndef HTTP_MESSAGE_TRANSPORT_H
+#define HTTP_MESSAGE_TRANSPORT_H
+
+#include "MessageTransport.h"
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+
+/**
+ * @brief MessageTransport posting each message as a JSON request body to one endpoint.
+ *
+ * HTTP has no topics: every message goes to the endpoint whatever its topic, and subscribe()
+ * always fails. The connection, and its TLS session for https, is kept alive between
+ * requests, and the response body is read into a sink so the next request can reuse it. A
+ * request blocks for up to REQUEST_TIMEOUT; call it from a task that may wait.
+ */
+class HttpMessageTransport : public MessageTransport {
+public:
+    static const uint16_t REQUEST_TIMEOUT = 5000; ///< Milliseconds before a request is abandoned.
+
+    /**
+     * @brief Constructs an HttpMessageTransport.
+     * @param buffer Buffer lent by acquire().
+     * @param size Size of the buffer in bytes.
+     */
+    HttpMessageTransport(uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Sets the endpoint URL. Takes effect on the next request.
+     * @param endpoint HTTP or HTTPS URL.
+     */
+    void setEndpoint(const char* endpoint);
+
+    /**
+     * @brief Gets the status code of the last request, or a negative HTTPClient error.
+     */
+    int getLastStatus() const;
+
+    uint8_t* acquire(size_t& capacity) override;
+    bool commit(const char* topic, size_t length) override;
+    void release() override;
+    bool publish(const char* topic, const uint8_t* payload, size_t length) override;
+    bool subscribe(const char* topic) override;
+    void setHandler(MessageHandler* handler) override;
+    bool isConnected() override;
+    void loop() override;
+
+private:
+    uint8_t* buffer;
+    size_t bufferSize;
+    bool lent;
+    const char* endpoint;
+    int lastStatus;
+
+    HTTPClient httpClient;
+    WiFiClient plainClient;
+    WiFiClientSecure secureClient;
+
+    bool post(const uint8_t* body, size_t length);
+    void discardResponse();
+};
+
+#endif // HTTP_MESSAGE_TRANSPORT_H
@@ -0,0 +1,194 @@
+#include "HttpUploader.h"
+
+const int HttpUploader::MAX_BATCH;
+
+HttpUploader::HttpUploader()
+    : queueHead(0), queueCount(0), stats(), endpoint(""), linkAvailable(false), taskRunning(false),
+      taskProfiler(nullptr), retryPending(false), retryTime(0), transport(batchBuffer, sizeof(batchBuffer)) {}
+
+void HttpUploader::setEndpoint(const char* endpoint) {
+    this->endpoint = endpoint;
+    transport.setEndpoint(endpoint);
+}
+
+void HttpUploader::setSourceInfo(const char* deviceId, const char* source) {
+    encoder.setSourceInfo(deviceId, source);
+}
+
+void HttpUploader::setLinkAvailable(bool available) {
+    linkAvailable = available;
+}
+
+void HttpUploader::enqueue(const SensorSample& sample) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (queueCount == QUEUE_CAPACITY) {
+        // Drop-oldest: the newest values matter most for monitoring
+        queueHead = (queueHead + 1) % QUEUE_CAPACITY;
+        queueCount--;
+        stats.dropped++;
+    }
+    queue[(queueHead + queueCount) % QUEUE_CAPACITY] = sample;
+    queueCount++;
+}
+
+bool HttpUploader::update() {
+    if (!linkAvailable) {
+        return false;
+    }
+    if (retryPending) {
+        if ((long)(millis() - retryTime) < 0) {
+            return false;
+        }
+        retryPending = false;
+    }
+
+    SensorSample batch[MAX_BATCH];
+    int count = takeBatch(batch);
+    if (count == 0) {
+        return false;
+    }
+
+    size_t capacity;
+    uint8_t* body = transport.acquire(capacity);
+    size_t length = encodeBatch(batch, count, body, capacity);
+    if (length == 0) {
+        // A sample that does not encode now never will: count it rather than lose it unseen
+        transport.release();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stats.dropped += count;
+        }
+        LOG_ERROR("HTTP batch of %d samples does not encode", count);
+        return false;
+    }
+
+    unsigned long start = millis();
+    bool success = transport.commit(endpoint, length);
+    unsigned long latency = millis() - start;
+    int responseCode = transport.getLastStatus();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.requests++;
+        stats.lastLatency = latency;
+        stats.totalLatency += latency;
+        if (latency > stats.maxLatency) {
+            stats.maxLatency = latency;
+        }
+        if (success) {
+            stats.samplesSent += count;
+        } else {
+            stats.failures++;
+        }
+    }
+
+    if (!success) {
+        LOG_ERROR("HTTP Error code: %d", responseCode);
+        if (isTransient(responseCode)) {
+            // Store and forward: the samples wait for the server instead of being lost
+            returnBatch(batch, count);
+            retryPending = true;
+            retryTime = millis() + RETRY_DELAY;
+        }
+    }
+    return true;
+}
+
+bool HttpUploader::startTask(int core, int priority) {
+#ifdef ESP32
+    if (taskRunning) {
+        return true;
+    }
+    taskProfiler = Profiler::current();
+    taskRunning = xTaskCreatePinnedToCore(uploadTask, "http", 8192, this, priority, nullptr, core) == pdPASS;
+    return taskRunning;
+#else
+    (void)core;
+    (void)priority;
+    return false;
+#endif
+}
+
+bool HttpUploader::isTaskRunning() const {
+    return taskRunning;
+}
+
+int HttpUploader::getQueuedCount() {
+    std::lock_guard<std::mutex> guard(lock);
+    return queueCount;
+}
+
+UploadStats HttpUploader::getStats() {
+    std::lock_guard<std::mutex> guard(lock);
+    return stats;
+}
+
+int HttpUploader::takeBatch(SensorSample* batch) {
+    std::lock_guard<std::mutex> guard(lock);
+    int count = queueCount < MAX_BATCH ? queueCount : MAX_BATCH;
+    for (int i = 0; i < count; i++) {
+        batch[i] = queue[queueHead];
+        queueHead = (queueHead + 1) % QUEUE_CAPACITY;
+    }
+    queueCount -= count;
+    return count;
+}
+
+void HttpUploader::returnBatch(const SensorSample* batch, int count) {
+    std::lock_guard<std::mutex> guard(lock);
+    // Back in front of anything queued meanwhile; when it does not all fit, the oldest goes
+    int room = QUEUE_CAPACITY - queueCount;
+    int kept = count < room ? count : room;
+    for (int i = count - 1; i >= count - kept; i--) {
+        queueHead = (queueHead + QUEUE_CAPACITY - 1) % QUEUE_CAPACITY;
+        queue[queueHead] = batch[i];
+    }
+    queueCount += kept;
+    stats.retried += kept;
+    stats.dropped += count - kept;
+}
+
+bool HttpUploader::isTransient(int responseCode) {
+    // Negative codes are HTTPClient errors: no connection, timeout, lost link
+    return responseCode <= 0 || responseCode == 408 || responseCode == 429 || responseCode >= 500;
+}
+
+size_t HttpUploader::encodeBatch(const SensorSample* batch, int count, uint8_t* body, size_t capacity) {
+    if (body == nullptr || capacity < BATCH_BUFFER_SIZE) {
+        return 0;
+    }
+    size_t position = 0;
+    if (count > 1) {
+        body[position++] = '[';
+    }
+    for (int i = 0; i < count; i++) {
+        size_t length;
+        if (!encoder.encode(batch[i])) {
+            return 0;
+        }
+        const char* payload = encoder.httpPayload(length);
+        if (i > 0) {
+            body[position++] = ',';
+        }
+        memcpy(body + position, payload, length);
+        position += length;
+    }
+    if (count > 1) {
+        body[position++] = ']';
+    }
+    return position;
+}
+
+void HttpUploader::uploadTask(void* parameter) {
+#ifdef ESP32
+    HttpUploader* uploader = static_cast<HttpUploader*>(parameter);
+    Profiler::select(uploader->taskProfiler);
+    for (;;) {
+        if (!uploader->update()) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+    }
+#else
+    (void)parameter;
+#endif
+}
@@ -0,0 +1,129 @@
+#ifndef HTTP_UPLOADER_H
+#define HTTP_UPLOADER_H
+
+#include <mutex>
+#include "HttpMessageTransport.h"
+#include "PipelineRecords.h"
+#include "TelemetryEncoder.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+/**
+ * @brief Latency and outcome statistics of the HTTP uploads.
+ */
+struct UploadStats {
+    unsigned long requests;     ///< Requests sent.
+    unsigned long failures;     ///< Requests that got no response or a non-2xx status.
+    unsigned long samplesSent;  ///< Samples delivered, counting every sample of a batch.
+    unsigned long dropped;      ///< Samples discarded because the queue was full or they did not encode.
+    unsigned long retried;      ///< Samples put back in the queue after a failed request.
+    unsigned long lastLatency;  ///< Duration of the last request in milliseconds.
+    unsigned long maxLatency;   ///< Longest request in milliseconds.
+    unsigned long totalLatency; ///< Sum of request durations, used to compute the mean.
+};
+
+/**
+ * @brief Background uploader posting sensor samples to an HTTP endpoint.
+ *
+ * Producers call `enqueue()`, which never blocks; the queue is bounded and drops the oldest
+ * sample when full. Uploads run from `update()` or, on ESP32, from a dedicated low-priority
+ * task started with `startTask()`, so a slow server never stalls the control loop. A batch
+ * whose request fails for a transient reason (no response, 408, 429 or 5xx) goes back to the
+ * front of the queue, under the same drop-oldest rule, and is retried after RETRY_DELAY; other
+ * errors are permanent and drop it. Requests
+ * go through an HttpMessageTransport, which keeps the connection alive between them; batches
+ * are encoded straight into its request buffer. When samples pile up they are sent together
+ * as a JSON array.
+ */
+class HttpUploader {
+public:
+    static const int QUEUE_CAPACITY = 16; ///< Samples held while the server is slow or down.
+    static const int MAX_BATCH = 4;       ///< Samples sent in a single request.
+    static const size_t BATCH_BUFFER_SIZE = MAX_BATCH * (TelemetryEncoder::BUFFER_SIZE + 1) + 2;
+    static const unsigned long RETRY_DELAY = 2000; ///< Pause in milliseconds after a transient failure.
+
+    HttpUploader();
+
+    /**
+     * @brief Sets the endpoint URL. Takes effect on the next request.
+     * @param endpoint HTTP or HTTPS URL.
+     */
+    void setEndpoint(const char* endpoint);
+
+    /**
+     * @brief Sets the identification fields added to every uploaded sample.
+     * @param deviceId Device identifier.
+     * @param source Source tag.
+     */
+    void setSourceInfo(const char* deviceId, const char* source);
+
+    /**
+     * @brief Tells the uploader whether the network is usable. Uploads pause while it is not.
+     * @param available True once WiFi is connected.
+     */
+    void setLinkAvailable(bool available);
+
+    /**
+     * @brief Queues a sample for upload. Never blocks; drops the oldest sample when full.
+     * @param sample The sample to upload.
+     */
+    void enqueue(const SensorSample& sample);
+
+    /**
+     * @brief Sends one request if samples are waiting. Blocks for the duration of the request.
+     * @return True if a request was made.
+     */
+    bool update();
+
+    /**
+     * @brief Starts a background task calling update(). ESP32 only; returns false elsewhere.
+     *
+     * The task records its spans into the profiler selected by the calling thread.
+     * @param core Core to pin the task to.
+     * @param priority FreeRTOS priority, below the control tasks.
+     * @return True if the task was created.
+     */
+    bool startTask(int core, int priority);
+
+    /**
+     * @brief Checks whether the background task is running.
+     */
+    bool isTaskRunning() const;
+
+    /**
+     * @brief Gets the number of samples waiting.
+     */
+    int getQueuedCount();
+
+    /**
+     * @brief Gets a copy of the upload statistics.
+     */
+    UploadStats getStats();
+
+private:
+    std::mutex lock;
+    SensorSample queue[QUEUE_CAPACITY];
+    int queueHead;
+    int queueCount;
+    UploadStats stats;
+
+    const char* endpoint;
+    volatile bool linkAvailable;
+    bool taskRunning;
+    Profiler* taskProfiler;   ///< Selected by the upload task.
+    bool retryPending;        ///< A failed batch waits for retryTime.
+    unsigned long retryTime;
+
+    TelemetryEncoder encoder;
+    uint8_t batchBuffer[BATCH_BUFFER_SIZE]; ///< Lent by the transport for each request body.
+    HttpMessageTransport transport;
+
+    int takeBatch(SensorSample* batch);
+    void returnBatch(const SensorSample* batch, int count);
+    static bool isTransient(int responseCode);
+    size_t encodeBatch(const SensorSample* batch, int count, uint8_t* body, size_t capacity);
+
+    static void uploadTask(void* parameter);
+};
+
+#endif // HTTP_UPLOADER_H
@@ -0,0 +1,48 @@
+#ifndef JOURNAL_STORAGE_H
+#define JOURNAL_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Abstract NOR-flash-like storage backing the TelemetryJournal.
+ *
+ * Follows flash semantics: erased bytes read 0xFF, writes can only clear bits, and erasing
+ * works on whole sectors. Implemented over a raw flash partition on the board and over a
+ * memory-mapped file on the host.
+ */
+class JournalStorage {
+public:
+    virtual bool begin() = 0;               ///< Opens the storage; false if unavailable.
+    virtual size_t size() const = 0;        ///< Total size in bytes, a multiple of the sector size.
+    virtual size_t sectorSize() const = 0;  ///< Erase unit in bytes.
+
+    /**
+     * @brief Reads bytes from the storage.
+     * @param offset Byte offset.
+     * @param data Receives the bytes.
+     * @param length Number of bytes.
+     * @return True on success.
+     */
+    virtual bool read(size_t offset, void* data, size_t length) = 0;
+
+    /**
+     * @brief Programs bytes into previously erased storage.
+     * @param offset Byte offset.
+     * @param data Bytes to write.
+     * @param length Number of bytes.
+     * @return True on success.
+     */
+    virtual bool write(size_t offset, const void* data, size_t length) = 0;
+
+    /**
+     * @brief Erases one sector back to 0xFF.
+     * @param sector Sector index.
+     * @return True on success.
+     */
+    virtual bool eraseSector(size_t sector) = 0;
+
+    virtual ~JournalStorage() = default; ///< Virtual destructor for safe inheritance.
+};
+
+#endif // JOURNAL_STORAGE_H
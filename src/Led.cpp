@@ -12,19 +12,28 @@ Led::Led(int pin, bool initialState, CommandHandler* commandHandler)
 }
 
 void Led::handle(Command command) {
-    if (command == TOGGLE_LED_COMMAND) {
-        state = !state;
-        digitalWrite(pin, state);
-    } else if (command == TURN_ON_COMMAND) {
-        state = true;
-        digitalWrite(pin, state);
-    } else if (command == TURN_OFF_COMMAND) {
-        state = false;
-        digitalWrite(pin, state);
-    }
+    apply(command);
     Actuator::handle(command); // Propagate to handler if set
 }
 
+bool Led::apply(Command command) {
+    switch (command.id) {
+        case TOGGLE_LED_COMMAND_ID:
+            state = !state;
+            break;
+        case TURN_ON_COMMAND_ID:
+            state = true;
+            break;
+        case TURN_OFF_COMMAND_ID:
+            state = false;
+            break;
+        default:
+            return false;
+    }
+    digitalWrite(pin, state);
+    return true;
+}
+
 bool Led::getState() const {
     return state;
 }
@@ -29,6 +29,15 @@ public:
      */
     void handle(Command command) override;
 
+    /**
+     * @brief Executes a command without propagating it to the handler.
+     *
+     * Non-virtual path for owners that drive the LED directly and need no feedback.
+     * @param command The command to execute.
+     * @return True if the command is one of the LED commands.
+     */
+    bool apply(Command command);
+
     /**
      * @brief Gets the current state of the LED.
      * @return True if the LED is ON, false if OFF.
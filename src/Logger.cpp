@@ -0,0 +1,332 @@
+#include "Logger.h"
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#ifndef ESP32
+#include <chrono>
+#include <thread>
+#endif
+
+const size_t LogRecord::HEADER_SIZE;
+const unsigned long Logger::DRAIN_PERIOD;
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of two");
+
+// Records waiting for the drain task, each stored as a length byte and the record. Writers
+// reserve space by advancing ringHead, copy the record in, then store its length byte last: a
+// zero length byte marks a record still being written. The drain task zeroes what it read
+// before moving ringTail, so every byte it may find at the tail later is either 0 or a length.
+static std::atomic<uint8_t> ringBuffer[LOG_BUFFER_SIZE];
+static std::atomic<uint32_t> ringHead(0);   ///< Total bytes reserved, the write position modulo the size.
+static std::atomic<uint32_t> ringTail(0);   ///< Total bytes read.
+static std::atomic_flag draining = ATOMIC_FLAG_INIT;
+static std::atomic<unsigned long> droppedCount(0);
+static unsigned long reportedDrops = 0; ///< Drop count at the last warning, read by the drain task only.
+#ifdef ESP32
+static volatile bool textOutput = false;
+#else
+static volatile bool textOutput = true; // No decoder needed on the host
+#endif
+static bool drainRunning = false;
+
+static const char LEVEL_NAMES[] = "-EWID";
+
+LogRecord::LogRecord(uint8_t level, uint32_t timestamp, const char* format) : length(0) {
+    bytes[length++] = level;
+    for (int i = 0; i < 4; i++) {
+        bytes[length++] = (uint8_t)(timestamp >> (8 * i));
+    }
+    uintptr_t address = (uintptr_t)format;
+    for (size_t i = 0; i < sizeof(address); i++) {
+        bytes[length++] = (uint8_t)(address >> (8 * i));
+    }
+}
+
+void LogRecord::add(bool value) {
+    addWord(LOG_ARG_INT, value ? 1 : 0);
+}
+
+void LogRecord::add(char value) {
+    addWord(LOG_ARG_INT, (uint32_t)(int32_t)value);
+}
+
+void LogRecord::add(int value) {
+    addWord(LOG_ARG_INT, (uint32_t)(int32_t)value);
+}
+
+void LogRecord::add(unsigned int value) {
+    addWord(LOG_ARG_UINT, (uint32_t)value);
+}
+
+void LogRecord::add(long value) {
+    addWord(LOG_ARG_INT, (uint32_t)(int32_t)value);
+}
+
+void LogRecord::add(unsigned long value) {
+    addWord(LOG_ARG_UINT, (uint32_t)value);
+}
+
+void LogRecord::add(double value) {
+    float single = (float)value;
+    uint32_t word;
+    memcpy(&word, &single, sizeof(word));
+    addWord(LOG_ARG_FLOAT, word);
+}
+
+void LogRecord::add(const char* value) {
+    if (value == nullptr) {
+        value = "(null)";
+    }
+    size_t count = strlen(value);
+    if (count > MAX_STRING) {
+        count = MAX_STRING;
+    }
+    if (length + 2 + count > MAX_SIZE) {
+        return;
+    }
+    bytes[length++] = LOG_ARG_STRING;
+    bytes[length++] = (uint8_t)count;
+    memcpy(bytes + length, value, count);
+    length += count;
+}
+
+void LogRecord::addWord(uint8_t tag, uint32_t word) {
+    if (length + 5 > MAX_SIZE) {
+        return;
+    }
+    bytes[length++] = tag;
+    for (int i = 0; i < 4; i++) {
+        bytes[length++] = (uint8_t)(word >> (8 * i));
+    }
+}
+
+const uint8_t* LogRecord::data() const {
+    return bytes;
+}
+
+size_t LogRecord::size() const {
+    return length;
+}
+
+static uint32_t readWord(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+size_t LogRecord::format(const uint8_t* record, size_t length, char* text, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    text[0] = '\0';
+    if (length < HEADER_SIZE) {
+        return 0;
+    }
+
+    uintptr_t address = 0;
+    for (size_t i = 0; i < sizeof(address); i++) {
+        address |= (uintptr_t)record[5 + i] << (8 * i);
+    }
+    uint8_t level = record[0] < sizeof(LEVEL_NAMES) - 1 ? record[0] : 0;
+    int position = snprintf(text, size, "[%c %lu] ", LEVEL_NAMES[level], (unsigned long)readWord(record + 1));
+    const char* cursor = (const char*)address;
+    size_t argument = HEADER_SIZE;
+
+    while (*cursor != '\0' && (size_t)position < size - 1) {
+        if (*cursor != '%') {
+            text[position++] = *cursor++;
+            continue;
+        }
+        if (cursor[1] == '%') {
+            text[position++] = '%';
+            cursor += 2;
+            continue;
+        }
+
+        // Keep flags, width and precision; the length modifier is replaced to match the stored type
+        char spec[16];
+        const char* start = cursor++;
+        while (*cursor != '\0' && strchr("-+ #0123456789.", *cursor) != nullptr && (size_t)(cursor - start) < sizeof(spec) - 4) {
+            cursor++;
+        }
+        size_t specLength = cursor - start;
+        memcpy(spec, start, specLength);
+        while (*cursor != '\0' && strchr("hlzjt", *cursor) != nullptr) {
+            cursor++;
+        }
+        char conversion = *cursor;
+        if (conversion == '\0') {
+            break;
+        }
+        cursor++;
+
+        size_t remaining = size - position;
+        int written = 0;
+        uint8_t tag = argument < length ? record[argument] : 0;
+        if ((tag == LOG_ARG_INT || tag == LOG_ARG_UINT) && argument + 5 <= length &&
+            strchr("diuxXoc", conversion) != nullptr) {
+            uint32_t word = readWord(record + argument + 1);
+            argument += 5;
+            if (conversion == 'c') {
+                spec[specLength++] = 'c';
+                spec[specLength] = '\0';
+                written = snprintf(text + position, remaining, spec, (int)word);
+            } else {
+                spec[specLength++] = 'l';
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                if (tag == LOG_ARG_INT && (conversion == 'd' || conversion == 'i')) {
+                    written = snprintf(text + position, remaining, spec, (long)(int32_t)word);
+                } else {
+                    written = snprintf(text + position, remaining, spec, (unsigned long)word);
+                }
+            }
+        } else if (tag == LOG_ARG_FLOAT && argument + 5 <= length && strchr("fFeEgG", conversion) != nullptr) {
+            uint32_t word = readWord(record + argument + 1);
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            argument += 5;
+            spec[specLength++] = conversion;
+            spec[specLength] = '\0';
+            written = snprintf(text + position, remaining, spec, (double)value);
+        } else if (tag == LOG_ARG_STRING && argument + 2 <= length && conversion == 's') {
+            size_t count = record[argument + 1];
+            if (argument + 2 + count > length) {
+                break;
+            }
+            char value[MAX_STRING + 1];
+            memcpy(value, record + argument + 2, count);
+            value[count] = '\0';
+            argument += 2 + count;
+            spec[specLength++] = 's';
+            spec[specLength] = '\0';
+            written = snprintf(text + position, remaining, spec, value);
+        } else {
+            // Missing or mismatched argument: mark it and stop consuming arguments
+            written = snprintf(text + position, remaining, "<?>");
+            argument = length;
+        }
+        if (written < 0) {
+            break;
+        }
+        position += (size_t)written < remaining ? written : remaining - 1;
+    }
+
+    if ((size_t)position >= size) {
+        position = size - 1;
+    }
+    text[position] = '\0';
+    return position;
+}
+
+bool Logger::begin(int core, int priority) {
+#ifdef ESP32
+    if (drainRunning) {
+        return true;
+    }
+    drainRunning = xTaskCreatePinnedToCore(drainTask, "log", 4096, nullptr, priority, nullptr, core) == pdPASS;
+    return drainRunning;
+#else
+    (void)core;
+    (void)priority;
+    if (!drainRunning) {
+        std::thread(drainTask, nullptr).detach();
+        drainRunning = true;
+    }
+    return true;
+#endif
+}
+
+void Logger::setTextOutput(bool enabled) {
+    textOutput = enabled;
+}
+
+void Logger::write(const LogRecord& record) {
+    uint32_t length = record.size();
+    uint32_t start = ringHead.load(std::memory_order_relaxed);
+    do {
+        if (LOG_BUFFER_SIZE - (start - ringTail.load(std::memory_order_acquire)) < length + 1) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!ringHead.compare_exchange_weak(start, start + length + 1, std::memory_order_relaxed));
+
+    const uint8_t* bytes = record.data();
+    for (uint32_t i = 0; i < length; i++) {
+        ringBuffer[(start + 1 + i) % LOG_BUFFER_SIZE].store(bytes[i], std::memory_order_relaxed);
+    }
+    ringBuffer[start % LOG_BUFFER_SIZE].store((uint8_t)length, std::memory_order_release);
+}
+
+void Logger::drain() {
+    if (draining.test_and_set(std::memory_order_acquire)) {
+        return; // Another caller is draining
+    }
+    uint8_t record[LogRecord::MAX_SIZE];
+    size_t length;
+    while (pop(record, length)) {
+        output(record, length);
+    }
+    unsigned long drops = getDroppedCount();
+    if (drops != reportedDrops) {
+        reportedDrops = drops;
+        LOG_WARN("Log ring full - %lu records dropped so far", drops);
+    }
+    draining.clear(std::memory_order_release);
+}
+
+unsigned long Logger::getDroppedCount() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+uint32_t Logger::timestamp() {
+    return millis();
+}
+
+bool Logger::pop(uint8_t* record, size_t& length) {
+    uint32_t tail = ringTail.load(std::memory_order_relaxed);
+    // Zero while the record at the tail is empty or still being written
+    length = ringBuffer[tail % LOG_BUFFER_SIZE].load(std::memory_order_acquire);
+    if (length == 0) {
+        return false;
+    }
+    ringBuffer[tail % LOG_BUFFER_SIZE].store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < length; i++) {
+        std::atomic<uint8_t>& slot = ringBuffer[(tail + 1 + i) % LOG_BUFFER_SIZE];
+        record[i] = slot.load(std::memory_order_relaxed);
+        slot.store(0, std::memory_order_relaxed);
+    }
+    ringTail.store(tail + 1 + length, std::memory_order_release);
+    return true;
+}
+
+void Logger::output(const uint8_t* record, size_t length) {
+    if (textOutput) {
+        char text[160];
+        LogRecord::format(record, length, text, sizeof(text));
+        Serial.println(text);
+        return;
+    }
+
+    // Frame: sync byte, length, record, XOR of the record bytes
+    uint8_t frame[LogRecord::MAX_SIZE + 3];
+    uint8_t checksum = 0;
+    frame[0] = FRAME_SYNC;
+    frame[1] = (uint8_t)length;
+    for (size_t i = 0; i < length; i++) {
+        frame[2 + i] = record[i];
+        checksum ^= record[i];
+    }
+    frame[2 + length] = checksum;
+    Serial.write(frame, length + 3);
+}
+
+void Logger::drainTask(void*) {
+    for (;;) {
+        drain();
+#ifdef ESP32
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_PERIOD));
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_PERIOD));
+#endif
+    }
+}
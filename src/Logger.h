@@ -0,0 +1,173 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO ///< Messages above this level are compiled out; override with a build flag.
+#endif
+
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 2048 ///< RAM ring holding records until the drain task writes them; a power of two.
+#endif
+
+/**
+ * @brief Type tag preceding each argument of a log record.
+ */
+enum LogArgType {
+    LOG_ARG_INT = 1,   ///< 4 bytes, signed.
+    LOG_ARG_UINT = 2,  ///< 4 bytes, unsigned.
+    LOG_ARG_FLOAT = 3, ///< 4 bytes, IEEE 754.
+    LOG_ARG_STRING = 4 ///< 1 length byte, then the characters.
+};
+
+/**
+ * @brief One log message in its binary form, built on the caller's stack.
+ *
+ * Layout, little-endian: level (1 byte), timestamp in milliseconds (4), address of the format
+ * string (4 on the ESP32), then each argument as a LogArgType tag and its value. The format string is never
+ * copied: its address identifies it, and the text is recovered from the firmware image by
+ * tools/log_decode.py, or on the device itself in text output mode. Arguments that do not fit
+ * are left out; strings are cut to MAX_STRING characters.
+ */
+class LogRecord {
+public:
+    static const size_t MAX_SIZE = 96;
+    static const size_t HEADER_SIZE = 5 + sizeof(const char*);
+    static const size_t MAX_STRING = 32;
+
+    LogRecord(uint8_t level, uint32_t timestamp, const char* format);
+
+    void add(bool value);
+    void add(char value);
+    void add(int value);
+    void add(unsigned int value);
+    void add(long value);
+    void add(unsigned long value);
+    void add(double value);
+    void add(const char* value);
+
+    const uint8_t* data() const;
+    size_t size() const;
+
+    /**
+     * @brief Renders a record as text, using the format string it points to.
+     * @param record Record bytes.
+     * @param length Record length.
+     * @param text Destination, always null-terminated.
+     * @param size Size of the destination.
+     * @return Number of characters written, without the terminator.
+     */
+    static size_t format(const uint8_t* record, size_t length, char* text, size_t size);
+
+private:
+    uint8_t bytes[MAX_SIZE];
+    size_t length;
+
+    void addWord(uint8_t tag, uint32_t word);
+};
+
+/**
+ * @brief Asynchronous logger: callers only pack a record into a RAM ring, a low-priority task
+ * writes it to the UART.
+ *
+ * Use the LOG_ERROR/LOG_WARN/LOG_INFO/LOG_DEBUG macros with a string literal and printf-style
+ * conversions (%d, %u, %lu, %x, %f, %s, %c). Levels above LOG_LEVEL expand to nothing, and their
+ * arguments are not evaluated. Any task may log: writers reserve ring space with an atomic
+ * compare-and-swap, never a lock, so logging never waits for the drain task or another writer.
+ * Records that do not fit in the ring are dropped and counted. By default the UART carries framed binary records (0xA5, length, record,
+ * XOR checksum) for tools/log_decode.py; setTextOutput() makes the drain task print text instead.
+ */
+class Logger {
+public:
+    static const uint8_t FRAME_SYNC = 0xA5;
+    static const unsigned long DRAIN_PERIOD = 10; ///< Milliseconds between drain passes.
+
+    /**
+     * @brief Starts the drain task, or a drain thread on the host.
+     * @param core Core to pin the task to.
+     * @param priority FreeRTOS priority, below every control and network task.
+     * @return True if the task is running.
+     */
+    static bool begin(int core, int priority);
+
+    /**
+     * @brief Selects text output instead of binary frames. Defaults to binary on the ESP32 and
+     * to text on the host.
+     */
+    static void setTextOutput(bool enabled);
+
+    /**
+     * @brief Packs a message and queues it. Called through the LOG_* macros.
+     */
+    template <typename... Args>
+    static void log(uint8_t level, const char* format, Args... args) {
+        LogRecord record(level, timestamp(), format);
+        pack(record, args...);
+        write(record);
+    }
+
+    /**
+     * @brief Queues a packed record. Never blocks; drops the record if the ring is full.
+     */
+    static void write(const LogRecord& record);
+
+    /**
+     * @brief Writes every queued record to the UART. Called by the drain task; returns at once if
+     * another caller is already draining.
+     */
+    static void drain();
+
+    /**
+     * @brief Gets the number of records dropped because the ring was full.
+     */
+    static unsigned long getDroppedCount();
+
+private:
+    static uint32_t timestamp();
+    static bool pop(uint8_t* record, size_t& length);
+    static void output(const uint8_t* record, size_t length);
+
+    static void pack(LogRecord&) {}
+
+    template <typename T, typename... Rest>
+    static void pack(LogRecord& record, T first, Rest... rest) {
+        record.add(first);
+        pack(record, rest...);
+    }
+
+    static void drainTask(void* parameter);
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::log(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::log(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif // LOGGER_H
@@ -0,0 +1,102 @@
+#include "LoopbackTransport.h"
+#include <string.h>
+
+const int LoopbackTransport::SLOT_COUNT;
+const size_t LoopbackTransport::MAX_TOPIC;
+const size_t LoopbackTransport::MAX_PAYLOAD;
+
+LoopbackTransport::LoopbackTransport() : head(0), count(0), lent(false), handler(nullptr), stats() {}
+
+int LoopbackTransport::pending() const {
+    return count;
+}
+
+LoopbackTransport::Stats LoopbackTransport::getStats() const {
+    return stats;
+}
+
+void LoopbackTransport::resetStats() {
+    stats = Stats();
+}
+
+uint8_t* LoopbackTransport::acquire(size_t& capacity) {
+    if (lent || count == SLOT_COUNT) {
+        return nullptr;
+    }
+    lent = true;
+    capacity = MAX_PAYLOAD;
+    return slots[(head + count) % SLOT_COUNT].payload;
+}
+
+bool LoopbackTransport::commit(const char* topic, size_t length) {
+    if (!lent) {
+        return false;
+    }
+    lent = false;
+    // The payload is already in the slot; only the topic is copied
+    return reserve(topic, length) != nullptr;
+}
+
+void LoopbackTransport::release() {
+    lent = false;
+}
+
+bool LoopbackTransport::publish(const char* topic, const uint8_t* payload, size_t length) {
+    if (lent) {
+        return false;
+    }
+    Slot* slot = reserve(topic, length);
+    if (slot == nullptr) {
+        return false;
+    }
+    memcpy(slot->payload, payload, length);
+    return true;
+}
+
+bool LoopbackTransport::subscribe(const char* topic) {
+    if (router.route(topic) != TopicRouter::NO_ROUTE) {
+        return true;
+    }
+    return router.add(topic, 0);
+}
+
+void LoopbackTransport::setHandler(MessageHandler* handler) {
+    this->handler = handler;
+}
+
+bool LoopbackTransport::isConnected() {
+    return true;
+}
+
+void LoopbackTransport::loop() {
+    // Messages the handler publishes in reply wait for the next call
+    int ready = count;
+    for (int i = 0; i < ready; i++) {
+        Slot& slot = slots[head];
+        if (handler != nullptr && router.route(slot.topic) != TopicRouter::NO_ROUTE) {
+            handler->onMessage(slot.topic, slot.payload, slot.length);
+            stats.delivered++;
+            stats.bytesDelivered += slot.length;
+        } else {
+            stats.dropped++;
+        }
+        // Freed only after the call, so a reply cannot be written over the message being read
+        head = (head + 1) % SLOT_COUNT;
+        count--;
+    }
+}
+
+LoopbackTransport::Slot* LoopbackTransport::reserve(const char* topic, size_t length) {
+    size_t topicLength = strlen(topic);
+    if (count == SLOT_COUNT || length > MAX_PAYLOAD || topicLength > MAX_TOPIC) {
+        stats.dropped++;
+        return nullptr;
+    }
+    Slot& slot = slots[(head + count) % SLOT_COUNT];
+    memcpy(slot.topic, topic, topicLength + 1);
+    slot.length = length;
+    count++;
+    stats.committed++;
+    stats.bytesCommitted += length;
+    return &slot;
+}
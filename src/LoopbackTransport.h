@@ -0,0 +1,71 @@
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#include "MessageTransport.h"
+#include "TopicRouter.h"
+
+/**
+ * @brief MessageTransport that queues messages in memory and delivers them back to its own
+ * handler.
+ *
+ * Messages wait in a fixed ring of slots until loop() hands those on a subscribed topic to the
+ * handler, in place, and drops the rest. acquire() lends the payload of the next free slot, so
+ * a committed message is never copied; publish() copies into one. Nothing is allocated and
+ * no socket is involved, which makes it the sink for measuring the encode and publish path on
+ * its own. Single-threaded: every call must come from the same task.
+ */
+class LoopbackTransport : public MessageTransport {
+public:
+    static const int SLOT_COUNT = 8;
+    static const size_t MAX_TOPIC = 64;    ///< Longest topic, without the terminator.
+    static const size_t MAX_PAYLOAD = 1024;
+
+    /**
+     * @brief Counters since construction or the last resetStats().
+     */
+    struct Stats {
+        uint32_t committed;      ///< Messages accepted by commit() or publish().
+        uint32_t delivered;      ///< Messages handed to the handler.
+        uint32_t dropped;        ///< Messages refused (queue full, too long) or not subscribed.
+        uint64_t bytesCommitted;
+        uint64_t bytesDelivered;
+    };
+
+    LoopbackTransport();
+
+    /**
+     * @brief Gets the number of messages waiting for loop().
+     */
+    int pending() const;
+
+    Stats getStats() const;
+    void resetStats();
+
+    uint8_t* acquire(size_t& capacity) override;
+    bool commit(const char* topic, size_t length) override;
+    void release() override;
+    bool publish(const char* topic, const uint8_t* payload, size_t length) override;
+    bool subscribe(const char* topic) override;
+    void setHandler(MessageHandler* handler) override;
+    bool isConnected() override;
+    void loop() override;
+
+private:
+    struct Slot {
+        char topic[MAX_TOPIC + 1];
+        size_t length;
+        uint8_t payload[MAX_PAYLOAD];
+    };
+
+    Slot slots[SLOT_COUNT];
+    int head;
+    int count;
+    bool lent;
+    TopicRouter router;
+    MessageHandler* handler;
+    Stats stats;
+
+    Slot* reserve(const char* topic, size_t length);
+};
+
+#endif // LOOPBACK_TRANSPORT_H
@@ -0,0 +1,95 @@
+#include "MappedFileJournalStorage.h"
+
+#ifndef ARDUINO
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFileJournalStorage::MappedFileJournalStorage(const char* path, size_t size, size_t sectorSize)
+    : path(path), totalSize(size - size % sectorSize), sectorBytes(sectorSize), fd(-1), data(nullptr),
+      eraseCounts(nullptr) {}
+
+MappedFileJournalStorage::~MappedFileJournalStorage() {
+    if (data != nullptr) {
+        munmap(data, totalSize);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    delete[] eraseCounts;
+}
+
+void MappedFileJournalStorage::setPath(const char* newPath) {
+    path = newPath;
+}
+
+bool MappedFileJournalStorage::begin() {
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    bool fresh = fstat(fd, &info) == 0 && (size_t)info.st_size < totalSize;
+    if (ftruncate(fd, totalSize) != 0) {
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<uint8_t*>(mapping);
+    if (fresh) {
+        memset(data, 0xFF, totalSize);
+    }
+
+    eraseCounts = new uint32_t[totalSize / sectorBytes]();
+    return true;
+}
+
+size_t MappedFileJournalStorage::size() const {
+    return totalSize;
+}
+
+size_t MappedFileJournalStorage::sectorSize() const {
+    return sectorBytes;
+}
+
+bool MappedFileJournalStorage::read(size_t offset, void* buffer, size_t length) {
+    if (data == nullptr || offset + length > totalSize) {
+        return false;
+    }
+    memcpy(buffer, data + offset, length);
+    return true;
+}
+
+bool MappedFileJournalStorage::write(size_t offset, const void* buffer, size_t length) {
+    if (data == nullptr || offset + length > totalSize) {
+        return false;
+    }
+    // NOR flash programming can only clear bits
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    for (size_t i = 0; i < length; i++) {
+        data[offset + i] &= bytes[i];
+    }
+    return true;
+}
+
+bool MappedFileJournalStorage::eraseSector(size_t sector) {
+    if (data == nullptr || (sector + 1) * sectorBytes > totalSize) {
+        return false;
+    }
+    memset(data + sector * sectorBytes, 0xFF, sectorBytes);
+    eraseCounts[sector]++;
+    return true;
+}
+
+uint32_t MappedFileJournalStorage::getEraseCount(size_t sector) const {
+    return (eraseCounts != nullptr && sector < totalSize / sectorBytes) ? eraseCounts[sector] : 0;
+}
+
+#endif // ARDUINO
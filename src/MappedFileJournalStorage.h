@@ -0,0 +1,55 @@
+#ifndef MAPPED_FILE_JOURNAL_STORAGE_H
+#define MAPPED_FILE_JOURNAL_STORAGE_H
+
+#include "JournalStorage.h"
+
+#ifndef ARDUINO
+
+/**
+ * @brief Host JournalStorage over a memory-mapped file, emulating NOR flash.
+ *
+ * Writes only clear bits and erases restore whole sectors to 0xFF, as on the board, so
+ * journal throughput, crash recovery (by reopening the file) and the wear pattern (through
+ * the per-sector erase counters) can be examined on Linux.
+ */
+class MappedFileJournalStorage : public JournalStorage {
+private:
+    const char* path;
+    size_t totalSize;
+    size_t sectorBytes;
+    int fd;
+    uint8_t* data;
+    uint32_t* eraseCounts;
+
+public:
+    /**
+     * @brief Constructs a MappedFileJournalStorage.
+     * @param path File backing the storage; created and filled with 0xFF if missing.
+     * @param size Size in bytes, a multiple of `sectorSize`.
+     * @param sectorSize Erase unit in bytes (default: 4096, as on the ESP32).
+     */
+    MappedFileJournalStorage(const char* path, size_t size, size_t sectorSize = 4096);
+    ~MappedFileJournalStorage() override;
+
+    /**
+     * @brief Changes the file backing the storage. Only takes effect before begin().
+     */
+    void setPath(const char* path);
+
+    bool begin() override;
+    size_t size() const override;
+    size_t sectorSize() const override;
+    bool read(size_t offset, void* buffer, size_t length) override;
+    bool write(size_t offset, const void* buffer, size_t length) override;
+    bool eraseSector(size_t sector) override;
+
+    /**
+     * @brief Gets how many times a sector was erased since begin().
+     * @param sector Sector index.
+     */
+    uint32_t getEraseCount(size_t sector) const;
+};
+
+#endif // ARDUINO
+
+#endif // MAPPED_FILE_JOURNAL_STORAGE_H
@@ -0,0 +1,75 @@
+#ifndef MESSAGE_TRANSPORT_H
+#define MESSAGE_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Receives the messages of the topics a MessageTransport is subscribed to.
+ */
+class MessageHandler {
+public:
+    /**
+     * @brief Called for each received message.
+     * @param topic NUL-terminated topic.
+     * @param payload Payload, read in place; valid during the call only.
+     * @param length Payload length in bytes.
+     */
+    virtual void onMessage(char* topic, uint8_t* payload, size_t length) = 0;
+
+    virtual ~MessageHandler() = default; ///< Virtual destructor for safe inheritance.
+};
+
+/**
+ * @brief Abstract publish/subscribe transport for the device's messages.
+ *
+ * Two ways to publish. publish() takes a payload an encoder already holds and lends it for the
+ * duration of the call. acquire() and commit() hand a buffer over without copying: acquire()
+ * lends a buffer owned by the transport, the caller writes the message straight into it, and
+ * commit() sends those bytes; release() gives the buffer back unused. One buffer is lent at a
+ * time, and none may be lent across a call to publish() or loop().
+ *
+ * Implemented over PubSubClient, over HTTP POST requests and as an in-memory loopback queue.
+ */
+class MessageTransport {
+public:
+    /**
+     * @brief Lends the transport's send buffer.
+     * @param capacity Receives the size of the buffer.
+     * @return The buffer, or nullptr if none is available now.
+     */
+    virtual uint8_t* acquire(size_t& capacity) = 0;
+
+    /**
+     * @brief Sends the message written into the acquired buffer and takes the buffer back.
+     * @param topic Topic of the message.
+     * @param length Bytes written.
+     * @return True if the message was accepted.
+     */
+    virtual bool commit(const char* topic, size_t length) = 0;
+
+    virtual void release() = 0; ///< Takes the acquired buffer back without sending it.
+
+    /**
+     * @brief Sends a message from a buffer the caller owns.
+     * @param topic Topic of the message.
+     * @param payload Payload, only read during the call.
+     * @param length Payload length in bytes.
+     * @return True if the message was accepted.
+     */
+    virtual bool publish(const char* topic, const uint8_t* payload, size_t length) = 0;
+
+    /**
+     * @brief Subscribes to a topic. The topic must outlive the subscription.
+     * @return False if the transport cannot subscribe now, or at all.
+     */
+    virtual bool subscribe(const char* topic) = 0;
+
+    virtual void setHandler(MessageHandler* handler) = 0; ///< Sets who receives messages.
+    virtual bool isConnected() = 0; ///< Checks whether messages can be sent now.
+    virtual void loop() = 0;        ///< Delivers received messages to the handler.
+
+    virtual ~MessageTransport() = default; ///< Virtual destructor for safe inheritance.
+};
+
+#endif // MESSAGE_TRANSPORT_H
@@ -3,14 +3,50 @@
 
 #include "EventHandler.h"
 #include "CommandHandler.h"
+#include "SubscriberList.h"
 #include "Sensor.h"
 #include "Actuator.h"
 #include "Device.h"
+#include "StaticGraph.h"
 #include "DhtSensor.h"
+#include "DhtFrameDecoder.h"
 #include "PirSensor.h"
+#include "MotionDebouncer.h"
 #include "Mq2Sensor.h"
+#include "GasLevelFilter.h"
 #include "Led.h"
 #include "ServoActuator.h"
+#include "MotionProfile.h"
+#include "Scheduler.h"
+#include "SpscRing.h"
+#include "SeqlockSnapshot.h"
+#include "PipelineRecords.h"
+#include "ConnectionTransport.h"
+#include "ConnectionManager.h"
+#include "WiFiMqttTransport.h"
+#include "TelemetryEncoder.h"
+#include "TelemetrySchema.h"
+#include "BinaryTelemetryEncoder.h"
+#include "TelemetryDecoder.h"
+#include "ChangeDetector.h"
+#include "RuleEngine.h"
+#include "RuleConfig.h"
+#include "CborWriter.h"
+#include "ColumnarBatchEncoder.h"
+#include "MessageTransport.h"
+#include "MqttMessageTransport.h"
+#include "HttpMessageTransport.h"
+#include "LoopbackTransport.h"
+#include "HttpUploader.h"
+#include "CommandParser.h"
+#include "TopicRouter.h"
+#include "AlertAggregator.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "JournalStorage.h"
+#include "PartitionJournalStorage.h"
+#include "MappedFileJournalStorage.h"
+#include "TelemetryJournal.h"
 #include "SmartSuiteDevice.h"
 //#include "Button.h"
 
@@ -0,0 +1,45 @@
+#include "MotionDebouncer.h"
+
+MotionDebouncer::MotionDebouncer(uint32_t debounceTime, uint32_t retriggerWindow)
+    : debounceTime(debounceTime), retriggerWindow(retriggerWindow), level(false), levelSince(0),
+      state(false) {}
+
+void MotionDebouncer::configure(uint32_t debounceTime, uint32_t retriggerWindow) {
+    this->debounceTime = debounceTime;
+    this->retriggerWindow = retriggerWindow;
+}
+
+void MotionDebouncer::reset(bool level, uint32_t now) {
+    this->level = level;
+    levelSince = now;
+    state = level;
+}
+
+bool MotionDebouncer::push(const EdgeRecord& edge, MotionTransition& transition) {
+    // Settle the level that was in effect up to this edge before replacing it
+    bool settled = poll(edge.time, transition);
+    bool newLevel = edge.level != 0;
+    if (newLevel != level) {
+        level = newLevel;
+        levelSince = edge.time;
+    }
+    return settled;
+}
+
+bool MotionDebouncer::poll(uint32_t now, MotionTransition& transition) {
+    if (level == state) {
+        return false;
+    }
+    uint32_t required = level ? debounceTime : (retriggerWindow > debounceTime ? retriggerWindow : debounceTime);
+    if (now - levelSince < required) {
+        return false;
+    }
+    state = level;
+    transition.motion = state;
+    transition.edgeTime = levelSince;
+    return true;
+}
+
+bool MotionDebouncer::getState() const {
+    return state;
+}
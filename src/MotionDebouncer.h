@@ -0,0 +1,81 @@
+#ifndef MOTION_DEBOUNCER_H
+#define MOTION_DEBOUNCER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Timestamped level change of a digital input, as captured by an ISR.
+ */
+struct EdgeRecord {
+    uint32_t time; ///< Time of the edge in microseconds.
+    uint8_t level; ///< Line level after the edge.
+};
+
+/**
+ * @brief Motion state change produced by the MotionDebouncer.
+ */
+struct MotionTransition {
+    bool motion;       ///< New motion state.
+    uint32_t edgeTime; ///< Time of the edge that started it, in microseconds.
+};
+
+/**
+ * @brief Turns a stream of raw PIR edges into debounced motion transitions.
+ *
+ * A level must hold for the debounce time to count, which filters electrical glitches. The
+ * end of motion is only reported once the line stayed low for the retrigger window, so a PIR
+ * that drops and retriggers within the window reports one continuous motion instead of a
+ * stopped/detected pair. Pure logic over timestamps, without hardware access, so edge streams
+ * can be replayed on the host. Times are microseconds and may wrap around.
+ */
+class MotionDebouncer {
+public:
+    /**
+     * @brief Constructs a MotionDebouncer.
+     * @param debounceTime Time a level must hold to count, in microseconds (default: 10 ms).
+     * @param retriggerWindow Time the line must stay low before motion ends, in microseconds
+     *        (default: 2 s).
+     */
+    explicit MotionDebouncer(uint32_t debounceTime = 10000, uint32_t retriggerWindow = 2000000);
+
+    /**
+     * @brief Sets the filtering times.
+     * @param debounceTime Time a level must hold to count, in microseconds.
+     * @param retriggerWindow Time the line must stay low before motion ends, in microseconds.
+     */
+    void configure(uint32_t debounceTime, uint32_t retriggerWindow);
+
+    /**
+     * @brief Restarts from a known line level, reported as the current state.
+     * @param level Current line level.
+     * @param now Current time in microseconds.
+     */
+    void reset(bool level, uint32_t now);
+
+    /**
+     * @brief Feeds an edge. Edges must be fed in time order.
+     * @param edge The edge.
+     * @param transition Receives the transition completed by the edge, if any.
+     * @return True if the level in effect before the edge became a transition.
+     */
+    bool push(const EdgeRecord& edge, MotionTransition& transition);
+
+    /**
+     * @brief Checks whether the current level has held long enough to be reported.
+     * @param now Current time in microseconds.
+     * @param transition Receives the transition, if any.
+     * @return True if a transition was produced.
+     */
+    bool poll(uint32_t now, MotionTransition& transition);
+
+    bool getState() const; ///< Reported motion state.
+
+private:
+    uint32_t debounceTime;
+    uint32_t retriggerWindow;
+    bool level;       ///< Raw line level after the last edge.
+    uint32_t levelSince;
+    bool state;
+};
+
+#endif // MOTION_DEBOUNCER_H
@@ -0,0 +1,76 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+MotionProfile::MotionProfile(float maxVelocity, float acceleration)
+    : maxVelocity(maxVelocity), acceleration(acceleration), position(0), velocity(0), target(0), moving(false) {}
+
+void MotionProfile::configure(float maxVelocity, float acceleration) {
+    this->maxVelocity = maxVelocity;
+    this->acceleration = acceleration;
+}
+
+void MotionProfile::reset(float position) {
+    this->position = position;
+    target = position;
+    velocity = 0;
+    moving = false;
+}
+
+void MotionProfile::setTarget(float target) {
+    this->target = target;
+    moving = target != position || velocity != 0;
+}
+
+bool MotionProfile::advance(float elapsed) {
+    if (!moving || elapsed <= 0) {
+        return false;
+    }
+
+    // Fastest velocity from which the target can still be reached by braking in whole steps of
+    // `elapsed` (the discrete form of sqrt(2 a d)), capped by the limit
+    float distance = target - position;
+    float stepChange = acceleration * elapsed;
+    float brakingSpeed = stepChange * (sqrtf(0.25f + 2.0f * fabsf(distance) / (stepChange * elapsed)) - 0.5f);
+    float desired = brakingSpeed < maxVelocity ? brakingSpeed : maxVelocity;
+    if (distance < 0) {
+        desired = -desired;
+    }
+
+    // Approach it within the acceleration limit
+    float maxChange = stepChange;
+    if (desired > velocity + maxChange) {
+        velocity += maxChange;
+    } else if (desired < velocity - maxChange) {
+        velocity -= maxChange;
+    } else {
+        velocity = desired;
+    }
+    position += velocity * elapsed;
+
+    // Arrive when the step reaches or passes the target while slow enough to stop within it
+    float remaining = target - position;
+    bool crossed = (distance > 0 && remaining <= 0) || (distance < 0 && remaining >= 0) || distance == 0;
+    if (crossed && fabsf(velocity) <= maxChange) {
+        position = target;
+        velocity = 0;
+        moving = false;
+        return true;
+    }
+    return false;
+}
+
+float MotionProfile::getPosition() const {
+    return position;
+}
+
+float MotionProfile::getVelocity() const {
+    return velocity;
+}
+
+float MotionProfile::getTarget() const {
+    return target;
+}
+
+bool MotionProfile::isMoving() const {
+    return moving;
+}
@@ -0,0 +1,66 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Trapezoidal motion profile generator for one axis.
+ *
+ * Moves a position towards a target with bounded velocity and acceleration: it accelerates,
+ * cruises at the velocity limit, and decelerates so that it stops on the target. The target
+ * may change at any time, mid-move included; the profile continues from the current position
+ * and velocity, so only the latest target matters. Pure arithmetic advanced by elapsed time,
+ * without hardware access or clocks.
+ */
+class MotionProfile {
+public:
+    /**
+     * @brief Constructs a MotionProfile at rest at position 0.
+     * @param maxVelocity Velocity limit in units per second.
+     * @param acceleration Acceleration and deceleration limit in units per second squared.
+     */
+    MotionProfile(float maxVelocity = 180.0f, float acceleration = 360.0f);
+
+    /**
+     * @brief Sets the limits. Takes effect on the next advance().
+     * @param maxVelocity Velocity limit in units per second, greater than 0.
+     * @param acceleration Acceleration limit in units per second squared, greater than 0.
+     */
+    void configure(float maxVelocity, float acceleration);
+
+    /**
+     * @brief Stops at a position, with the target set to it.
+     */
+    void reset(float position);
+
+    /**
+     * @brief Sets the position to move to, replacing any previous target.
+     */
+    void setTarget(float target);
+
+    /**
+     * @brief Advances the profile.
+     * @param elapsed Time since the previous advance in seconds.
+     * @return True if the target was reached during this step.
+     */
+    bool advance(float elapsed);
+
+    float getPosition() const;
+    float getVelocity() const;
+    float getTarget() const;
+
+    /**
+     * @brief Checks whether the position has not reached the target yet.
+     */
+    bool isMoving() const;
+
+private:
+    float maxVelocity;
+    float acceleration;
+    float position;
+    float velocity;
+    float target;
+    bool moving;
+};
+
+#endif // MOTION_PROFILE_H
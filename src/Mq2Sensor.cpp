@@ -6,33 +6,66 @@ const Event Mq2Sensor::GAS_MEDIUM_EVENT = Event(GAS_MEDIUM_EVENT_ID);
 const Event Mq2Sensor::GAS_HIGH_EVENT = Event(GAS_HIGH_EVENT_ID);
 const Event Mq2Sensor::GAS_CLEAR_EVENT = Event(GAS_CLEAR_EVENT_ID);
 
-Mq2Sensor::Mq2Sensor(int pin, float mediumThreshold, float highThreshold, EventHandler* eventHandler)
-    : Sensor(pin, eventHandler), lastPpmValue(0.0), mediumThreshold(mediumThreshold), highThreshold(highThreshold) {}
+Mq2Sensor::Mq2Sensor(int pin, float mediumThreshold, float highThreshold, float hysteresis,
+                     EventHandler* eventHandler)
+    : Sensor(pin, eventHandler), lastPpmValue(0.0), mediumThreshold(mediumThreshold), highThreshold(highThreshold),
+      oversampling(8),
+      classifier(ppmToCounts(mediumThreshold), ppmToCounts(highThreshold), ppmToCounts(hysteresis)) {}
 
 void Mq2Sensor::begin() {
     // Analog pins don't need pinMode setup
+    filter.reset();
+    classifier.reset();
 }
 
 float Mq2Sensor::readGasLevel() {
-    int analogValue = analogRead(pin);
-    float ppm = (analogValue / 4095.0) * 1000.0; // Convert to estimated PPM
-    
-    // Store the last reading
-    float previousPpm = lastPpmValue;
+    Event event(0);
+    if (acquire(event)) {
+        on(event);
+    }
+    return lastPpmValue;
+}
+
+bool Mq2Sensor::acquire(Event& event) {
+    // Oversample, then filter in ADC counts; PPM is only derived for reporting
+    uint16_t block[MAX_OVERSAMPLING];
+    for (int i = 0; i < oversampling; i++) {
+        block[i] = analogRead(pin);
+    }
+    uint16_t counts = filter.pushBlock(block, oversampling);
+    float ppm = counts * ((float)PPM_FULL_SCALE / ADC_MAX);
     lastPpmValue = ppm;
     
-    // Generate events based on thresholds
-    if (ppm >= highThreshold && previousPpm < highThreshold) {
-        on(GAS_HIGH_EVENT);
-    } else if (ppm >= mediumThreshold && previousPpm < mediumThreshold) {
-        on(GAS_MEDIUM_EVENT);
-    } else if (ppm > 0 && previousPpm == 0) {
-        on(GAS_DETECTED_EVENT);
-    } else if (ppm < mediumThreshold && previousPpm >= mediumThreshold) {
-        on(GAS_CLEAR_EVENT);
+    GasLevel previousLevel = classifier.getLevel();
+    if (!classifier.update(counts)) {
+        return false;
     }
     
-    return ppm;
+    // Generate events based on threshold crossings
+    uint32_t now = millis();
+    switch (classifier.getLevel()) {
+        case GAS_LEVEL_HIGH:
+            event = GAS_HIGH_EVENT.withPayload(ppm, pin, now);
+            return true;
+        case GAS_LEVEL_MEDIUM:
+            if (previousLevel == GAS_LEVEL_HIGH) {
+                return false; // Still above medium, nothing new to report
+            }
+            event = GAS_MEDIUM_EVENT.withPayload(ppm, pin, now);
+            return true;
+        case GAS_LEVEL_PRESENT:
+        case GAS_LEVEL_NONE:
+            if (previousLevel >= GAS_LEVEL_MEDIUM) {
+                event = GAS_CLEAR_EVENT.withPayload(ppm, pin, now);
+                return true;
+            }
+            if (previousLevel == GAS_LEVEL_NONE) {
+                event = GAS_DETECTED_EVENT.withPayload(ppm, pin, now);
+                return true;
+            }
+            return false;
+    }
+    return false;
 }
 
 float Mq2Sensor::getGasLevel() const {
@@ -42,4 +75,30 @@ float Mq2Sensor::getGasLevel() const {
 void Mq2Sensor::setThresholds(float medium, float high) {
     mediumThreshold = medium;
     highThreshold = high;
+    classifier.setThresholds(ppmToCounts(medium), ppmToCounts(high));
+}
+
+void Mq2Sensor::setHysteresis(float hysteresis) {
+    classifier.setBand(ppmToCounts(hysteresis));
+}
+
+void Mq2Sensor::setOversampling(uint8_t samples) {
+    if (samples < 1) {
+        samples = 1;
+    } else if (samples > MAX_OVERSAMPLING) {
+        samples = MAX_OVERSAMPLING;
+    }
+    oversampling = samples;
+}
+
+void Mq2Sensor::setFilter(uint8_t emaShift) {
+    filter.setEmaShift(emaShift);
+}
+
+uint16_t Mq2Sensor::ppmToCounts(float ppm) {
+    if (ppm <= 0) {
+        return 0;
+    }
+    float counts = ppm * ADC_MAX / PPM_FULL_SCALE + 0.5f;
+    return counts > 65535.0f ? 65535 : (uint16_t)counts;
 }
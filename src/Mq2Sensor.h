@@ -2,13 +2,24 @@
 #define MQ2_SENSOR_H
 
 #include "Sensor.h"
+#include "GasLevelFilter.h"
 
 class Mq2Sensor : public Sensor {
 private:
+    static const int ADC_MAX = 4095;          ///< Full scale of the 12-bit ADC.
+    static const int PPM_FULL_SCALE = 1000;   ///< Estimated PPM at ADC full scale.
+
     float lastPpmValue;
     float mediumThreshold;
     float highThreshold;
 
+    // Oversampled, filtered acquisition
+    uint8_t oversampling;
+    GasLevelFilter filter;
+    GasLevelClassifier classifier;
+
+    static uint16_t ppmToCounts(float ppm);
+
 public:
     static const int GAS_DETECTED_EVENT_ID = 300;
     static const int GAS_MEDIUM_EVENT_ID = 301;
@@ -19,14 +30,18 @@ public:
     static const Event GAS_HIGH_EVENT;
     static const Event GAS_CLEAR_EVENT;
 
+    static const int MAX_OVERSAMPLING = 32; ///< Conversions averaged per acquisition, at most.
+
     /**
      * @brief Constructs an Mq2Sensor.
      * @param pin The analog GPIO pin for the MQ2 sensor.
      * @param mediumThreshold PPM threshold for medium gas level (default: 300).
      * @param highThreshold PPM threshold for high gas level (default: 600).
+     * @param hysteresis PPM the level must fall below a threshold to leave it (default: 30).
      * @param eventHandler Optional handler to receive sensor events (default: nullptr).
      */
-    Mq2Sensor(int pin, float mediumThreshold = 300.0, float highThreshold = 600.0, EventHandler* eventHandler = nullptr);
+    Mq2Sensor(int pin, float mediumThreshold = 300.0, float highThreshold = 600.0, float hysteresis = 30.0,
+              EventHandler* eventHandler = nullptr);
 
     /**
      * @brief Initializes the MQ2 sensor.
@@ -35,10 +50,38 @@ public:
 
     /**
      * @brief Reads the gas level from the sensor.
-     * @return Gas level in estimated PPM.
+     *
+     * Each call averages a block of conversions and feeds it through the median/EMA filter;
+     * threshold events are emitted from the filtered level. Meant to be called at a steady,
+     * short period (tens of milliseconds) so that the filter sees a continuous signal.
+     * @return Filtered gas level in estimated PPM.
      */
     float readGasLevel();
 
+    /**
+     * @brief Reads the gas level and delivers any event straight to `sink`.
+     *
+     * Compile-time counterpart of readGasLevel(): the call to `sink.on()` is resolved
+     * statically (and inlined when `Sink` is final), bypassing the handler set at construction.
+     * @param sink Object with an `on(Event)` method.
+     * @return Gas level in estimated PPM.
+     */
+    template<typename Sink>
+    float readGasLevel(Sink& sink) {
+        Event event(0);
+        if (acquire(event)) {
+            sink.on(event);
+        }
+        return lastPpmValue;
+    }
+
+    /**
+     * @brief Reads and filters the gas level without emitting anything.
+     * @param event Receives the threshold event, if the reading crossed a threshold.
+     * @return True if an event was produced.
+     */
+    bool acquire(Event& event);
+
     /**
      * @brief Gets the last gas level reading.
      * @return Gas level in PPM.
@@ -51,6 +94,24 @@ public:
      * @param high High threshold in PPM.
      */
     void setThresholds(float medium, float high);
+
+    /**
+     * @brief Sets the hysteresis band applied below each threshold.
+     * @param hysteresis Band in PPM.
+     */
+    void setHysteresis(float hysteresis);
+
+    /**
+     * @brief Sets the number of conversions averaged per acquisition.
+     * @param samples Conversions per acquisition, from 1 to MAX_OVERSAMPLING (default: 8).
+     */
+    void setOversampling(uint8_t samples);
+
+    /**
+     * @brief Sets the smoothing of the EMA stage.
+     * @param emaShift Weight of each acquisition as a power of two: 0 disables smoothing (default: 3).
+     */
+    void setFilter(uint8_t emaShift);
 };
 
 #endif // MQ2_SENSOR_H
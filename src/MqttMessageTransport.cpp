@@ -0,0 +1,54 @@
+#include "MqttMessageTransport.h"
+
+MqttMessageTransport::MqttMessageTransport(PubSubClient& mqttClient, uint8_t* buffer, size_t size,
+                                           ConnectionTransport* link)
+    : mqttClient(mqttClient), buffer(buffer), bufferSize(size), lent(false), handler(nullptr), link(link) {
+    // Bound to this transport, so any number of devices can share a process
+    mqttClient.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        if (this->handler != nullptr) {
+            this->handler->onMessage(topic, payload, length);
+        }
+    });
+}
+
+uint8_t* MqttMessageTransport::acquire(size_t& capacity) {
+    if (lent) {
+        return nullptr;
+    }
+    lent = true;
+    capacity = bufferSize;
+    return buffer;
+}
+
+bool MqttMessageTransport::commit(const char* topic, size_t length) {
+    lent = false;
+    if (length > bufferSize || !mqttClient.beginPublish(topic, length, false)) {
+        return false;
+    }
+    size_t written = mqttClient.write(buffer, length);
+    return mqttClient.endPublish() == 1 && written == length;
+}
+
+void MqttMessageTransport::release() {
+    lent = false;
+}
+
+bool MqttMessageTransport::publish(const char* topic, const uint8_t* payload, size_t length) {
+    return mqttClient.publish(topic, payload, length);
+}
+
+bool MqttMessageTransport::subscribe(const char* topic) {
+    return mqttClient.subscribe(topic);
+}
+
+void MqttMessageTransport::setHandler(MessageHandler* handler) {
+    this->handler = handler;
+}
+
+bool MqttMessageTransport::isConnected() {
+    return link != nullptr ? link->isMqttConnected() : mqttClient.connected();
+}
+
+void MqttMessageTransport::loop() {
+    // Serviced by the ConnectionManager through WiFiMqttTransport::loopMqtt()
+}
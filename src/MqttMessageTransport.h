@@ -0,0 +1,46 @@
+#ifndef MQTT_MESSAGE_TRANSPORT_H
+#define MQTT_MESSAGE_TRANSPORT_H
+
+#include "MessageTransport.h"
+#include "ConnectionTransport.h"
+#include <PubSubClient.h>
+
+/**
+ * @brief MessageTransport over a PubSubClient.
+ *
+ * publish() goes through the client's own packet buffer and its size limit. A committed
+ * buffer is streamed to the socket with beginPublish(), without passing through the packet
+ * buffer, so it may be larger. The session itself is driven by the ConnectionManager, which
+ * also services it; loop() does nothing. Given the link the ConnectionManager drives,
+ * isConnected() asks it rather than the client, which may be busy connecting on another task.
+ */
+class MqttMessageTransport : public MessageTransport {
+private:
+    PubSubClient& mqttClient;
+    uint8_t* buffer;
+    size_t bufferSize;
+    bool lent;
+    MessageHandler* handler;
+    ConnectionTransport* link;
+
+public:
+    /**
+     * @brief Constructs an MqttMessageTransport.
+     * @param mqttClient Client to publish and subscribe with.
+     * @param buffer Buffer lent by acquire().
+     * @param size Size of the buffer in bytes.
+     * @param link Link layer connecting the client (default: nullptr, ask the client).
+     */
+    MqttMessageTransport(PubSubClient& mqttClient, uint8_t* buffer, size_t size, ConnectionTransport* link = nullptr);
+
+    uint8_t* acquire(size_t& capacity) override;
+    bool commit(const char* topic, size_t length) override;
+    void release() override;
+    bool publish(const char* topic, const uint8_t* payload, size_t length) override;
+    bool subscribe(const char* topic) override;
+    void setHandler(MessageHandler* handler) override;
+    bool isConnected() override;
+    void loop() override;
+};
+
+#endif // MQTT_MESSAGE_TRANSPORT_H
@@ -0,0 +1,34 @@
+#include "PartitionJournalStorage.h"
+
+#ifdef ESP32
+
+PartitionJournalStorage::PartitionJournalStorage(const char* label)
+    : label(label), partition(nullptr) {}
+
+bool PartitionJournalStorage::begin() {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    return partition != nullptr;
+}
+
+size_t PartitionJournalStorage::size() const {
+    return partition != nullptr ? partition->size - (partition->size % SECTOR_SIZE) : 0;
+}
+
+size_t PartitionJournalStorage::sectorSize() const {
+    return SECTOR_SIZE;
+}
+
+bool PartitionJournalStorage::read(size_t offset, void* data, size_t length) {
+    return partition != nullptr && esp_partition_read(partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionJournalStorage::write(size_t offset, const void* data, size_t length) {
+    return partition != nullptr && esp_partition_write(partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionJournalStorage::eraseSector(size_t sector) {
+    return partition != nullptr &&
+           esp_partition_erase_range(partition, sector * SECTOR_SIZE, SECTOR_SIZE) == ESP_OK;
+}
+
+#endif // ESP32
@@ -0,0 +1,36 @@
+#ifndef PARTITION_JOURNAL_STORAGE_H
+#define PARTITION_JOURNAL_STORAGE_H
+
+#include "JournalStorage.h"
+
+#ifdef ESP32
+#include <esp_partition.h>
+
+/**
+ * @brief JournalStorage over a raw ESP32 flash data partition (see partitions.csv).
+ */
+class PartitionJournalStorage : public JournalStorage {
+private:
+    const char* label;
+    const esp_partition_t* partition;
+
+public:
+    static const size_t SECTOR_SIZE = 4096; ///< ESP32 flash erase unit.
+
+    /**
+     * @brief Constructs a PartitionJournalStorage.
+     * @param label Name of the data partition in the partition table (default: "journal").
+     */
+    explicit PartitionJournalStorage(const char* label = "journal");
+
+    bool begin() override;
+    size_t size() const override;
+    size_t sectorSize() const override;
+    bool read(size_t offset, void* data, size_t length) override;
+    bool write(size_t offset, const void* data, size_t length) override;
+    bool eraseSector(size_t sector) override;
+};
+
+#endif // ESP32
+
+#endif // PARTITION_JOURNAL_STORAGE_H
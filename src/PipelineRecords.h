@@ -0,0 +1,45 @@
+#ifndef PIPELINE_RECORDS_H
+#define PIPELINE_RECORDS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Snapshot of every sensor and actuator value at one instant.
+ *
+ * Produced by the acquisition side and handed to the network side, which encodes and
+ * publishes it. Temperature and humidity are NaN while the DHT has no valid reading.
+ */
+struct SensorSample {
+    uint32_t sequence;    ///< Monotonic sample number.
+    uint32_t timestamp;   ///< Acquisition time in milliseconds.
+    float temperature;    ///< Temperature in Celsius.
+    float humidity;       ///< Relative humidity in percent.
+    float smokeLevel;     ///< Estimated gas level in PPM.
+    int16_t servoPosition;  ///< Servo 1 position in degrees.
+    int16_t servo2Position; ///< Servo 2 position in degrees.
+    bool motionDetected;  ///< PIR state.
+};
+
+/**
+ * @brief Alert raised by the control logic, queued for publication.
+ */
+struct AlertRecord {
+    static const int TYPE_SIZE = 16;
+    static const int SEVERITY_SIZE = 8;
+    static const int MESSAGE_SIZE = 80;
+
+    char type[TYPE_SIZE];         ///< Alert category, e.g. "smoke".
+    char severity[SEVERITY_SIZE]; ///< Alert severity, e.g. "high".
+    char message[MESSAGE_SIZE];   ///< Human readable description.
+    uint32_t timestamp;           ///< Time the alert was raised in milliseconds.
+};
+
+/**
+ * @brief Servo position request received from the network, queued for the control side.
+ */
+struct ServoCommandRecord {
+    uint8_t servo;    ///< Servo number (1 or 2).
+    int16_t position; ///< Target position in degrees.
+};
+
+#endif // PIPELINE_RECORDS_H
@@ -5,29 +5,102 @@ const Event PirSensor::MOTION_DETECTED_EVENT = Event(MOTION_DETECTED_EVENT_ID);
 const Event PirSensor::MOTION_STOPPED_EVENT = Event(MOTION_STOPPED_EVENT_ID);
 
 PirSensor::PirSensor(int pin, EventHandler* eventHandler)
-    : Sensor(pin, eventHandler), lastMotionState(false) {}
+    : Sensor(pin, eventHandler), lastMotionState(false), interruptMode(false), latencyStats() {}
 
 void PirSensor::begin() {
     pinMode(pin, INPUT);
+    if (interruptMode) {
+        debouncer.reset(digitalRead(pin), micros());
+        lastMotionState = debouncer.getState();
+        attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+    }
+}
+
+void PirSensor::setInterruptMode(bool enabled) {
+    interruptMode = enabled;
+}
+
+void PirSensor::setDebounce(unsigned long debounceMs, unsigned long retriggerMs) {
+    debouncer.configure(debounceMs * 1000UL, retriggerMs * 1000UL);
 }
 
 bool PirSensor::readMotion() {
+    Event event(0);
+    while (acquire(event)) {
+        on(event);
+    }
+    return lastMotionState;
+}
+
+bool PirSensor::acquire(Event& event) {
+    if (interruptMode) {
+        return acquireFromEdges(event);
+    }
+
     bool currentMotion = digitalRead(pin);
     
     // Only trigger events on state change
-    if (currentMotion != lastMotionState) {
-        lastMotionState = currentMotion;
-        
-        if (currentMotion) {
-            on(MOTION_DETECTED_EVENT);
-        } else {
-            on(MOTION_STOPPED_EVENT);
-        }
+    if (currentMotion == lastMotionState) {
+        return false;
     }
+    lastMotionState = currentMotion;
     
-    return currentMotion;
+    if (currentMotion) {
+        event = MOTION_DETECTED_EVENT.withPayload(1, pin, millis());
+    } else {
+        event = MOTION_STOPPED_EVENT.withPayload(0, pin, millis());
+    }
+    return true;
+}
+
+bool PirSensor::acquireFromEdges(Event& event) {
+    // Feed edges until one settles a transition; the rest stay queued for the next call
+    MotionTransition transition;
+    bool settled = false;
+    EdgeRecord edge;
+    while (!settled && edges.pop(edge)) {
+        settled = debouncer.push(edge, transition);
+    }
+    if (!settled) {
+        settled = debouncer.poll(micros(), transition);
+    }
+    if (!settled) {
+        return false;
+    }
+    lastMotionState = transition.motion;
+
+    unsigned long latency = micros() - transition.edgeTime;
+    latencyStats.events++;
+    latencyStats.lastLatency = latency;
+    latencyStats.totalLatency += latency;
+    if (latency > latencyStats.maxLatency) {
+        latencyStats.maxLatency = latency;
+    }
+
+    // Stamp the event with the time of the edge, not the time it was drained
+    unsigned long edgeMillis = millis() - latency / 1000UL;
+    if (transition.motion) {
+        event = MOTION_DETECTED_EVENT.withPayload(1, pin, edgeMillis);
+    } else {
+        event = MOTION_STOPPED_EVENT.withPayload(0, pin, edgeMillis);
+    }
+    return true;
+}
+
+void IRAM_ATTR PirSensor::onEdge(void* arg) {
+    PirSensor* sensor = static_cast<PirSensor*>(arg);
+    EdgeRecord edge;
+    edge.time = micros();
+    edge.level = digitalRead(sensor->pin);
+    sensor->edges.push(edge);
 }
 
 bool PirSensor::getMotionState() const {
     return lastMotionState;
 }
+
+MotionLatencyStats PirSensor::getLatencyStats() const {
+    MotionLatencyStats stats = latencyStats;
+    stats.droppedEdges = edges.getDroppedCount();
+    return stats;
+}
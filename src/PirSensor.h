@@ -2,11 +2,35 @@
 #define PIR_SENSOR_H
 
 #include "Sensor.h"
+#include "SpscRing.h"
+#include "MotionDebouncer.h"
+
+/**
+ * @brief Edge-to-event latency statistics of the interrupt-driven PIR capture.
+ */
+struct MotionLatencyStats {
+    unsigned long events;       ///< Motion events emitted.
+    unsigned long lastLatency;  ///< Microseconds from the edge to the last event, including the hold time.
+    unsigned long maxLatency;   ///< Longest edge-to-event time in microseconds.
+    unsigned long totalLatency; ///< Sum of edge-to-event times, used to compute the mean.
+    uint32_t droppedEdges;      ///< Edges lost because the ring was full.
+};
 
 class PirSensor : public Sensor {
 private:
+    static const size_t EDGE_RING_CAPACITY = 32;
+
     bool lastMotionState;
 
+    // Interrupt-driven capture
+    bool interruptMode;
+    SpscRing<EdgeRecord, EDGE_RING_CAPACITY> edges;
+    MotionDebouncer debouncer;
+    MotionLatencyStats latencyStats;
+
+    static void onEdge(void* arg);
+    bool acquireFromEdges(Event& event);
+
 public:
     static const int MOTION_DETECTED_EVENT_ID = 200;
     static const int MOTION_STOPPED_EVENT_ID = 201;
@@ -21,21 +45,69 @@ public:
     PirSensor(int pin, EventHandler* eventHandler = nullptr);
 
     /**
-     * @brief Initializes the PIR sensor.
+     * @brief Initializes the PIR sensor. In interrupt mode also attaches the edge ISR.
      */
     void begin();
 
+    /**
+     * @brief Selects interrupt-driven capture. Must be called before begin().
+     *
+     * Instead of sampling the pin when polled, an ISR timestamps every edge into a lock-free
+     * ring and the poll drains it through a MotionDebouncer. Short pulses between polls are no
+     * longer missed and events carry the time of the edge rather than the time of the poll.
+     * @param enabled True to capture edges by interrupt, false to sample the pin (default).
+     */
+    void setInterruptMode(bool enabled);
+
+    /**
+     * @brief Sets the debounce time and retrigger window used in interrupt mode.
+     * @param debounceMs Time a level must hold to count, in milliseconds.
+     * @param retriggerMs Time without motion before MOTION_STOPPED_EVENT is emitted, in milliseconds.
+     */
+    void setDebounce(unsigned long debounceMs, unsigned long retriggerMs);
+
     /**
      * @brief Reads the current motion state from the sensor.
      * @return True if motion is detected, false otherwise.
      */
     bool readMotion();
 
+    /**
+     * @brief Reads the motion state and delivers any event straight to `sink`.
+     *
+     * Compile-time counterpart of readMotion(): the call to `sink.on()` is resolved statically
+     * (and inlined when `Sink` is final), bypassing the handler set at construction.
+     * @param sink Object with an `on(Event)` method.
+     * @return True if motion is detected, false otherwise.
+     */
+    template<typename Sink>
+    bool readMotion(Sink& sink) {
+        Event event(0);
+        while (acquire(event)) {
+            sink.on(event);
+        }
+        return lastMotionState;
+    }
+
+    /**
+     * @brief Reads the motion state without emitting anything.
+     *
+     * In interrupt mode several transitions may be pending; each call returns the next one.
+     * @param event Receives MOTION_DETECTED_EVENT or MOTION_STOPPED_EVENT on a change.
+     * @return True if the state changed.
+     */
+    bool acquire(Event& event);
+
     /**
      * @brief Gets the last motion state.
      * @return True if motion was last detected, false otherwise.
      */
     bool getMotionState() const;
+
+    /**
+     * @brief Gets the edge-to-event latency statistics of interrupt mode.
+     */
+    MotionLatencyStats getLatencyStats() const;
 };
 
 #endif // PIR_SENSOR_H
@@ -0,0 +1,217 @@
+#include "Profiler.h"
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#ifdef ESP32
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+const int SpanStats::BUCKET_COUNT;
+
+static const char* spanNames[Profiler::MAX_SPANS];
+static std::atomic<int> spanCount(0);
+static std::mutex registerLock;
+static std::atomic<uint32_t> ticksPerMicrosecond(0);
+static thread_local Profiler* selected = nullptr;
+
+uint32_t SpanStats::percentile(int percent) const {
+    if (count == 0) {
+        return 0;
+    }
+    // Rank of the run at the percentile, rounded up, 1-based
+    unsigned long rank = (count * (unsigned long)percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    unsigned long seen = 0;
+    for (int i = 0; i < BUCKET_COUNT - 1; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = (uint32_t)1 << i;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+int Profiler::registerSpan(const char* name) {
+    std::lock_guard<std::mutex> guard(registerLock);
+    if (ticksPerMicrosecond.load(std::memory_order_relaxed) == 0) {
+#ifdef ESP32
+        ticksPerMicrosecond.store(ESP.getCpuFreqMHz(), std::memory_order_relaxed);
+#else
+        ticksPerMicrosecond.store(1000, std::memory_order_relaxed);
+#endif
+    }
+    int count = spanCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(spanNames[i], name) == 0) {
+            return i;
+        }
+    }
+    if (count >= MAX_SPANS) {
+        return -1;
+    }
+    // Counters of unregistered spans are never touched, so they are still zero in every profiler
+    spanNames[count] = name;
+    spanCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+uint32_t Profiler::now() {
+#ifdef ESP32
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+Profiler* Profiler::current() {
+    return selected;
+}
+
+Profiler* Profiler::select(Profiler* profiler) {
+    Profiler* previous = selected;
+    selected = profiler;
+    return previous;
+}
+
+Profiler::Profiler() {
+    // Atomics are left uninitialized by their default constructor
+    clear(MAX_SPANS);
+}
+
+void Profiler::record(int span, uint32_t start) {
+    uint32_t elapsed = now() - start;
+    if (span < 0) {
+        return;
+    }
+    uint32_t micros = elapsed / ticksPerMicrosecond.load(std::memory_order_relaxed);
+
+    // Tasks of the other core write to their own table; the atomics cover preemption on this
+    // core, a task moving between cores, and the threads sharing one table on the host
+#ifdef ESP32
+    SpanCounters& counters = tables[xPortGetCoreID()][span];
+#else
+    SpanCounters& counters = tables[0][span];
+#endif
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    uint32_t low = counters.totalLow.fetch_add(micros, std::memory_order_relaxed);
+    if (low + micros < low) {
+        counters.totalHigh.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint32_t max = counters.max.load(std::memory_order_relaxed);
+    while (micros > max && !counters.max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+    counters.buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+}
+
+int Profiler::getSpanCount() {
+    return spanCount.load(std::memory_order_acquire);
+}
+
+bool Profiler::getStats(int span, SpanStats& stats) const {
+    if (span < 0 || span >= getSpanCount()) {
+        return false;
+    }
+    memset(&stats, 0, sizeof(stats));
+    stats.name = spanNames[span];
+    for (int table = 0; table < TABLE_COUNT; table++) {
+        const SpanCounters& counters = tables[table][span];
+        stats.count += counters.count.load(std::memory_order_relaxed);
+        stats.total += ((uint64_t)counters.totalHigh.load(std::memory_order_relaxed) << 32)
+            + counters.totalLow.load(std::memory_order_relaxed);
+        uint32_t max = counters.max.load(std::memory_order_relaxed);
+        if (max > stats.max) {
+            stats.max = max;
+        }
+        for (int bucket = 0; bucket < SpanStats::BUCKET_COUNT; bucket++) {
+            stats.buckets[bucket] += counters.buckets[bucket].load(std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+void Profiler::reset() {
+    clear(getSpanCount());
+}
+
+void Profiler::clear(int spans) {
+    for (int table = 0; table < TABLE_COUNT; table++) {
+        for (int span = 0; span < spans; span++) {
+            SpanCounters& counters = tables[table][span];
+            counters.count.store(0, std::memory_order_relaxed);
+            counters.totalLow.store(0, std::memory_order_relaxed);
+            counters.totalHigh.store(0, std::memory_order_relaxed);
+            counters.max.store(0, std::memory_order_relaxed);
+            for (int bucket = 0; bucket < SpanStats::BUCKET_COUNT; bucket++) {
+                counters.buckets[bucket].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+size_t Profiler::encode(char* buffer, size_t size, unsigned long window) const {
+    size_t position = 0;
+    int written = snprintf(buffer, size, "{\"window\":%lu,\"spans\":[", window);
+    if (written < 0 || (size_t)written >= size) {
+        return 0;
+    }
+    position = written;
+
+    bool first = true;
+    int count = getSpanCount();
+    for (int i = 0; i < count; i++) {
+        SpanStats stats;
+        if (!getStats(i, stats) || stats.count == 0) {
+            continue;
+        }
+        written = snprintf(buffer + position, size - position,
+                           "%s{\"name\":\"%s\",\"count\":%lu,\"mean\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu,\"hist\":[",
+                           first ? "" : ",", stats.name, stats.count, (unsigned long)(stats.total / stats.count),
+                           (unsigned long)stats.percentile(50), (unsigned long)stats.percentile(99),
+                           (unsigned long)stats.max);
+        if (written < 0 || (size_t)written >= size - position) {
+            return 0;
+        }
+        position += written;
+        first = false;
+
+        int used = SpanStats::BUCKET_COUNT;
+        while (used > 0 && stats.buckets[used - 1] == 0) {
+            used--;
+        }
+        for (int bucket = 0; bucket < used; bucket++) {
+            written = snprintf(buffer + position, size - position, bucket == 0 ? "%lu" : ",%lu",
+                               (unsigned long)stats.buckets[bucket]);
+            if (written < 0 || (size_t)written >= size - position) {
+                return 0;
+            }
+            position += written;
+        }
+        written = snprintf(buffer + position, size - position, "]}");
+        if (written < 0 || (size_t)written >= size - position) {
+            return 0;
+        }
+        position += written;
+    }
+
+    written = snprintf(buffer + position, size - position, "]}");
+    if (written < 0 || (size_t)written >= size - position) {
+        return 0;
+    }
+    return position + written;
+}
+
+int Profiler::bucketOf(uint32_t micros) {
+    int bucket = 0;
+    while (micros > 0 && bucket < SpanStats::BUCKET_COUNT - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
@@ -0,0 +1,211 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED 1 ///< Set to 0 with a build flag to compile every PROFILE_SPAN out.
+#endif
+
+/**
+ * @brief Latency statistics of one span, in microseconds.
+ *
+ * Bucket 0 counts runs under 1 us; bucket i, for i > 0, runs from 2^(i-1) up to 2^i us. The last
+ * bucket also takes everything longer.
+ */
+struct SpanStats {
+    static const int BUCKET_COUNT = 24; ///< The last bucket starts at about 4.2 s.
+
+    const char* name;
+    unsigned long count;
+    uint64_t total;
+    uint32_t max;
+    uint32_t buckets[BUCKET_COUNT];
+
+    /**
+     * @brief Estimates a percentile as the upper bound of the bucket it falls in.
+     * @param percent Percentile, 0 to 100.
+     * @return Microseconds, 0 if the span never ran.
+     */
+    uint32_t percentile(int percent) const;
+};
+
+/**
+ * @brief Counters of one span in one core's table, updated with relaxed atomics.
+ */
+struct SpanCounters {
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> totalLow;  ///< Low word of the total, in microseconds.
+    std::atomic<uint32_t> totalHigh; ///< Carries of totalLow; 64-bit atomics take a lock on the ESP32.
+    std::atomic<uint32_t> max;
+    std::atomic<uint32_t> buckets[SpanStats::BUCKET_COUNT];
+};
+
+/**
+ * @brief Fixed-memory latency histograms of named code spans.
+ *
+ * Spans are timed with the CPU cycle counter on the ESP32 and std::chrono elsewhere, and
+ * recorded into log2-bucketed histograms, so a span costs two clock reads and a few relaxed
+ * atomic updates whatever its duration. Each core records into its own table, so the two cores
+ * never contend for a counter and nothing takes a lock; readers merge the tables. Mark a scope
+ * with PROFILE_SPAN("name"); the span is registered the first time the scope runs, which is the
+ * only step taking a lock. With PROFILING_ENABLED set to 0 the macro expands to nothing.
+ *
+ * Span names are registered once for the whole program, but the histograms belong to a
+ * Profiler instance, so that several devices in one process keep separate statistics. A span
+ * records into the profiler its thread has selected with select() or a ProfilerSelection, and
+ * is not recorded at all while none is selected.
+ */
+class Profiler {
+public:
+    static const int MAX_SPANS = 16;
+#ifdef ESP32
+    static const int TABLE_COUNT = 2; ///< One span table per core.
+#else
+    static const int TABLE_COUNT = 1;
+#endif
+
+    /**
+     * @brief Registers a span, or finds it if the name is already registered.
+     * @param name Span name. Must outlive the profiler, normally a string literal.
+     * @return Span index, or -1 if MAX_SPANS spans exist already.
+     */
+    static int registerSpan(const char* name);
+
+    /**
+     * @brief Reads the span clock.
+     *
+     * The clock wraps, so a single run is measured correctly up to about 17 s on the ESP32 at
+     * 240 MHz and 4 s elsewhere.
+     * @return Cycles on the ESP32, nanoseconds elsewhere.
+     */
+    static uint32_t now();
+
+    /**
+     * @brief Gets the number of registered spans.
+     */
+    static int getSpanCount();
+
+    /**
+     * @brief Maps a duration to its histogram bucket.
+     */
+    static int bucketOf(uint32_t micros);
+
+    /**
+     * @brief Gets the profiler the calling thread records into, or nullptr.
+     */
+    static Profiler* current();
+
+    /**
+     * @brief Selects the profiler the calling thread records into.
+     * @param profiler The profiler, or nullptr to stop recording.
+     * @return The profiler selected before.
+     */
+    static Profiler* select(Profiler* profiler);
+
+    /**
+     * @brief Constructs a Profiler with empty histograms.
+     */
+    Profiler();
+
+    /**
+     * @brief Adds a run to a span.
+     * @param span Span index; negative values are ignored.
+     * @param start Value of now() when the run started.
+     */
+    void record(int span, uint32_t start);
+
+    /**
+     * @brief Copies the statistics of a span, merged over the tables of every core.
+     *
+     * Runs recorded while the copy is made may be partly included.
+     * @param span Span index.
+     * @param stats Receives the statistics.
+     * @return False if the index is out of range.
+     */
+    bool getStats(int span, SpanStats& stats) const;
+
+    /**
+     * @brief Clears every histogram, starting a new measurement window. Spans stay registered.
+     *
+     * Runs recorded during the reset may land in either window, or partly in both.
+     */
+    void reset();
+
+    /**
+     * @brief Writes the statistics of every span that ran as JSON.
+     *
+     * `{"window":ms,"spans":[{"name":..,"count":..,"mean":..,"p50":..,"p99":..,"max":..,"hist":[..]}]}`,
+     * times in microseconds, with trailing empty buckets left out of `hist`.
+     * @param buffer Destination.
+     * @param size Size of the destination.
+     * @param window Length of the measurement window in milliseconds.
+     * @return Length written, or 0 if the buffer is too small.
+     */
+    size_t encode(char* buffer, size_t size, unsigned long window) const;
+
+private:
+    SpanCounters tables[TABLE_COUNT][MAX_SPANS];
+
+    void clear(int spans);
+
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+};
+
+/**
+ * @brief Selects a profiler for the calling thread until the end of the scope.
+ *
+ * PROFILE_SELECT(profiler) declares one, and compiles out with PROFILING_ENABLED set to 0.
+ */
+class ProfilerSelection {
+public:
+    explicit ProfilerSelection(Profiler& profiler) : previous(Profiler::select(&profiler)) {}
+    ~ProfilerSelection() { Profiler::select(previous); }
+
+private:
+    Profiler* previous;
+
+    ProfilerSelection(const ProfilerSelection&);
+    ProfilerSelection& operator=(const ProfilerSelection&);
+};
+
+/**
+ * @brief Records the lifetime of a scope into a span of the thread's profiler.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(int span)
+        : profiler(Profiler::current()), span(span), start(profiler != nullptr ? Profiler::now() : 0) {}
+    ~ProfileScope() {
+        if (profiler != nullptr) {
+            profiler->record(span, start);
+        }
+    }
+
+private:
+    Profiler* profiler;
+    int span;
+    uint32_t start;
+
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILING_ENABLED
+#define PROFILE_SPAN(name) \
+    static const int PROFILE_CONCAT(profileSpan, __LINE__) = Profiler::registerSpan(name); \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileSpan, __LINE__))
+#define PROFILE_SELECT(profiler) \
+    ProfilerSelection PROFILE_CONCAT(profilerSelection, __LINE__)(profiler)
+#else
+#define PROFILE_SPAN(name) do {} while (0)
+#define PROFILE_SELECT(profiler) do {} while (0)
+#endif
+
+#endif // PROFILER_H
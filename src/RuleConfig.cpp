@@ -0,0 +1,159 @@
+#include "RuleConfig.h"
+#include <string.h>
+
+const char* const RuleConfig::LED_NAMES[] = {"red", "green", "orange", "blue", "alert"};
+
+static const char* const FIELD_NAMES[] = {"temperature", "humidity", "smokeLevel", "motionDetected"};
+static const char* const OPERATOR_NAMES[] = {"<", ">"};
+
+// Same behaviour as the original hard-coded control logic
+const char RuleConfig::DEFAULT_RULES[] =
+    "{\"rules\":["
+    "{\"group\":1,\"any\":true,\"when\":[[\"temperature\",\"<\",18],[\"humidity\",\"<\",40]],"
+    "\"then\":[{\"led\":\"red\",\"on\":true}],\"else\":[{\"led\":\"red\",\"on\":false}]},"
+    "{\"group\":1,\"any\":true,\"when\":[[\"temperature\",\">\",28],[\"humidity\",\">\",70]],"
+    "\"then\":[{\"led\":\"orange\",\"on\":true}],\"else\":[{\"led\":\"orange\",\"on\":false}]},"
+    "{\"group\":1,\"then\":[{\"led\":\"green\",\"on\":true}],\"else\":[{\"led\":\"green\",\"on\":false}]},"
+    "{\"when\":[[\"temperature\",\">\",32]],\"hysteresis\":0.5,"
+    "\"then\":[{\"servo\":1,\"angle\":90}],\"else\":[{\"servo\":1,\"angle\":0}],"
+    "\"alert\":{\"type\":\"temperature\",\"severity\":\"high\",\"message\":\"High temperature detected\"}},"
+    "{\"when\":[[\"smokeLevel\",\">\",300]],\"hysteresis\":30,\"hold\":5000,"
+    "\"then\":[{\"led\":\"alert\",\"on\":true},{\"servo\":2,\"angle\":90}],"
+    "\"else\":[{\"led\":\"alert\",\"on\":false},{\"servo\":2,\"angle\":0}],"
+    "\"alert\":{\"type\":\"smoke\",\"severity\":\"medium\",\"message\":\"Smoke level detected\"}},"
+    "{\"when\":[[\"smokeLevel\",\">\",600]],\"hysteresis\":30,"
+    "\"alert\":{\"type\":\"smoke\",\"severity\":\"high\",\"message\":\"Smoke level detected\"}}"
+    "]}";
+
+int RuleConfig::load(const char* json, size_t length, RuleEngine& engine) {
+    if (length > MAX_JSON_SIZE) {
+        return -1;
+    }
+    DynamicJsonDocument doc(DOCUMENT_CAPACITY);
+    if (deserializeJson(doc, json, length)) {
+        return -1;
+    }
+    JsonArrayConst rules = doc["rules"];
+    if (rules.isNull() || rules.size() > (size_t)RuleEngine::MAX_RULES) {
+        return -1;
+    }
+
+    // Validate everything before touching the running table
+    Rule rule;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (!parseRule(rules[i], rule)) {
+            return -1;
+        }
+    }
+    engine.clear();
+    for (size_t i = 0; i < rules.size(); i++) {
+        parseRule(rules[i], rule);
+        engine.addRule(rule);
+    }
+    return engine.getRuleCount();
+}
+
+bool RuleConfig::parseRule(JsonObjectConst object, Rule& rule) {
+    if (object.isNull()) {
+        return false;
+    }
+    memset(&rule, 0, sizeof(rule));
+    rule.group = object["group"].as<uint8_t>();
+    rule.matchAny = object["any"].as<bool>();
+    rule.hysteresis = object["hysteresis"].as<float>();
+    rule.holdTime = object["hold"].as<uint32_t>();
+
+    JsonArrayConst when = object["when"];
+    if (when.size() > (size_t)Rule::MAX_TERMS) {
+        return false;
+    }
+    for (size_t i = 0; i < when.size(); i++) {
+        JsonArrayConst term = when[i];
+        int field = lookup(term[0].as<const char*>(), FIELD_NAMES, RULE_FIELD_COUNT);
+        int op = lookup(term[1].as<const char*>(), OPERATOR_NAMES, 2);
+        if (field < 0 || op < 0 || !term[2].is<float>()) {
+            return false;
+        }
+        rule.terms[i].field = field;
+        rule.terms[i].op = op;
+        rule.terms[i].threshold = term[2].as<float>();
+    }
+    rule.termCount = when.size();
+
+    int count = parseActions(object["then"], rule.activeActions);
+    if (count < 0) {
+        return false;
+    }
+    rule.activeActionCount = count;
+    count = parseActions(object["else"], rule.inactiveActions);
+    if (count < 0) {
+        return false;
+    }
+    rule.inactiveActionCount = count;
+
+    JsonObjectConst alert = object["alert"];
+    if (!alert.isNull()) {
+        rule.hasAlert = true;
+        copyText(rule.alert.type, sizeof(rule.alert.type), alert["type"].as<const char*>());
+        copyText(rule.alert.severity, sizeof(rule.alert.severity), alert["severity"].as<const char*>());
+        copyText(rule.alert.message, sizeof(rule.alert.message), alert["message"].as<const char*>());
+    }
+    return RuleEngine::isValid(rule);
+}
+
+int RuleConfig::parseActions(JsonArrayConst array, RuleAction* actions) {
+    if (array.size() > (size_t)Rule::MAX_ACTIONS) {
+        return -1;
+    }
+    for (size_t i = 0; i < array.size(); i++) {
+        if (!parseAction(array[i], actions[i])) {
+            return -1;
+        }
+    }
+    return array.size();
+}
+
+bool RuleConfig::parseAction(JsonObjectConst object, RuleAction& action) {
+    if (object.containsKey("led")) {
+        int led = lookup(object["led"].as<const char*>(), LED_NAMES, LED_COUNT);
+        if (led < 0) {
+            return false;
+        }
+        action.type = RULE_ACTION_LED;
+        action.target = led;
+        action.value = object["on"].as<bool>() ? 1 : 0;
+        return true;
+    }
+    if (object.containsKey("servo")) {
+        int servo = object["servo"].as<int>();
+        int angle = object["angle"].as<int>();
+        if (servo < 1 || servo > 2 || angle < 0 || angle > 180) {
+            return false;
+        }
+        action.type = RULE_ACTION_SERVO;
+        action.target = servo;
+        action.value = angle;
+        return true;
+    }
+    return false;
+}
+
+int RuleConfig::lookup(const char* name, const char* const* names, int count) {
+    if (name == nullptr) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void RuleConfig::copyText(char* destination, size_t size, const char* source) {
+    if (source == nullptr) {
+        source = "";
+    }
+    strncpy(destination, source, size - 1);
+    destination[size - 1] = '\0';
+}
@@ -0,0 +1,50 @@
+#ifndef RULE_CONFIG_H
+#define RULE_CONFIG_H
+
+#include <stddef.h>
+#include <ArduinoJson.h>
+#include "RuleEngine.h"
+
+/**
+ * @brief Loads RuleEngine tables from JSON.
+ *
+ * The format is `{"rules":[...]}`, one object per rule:
+ *
+ *     {"group":1, "any":true, "hysteresis":0.5, "hold":5000,
+ *      "when":[["temperature","<",18],["humidity","<",40]],
+ *      "then":[{"led":"red","on":true},{"servo":1,"angle":90}],
+ *      "else":[{"led":"red","on":false}],
+ *      "alert":{"type":"temperature","severity":"high","message":"Cold room"}}
+ *
+ * Fields use the telemetry names (temperature, humidity, smokeLevel, motionDetected), operators
+ * are "<" and ">", and LEDs are named red, green, orange, blue and alert. Only "when"
+ * comparisons, or none for an always-matching rule, and the actions are needed.
+ */
+class RuleConfig {
+public:
+    static const size_t MAX_JSON_SIZE = 2048;       ///< Largest accepted document, in bytes.
+    static const size_t DOCUMENT_CAPACITY = 8192;   ///< ArduinoJson pool for a MAX_JSON_SIZE document.
+    static const char* const LED_NAMES[];           ///< Indexed by RuleAction::target.
+    static const int LED_COUNT = 5;
+    static const char DEFAULT_RULES[];              ///< Compiled-in rules, used until others are loaded.
+
+    /**
+     * @brief Replaces the rules of `engine` with those described by a JSON document.
+     *
+     * The whole document is validated first; on any error the engine is left untouched.
+     * @param json The document.
+     * @param length Length of the document in bytes.
+     * @param engine Engine receiving the rules.
+     * @return Number of rules loaded, or -1 if the document was rejected.
+     */
+    static int load(const char* json, size_t length, RuleEngine& engine);
+
+private:
+    static bool parseRule(JsonObjectConst object, Rule& rule);
+    static int parseActions(JsonArrayConst array, RuleAction* actions);
+    static bool parseAction(JsonObjectConst object, RuleAction& action);
+    static int lookup(const char* name, const char* const* names, int count);
+    static void copyText(char* destination, size_t size, const char* source);
+};
+
+#endif // RULE_CONFIG_H
@@ -0,0 +1,230 @@
+#include "RuleEngine.h"
+#include <math.h>
+
+RuleEngine::RuleEngine()
+    : ruleCount(0), validMask(0), dirtyMask(0), fullPass(false), pendingCount(0), pass(0), checkCount(0) {
+    for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+        readerCount[i] = 0;
+        values[i] = 0;
+    }
+}
+
+void RuleEngine::clear() {
+    ruleCount = 0;
+    pendingCount = 0;
+    for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+        readerCount[i] = 0;
+    }
+    fullPass = true;
+}
+
+bool RuleEngine::addRule(const Rule& rule) {
+    if (ruleCount >= MAX_RULES || !isValid(rule)) {
+        return false;
+    }
+    int index = ruleCount++;
+    rules[index] = rule;
+    RuleState& state = states[index];
+    state.matched = false;
+    state.active = -1;
+    state.pending = false;
+    state.holding = false;
+    state.changedAt = 0;
+    state.checkedPass = pass;
+
+    // Index the rule under each field it reads, once
+    uint8_t readMask = 0;
+    for (int i = 0; i < rule.termCount; i++) {
+        uint8_t bit = 1 << rule.terms[i].field;
+        if (!(readMask & bit)) {
+            readMask |= bit;
+            readers[rule.terms[i].field][readerCount[rule.terms[i].field]++] = index;
+        }
+    }
+    fullPass = true;
+    return true;
+}
+
+bool RuleEngine::isValid(const Rule& rule) {
+    if (rule.termCount > Rule::MAX_TERMS || rule.activeActionCount > Rule::MAX_ACTIONS ||
+        rule.inactiveActionCount > Rule::MAX_ACTIONS || rule.group > Rule::MAX_GROUP || !(rule.hysteresis >= 0)) {
+        return false;
+    }
+    for (int i = 0; i < rule.termCount; i++) {
+        if (rule.terms[i].field >= RULE_FIELD_COUNT || rule.terms[i].op > RULE_GREATER || isnan(rule.terms[i].threshold)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < rule.activeActionCount; i++) {
+        if (rule.activeActions[i].type > RULE_ACTION_SERVO) {
+            return false;
+        }
+    }
+    for (int i = 0; i < rule.inactiveActionCount; i++) {
+        if (rule.inactiveActions[i].type > RULE_ACTION_SERVO) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RuleEngine::setField(RuleField field, float value) {
+    uint8_t bit = 1 << field;
+    if (isnan(value)) {
+        validMask &= ~bit;
+        return;
+    }
+    if (!(validMask & bit) || value != values[field]) {
+        values[field] = value;
+        validMask |= bit;
+        dirtyMask |= bit;
+    }
+}
+
+int RuleEngine::evaluate(uint32_t now, RuleActionHandler& handler) {
+    pass++;
+    uint32_t dirtyGroups = 0;
+    int changes = 0;
+
+    // Everything after a table change; otherwise only rules still inside their hold time...
+    if (fullPass || pendingCount > 0) {
+        bool all = fullPass;
+        fullPass = false;
+        for (int index = 0; index < ruleCount; index++) {
+            if (all || states[index].pending) {
+                changes += visit(index, now, dirtyGroups, handler);
+            }
+        }
+    }
+
+    // ...and the readers of the fields that changed
+    for (int field = 0; dirtyMask != 0 && field < RULE_FIELD_COUNT; field++) {
+        if (dirtyMask & (1 << field)) {
+            for (int i = 0; i < readerCount[field]; i++) {
+                changes += visit(readers[field][i], now, dirtyGroups, handler);
+            }
+        }
+    }
+    dirtyMask = 0;
+
+    for (int group = 1; dirtyGroups != 0 && group <= Rule::MAX_GROUP; group++) {
+        if (dirtyGroups & (1UL << group)) {
+            changes += resolve(group, handler);
+        }
+    }
+    return changes;
+}
+
+int RuleEngine::getRuleCount() const {
+    return ruleCount;
+}
+
+const Rule& RuleEngine::getRule(int index) const {
+    return rules[index];
+}
+
+bool RuleEngine::isActive(int index) const {
+    return states[index].active == 1;
+}
+
+unsigned long RuleEngine::getCheckCount() const {
+    return checkCount;
+}
+
+int RuleEngine::visit(int index, uint32_t now, uint32_t& dirtyGroups, RuleActionHandler& handler) {
+    RuleState& state = states[index];
+    if (state.checkedPass == pass) {
+        return 0; // Reads several changed fields, already checked in this pass
+    }
+    state.checkedPass = pass;
+    if (!check(index, now)) {
+        return 0;
+    }
+    if (rules[index].group != 0) {
+        dirtyGroups |= 1UL << rules[index].group;
+        return 0;
+    }
+    apply(index, state.matched, handler);
+    return 1;
+}
+
+bool RuleEngine::check(int index, uint32_t now) {
+    const Rule& rule = rules[index];
+    RuleState& state = states[index];
+    checkCount++;
+
+    bool result = !rule.matchAny || rule.termCount == 0;
+    for (int i = 0; i < rule.termCount; i++) {
+        const RuleTerm& term = rule.terms[i];
+        if (!(validMask & (1 << term.field))) {
+            return false; // Not enough data; keep the current state
+        }
+        bool holds = termHolds(term, state.matched, rule.hysteresis);
+        if (rule.matchAny) {
+            result = result || holds;
+        } else {
+            result = result && holds;
+        }
+    }
+
+    bool initialized = state.active >= 0;
+    if (state.holding && result != state.matched && now - state.changedAt < rule.holdTime) {
+        if (!state.pending) {
+            state.pending = true;
+            pendingCount++;
+        }
+        return false;
+    }
+    if (state.pending) {
+        state.pending = false;
+        pendingCount--;
+    }
+    if (initialized && result == state.matched) {
+        return false;
+    }
+    state.holding = initialized;
+    state.matched = result;
+    state.changedAt = now;
+    return true;
+}
+
+bool RuleEngine::termHolds(const RuleTerm& term, bool matched, float hysteresis) const {
+    // A matched term is released only once the value moves the band past its threshold
+    float value = values[term.field];
+    float band = matched ? hysteresis : 0;
+    if (term.op == RULE_LESS) {
+        return value < term.threshold + band;
+    }
+    return value > term.threshold - band;
+}
+
+int RuleEngine::resolve(int group, RuleActionHandler& handler) {
+    int changes = 0;
+    bool taken = false;
+    for (int index = 0; index < ruleCount; index++) {
+        if (rules[index].group != group) {
+            continue;
+        }
+        bool active = states[index].matched && !taken;
+        taken = taken || active;
+        if (states[index].active != (active ? 1 : 0)) {
+            apply(index, active, handler);
+            changes++;
+        }
+    }
+    return changes;
+}
+
+void RuleEngine::apply(int index, bool active, RuleActionHandler& handler) {
+    const Rule& rule = rules[index];
+    states[index].active = active ? 1 : 0;
+    const RuleAction* actions = active ? rule.activeActions : rule.inactiveActions;
+    int count = active ? rule.activeActionCount : rule.inactiveActionCount;
+    for (int i = 0; i < count; i++) {
+        handler.applyRuleAction(actions[i]);
+    }
+    if (active && rule.hasAlert) {
+        float value = rule.termCount > 0 ? values[rule.terms[0].field] : 0;
+        handler.raiseRuleAlert(rule.alert, value);
+    }
+}
@@ -0,0 +1,194 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <stdint.h>
+
+#ifndef RULE_ENGINE_MAX_RULES
+#define RULE_ENGINE_MAX_RULES 32 ///< Rule table capacity; override with a build flag.
+#endif
+
+/**
+ * @brief Sensor values a rule can test.
+ */
+enum RuleField {
+    RULE_FIELD_TEMPERATURE, ///< Celsius.
+    RULE_FIELD_HUMIDITY,    ///< Percent.
+    RULE_FIELD_SMOKE,       ///< PPM.
+    RULE_FIELD_MOTION,      ///< 1 while motion is detected, 0 otherwise.
+    RULE_FIELD_COUNT
+};
+
+/**
+ * @brief Comparison applied by a rule term.
+ */
+enum RuleOperator {
+    RULE_LESS,    ///< Field below the threshold.
+    RULE_GREATER  ///< Field above the threshold.
+};
+
+/**
+ * @brief Kind of output a rule drives.
+ */
+enum RuleActionType {
+    RULE_ACTION_LED,  ///< Switch an LED: target is the LED index, value 1 for on, 0 for off.
+    RULE_ACTION_SERVO ///< Move a servo: target is the servo number, value the angle.
+};
+
+/**
+ * @brief One comparison of a rule condition.
+ */
+struct RuleTerm {
+    uint8_t field;   ///< A RuleField.
+    uint8_t op;      ///< A RuleOperator.
+    float threshold; ///< Value compared against.
+};
+
+/**
+ * @brief One output change applied when a rule becomes active or inactive.
+ */
+struct RuleAction {
+    uint8_t type;  ///< A RuleActionType.
+    uint8_t target;
+    int16_t value;
+};
+
+/**
+ * @brief Alert raised when a rule becomes active.
+ */
+struct RuleAlert {
+    char type[16];
+    char severity[8];
+    char message[48]; ///< The triggering value is appended by the receiver.
+};
+
+/**
+ * @brief A condition over sensor fields and the actions it drives.
+ *
+ * The condition combines up to MAX_TERMS comparisons with AND, or OR when `matchAny` is set;
+ * a rule without terms always matches. Once matched, a term holds until its field moves
+ * `hysteresis` past the threshold in the other direction, and the rule keeps any state for
+ * at least `holdTime` before changing again. Rules sharing a non-zero `group` are exclusive:
+ * only the first matching rule of the group, in table order, is active.
+ */
+struct Rule {
+    static const int MAX_TERMS = 2;
+    static const int MAX_ACTIONS = 3;
+    static const int MAX_GROUP = 31;
+
+    RuleTerm terms[MAX_TERMS];
+    uint8_t termCount;
+    bool matchAny;
+    float hysteresis;
+    uint32_t holdTime;  ///< Milliseconds.
+    uint8_t group;      ///< 0 for none, up to MAX_GROUP.
+    RuleAction activeActions[MAX_ACTIONS];   ///< Applied when the rule becomes active.
+    uint8_t activeActionCount;
+    RuleAction inactiveActions[MAX_ACTIONS]; ///< Applied when the rule becomes inactive.
+    uint8_t inactiveActionCount;
+    bool hasAlert;
+    RuleAlert alert;
+};
+
+/**
+ * @brief Abstract interface receiving the outputs of a RuleEngine.
+ */
+class RuleActionHandler {
+public:
+    virtual void applyRuleAction(const RuleAction& action) = 0;
+    virtual void raiseRuleAlert(const RuleAlert& alert, float value) = 0; ///< value: first term's field.
+    virtual ~RuleActionHandler() = default;
+};
+
+/**
+ * @brief Evaluates a table of rules against sensor fields, incrementally.
+ *
+ * Fields are set as readings arrive; evaluate() then re-checks only the rules reading a field
+ * that changed, plus those waiting for their hold time to pass, and applies actions on state
+ * changes only. A rule reading a field that has no valid value yet keeps its state. Pure logic
+ * over values and timestamps, without hardware access.
+ */
+class RuleEngine {
+public:
+    static const int MAX_RULES = RULE_ENGINE_MAX_RULES;
+
+    RuleEngine();
+
+    /**
+     * @brief Removes all rules. Outputs keep their current state.
+     */
+    void clear();
+
+    /**
+     * @brief Appends a rule. It is evaluated, and its actions applied, on the next evaluate().
+     * @param rule The rule to copy into the table.
+     * @return False if the table is full or the rule is malformed.
+     */
+    bool addRule(const Rule& rule);
+
+    /**
+     * @brief Checks a rule for out-of-range fields and counts.
+     */
+    static bool isValid(const Rule& rule);
+
+    /**
+     * @brief Updates a field. NaN marks it invalid.
+     * @param field The field.
+     * @param value New value.
+     */
+    void setField(RuleField field, float value);
+
+    /**
+     * @brief Re-checks the rules affected by field changes and applies the resulting actions.
+     * @param now Current time in milliseconds.
+     * @param handler Receives actions and alerts.
+     * @return Number of rules that changed state.
+     */
+    int evaluate(uint32_t now, RuleActionHandler& handler);
+
+    int getRuleCount() const;
+    const Rule& getRule(int index) const;
+
+    /**
+     * @brief Checks whether a rule is currently active.
+     */
+    bool isActive(int index) const;
+
+    /**
+     * @brief Gets the number of rule conditions checked since construction.
+     */
+    unsigned long getCheckCount() const;
+
+private:
+    struct RuleState {
+        bool matched;      ///< Condition result, after hysteresis and hold.
+        int8_t active;     ///< -1 until first applied, then 0 or 1.
+        bool pending;      ///< Condition differs from `matched` but the hold time has not passed.
+        bool holding;      ///< `changedAt` is a real transition; the first evaluation does not start a hold.
+        uint32_t changedAt;
+        uint32_t checkedPass;
+    };
+
+    Rule rules[MAX_RULES];
+    RuleState states[MAX_RULES];
+    int ruleCount;
+
+    // Rules reading each field, so a change only re-checks its readers
+    uint16_t readerCount[RULE_FIELD_COUNT];
+    uint16_t readers[RULE_FIELD_COUNT][MAX_RULES];
+
+    float values[RULE_FIELD_COUNT];
+    uint8_t validMask;
+    uint8_t dirtyMask;
+    bool fullPass;         ///< Check every rule on the next evaluate(), after the table changed.
+    int pendingCount;
+    uint32_t pass;
+    unsigned long checkCount;
+
+    int visit(int index, uint32_t now, uint32_t& dirtyGroups, RuleActionHandler& handler);
+    bool check(int index, uint32_t now);
+    bool termHolds(const RuleTerm& term, bool matched, float hysteresis) const;
+    int resolve(int group, RuleActionHandler& handler);
+    void apply(int index, bool active, RuleActionHandler& handler);
+};
+
+#endif // RULE_ENGINE_H
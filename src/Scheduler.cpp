@@ -0,0 +1,155 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(EventHandler* eventHandler, ClockFunction clock)
+    : taskCount(0), handler(eventHandler), clock(clock) {}
+
+bool Scheduler::addTask(int taskId, unsigned long period, unsigned long deadline) {
+    if (taskCount >= MAX_TASKS || findTask(taskId) != nullptr) {
+        return false;
+    }
+
+    Task& task = tasks[taskCount++];
+    task.id = taskId;
+    task.period = period;
+    task.deadline = deadline > 0 ? deadline : period;
+    task.release = clock != nullptr ? clock() : 0;
+    task.enabled = true;
+    task.stats = TaskStats();
+    return true;
+}
+
+bool Scheduler::setPeriod(int taskId, unsigned long period) {
+    Task* task = findTask(taskId);
+    if (task == nullptr) {
+        return false;
+    }
+    if (task->deadline == task->period) {
+        task->deadline = period;
+    }
+    task->period = period;
+    return true;
+}
+
+void Scheduler::setEnabled(int taskId, bool enabled) {
+    Task* task = findTask(taskId);
+    if (task == nullptr || task->enabled == enabled) {
+        return;
+    }
+    task->enabled = enabled;
+    if (enabled && clock != nullptr) {
+        task->release = clock();
+    }
+}
+
+void Scheduler::tick() {
+    if (clock == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < taskCount; i++) {
+        Task& task = tasks[i];
+        unsigned long start = clock();
+
+        // Signed difference keeps the comparison correct across millis() wrap-around
+        if (!task.enabled || (long)(start - task.release) < 0) {
+            continue;
+        }
+
+        unsigned long lateness = start - task.release;
+
+        if (handler != nullptr) {
+            // The payload tells the job how late it was released
+            handler->on(Event(task.id, lateness, 0, start));
+        }
+
+        unsigned long finish = clock();
+        TaskStats& stats = task.stats;
+        stats.runs++;
+        stats.lastRunTime = finish - start;
+        if (stats.lastRunTime > stats.maxRunTime) {
+            stats.maxRunTime = stats.lastRunTime;
+        }
+        if (lateness > stats.maxLateness) {
+            stats.maxLateness = lateness;
+        }
+        stats.totalLateness += lateness;
+        if (finish - task.release > task.deadline) {
+            stats.overruns++;
+        }
+
+        // Keep the original phase unless whole periods were missed, then resynchronize on this
+        // run, so the missed releases do not come out as a burst of back-to-back runs
+        task.release += task.period;
+        if ((long)(finish - task.release) >= (long)task.period) {
+            task.release = finish + task.period;
+        }
+    }
+}
+
+unsigned long Scheduler::timeUntilNextTask() const {
+    if (clock == nullptr) {
+        return 0;
+    }
+
+    unsigned long now = clock();
+    unsigned long next = (unsigned long)-1;
+    for (int i = 0; i < taskCount; i++) {
+        const Task& task = tasks[i];
+        if (!task.enabled) {
+            continue;
+        }
+        long remaining = (long)(task.release - now);
+        if (remaining <= 0) {
+            return 0;
+        }
+        if ((unsigned long)remaining < next) {
+            next = remaining;
+        }
+    }
+    return next;
+}
+
+const TaskStats* Scheduler::getStats(int taskId) const {
+    const Task* task = findTask(taskId);
+    return task != nullptr ? &task->stats : nullptr;
+}
+
+void Scheduler::resetStats() {
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].stats = TaskStats();
+    }
+}
+
+int Scheduler::getTaskCount() const {
+    return taskCount;
+}
+
+int Scheduler::getTaskId(int index) const {
+    return (index >= 0 && index < taskCount) ? tasks[index].id : -1;
+}
+
+void Scheduler::setHandler(EventHandler* eventHandler) {
+    handler = eventHandler;
+}
+
+void Scheduler::setClock(ClockFunction clock) {
+    this->clock = clock;
+}
+
+Scheduler::Task* Scheduler::findTask(int taskId) {
+    for (int i = 0; i < taskCount; i++) {
+        if (tasks[i].id == taskId) {
+            return &tasks[i];
+        }
+    }
+    return nullptr;
+}
+
+const Scheduler::Task* Scheduler::findTask(int taskId) const {
+    for (int i = 0; i < taskCount; i++) {
+        if (tasks[i].id == taskId) {
+            return &tasks[i];
+        }
+    }
+    return nullptr;
+}
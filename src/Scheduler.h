@@ -0,0 +1,136 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "EventHandler.h"
+
+/**
+ * @brief Function returning the current time in milliseconds.
+ *
+ * On the board this is `millis`; host builds can pass a fake clock to drive the scheduler
+ * deterministically and measure loop latency and jitter.
+ */
+typedef unsigned long (*ClockFunction)();
+
+/**
+ * @brief Per-task execution statistics collected by the Scheduler.
+ */
+struct TaskStats {
+    unsigned long runs;          ///< Number of times the task has run.
+    unsigned long overruns;      ///< Runs that finished after their deadline.
+    unsigned long lastRunTime;   ///< Duration of the last run in milliseconds.
+    unsigned long maxRunTime;    ///< Longest run observed in milliseconds.
+    unsigned long maxLateness;   ///< Worst start delay after the release time in milliseconds.
+    unsigned long totalLateness; ///< Sum of start delays, used to compute the mean jitter.
+};
+
+/**
+ * @brief Cooperative, non-blocking tick scheduler for periodic jobs.
+ *
+ * Each job is registered with an ID, a period and a deadline relative to its release time.
+ * Calling `tick()` from the main loop runs every job that is due by raising an `Event` with the
+ * job ID on the assigned handler, so jobs are handled like any other event in the framework.
+ * A run that finishes later than its deadline is counted as an overrun. A late job keeps its
+ * phase; one that missed whole periods runs once and is next released a period after that run.
+ */
+class Scheduler {
+public:
+    static const int MAX_TASKS = 12; ///< Maximum number of registered jobs.
+
+    /**
+     * @brief Constructs a Scheduler.
+     * @param eventHandler Handler receiving an Event with the job ID each time a job runs.
+     * @param clock Time source in milliseconds (default: nullptr, must be set before ticking).
+     */
+    Scheduler(EventHandler* eventHandler = nullptr, ClockFunction clock = nullptr);
+
+    /**
+     * @brief Registers a periodic job. The first run is released immediately.
+     * @param taskId Unique ID, raised as the event ID when the job runs.
+     * @param period Period in milliseconds.
+     * @param deadline Deadline in milliseconds after release (default: 0, meaning the period).
+     * @return True if the job was registered, false if the table is full or the ID is in use.
+     */
+    bool addTask(int taskId, unsigned long period, unsigned long deadline = 0);
+
+    /**
+     * @brief Changes the period of a registered job, keeping its current release time.
+     * @param taskId The job ID.
+     * @param period New period in milliseconds.
+     * @return True if the job exists.
+     */
+    bool setPeriod(int taskId, unsigned long period);
+
+    /**
+     * @brief Enables or disables a registered job. A re-enabled job is released immediately.
+     * @param taskId The job ID.
+     * @param enabled True to run the job, false to skip it.
+     */
+    void setEnabled(int taskId, bool enabled);
+
+    /**
+     * @brief Runs every job that is due. Never blocks.
+     */
+    void tick();
+
+    /**
+     * @brief Gets the time until the next job is released.
+     * @return Milliseconds until the next release, 0 if a job is already due.
+     */
+    unsigned long timeUntilNextTask() const;
+
+    /**
+     * @brief Gets the statistics of a job.
+     * @param taskId The job ID.
+     * @return Pointer to the statistics, or nullptr if the job does not exist.
+     */
+    const TaskStats* getStats(int taskId) const;
+
+    /**
+     * @brief Clears the statistics of every job.
+     */
+    void resetStats();
+
+    /**
+     * @brief Gets the number of registered jobs.
+     */
+    int getTaskCount() const;
+
+    /**
+     * @brief Gets the ID of the job at a table position, for iterating over statistics.
+     * @param index Position in registration order.
+     * @return The job ID, or -1 if the index is out of range.
+     */
+    int getTaskId(int index) const;
+
+    /**
+     * @brief Sets or updates the handler receiving job events.
+     * @param eventHandler Pointer to the new EventHandler.
+     */
+    void setHandler(EventHandler* eventHandler);
+
+    /**
+     * @brief Sets the time source.
+     * @param clock Function returning the current time in milliseconds.
+     */
+    void setClock(ClockFunction clock);
+
+private:
+    struct Task {
+        int id;
+        unsigned long period;
+        unsigned long deadline;
+        unsigned long release;
+        bool enabled;
+        TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    int taskCount;
+    EventHandler* handler;
+    ClockFunction clock;
+
+    Task* findTask(int taskId);
+    const Task* findTask(int taskId) const;
+};
+
+#endif // SCHEDULER_H
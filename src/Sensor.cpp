@@ -1,14 +1,27 @@
 #include "Sensor.h"
 
+const int Sensor::ANY_EVENT;
+
 Sensor::Sensor(int pin, EventHandler* eventHandler)
-    : pin(pin), handler(eventHandler) {}
+    : pin(pin), handler(eventHandler) {
+    subscribers.subscribe(eventHandler);
+}
 
 void Sensor::on(Event event) {
-    if (handler != nullptr) {
-        handler->on(event);
-    }
+    subscribers.dispatch(&EventHandler::on, event);
 }
 
 void Sensor::setHandler(EventHandler* eventHandler) {
+    // Only the catch-all entry; per-ID subscriptions of the same receiver stay
+    subscribers.unsubscribeFilter(handler, ANY_EVENT);
     handler = eventHandler;
+    subscribers.subscribe(eventHandler);
+}
+
+bool Sensor::subscribe(EventHandler* subscriber, int eventId) {
+    return subscribers.subscribe(subscriber, eventId);
+}
+
+bool Sensor::unsubscribe(EventHandler* subscriber, int eventId) {
+    return subscribers.unsubscribe(subscriber, eventId);
 }
@@ -2,11 +2,17 @@
 #define SENSOR_H
 
 #include "EventHandler.h"
+#include "SubscriberList.h"
 
 class Sensor : public EventHandler {
+public:
+    static const int MAX_SUBSCRIBERS = 4; ///< Subscriptions per sensor, the handler included.
+    static const int ANY_EVENT = SubscriberList<EventHandler, MAX_SUBSCRIBERS>::ANY_ID;
+
 protected:
     int pin; ///< GPIO pin assigned to the sensor.
-    EventHandler* handler; ///< Optional handler to receive propagated events.
+    EventHandler* handler; ///< Optional handler to receive propagated events, also in `subscribers`.
+    SubscriberList<EventHandler, MAX_SUBSCRIBERS> subscribers; ///< Receivers of propagated events.
 
 public:
     /**
@@ -17,16 +23,35 @@ public:
     Sensor(int pin, EventHandler* eventHandler = nullptr);
 
     /**
-     * @brief Handles an event by propagating it to the assigned handler.
+     * @brief Handles an event by propagating it to the subscribers whose filter accepts it.
      * @param event The event to handle.
      */
     void on(Event event) override;
 
     /**
-     * @brief Sets or updates the event handler for this sensor.
+     * @brief Sets or updates the event handler for this sensor, which receives every event.
+     * Other subscribers are kept.
      * @param eventHandler Pointer to the new EventHandler.
      */
     void setHandler(EventHandler* eventHandler);
+
+    /**
+     * @brief Adds a receiver of this sensor's events, alongside the handler. Allowed while an
+     * event is being propagated; the new subscriber starts with the next one.
+     * @param subscriber Receiver of the events.
+     * @param eventId Event ID to receive, or ANY_EVENT for all of them (default).
+     * @return False if MAX_SUBSCRIBERS subscriptions exist already.
+     */
+    bool subscribe(EventHandler* subscriber, int eventId = ANY_EVENT);
+
+    /**
+     * @brief Removes subscriptions added with subscribe(). Allowed while an event is being
+     * propagated; the subscriber is not called again.
+     * @param subscriber Receiver to remove.
+     * @param eventId Filter to remove, or ANY_EVENT for every subscription of the receiver.
+     * @return True if a subscription was removed.
+     */
+    bool unsubscribe(EventHandler* subscriber, int eventId = ANY_EVENT);
 };
 
 #endif // SENSOR_H
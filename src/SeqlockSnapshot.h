@@ -0,0 +1,80 @@
+#ifndef SEQLOCK_SNAPSHOT_H
+#define SEQLOCK_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+/**
+ * @brief Latest-value cell shared between one writer and any number of readers.
+ *
+ * The writer never waits. Readers copy the value and retry if a write happened meanwhile,
+ * so they always observe a complete, consistent record. The value is stored as atomic words,
+ * which keeps the cell free of data races under thread sanitizers on the host.
+ *
+ * @tparam T Trivially copyable value type.
+ */
+template <typename T>
+class SeqlockSnapshot {
+public:
+    SeqlockSnapshot() : sequence(0) {
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Publishes a new value. Single writer only.
+     * @param value The value to publish.
+     */
+    void write(const T& value) {
+        uint32_t buffer[WORDS] = {};
+        memcpy(buffer, &value, sizeof(T));
+
+        uint32_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the latest consistent value.
+     * @param value Receives the value.
+     * @return The version of the value read; 0 if nothing was written yet.
+     */
+    uint32_t read(T& value) const {
+        uint32_t buffer[WORDS];
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        memcpy(&value, buffer, sizeof(T));
+        return before / 2;
+    }
+
+    /**
+     * @brief Gets the number of values written so far.
+     */
+    uint32_t getVersion() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> words[WORDS];
+};
+
+#endif // SEQLOCK_SNAPSHOT_H
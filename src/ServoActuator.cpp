@@ -1,36 +1,106 @@
 #include "ServoActuator.h"
+#include <Arduino.h>
 
 const Command ServoActuator::MOVE_TO_POSITION_COMMAND = Command(MOVE_TO_POSITION_COMMAND_ID);
 const Command ServoActuator::MOVE_TO_0_COMMAND = Command(MOVE_TO_0_COMMAND_ID);
 const Command ServoActuator::MOVE_TO_90_COMMAND = Command(MOVE_TO_90_COMMAND_ID);
 const Command ServoActuator::MOVE_TO_180_COMMAND = Command(MOVE_TO_180_COMMAND_ID);
+const Event ServoActuator::POSITION_EVENT = Event(POSITION_EVENT_ID);
+const Event ServoActuator::ARRIVED_EVENT = Event(ARRIVED_EVENT_ID);
 
 ServoActuator::ServoActuator(int pin, int initialPosition, CommandHandler* commandHandler)
-    : Actuator(pin, commandHandler), currentPosition(initialPosition), targetPosition(initialPosition) {}
+    : Actuator(pin, commandHandler), currentPosition(initialPosition), targetPosition(initialPosition),
+      profiled(false), lastStepTime(0), lastReportTime(0), reportedPosition(initialPosition) {
+    profile.reset(initialPosition);
+}
 
 void ServoActuator::begin() {
     servo.attach(pin);
     servo.write(currentPosition);
+    profile.reset(currentPosition);
+    lastStepTime = millis();
 }
 
 void ServoActuator::handle(Command command) {
-    if (command == MOVE_TO_POSITION_COMMAND) {
-        moveTo(targetPosition);
-    } else if (command == MOVE_TO_0_COMMAND) {
-        moveTo(0);
-    } else if (command == MOVE_TO_90_COMMAND) {
-        moveTo(90);
-    } else if (command == MOVE_TO_180_COMMAND) {
-        moveTo(180);
-    }
+    apply(command);
     Actuator::handle(command); // Propagate to handler if set
 }
 
+bool ServoActuator::apply(Command command) {
+    switch (command.id) {
+        case MOVE_TO_POSITION_COMMAND_ID:
+            // The angle travels with the command; setTargetPosition() is kept for older callers
+            moveTo(command.hasValue ? (int)command.value : targetPosition);
+            break;
+        case MOVE_TO_0_COMMAND_ID:
+            moveTo(0);
+            break;
+        case MOVE_TO_90_COMMAND_ID:
+            moveTo(90);
+            break;
+        case MOVE_TO_180_COMMAND_ID:
+            moveTo(180);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
 void ServoActuator::moveTo(int position) {
-    if (position >= 0 && position <= 180) {
+    if (position < 0 || position > 180) {
+        return;
+    }
+    targetPosition = position;
+    if (profiled) {
+        if (!profile.isMoving()) {
+            lastStepTime = millis(); // Do not count the idle time as elapsed motion
+        }
+        profile.setTarget(position);
+        return;
+    }
+    currentPosition = position;
+    servo.write(position);
+}
+
+void ServoActuator::setMotionProfile(float maxVelocity, float acceleration) {
+    profiled = maxVelocity > 0 && acceleration > 0;
+    if (profiled) {
+        profile.configure(maxVelocity, acceleration);
+    }
+    profile.reset(currentPosition);
+}
+
+bool ServoActuator::step(uint32_t now, Event& event) {
+    if (!profiled || !profile.isMoving()) {
+        return false;
+    }
+    bool arrived = profile.advance((now - lastStepTime) / 1000.0f);
+    lastStepTime = now;
+
+    int position = (int)(profile.getPosition() + 0.5f);
+    if (position != currentPosition) {
         currentPosition = position;
         servo.write(position);
     }
+
+    if (arrived) {
+        reportedPosition = position;
+        lastReportTime = now;
+        event = ARRIVED_EVENT.withPayload(position, pin, now);
+        return true;
+    }
+    if (position != reportedPosition && now - lastReportTime >= POSITION_REPORT_INTERVAL) {
+        reportedPosition = position;
+        lastReportTime = now;
+        event = POSITION_EVENT.withPayload(position, pin, now);
+        return true;
+    }
+    return false;
+}
+
+bool ServoActuator::isMoving() const {
+    return profiled && profile.isMoving();
 }
 
 void ServoActuator::setTargetPosition(int position) {
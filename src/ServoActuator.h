@@ -2,6 +2,8 @@
 #define SERVO_ACTUATOR_H
 
 #include "Actuator.h"
+#include "EventHandler.h"
+#include "MotionProfile.h"
 #include <ESP32Servo.h>
 
 class ServoActuator : public Actuator {
@@ -10,6 +12,13 @@ private:
     int currentPosition;
     int targetPosition;
 
+    // Motion profile mode
+    bool profiled;
+    MotionProfile profile;
+    uint32_t lastStepTime;
+    uint32_t lastReportTime;
+    int reportedPosition;
+
 public:
     static const int MOVE_TO_POSITION_COMMAND_ID = 10;
     static const int MOVE_TO_0_COMMAND_ID = 11;
@@ -20,6 +29,12 @@ public:
     static const Command MOVE_TO_90_COMMAND;
     static const Command MOVE_TO_180_COMMAND;
 
+    static const int POSITION_EVENT_ID = 14;
+    static const int ARRIVED_EVENT_ID = 15;
+    static const Event POSITION_EVENT; ///< Position while moving, at most every POSITION_REPORT_INTERVAL.
+    static const Event ARRIVED_EVENT;  ///< Target reached.
+    static const uint32_t POSITION_REPORT_INTERVAL = 100; ///< Milliseconds between position events.
+
     /**
      * @brief Constructs a ServoActuator.
      * @param pin The GPIO pin for the servo (PWM capable).
@@ -35,16 +50,71 @@ public:
 
     /**
      * @brief Handles commands to control the servo position.
+     *
+     * MOVE_TO_POSITION_COMMAND moves to the command value when it has one, e.g.
+     * `MOVE_TO_POSITION_COMMAND.withValue(45)`, and to the target position otherwise.
      * @param command The command to execute.
      */
     void handle(Command command) override;
 
+    /**
+     * @brief Executes a command without propagating it to the handler.
+     *
+     * Non-virtual path for owners that drive the servo directly and need no feedback.
+     * @param command The command to execute.
+     * @return True if the command is one of the servo commands.
+     */
+    bool apply(Command command);
+
     /**
      * @brief Moves the servo to a specific position.
+     *
+     * In motion profile mode only sets the target; the move happens in step(). A new target
+     * replaces the previous one even mid-move, so a burst of commands ends at the last one.
      * @param position Target position (0-180 degrees).
      */
     void moveTo(int position);
 
+    /**
+     * @brief Enables smooth moves with limited velocity and acceleration.
+     *
+     * Instead of jumping to each target, the servo follows a trapezoidal MotionProfile advanced
+     * by step(), which the owner must call regularly (e.g. every 20 ms, the servo PWM period).
+     * Limiting acceleration avoids the current spikes of full-speed jumps.
+     * @param maxVelocity Velocity limit in degrees per second, 0 to jump as before.
+     * @param acceleration Acceleration limit in degrees per second squared.
+     */
+    void setMotionProfile(float maxVelocity, float acceleration);
+
+    /**
+     * @brief Advances the motion profile and writes the new position to the servo.
+     * @param now Current time in milliseconds.
+     * @param event Receives ARRIVED_EVENT when the target is reached, or POSITION_EVENT while
+     *        moving; the event value is the position in degrees.
+     * @return True if an event was produced.
+     */
+    bool step(uint32_t now, Event& event);
+
+    /**
+     * @brief Advances the motion profile and delivers any event straight to `sink`.
+     * @param now Current time in milliseconds.
+     * @param sink Object with an `on(Event)` method.
+     * @return True while the servo is moving.
+     */
+    template<typename Sink>
+    bool step(uint32_t now, Sink& sink) {
+        Event event(0);
+        if (step(now, event)) {
+            sink.on(event);
+        }
+        return isMoving();
+    }
+
+    /**
+     * @brief Checks whether a profiled move is in progress.
+     */
+    bool isMoving() const;
+
     /**
      * @brief Sets the target position for the servo (used with MOVE_TO_POSITION_COMMAND).
      * @param position Target position (0-180 degrees).
@@ -52,13 +122,13 @@ public:
     void setTargetPosition(int position);
 
     /**
-     * @brief Gets the current position of the servo.
+     * @brief Gets the current position of the servo; mid-move in motion profile mode.
      * @return Current position in degrees.
      */
     int getCurrentPosition() const;
 
     /**
-     * @brief Gets the target position of the servo.
+     * @brief Gets the target position of the servo, the last one requested.
      * @return Target position in degrees.
      */
     int getTargetPosition() const;
@@ -1,12 +1,18 @@
 #include "SmartSuiteDevice.h"
 
-// Static instance for MQTT callback
-SmartSuiteDevice* SmartSuiteDevice::instance = nullptr;
+const unsigned long SmartSuiteDevice::EXCEPTION_CHECK_PERIOD;
+
+// NVS location of the rule table received over MQTT
+static const char* const RULES_NAMESPACE = "rules";
+static const char* const RULES_KEY = "json";
+
+// Indexed by CommandParseResult, for the servo command responses
+static const char* const PARSE_RESULT_NAMES[] = {"ok", "malformed", "missing_field", "out_of_range"};
 
 SmartSuiteDevice::SmartSuiteDevice()
     : dhtSensor(DHT_PIN, DHT11, this),
       pirSensor(PIR_PIN, this),
-      mq2Sensor(MQ2_PIN, 300.0, 600.0, this),
+      mq2Sensor(MQ2_PIN, 300.0, 600.0, 30.0, this),
       ledRed(LED_RED_PIN, false, this),
       ledGreen(LED_GREEN_PIN, false, this),
       ledOrange(LED_ORANGE_PIN, false, this),
@@ -15,120 +21,450 @@ SmartSuiteDevice::SmartSuiteDevice()
       servo1(SERVO1_PIN, 0, this),
       servo2(SERVO2_PIN, 0, this),
       mqttClient(espClient),
+      mqttTransport(mqttClient, transportBuffer, sizeof(transportBuffer), &connectionTransport),
+      transport(&mqttTransport),
+      connectionTransport(mqttClient),
+      connection(&connectionTransport, this, millis, esp_random),
       wifiSSID("Las4as.pe"),
       wifiPassword("L@s4as.pe"),
       mqttBroker("192.168.0.237"),
       mqttTopicData("smartsuite/sensors/data"),
       mqttTopicServoCommand("smartsuite/servo/command"),
+      mqttTopicServoResponse("smartsuite/servo/response"),
       mqttTopicAlerts("smartsuite/alerts"),
+      mqttTopicRules("smartsuite/config/rules"),
+      mqttTopicMetrics("smartsuite/metrics"),
       httpEndpoint("https://jsonplaceholder.typicode.com/posts"),
       clientId("SmartSuite_ESP32"),
       mqttPort(1883),
-      lastSensorRead(0),
-      lastDataSent(0),
+      scheduler(this, millis),
+      networkScheduler(this, millis),
       sensorInterval(2000),  // Increased to 2 seconds for DHT11 stability
-      mqttInterval(5000) {
-    
-    instance = this;
+      mqttInterval(5000),
+      lastSample(),
+      journaledSequence(0),
+      dataFormat(PAYLOAD_JSON),
+      alertFormat(PAYLOAD_JSON),
+      reportByException(false),
+      suppressedSamples(0),
+      batching(false),
+      batchSize(20),
+      batchInterval(5000),
+      batchStartTime(0),
+      sampleSequence(0),
+      lastMotionState(false),
+      pipelined(false),
+      pendingRulesLength(0),
+      rulesPending(false)
+#if PROFILING_ENABLED
+      , metricsWindowStart(0)
+#endif
+      {
+    
+    configureTopics();
+    alertAggregator.setWindow("motion", MOTION_ALERT_WINDOW);
+    alertAggregator.setWindow("smoke", SMOKE_ALERT_WINDOW);
 }
 
 void SmartSuiteDevice::begin() {
+    PROFILE_SELECT(profiler); // The HTTP task started below records into it too
     Serial.begin(115200);
+    Logger::begin(NETWORK_TASK_CORE, LOG_TASK_PRIORITY);
     
-    // Initialize sensors
-    dhtSensor.begin();
-    pirSensor.begin();
-    mq2Sensor.begin();
-    
-    // Initialize actuators  
-    servo1.begin();
-    servo2.begin();
+    // Initialize sensors and actuators
+    dhtSensor.setAsyncMode(true);
+    pirSensor.setInterruptMode(true);
+    servo1.setMotionProfile(SERVO_MAX_VELOCITY, SERVO_ACCELERATION);
+    servo2.setMotionProfile(SERVO_MAX_VELOCITY, SERVO_ACCELERATION);
+    makeComponentList(dhtSensor, pirSensor, mq2Sensor, servo1, servo2).forEach(BeginComponent());
     
     // Set initial servo positions
-    servo1.handle(ServoActuator::MOVE_TO_0_COMMAND);
-    servo2.handle(ServoActuator::MOVE_TO_0_COMMAND);
+    makeComponentList(servo1, servo2).forEach(ApplyCommand(ServoActuator::MOVE_TO_0_COMMAND));
+    loadRules();
     
-    // Setup WiFi and MQTT
-    setupWiFi();
+    // Setup WiFi and MQTT; the connection is established in the background by update()
     mqttClient.setServer(mqttBroker, mqttPort);
-    mqttClient.setCallback(mqttCallback);
+    mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT);
+    mqttClient.setBufferSize(MQTT_RULES_BUFFER_SIZE);
+    configureBatch();
+    connectionTransport.setCredentials(wifiSSID, wifiPassword);
+    connectionTransport.setClientId(clientId);
+    connectionTransport.startTask(NETWORK_TASK_CORE, NETWORK_TASK_PRIORITY); // Broker attempts off the control loop
+    connection.begin();
+    transport->setHandler(this);
+    if (transport->isConnected()) {
+        subscribeTopics(); // Otherwise on MQTT_CONNECTED_EVENT
+    }
+    
+    // HTTP uploads run in their own low-priority task, off the control path
+    httpUploader.setEndpoint(httpEndpoint);
+    httpUploader.setSourceInfo(clientId, "smartsuite-esp32");
+    httpUploader.startTask(NETWORK_TASK_CORE, HTTP_TASK_PRIORITY);
+    
+    // Samples missed while offline survive reboots in flash and are replayed on reconnect
+    if (journal.begin()) {
+        LOG_INFO("Telemetry journal ready, samples pending: %u", journal.getPendingCount());
+    }
     
-    Serial.println("SmartSuite ESP32 initialized using ModestIoT framework");
-    Serial.println("Sensors: DHT11, PIR, MQ2");
-    Serial.println("Actuators: 5 LEDs, 2 Servos");
-    Serial.println("Connectivity: WiFi + MQTT");
+    // Register periodic jobs; each one runs on its own period instead of the slowest blocking call
+    scheduler.addTask(PIR_POLL_TASK_ID, PIR_POLL_PERIOD);
+    scheduler.addTask(MQ2_ACQUIRE_TASK_ID, MQ2_ACQUIRE_PERIOD);
+    scheduler.addTask(MQ2_SAMPLE_TASK_ID, MQ2_SAMPLE_PERIOD);
+    scheduler.addTask(DHT_READ_TASK_ID, sensorInterval);
+    scheduler.addTask(CONTROL_TASK_ID, sensorInterval);
+    scheduler.addTask(STATS_REPORT_TASK_ID, STATS_REPORT_PERIOD);
+    scheduler.addTask(SERVO_MOTION_TASK_ID, SERVO_MOTION_PERIOD);
+    networkScheduler.addTask(MQTT_KEEPALIVE_TASK_ID, MQTT_KEEPALIVE_PERIOD);
+    networkScheduler.addTask(TELEMETRY_TASK_ID, reportByException ? EXCEPTION_CHECK_PERIOD : mqttInterval);
+    networkScheduler.addTask(HTTP_UPLOAD_TASK_ID, mqttInterval);
+    networkScheduler.addTask(JOURNAL_REPLAY_TASK_ID, JOURNAL_REPLAY_PERIOD);
+#if PROFILING_ENABLED
+    networkScheduler.addTask(METRICS_TASK_ID, METRICS_PERIOD);
+    metricsWindowStart = millis();
+#endif
+    
+    LOG_INFO("SmartSuite ESP32 initialized using ModestIoT framework");
+
+#ifdef ESP32
+    if (pipelined) {
+        xTaskCreatePinnedToCore(sensorTask, "sensors", TASK_STACK_SIZE, this,
+                                SENSOR_TASK_PRIORITY, nullptr, SENSOR_TASK_CORE);
+        xTaskCreatePinnedToCore(networkTask, "network", TASK_STACK_SIZE, this,
+                                NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+        LOG_INFO("Pipelined mode: sensors on core %d, network on core %d", SENSOR_TASK_CORE, NETWORK_TASK_CORE);
+    }
+#endif
 }
 
 void SmartSuiteDevice::update() {
-    // Maintain MQTT connection
-    if (!mqttClient.connected()) {
-        reconnectMQTT();
+    PROFILE_SELECT(profiler);
+    unsigned long wait = MQTT_KEEPALIVE_PERIOD;
+    if (!pipelined) {
+        runSensorSide();
+        runNetworkSide();
+        unsigned long next = timeUntilNextTask();
+        if (next < wait) {
+            wait = next;
+        }
     }
-    mqttClient.loop();
-    
-    unsigned long currentTime = millis();
-    
-    // Read sensors periodically
-    if (currentTime - lastSensorRead >= sensorInterval) {
-        lastSensorRead = currentTime;
-        
-        // Read all sensors with retry mechanism
-        bool dhtSuccess = dhtSensor.readSensor();
-        if (!dhtSuccess) {
-            // Wait a bit and try one more time
-            delay(500);
-            dhtSuccess = dhtSensor.readSensor();
+#ifdef ESP32
+    // Give the core up until the next job is due instead of spinning through loop()
+    if (wait > 0) {
+        vTaskDelay(pdMS_TO_TICKS(wait));
+    }
+#else
+    // Host runs drive the clock themselves, from timeUntilNextTask()
+    (void)wait;
+#endif
+}
+
+void SmartSuiteDevice::setPipelined(bool enabled) {
+#ifdef ESP32
+    pipelined = enabled;
+#else
+    (void)enabled;
+    pipelined = false;
+#endif
+}
+
+void SmartSuiteDevice::setMessageTransport(MessageTransport* messageTransport) {
+    transport = messageTransport != nullptr ? messageTransport : &mqttTransport;
+}
+
+void SmartSuiteDevice::setJournalStorage(JournalStorage* storage) {
+    journal.setStorage(storage);
+}
+
+const Scheduler& SmartSuiteDevice::getScheduler() const {
+    return scheduler;
+}
+
+const Scheduler& SmartSuiteDevice::getNetworkScheduler() const {
+    return networkScheduler;
+}
+
+const ConnectionManager& SmartSuiteDevice::getConnection() const {
+    return connection;
+}
+
+unsigned long SmartSuiteDevice::timeUntilNextTask() const {
+    if (!commandRing.empty()) {
+        return 0;
+    }
+    unsigned long sensorWait = scheduler.timeUntilNextTask();
+    unsigned long networkWait = networkScheduler.timeUntilNextTask();
+    unsigned long wait = sensorWait < networkWait ? sensorWait : networkWait;
+    // The DHT state machine is polled on every update(), not scheduled
+    if (dhtSensor.isBusy() && wait > 1) {
+        wait = 1;
+    }
+    return wait;
+}
+
+bool SmartSuiteDevice::getLatestSample(SensorSample& sample) const {
+    return latestSample.read(sample) > 0;
+}
+
+void SmartSuiteDevice::runSensorSide() {
+    PROFILE_SPAN("sensorSide");
+    applyServoCommands();
+    {
+        PROFILE_SPAN("dht");
+        dhtSensor.update();
+    }
+    scheduler.tick();
+}
+
+void SmartSuiteDevice::runNetworkSide() {
+    PROFILE_SPAN("networkSide");
+    networkScheduler.tick();
+}
+
+void SmartSuiteDevice::sensorTask(void* parameter) {
+#ifdef ESP32
+    SmartSuiteDevice* device = static_cast<SmartSuiteDevice*>(parameter);
+    PROFILE_SELECT(device->profiler);
+    for (;;) {
+        device->runSensorSide();
+        vTaskDelay(1);
+    }
+#else
+    (void)parameter;
+#endif
+}
+
+void SmartSuiteDevice::networkTask(void* parameter) {
+#ifdef ESP32
+    SmartSuiteDevice* device = static_cast<SmartSuiteDevice*>(parameter);
+    PROFILE_SELECT(device->profiler);
+    for (;;) {
+        device->runNetworkSide();
+        vTaskDelay(1);
+    }
+#else
+    (void)parameter;
+#endif
+}
+
+void SmartSuiteDevice::publishSample() {
+    SensorSample sample;
+    sample.sequence = ++sampleSequence;
+    sample.timestamp = millis();
+    sample.temperature = dhtSensor.getTemperature();
+    sample.humidity = dhtSensor.getHumidity();
+    sample.smokeLevel = mq2Sensor.getGasLevel();
+    sample.servoPosition = servo1.getCurrentPosition();
+    sample.servo2Position = servo2.getCurrentPosition();
+    sample.motionDetected = pirSensor.getMotionState();
+
+    latestSample.write(sample);
+    sampleRing.push(sample);
+}
+
+void SmartSuiteDevice::drainSamples() {
+    SensorSample sample;
+    while (sampleRing.pop(sample)) {
+        lastSample = sample;
+        if (batching) {
+            batchSample(sample);
         }
-        
-        pirSensor.readMotion();
-        mq2Sensor.readGasLevel();
-        
-        // Process sensor data
-        processTemperatureHumidity();
-        processMotionDetection();
-        processGasDetection();
     }
-    
-    // Send MQTT data periodically
-    if (currentTime - lastDataSent >= mqttInterval) {
-        lastDataSent = currentTime;
-        sendSensorData();
-        sendSensorDataHTTP(); // También enviar por HTTP
+}
+
+void SmartSuiteDevice::applyServoCommands() {
+    // Latest wins: of a burst of commands only the last one per servo is executed
+    int latest[2] = {-1, -1};
+    ServoCommandRecord command;
+    while (commandRing.pop(command)) {
+        latest[command.servo == 2 ? 1 : 0] = command.position;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (latest[i] < 0) {
+            continue;
+        }
+        ServoActuator& servo = i == 1 ? servo2 : servo1;
+        servo.apply(ServoActuator::MOVE_TO_POSITION_COMMAND.withValue(latest[i]));
+        LOG_INFO("Servo %d moving to position: %d", i + 1, latest[i]);
+    }
+}
+
+void SmartSuiteDevice::runTask(int taskId) {
+    switch (taskId) {
+        case MQTT_KEEPALIVE_TASK_ID:
+            // Maintain WiFi/MQTT connection one step at a time
+            connection.update();
+            transport->loop();
+            drainSamples();
+            collectAlerts();
+            if (batching && (!alertAggregator.isEmpty() || millis() - batchStartTime >= batchInterval)) {
+                flushBatch(); // Due, or an alert follows: send the samples leading up to it first
+            }
+            publishAlerts();
+            break;
+        case PIR_POLL_TASK_ID:
+            if (pirSensor.readMotion(*this) != lastMotionState) {
+                lastMotionState = !lastMotionState;
+                publishSample();
+            }
+            break;
+        case MQ2_ACQUIRE_TASK_ID:
+            // Continuous acquisition; threshold events come from the filtered level
+            mq2Sensor.readGasLevel(*this);
+            break;
+        case MQ2_SAMPLE_TASK_ID:
+            publishSample();
+            break;
+        case SERVO_MOTION_TASK_ID:
+            servo1.step(millis(), *this);
+            servo2.step(millis(), *this);
+            break;
+        case DHT_READ_TASK_ID:
+            // Non-blocking: the reading arrives later as TEMPERATURE/HUMIDITY_READ_EVENT
+            dhtSensor.startConversion();
+            break;
+        case CONTROL_TASK_ID: {
+            PROFILE_SPAN("control");
+            processTemperatureHumidity();
+            processMotionDetection();
+            processGasDetection();
+            publishSample();
+            break;
+        }
+        case TELEMETRY_TASK_ID:
+            drainSamples();
+            if (!batching) {
+                sendSensorData();
+            }
+            break;
+        case HTTP_UPLOAD_TASK_ID:
+            drainSamples();
+            sendSensorDataHTTP(); // También enviar por HTTP
+            break;
+        case STATS_REPORT_TASK_ID:
+            reportTaskStats();
+            break;
+        case JOURNAL_REPLAY_TASK_ID:
+            replayJournal();
+            break;
+        case METRICS_TASK_ID:
+            publishMetrics();
+            break;
+    }
+}
+
+void SmartSuiteDevice::reportTaskStats() {
+    LOG_INFO("=== TASK STATS ===");
+    reportSchedulerStats(scheduler);
+    reportSchedulerStats(networkScheduler);
+    LOG_INFO("Dropped samples/alerts/commands/logs: %u/%u/%u/%lu", sampleRing.getDroppedCount(),
+             alertRing.getDroppedCount(), commandRing.getDroppedCount(), Logger::getDroppedCount());
+    AlertStats alerts = alertAggregator.getStats();
+    LOG_INFO("Alerts: received=%lu queued=%lu suppressed=%lu dropped=%lu", alerts.received, alerts.queued,
+             alerts.suppressed, alerts.dropped);
+    if (reportByException) {
+        LOG_INFO("Report by exception: suppressed=%lu", suppressedSamples);
+    }
+    MotionLatencyStats motion = pirSensor.getLatencyStats();
+    LOG_INFO("PIR: events=%lu droppedEdges=%u lastLatency=%luus maxLatency=%luus avgLatency=%luus", motion.events,
+             motion.droppedEdges, motion.lastLatency, motion.maxLatency,
+             motion.events > 0 ? motion.totalLatency / motion.events : 0UL);
+    if (journal.isReady()) {
+        LOG_INFO("Journal: pending=%u overwritten=%u corrupt=%u", journal.getPendingCount(),
+                 journal.getOverwrittenCount(), journal.getCorruptCount());
+    }
+    UploadStats upload = httpUploader.getStats();
+    LOG_INFO("HTTP: requests=%lu failures=%lu samples=%lu retried=%lu dropped=%lu", upload.requests,
+             upload.failures, upload.samplesSent, upload.retried, upload.dropped);
+    LOG_INFO("HTTP: lastLatency=%lums maxLatency=%lums avgLatency=%lums", upload.lastLatency, upload.maxLatency,
+             upload.requests > 0 ? upload.totalLatency / upload.requests : 0UL);
+    LOG_INFO("==================");
+}
+
+void SmartSuiteDevice::reportSchedulerStats(const Scheduler& taskScheduler) {
+    for (int i = 0; i < taskScheduler.getTaskCount(); i++) {
+        int taskId = taskScheduler.getTaskId(i);
+        const TaskStats* stats = taskScheduler.getStats(taskId);
+        if (stats == nullptr || stats->runs == 0) {
+            continue;
+        }
+        LOG_INFO("Task %d: runs=%lu overruns=%lu maxRun=%lums maxLate=%lums avgLate=%lums", taskId, stats->runs,
+                 stats->overruns, stats->maxRunTime, stats->maxLateness, stats->totalLateness / stats->runs);
     }
-    
-    // Small delay for system stability
-    delay(100);
 }
 
 void SmartSuiteDevice::on(Event event) {
-    if (event == DhtSensor::TEMPERATURE_READ_EVENT || event == DhtSensor::HUMIDITY_READ_EVENT) {
-        processTemperatureHumidity();
+    // A chain beats an ID-indexed table here: the handlers inline and scheduler jobs, the
+    // most frequent events, are matched first (see `program --micro dispatch`)
+    if (event.id >= MQTT_KEEPALIVE_TASK_ID && event.id <= METRICS_TASK_ID) {
+        runTask(event.id);
+    } else if (event.id >= ConnectionManager::WIFI_CONNECTED_EVENT_ID &&
+               event.id <= ConnectionManager::MQTT_DISCONNECTED_EVENT_ID) {
+        handleConnectionEvent(event);
+    } else if (event == DhtSensor::TEMPERATURE_READ_EVENT) {
+        // Humidity follows from the same frame; react once both values are in
+    } else if (event == DhtSensor::HUMIDITY_READ_EVENT) {
+        onClimateRead(event);
     } else if (event == PirSensor::MOTION_DETECTED_EVENT) {
-        ledBlue.handle(Led::TURN_ON_COMMAND);
-        sendAlert("motion", "medium", "Motion detected in the area");
+        onMotionDetected(event);
     } else if (event == PirSensor::MOTION_STOPPED_EVENT) {
-        ledBlue.handle(Led::TURN_OFF_COMMAND);
-    } else if (event == Mq2Sensor::GAS_MEDIUM_EVENT) {
-        processGasDetection();
-        sendAlert("smoke", "medium", ("Gas level detected: " + String(mq2Sensor.getGasLevel()) + " ppm").c_str());
-    } else if (event == Mq2Sensor::GAS_HIGH_EVENT) {
-        processGasDetection();
-        sendAlert("smoke", "high", ("High gas level detected: " + String(mq2Sensor.getGasLevel()) + " ppm").c_str());
+        onMotionStopped(event);
+    } else if (event == Mq2Sensor::GAS_MEDIUM_EVENT || event == Mq2Sensor::GAS_HIGH_EVENT) {
+        onGasDetected(event);
     } else if (event == Mq2Sensor::GAS_CLEAR_EVENT) {
-        ledAlert.handle(Led::TURN_OFF_COMMAND);
-        servo2.handle(ServoActuator::MOVE_TO_0_COMMAND);
+        onGasClear(event);
+    } else if (event == ServoActuator::POSITION_EVENT || event == ServoActuator::ARRIVED_EVENT) {
+        onServoMoved(event);
+    }
+}
+
+void SmartSuiteDevice::onClimateRead(const Event&) {
+    processTemperatureHumidity();
+    publishSample();
+}
+
+void SmartSuiteDevice::onMotionDetected(const Event&) {
+    ledBlue.apply(Led::TURN_ON_COMMAND);
+    sendAlert("motion", "medium", "Motion detected in the area");
+}
+
+void SmartSuiteDevice::onMotionStopped(const Event&) {
+    ledBlue.apply(Led::TURN_OFF_COMMAND);
+}
+
+void SmartSuiteDevice::onGasDetected(const Event& event) {
+    processGasDetection();
+    char message[AlertRecord::MESSAGE_SIZE];
+    if (event == Mq2Sensor::GAS_HIGH_EVENT) {
+        snprintf(message, sizeof(message), "High gas level detected: %.2f ppm", event.value);
+        sendAlert("smoke", "high", message);
+    } else {
+        snprintf(message, sizeof(message), "Gas level detected: %.2f ppm", event.value);
+        sendAlert("smoke", "medium", message);
+    }
+}
+
+void SmartSuiteDevice::onGasClear(const Event&) {
+    processGasDetection();
+}
+
+void SmartSuiteDevice::onServoMoved(const Event& event) {
+    // Progress goes out with the telemetry; arrival is also logged
+    publishSample();
+    if (event == ServoActuator::ARRIVED_EVENT) {
+        LOG_INFO("Servo on pin %d arrived at %.0f", event.sourceId, event.value);
     }
 }
 
 void SmartSuiteDevice::handle(Command command) {
     // Handle actuator feedback or logging
-    Serial.print("Command executed: ");
-    Serial.println(command.id);
+    (void)command; // Only read by LOG_DEBUG, which may be compiled out
+    LOG_DEBUG("Command executed: %d", command.id);
 }
 
 void SmartSuiteDevice::setWiFiCredentials(const char* ssid, const char* password) {
     wifiSSID = ssid;
     wifiPassword = password;
+    connectionTransport.setCredentials(ssid, password);
 }
 
 void SmartSuiteDevice::setMQTTConfig(const char* broker, int port, const char* topicData, 
@@ -138,184 +474,358 @@ void SmartSuiteDevice::setMQTTConfig(const char* broker, int port, const char* t
     mqttTopicData = topicData;
     mqttTopicServoCommand = topicServoCommand;
     mqttTopicAlerts = topicAlerts;
+    mqttClient.setServer(mqttBroker, mqttPort);
+    configureTopics();
+    configureBatch();
 }
 
-void SmartSuiteDevice::setHTTPEndpoint(const char* endpoint) {
-    httpEndpoint = endpoint;
+void SmartSuiteDevice::setClientId(const char* id) {
+    clientId = id;
+    connectionTransport.setClientId(clientId);
+    httpUploader.setSourceInfo(clientId, "smartsuite-esp32");
+}
+
+void SmartSuiteDevice::setPayloadFormats(PayloadFormat data, PayloadFormat alerts) {
+    dataFormat = data;
+    alertFormat = alerts;
+    configureBatch();
 }
 
-void SmartSuiteDevice::setupWiFi() {
-    delay(10);
-    Serial.println();
-    Serial.print("Connecting to ");
-    Serial.println(wifiSSID);
+void SmartSuiteDevice::setReportByException(bool enabled, unsigned long maxSilence) {
+    reportByException = enabled;
+    changeDetector.setMaxSilence(maxSilence);
+    changeDetector.reset();
+    networkScheduler.setPeriod(TELEMETRY_TASK_ID, enabled ? EXCEPTION_CHECK_PERIOD : mqttInterval);
+}
 
-    WiFi.begin(wifiSSID, wifiPassword);
+void SmartSuiteDevice::setDeadband(ChangeDetector::Field field, float absolute, float percent) {
+    changeDetector.setDeadband(field, absolute, percent);
+}
 
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
+void SmartSuiteDevice::setBatching(bool enabled, int maxSamples, unsigned long maxAge) {
+    batching = enabled;
+    batchSize = maxSamples;
+    batchInterval = maxAge;
+    if (enabled && mqttClient.getBufferSize() < MQTT_BATCH_BUFFER_SIZE) {
+        mqttClient.setBufferSize(MQTT_BATCH_BUFFER_SIZE);
     }
+    configureBatch();
+}
 
-    Serial.println("");
-    Serial.println("WiFi connected");
-    Serial.println("IP address: ");
-    Serial.println(WiFi.localIP());
+void SmartSuiteDevice::setRulesTopic(const char* topic) {
+    mqttTopicRules = topic;
+    configureTopics();
 }
 
-void SmartSuiteDevice::reconnectMQTT() {
-    while (!mqttClient.connected()) {
-        Serial.print("Attempting MQTT connection...");
-        
-        if (mqttClient.connect(clientId)) {
-            Serial.println("connected");
-            mqttClient.subscribe(mqttTopicServoCommand);
-            Serial.println("Subscribed to: " + String(mqttTopicServoCommand));
-        } else {
-            Serial.print("failed, rc=");
-            Serial.print(mqttClient.state());
-            Serial.println(" trying again in 5 seconds");
-            delay(5000);
-        }
-    }
+void SmartSuiteDevice::setMetricsTopic(const char* topic) {
+    mqttTopicMetrics = topic;
+}
+
+void SmartSuiteDevice::setResponseTopic(const char* topic) {
+    mqttTopicServoResponse = topic;
 }
 
-void SmartSuiteDevice::handleMQTTMessage(char* topic, byte* payload, unsigned int length) {
-    Serial.print("Message received on topic: ");
-    Serial.println(topic);
+void SmartSuiteDevice::setHTTPEndpoint(const char* endpoint) {
+    httpEndpoint = endpoint;
+    httpUploader.setEndpoint(endpoint);
+}
 
-    // Convert payload to string
-    String message;
-    for (int i = 0; i < length; i++) {
-        message += (char)payload[i];
+void SmartSuiteDevice::handleConnectionEvent(const Event& event) {
+    if (event == ConnectionManager::WIFI_CONNECTED_EVENT) {
+        httpUploader.setLinkAvailable(true);
+        LOG_INFO("WiFi connected to %s, IP address: %s", wifiSSID, WiFi.localIP().toString().c_str());
+    } else if (event == ConnectionManager::WIFI_DISCONNECTED_EVENT) {
+        httpUploader.setLinkAvailable(false);
+        LOG_WARN("WiFi connection lost - reconnecting in background");
+    } else if (event == ConnectionManager::MQTT_CONNECTED_EVENT) {
+        subscribeTopics();
+        changeDetector.reset(); // Start the new session with a full report
+        LOG_INFO("MQTT connected, subscribed to: %s", mqttTopicServoCommand);
+    } else if (event == ConnectionManager::MQTT_DISCONNECTED_EVENT) {
+        LOG_WARN("MQTT connection lost, rc=%d", mqttClient.state());
     }
-    Serial.println("Message: " + message);
+}
 
-    // Process servo commands
-    if (String(topic) == mqttTopicServoCommand) {
-        DynamicJsonDocument doc(1024);
-        deserializeJson(doc, message);
-        
-        if (doc.containsKey("position")) {
-            int position = doc["position"];
-            int servoNumber = doc.containsKey("servo") ? doc["servo"] : 1;
-            
-            if (servoNumber == 1 && position >= 0 && position <= 180) {
-                servo1.setTargetPosition(position);
-                servo1.handle(ServoActuator::MOVE_TO_POSITION_COMMAND);
-                Serial.println("Servo 1 moved to position: " + String(position));
-            } else if (servoNumber == 2 && position >= 0 && position <= 180) {
-                servo2.setTargetPosition(position);
-                servo2.handle(ServoActuator::MOVE_TO_POSITION_COMMAND);
-                Serial.println("Servo 2 moved to position: " + String(position));
+void SmartSuiteDevice::configureTopics() {
+    topicRouter.clear();
+    topicRouter.add(mqttTopicServoCommand, SERVO_COMMAND_TOPIC_ID);
+    topicRouter.add(mqttTopicRules, RULES_TOPIC_ID);
+}
+
+void SmartSuiteDevice::subscribeTopics() {
+    transport->subscribe(mqttTopicServoCommand);
+    transport->subscribe(mqttTopicRules);
+}
+
+void SmartSuiteDevice::onMessage(char* topic, uint8_t* payload, size_t length) {
+    PROFILE_SPAN("mqttMessage");
+    LOG_DEBUG("Message received on topic: %s, bytes: %u", topic, (unsigned)length);
+
+    // The payload is read in place from the transport's buffer; nothing is copied or allocated
+    switch (topicRouter.route(topic)) {
+        case SERVO_COMMAND_TOPIC_ID: {
+            ServoCommandRecord command;
+            CommandParseResult result = CommandParser::parseServoCommand(payload, length, command);
+            if (result != COMMAND_PARSE_OK) {
+                LOG_WARN("Servo command rejected: %d", (int)result);
+                sendCommandResponse("rejected", nullptr, result);
+                break;
             }
+            // Servos belong to the control side; hand the request over instead of moving them here
+            if (commandRing.push(command)) {
+                sendCommandResponse("accepted", &command, result);
+            } else {
+                LOG_WARN("Servo command queue full - command dropped");
+                sendCommandResponse("busy", &command, result);
+            }
+            break;
         }
+        case RULES_TOPIC_ID:
+            // Rules belong to the control side too; it loads the table on its next evaluation
+            if (rulesPending.load(std::memory_order_acquire)) {
+                LOG_WARN("Rules update already pending - message dropped");
+            } else if (length > RuleConfig::MAX_JSON_SIZE) {
+                LOG_WARN("Rules message too large - message dropped");
+            } else {
+                memcpy(pendingRules, payload, length);
+                pendingRules[length] = '\0';
+                pendingRulesLength = length;
+                rulesPending.store(true, std::memory_order_release);
+            }
+            break;
+    }
+}
+
+void SmartSuiteDevice::sendCommandResponse(const char* status, const ServoCommandRecord* command,
+                                           CommandParseResult result) {
+    // Sent from the message callback: the command has been read, so the client buffer is free
+    char response[80];
+    int length;
+    if (command != nullptr) {
+        length = snprintf(response, sizeof(response), "{\"servo\":%u,\"position\":%d,\"status\":\"%s\"}",
+                          (unsigned)command->servo, (int)command->position, status);
+    } else {
+        length = snprintf(response, sizeof(response), "{\"status\":\"%s\",\"reason\":\"%s\"}", status,
+                          PARSE_RESULT_NAMES[result]);
+    }
+    if (!transport->publish(mqttTopicServoResponse, (const uint8_t*)response, length)) {
+        LOG_WARN("Servo command response not sent");
     }
 }
 
 void SmartSuiteDevice::sendSensorData() {
-    DynamicJsonDocument doc(1024);
-    
-    float temp = dhtSensor.getTemperature();
-    float hum = dhtSensor.getHumidity();
-    
-    // Handle sensor failures with error values (-999)
-    float tempToSend = !isnan(temp) ? temp : -999.0;  // -999 indicates error
-    float humToSend = !isnan(hum) ? hum : -999.0;     // -999 indicates error
-    
-    doc["temperature"] = tempToSend;
-    doc["humidity"] = humToSend;
-    doc["motionDetected"] = pirSensor.getMotionState();
-    doc["smokeLevel"] = mq2Sensor.getGasLevel();
-    doc["servoPosition"] = servo1.getCurrentPosition();
-    doc["servo2Position"] = servo2.getCurrentPosition();
-    doc["timestamp"] = millis();
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    
-    Serial.println("=== SENDING MQTT DATA ===");
-    Serial.println("Topic: " + String(mqttTopicData));
-    Serial.println("Data: " + jsonString);
+    // Values come from the newest sample handed over by the acquisition side
+    if (lastSample.sequence == 0) {
+        return;
+    }
+    unsigned long now = millis();
+    if (reportByException) {
+        if (!changeDetector.shouldReport(lastSample, now)) {
+            suppressedSamples++;
+            return;
+        }
+        changeDetector.markReported(lastSample, now);
+    }
+    if (!transport->isConnected()) {
+        journalSample(lastSample);
+        return;
+    }
+    size_t length;
+    const uint8_t* payload = encodeSample(lastSample, telemetryEncoder, length);
+    if (payload == nullptr) {
+        LOG_ERROR("Telemetry encoding failed");
+        return;
+    }
     
-    if (mqttClient.publish(mqttTopicData, jsonString.c_str())) {
-        Serial.println("✅ Data sent successfully");
+    bool sent;
+    {
+        PROFILE_SPAN("publish");
+        sent = transport->publish(mqttTopicData, payload, length);
+    }
+    if (sent) {
+        LOG_DEBUG("Data sent to %s, %s bytes: %u", mqttTopicData, dataFormat == PAYLOAD_JSON ? "JSON" : "CBOR", length);
     } else {
-        Serial.println("❌ Error sending data - MQTT state: " + String(mqttClient.state()));
+        LOG_ERROR("Error sending data to %s", mqttTopicData);
+        journalSample(lastSample);
     }
-    Serial.println("============================");
 }
 
-void SmartSuiteDevice::sendAlert(const char* type, const char* severity, const char* message) {
-    DynamicJsonDocument doc(512);
+const uint8_t* SmartSuiteDevice::encodeSample(const SensorSample& sample, TelemetryEncoder& jsonEncoder,
+                                              size_t& length) {
+    PROFILE_SPAN("encode");
+    if (dataFormat == PAYLOAD_CBOR) {
+        if (!binaryEncoder.encode(sample)) {
+            return nullptr;
+        }
+        return binaryEncoder.payload(length);
+    }
+    if (!jsonEncoder.encode(sample)) {
+        return nullptr;
+    }
+    return (const uint8_t*)jsonEncoder.mqttPayload(length);
+}
+
+void SmartSuiteDevice::configureBatch() {
+    // The PubSubClient buffer also holds the fixed header, the topic and its length
+    size_t overhead = 5 + 2 + strlen(mqttTopicData);
+    sampleBatch.configure(dataFormat, MQTT_BATCH_BUFFER_SIZE - overhead);
+}
+
+void SmartSuiteDevice::batchSample(const SensorSample& sample) {
+    if (sampleBatch.isEmpty()) {
+        batchStartTime = millis();
+    }
+    if (!sampleBatch.add(sample)) {
+        flushBatch(); // Would not fit the MQTT buffer
+        batchStartTime = millis();
+        sampleBatch.add(sample);
+    }
+    if (sampleBatch.getCount() >= batchSize) {
+        flushBatch();
+    }
+}
+
+void SmartSuiteDevice::flushBatch() {
+    if (sampleBatch.isEmpty()) {
+        return;
+    }
     
-    doc["type"] = type;
-    doc["severity"] = severity;
-    doc["message"] = message;
-    doc["timestamp"] = millis();
+    size_t length;
+    const uint8_t* payload = sampleBatch.encode(length);
+    if (length > 0 && transport->isConnected() && transport->publish(mqttTopicData, payload, length)) {
+        LOG_DEBUG("Batch sent, samples: %d, bytes: %u", sampleBatch.getCount(), length);
+    } else {
+        // Keep the samples for replay; the journal publishes them one by one
+        for (int i = 0; i < sampleBatch.getCount(); i++) {
+            journalSample(sampleBatch.getSample(i));
+        }
+    }
+    sampleBatch.clear();
+}
+
+void SmartSuiteDevice::journalSample(const SensorSample& sample) {
+    // A sample is journaled once, however many telemetry periods pass without a new one
+    if (!journal.isReady() || sample.sequence == journaledSequence) {
+        return;
+    }
+    if (journal.append(sample)) {
+        journaledSequence = sample.sequence;
+    }
+}
+
+void SmartSuiteDevice::replayJournal() {
+    if (!journal.isReady() || !transport->isConnected()) {
+        return;
+    }
     
-    String jsonString;
-    serializeJson(doc, jsonString);
+    // A few samples per period: the backlog drains without delaying live telemetry
+    SensorSample sample;
+    for (int i = 0; i < JOURNAL_REPLAY_BATCH && journal.peek(sample); i++) {
+        size_t length;
+        const uint8_t* payload = encodeSample(sample, replayEncoder, length);
+        if (payload == nullptr) {
+            journal.markReplayed(); // Unencodable, skip it rather than block the backlog
+            continue;
+        }
+        if (!transport->publish(mqttTopicData, payload, length)) {
+            return; // Retried on the next period
+        }
+        journal.markReplayed();
+    }
+    if (journal.getPendingCount() > 0) {
+        LOG_DEBUG("Journal replay, samples pending: %u", journal.getPendingCount());
+    }
+}
+
+void SmartSuiteDevice::sendAlert(const char* type, const char* severity, const char* message) {
+    // Alerts are raised by the control side; the network side publishes them
+    AlertRecord alert;
+    strncpy(alert.type, type, sizeof(alert.type) - 1);
+    alert.type[sizeof(alert.type) - 1] = '\0';
+    strncpy(alert.severity, severity, sizeof(alert.severity) - 1);
+    alert.severity[sizeof(alert.severity) - 1] = '\0';
+    strncpy(alert.message, message, sizeof(alert.message) - 1);
+    alert.message[sizeof(alert.message) - 1] = '\0';
+    alert.timestamp = millis();
+    
+    if (!alertRing.push(alert)) {
+        LOG_WARN("Alert queue full - alert dropped");
+    }
+}
+
+void SmartSuiteDevice::collectAlerts() {
+    // Repeats are counted here, so the ring never fills with the same alert
+    uint32_t now = millis();
+    AlertRecord alert;
+    while (alertRing.pop(alert)) {
+        alertAggregator.submit(alert, now);
+    }
+    alertAggregator.update(now);
+}
+
+void SmartSuiteDevice::publishAlerts() {
+    // Keep alerts queued until the broker is reachable
+    if (!transport->isConnected()) {
+        return;
+    }
     
-    if (mqttClient.publish(mqttTopicAlerts, jsonString.c_str())) {
-        Serial.println("Alert sent: " + jsonString);
-    } else {
-        Serial.println("Error sending alert");
+    const AlertRecord* alert;
+    while ((alert = alertAggregator.peek()) != nullptr) {
+        size_t length;
+        const uint8_t* payload;
+        if (alertFormat == PAYLOAD_CBOR) {
+            binaryEncoder.encode(*alert);
+            payload = binaryEncoder.payload(length);
+        } else {
+            telemetryEncoder.encode(*alert);
+            payload = reinterpret_cast<const uint8_t*>(telemetryEncoder.mqttPayload(length));
+        }
+        
+        if (length == 0 || !transport->publish(mqttTopicAlerts, payload, length)) {
+            LOG_ERROR("Error sending alert");
+            return; // Kept queued; retried on the next pass
+        }
+        LOG_INFO("Alert sent: %s", alert->message);
+        alertAggregator.pop();
     }
 }
 
+void SmartSuiteDevice::publishMetrics() {
+#if PROFILING_ENABLED
+    unsigned long now = millis();
+    size_t capacity;
+    uint8_t* buffer = transport->isConnected() ? transport->acquire(capacity) : nullptr;
+    if (buffer == nullptr) {
+        return; // Keep accumulating; the next window covers the outage too
+    }
+    // Encoded straight into the transport's buffer, which sends it without another copy
+    size_t length = profiler.encode((char*)buffer, capacity, now - metricsWindowStart);
+    if (length == 0) {
+        transport->release();
+        LOG_WARN("Metrics do not fit in %u bytes - window dropped", (unsigned)capacity);
+    } else if (!transport->commit(mqttTopicMetrics, length)) {
+        LOG_ERROR("Error sending metrics");
+        return;
+    }
+    profiler.reset();
+    metricsWindowStart = now;
+#endif
+}
+
 void SmartSuiteDevice::processTemperatureHumidity() {
     float temp = dhtSensor.getTemperature();
     float hum = dhtSensor.getHumidity();
     
     if (!isnan(temp) && !isnan(hum)) {
-        Serial.print("Temperature: ");
-        Serial.print(temp);
-        Serial.print(" °C\tHumidity: ");
-        Serial.print(hum);
-        Serial.println(" %");
-        
-        // Control LEDs based on climate conditions
-        if (temp < 18 || hum < 40) {
-            ledRed.handle(Led::TURN_ON_COMMAND);
-            ledGreen.handle(Led::TURN_OFF_COMMAND);
-            ledOrange.handle(Led::TURN_OFF_COMMAND);
-        } else if (temp > 28 || hum > 70) {
-            ledRed.handle(Led::TURN_OFF_COMMAND);
-            ledGreen.handle(Led::TURN_OFF_COMMAND);
-            ledOrange.handle(Led::TURN_ON_COMMAND);
-        } else {
-            ledRed.handle(Led::TURN_OFF_COMMAND);
-            ledGreen.handle(Led::TURN_ON_COMMAND);
-            ledOrange.handle(Led::TURN_OFF_COMMAND);
-        }
+        LOG_DEBUG("Temperature: %.2f °C\tHumidity: %.2f %%", temp, hum);
         
-        // Control Servo 1 for high temperature
-        if (temp > 32) {
-            if (servo1.getCurrentPosition() != 90) {
-                servo1.handle(ServoActuator::MOVE_TO_90_COMMAND);
-                sendAlert("temperature", "high", ("High temperature detected: " + String(temp) + "°C").c_str());
-            }
-        } else {
-            if (servo1.getCurrentPosition() != 0) {
-                servo1.handle(ServoActuator::MOVE_TO_0_COMMAND);
-            }
-        }
+        // Climate LEDs and the Servo 1 cooling rule
+        evaluateRules();
     } else {
-        // More detailed error information
-        Serial.println("DHT11 sensor error - attempting to retry reading...");
-        
-        // Try to read the sensor directly one more time
-        if (dhtSensor.readSensor()) {
-            Serial.println("DHT11 retry successful!");
-        } else {
-            Serial.println("DHT11 retry failed - check sensor connections, power, and timing");
-            Serial.println("Troubleshooting tips:");
-            Serial.println("- Ensure DHT11 is connected to pin 4");
-            Serial.println("- Check 3.3V/5V power supply");
-            Serial.println("- Verify pull-up resistor (10kΩ) on data line");
-            Serial.println("- Sensor may need more time between readings");
-        }
+        // No valid reading yet; the next conversion is the retry
+        // Troubleshooting tips are in the README rather than on every failed tick
+        LOG_WARN("DHT11 sensor error - timeouts: %lu, checksum errors: %lu; check wiring on pin %d, power and pull-up",
+                 dhtSensor.getTimeoutCount(), dhtSensor.getChecksumErrorCount(), DHT_PIN);
     }
 }
 
@@ -326,106 +836,92 @@ void SmartSuiteDevice::processMotionDetection() {
 }
 
 void SmartSuiteDevice::processGasDetection() {
-    static bool gasAlertActive = false;  // Variable estática para controlar el estado
-    static unsigned long lastServoAction = 0;  // Tiempo de la última acción del servo
-    const unsigned long servoDebounceTime = 5000;  // 5 segundos entre movimientos
+    LOG_DEBUG("MQ2 Estimated smoke level: %.2f ppm", mq2Sensor.getGasLevel());
     
-    float ppm = mq2Sensor.getGasLevel();
-    
-    Serial.print("MQ2 Estimated smoke level: ");
-    Serial.print(ppm);
-    Serial.println(" ppm");
-    
-    unsigned long currentTime = millis();
-    
-    if (ppm > 300) {
-        // Solo activar si no está ya activo o ha pasado suficiente tiempo
-        if (!gasAlertActive || (currentTime - lastServoAction > servoDebounceTime)) {
-            ledAlert.handle(Led::TURN_ON_COMMAND);
-            
-            // Solo mover el servo si no está ya en la posición correcta
-            if (servo2.getCurrentPosition() != 90) {
-                servo2.handle(ServoActuator::MOVE_TO_90_COMMAND);
-                lastServoAction = currentTime;
-                gasAlertActive = true;
-                
-                String severity = ppm > 600 ? "high" : "medium";
-                sendAlert("smoke", severity.c_str(), ("Smoke level detected: " + String(ppm) + " ppm").c_str());
-                
-                Serial.println("🚨 Servo2 moved to 90° - Gas detection mode activated");
-            }
-        }
+    // Alert LED and Servo 2, with the hold time between movements kept by the rule
+    evaluateRules();
+}
+
+void SmartSuiteDevice::evaluateRules() {
+    PROFILE_SPAN("rules");
+    loadPendingRules();
+    ruleEngine.setField(RULE_FIELD_TEMPERATURE, dhtSensor.getTemperature());
+    ruleEngine.setField(RULE_FIELD_HUMIDITY, dhtSensor.getHumidity());
+    ruleEngine.setField(RULE_FIELD_SMOKE, mq2Sensor.getGasLevel());
+    ruleEngine.setField(RULE_FIELD_MOTION, pirSensor.getMotionState() ? 1 : 0);
+    ruleEngine.evaluate(millis(), *this);
+}
+
+void SmartSuiteDevice::loadRules() {
+    // Rules received over MQTT are kept in NVS; without them the compiled-in table applies
+    Preferences preferences;
+    size_t length = 0;
+    if (preferences.begin(RULES_NAMESPACE, true)) {
+        length = preferences.getString(RULES_KEY, pendingRules, sizeof(pendingRules));
+        preferences.end();
+    }
+    int count = -1;
+    if (length > 0) {
+        count = RuleConfig::load(pendingRules, strlen(pendingRules), ruleEngine);
+    }
+    if (count < 0) {
+        count = RuleConfig::load(RuleConfig::DEFAULT_RULES, strlen(RuleConfig::DEFAULT_RULES), ruleEngine);
+        LOG_INFO("Control rules: defaults, %d rules", count);
     } else {
-        // Solo desactivar si estaba activo y ha pasado suficiente tiempo
-        if (gasAlertActive && (currentTime - lastServoAction > servoDebounceTime)) {
-            ledAlert.handle(Led::TURN_OFF_COMMAND);
-            
-            // Solo mover el servo si no está ya en la posición correcta
-            if (servo2.getCurrentPosition() != 0) {
-                servo2.handle(ServoActuator::MOVE_TO_0_COMMAND);
-                lastServoAction = currentTime;
-                gasAlertActive = false;
-                
-                Serial.println("✅ Servo2 moved to 0° - Gas cleared");
-            }
-        }
+        LOG_INFO("Control rules: stored, %d rules", count);
     }
 }
 
-void SmartSuiteDevice::sendSensorDataHTTP() {
-    // Only send HTTP data if WiFi is connected
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("❌ WiFi not connected - skipping HTTP data send");
+void SmartSuiteDevice::loadPendingRules() {
+    if (!rulesPending.load(std::memory_order_acquire)) {
         return;
     }
-    
-    DynamicJsonDocument doc(1024);
-    
-    float temp = dhtSensor.getTemperature();
-    float hum = dhtSensor.getHumidity();
-    
-    // Handle sensor failures with error values (-999)
-    float tempToSend = !isnan(temp) ? temp : -999.0;  // -999 indicates error
-    float humToSend = !isnan(hum) ? hum : -999.0;     // -999 indicates error
-    
-    doc["temperature"] = tempToSend;
-    doc["humidity"] = humToSend;
-    doc["motionDetected"] = pirSensor.getMotionState();
-    doc["smokeLevel"] = mq2Sensor.getGasLevel();
-    doc["servoPosition"] = servo1.getCurrentPosition();
-    doc["servo2Position"] = servo2.getCurrentPosition();
-    doc["timestamp"] = millis();
-    doc["deviceId"] = clientId;
-    doc["source"] = "smartsuite-esp32";
-    
-    String jsonString;
-    serializeJson(doc, jsonString);
-    
-    Serial.println("=== SENDING HTTP DATA ===");
-    Serial.println("Endpoint: " + String(httpEndpoint));
-    Serial.println("Data: " + jsonString);
-    
-    httpClient.begin(httpEndpoint);
-    httpClient.addHeader("Content-Type", "application/json");
-    httpClient.addHeader("User-Agent", "SmartSuite-ESP32/1.0");
-    
-    int httpResponseCode = httpClient.POST(jsonString);
-    
-    if (httpResponseCode > 0) {
-        String response = httpClient.getString();
-        Serial.println("✅ HTTP Response code: " + String(httpResponseCode));
-        Serial.println("📡 Response: " + response);
+    int count = RuleConfig::load(pendingRules, pendingRulesLength, ruleEngine);
+    if (count < 0) {
+        LOG_ERROR("Rules rejected - keeping the current rules");
     } else {
-        Serial.println("❌ HTTP Error code: " + String(httpResponseCode));
-        Serial.println("🔧 Check network connection and endpoint URL");
+        Preferences preferences;
+        if (preferences.begin(RULES_NAMESPACE, false)) {
+            preferences.putString(RULES_KEY, pendingRules);
+            preferences.end();
+        }
+        LOG_INFO("Rules updated: %d", count);
+    }
+    rulesPending.store(false, std::memory_order_release);
+}
+
+void SmartSuiteDevice::applyRuleAction(const RuleAction& action) {
+    if (action.type == RULE_ACTION_SERVO) {
+        ServoActuator& servo = action.target == 2 ? servo2 : servo1;
+        if (servo.getTargetPosition() != action.value) {
+            servo.apply(ServoActuator::MOVE_TO_POSITION_COMMAND.withValue(action.value));
+        }
+        return;
+    }
+    Led* leds[RuleConfig::LED_COUNT] = {&ledRed, &ledGreen, &ledOrange, &ledBlue, &ledAlert};
+    if (action.target < RuleConfig::LED_COUNT) {
+        leds[action.target]->apply(action.value ? Led::TURN_ON_COMMAND : Led::TURN_OFF_COMMAND);
     }
-    
-    httpClient.end();
-    Serial.println("============================");
 }
 
-void SmartSuiteDevice::mqttCallback(char* topic, byte* payload, unsigned int length) {
-    if (instance != nullptr) {
-        instance->handleMQTTMessage(topic, payload, length);
+void SmartSuiteDevice::raiseRuleAlert(const RuleAlert& alert, float value) {
+    char message[AlertRecord::MESSAGE_SIZE];
+    snprintf(message, sizeof(message), "%s: %.2f", alert.message, value);
+    sendAlert(alert.type, alert.severity, message);
+}
+
+void SmartSuiteDevice::sendSensorDataHTTP() {
+    if (lastSample.sequence == 0) {
+        return;
+    }
+    PROFILE_SPAN("httpEnqueue");
+    
+    // Only queues the sample; the uploader posts it from its own task over a kept-alive connection
+    httpUploader.enqueue(lastSample);
+    if (!connection.isWiFiConnected()) {
+        LOG_DEBUG("WiFi not connected - HTTP samples queued: %d", httpUploader.getQueuedCount());
+    }
+    if (!httpUploader.isTaskRunning()) {
+        httpUploader.update();
     }
 }
@@ -7,12 +7,46 @@
 #include "Mq2Sensor.h"
 #include "Led.h"
 #include "ServoActuator.h"
+#include "Scheduler.h"
+#include "SpscRing.h"
+#include "SeqlockSnapshot.h"
+#include "PipelineRecords.h"
+#include "ConnectionManager.h"
+#include "WiFiMqttTransport.h"
+#include "MessageTransport.h"
+#include "MqttMessageTransport.h"
+#include "TelemetryEncoder.h"
+#include "HttpUploader.h"
+#include "TelemetryJournal.h"
+#include "BinaryTelemetryEncoder.h"
+#include "ChangeDetector.h"
+#include "ColumnarBatchEncoder.h"
+#include "StaticGraph.h"
+#include "RuleEngine.h"
+#include "RuleConfig.h"
+#include "CommandParser.h"
+#include "TopicRouter.h"
+#include "AlertAggregator.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include <atomic>
+#include <Preferences.h>
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 
-class SmartSuiteDevice : public Device {
+/**
+ * @brief The SmartSuite room controller: DHT11, PIR and MQ2 sensors, five LEDs and two servos.
+ *
+ * Components are members wired at compile time: sensors deliver events straight to this
+ * final class and actuators are driven through their non-virtual apply(), so the hot paths
+ * make direct calls. Components still accept this device as their runtime handler for
+ * callers using the polymorphic API. The climate and smoke reactions are a RuleEngine table,
+ * replaceable at runtime over MQTT (see RuleConfig). Messages are published and received
+ * through a MessageTransport, MQTT unless another one is set.
+ */
+class SmartSuiteDevice final : public Device, public RuleActionHandler, public MessageHandler {
 private:
     // Sensors
     DhtSensor dhtSensor;
@@ -31,7 +65,12 @@ private:
     // WiFi and MQTT
     WiFiClient espClient;
     PubSubClient mqttClient;
-    HTTPClient httpClient;
+    uint8_t transportBuffer[RuleConfig::MAX_JSON_SIZE]; ///< Lent by the MQTT transport; holds the metrics.
+    MqttMessageTransport mqttTransport;
+    MessageTransport* transport; ///< Where messages are published and received.
+    HttpUploader httpUploader;
+    WiFiMqttTransport connectionTransport;
+    ConnectionManager connection;
     
     // Configuration
     const char* wifiSSID;
@@ -39,17 +78,58 @@ private:
     const char* mqttBroker;
     const char* mqttTopicData;
     const char* mqttTopicServoCommand;
+    const char* mqttTopicServoResponse;
     const char* mqttTopicAlerts;
+    const char* mqttTopicRules;
+    const char* mqttTopicMetrics;
+    TopicRouter topicRouter;   ///< Subscribed topics, routed by hash.
     const char* httpEndpoint;
     const char* clientId;
     int mqttPort;
     
     // Timing
-    unsigned long lastSensorRead;
-    unsigned long lastDataSent;
+    Scheduler scheduler;        ///< Acquisition and control jobs.
+    Scheduler networkScheduler; ///< MQTT and HTTP jobs.
     unsigned long sensorInterval;
     unsigned long mqttInterval;
 
+    // Hand-off between the acquisition side and the network side
+    SpscRing<SensorSample, 32> sampleRing;
+    SpscRing<AlertRecord, 16> alertRing;
+    AlertAggregator alertAggregator;  ///< Network side: repeats folded into summaries, urgent alerts first.
+    SpscRing<ServoCommandRecord, 8> commandRing;
+    SeqlockSnapshot<SensorSample> latestSample;
+    SensorSample lastSample;  ///< Newest sample seen by the network side.
+    TelemetryEncoder telemetryEncoder;
+    TelemetryJournal journal;         ///< Samples kept while MQTT is unavailable.
+    TelemetryEncoder replayEncoder;   ///< Separate so replays never evict the live encoding.
+    uint32_t journaledSequence;       ///< Last live sample written to the journal.
+    BinaryTelemetryEncoder binaryEncoder;
+    PayloadFormat dataFormat;
+    PayloadFormat alertFormat;
+    ChangeDetector changeDetector;
+    bool reportByException;
+    unsigned long suppressedSamples; ///< Samples not published because nothing changed.
+    ColumnarBatchEncoder sampleBatch;
+    bool batching;
+    int batchSize;
+    unsigned long batchInterval;
+    unsigned long batchStartTime;    ///< Arrival of the oldest sample in the batch.
+    uint32_t sampleSequence;
+    bool lastMotionState;
+    bool pipelined;
+
+    // Control rules; a table received over MQTT waits here until the control side loads it
+    RuleEngine ruleEngine;
+    char pendingRules[RuleConfig::MAX_JSON_SIZE + 1];
+    size_t pendingRulesLength;
+    std::atomic<bool> rulesPending;
+
+#if PROFILING_ENABLED
+    Profiler profiler;                ///< Selected wherever the device's code runs.
+    unsigned long metricsWindowStart; ///< Span histograms are encoded into the transport's buffer.
+#endif
+
 public:
     // Pin definitions
     static const int PIR_PIN = 13;
@@ -63,6 +143,51 @@ public:
     static const int LED_BLUE_PIN = 33;
     static const int LED_ALERT_PIN = 32;
 
+    // Periodic jobs run by the scheduler
+    static const int MQTT_KEEPALIVE_TASK_ID = 900;
+    static const int PIR_POLL_TASK_ID = 901;
+    static const int MQ2_SAMPLE_TASK_ID = 902;
+    static const int DHT_READ_TASK_ID = 903;
+    static const int CONTROL_TASK_ID = 904;
+    static const int TELEMETRY_TASK_ID = 905;
+    static const int HTTP_UPLOAD_TASK_ID = 906;
+    static const int STATS_REPORT_TASK_ID = 907;
+    static const int JOURNAL_REPLAY_TASK_ID = 908;
+    static const int MQ2_ACQUIRE_TASK_ID = 909;
+    static const int SERVO_MOTION_TASK_ID = 910;
+    static const int METRICS_TASK_ID = 911;
+
+    // Subscribed topics
+    static const int SERVO_COMMAND_TOPIC_ID = 1;
+    static const int RULES_TOPIC_ID = 2;
+
+    static const unsigned long MQTT_KEEPALIVE_PERIOD = 10;
+    static const unsigned long PIR_POLL_PERIOD = 20; ///< Drains the PIR edge ring; bounds the edge-to-event latency.
+    static const unsigned long MQ2_SAMPLE_PERIOD = 500;
+    static const unsigned long MQ2_ACQUIRE_PERIOD = 20; ///< Oversampled MQ2 blocks fed to its filter.
+    static const unsigned long SERVO_MOTION_PERIOD = 20; ///< Motion profile steps, one per servo PWM frame.
+    static const int SERVO_MAX_VELOCITY = 180;  ///< Degrees per second.
+    static const int SERVO_ACCELERATION = 360;  ///< Degrees per second squared.
+    static const unsigned long STATS_REPORT_PERIOD = 60000;
+    static const unsigned long METRICS_PERIOD = 60000; ///< Span histograms published, then cleared, once a minute.
+    static const uint32_t MOTION_ALERT_WINDOW = 60000; ///< Repeated motion alerts summarized once a minute.
+    static const uint32_t SMOKE_ALERT_WINDOW = 10000;  ///< Ongoing smoke is reported again every 10 seconds.
+    static const unsigned long JOURNAL_REPLAY_PERIOD = 1000;
+    static const int JOURNAL_REPLAY_BATCH = 5; ///< Replayed samples per period, leaving room for live data.
+    static const unsigned long EXCEPTION_CHECK_PERIOD = 100; ///< Telemetry period in report-by-exception mode.
+    static const uint16_t MQTT_BATCH_BUFFER_SIZE = 1024; ///< PubSubClient buffer in batching mode.
+    static const uint16_t MQTT_RULES_BUFFER_SIZE = RuleConfig::MAX_JSON_SIZE + 128; ///< Fits a rule table message.
+    static const int MQTT_SOCKET_TIMEOUT = 2; ///< Seconds a single broker attempt may block.
+
+    // Pipelined mode tasks
+    static const int SENSOR_TASK_CORE = 1;
+    static const int NETWORK_TASK_CORE = 0;
+    static const int SENSOR_TASK_PRIORITY = 3;
+    static const int NETWORK_TASK_PRIORITY = 2;
+    static const int HTTP_TASK_PRIORITY = 1;
+    static const int LOG_TASK_PRIORITY = 1; ///< UART output of the logs, behind everything else.
+    static const int TASK_STACK_SIZE = 8192;
+
     /**
      * @brief Constructs a SmartSuiteDevice with default configuration.
      */
@@ -74,10 +199,78 @@ public:
     void begin();
 
     /**
-     * @brief Main update loop for the device.
+     * @brief Main update loop for the device. Runs the jobs that are due without blocking.
+     *
+     * On the ESP32 it then sleeps until the next job is due, at most MQTT_KEEPALIVE_PERIOD, so
+     * loop() gives the core up between ticks. Elsewhere it returns at once and the caller waits
+     * for timeUntilNextTask(). Runs no jobs in pipelined mode, where both sides run in their own
+     * tasks.
      */
     void update();
 
+    /**
+     * @brief Enables the dual-core pipelined mode. Must be called before begin().
+     *
+     * Sensor acquisition and the control rules run in a task pinned to one core while WiFi,
+     * MQTT and HTTP run in a task pinned to the other, so network stalls do not delay the
+     * reaction to gas or motion. The sides exchange samples, alerts and servo commands through
+     * lock-free rings. Only available on ESP32; ignored elsewhere.
+     * @param enabled True to run pipelined, false to run everything from update().
+     */
+    void setPipelined(bool enabled);
+
+    /**
+     * @brief Sets the storage of the offline telemetry journal. Must be called before begin().
+     *
+     * Samples that cannot be published over MQTT are appended to the journal and replayed,
+     * oldest first and a few per second, once the broker is reachable again. Without storage
+     * the device keeps only the newest sample, as before.
+     * @param storage Flash partition or file backing the journal.
+     */
+    void setJournalStorage(JournalStorage* storage);
+
+    /**
+     * @brief Sets the transport of the data, alert and metrics messages and of the servo
+     * command and rules subscriptions. Must be called before begin().
+     *
+     * The WiFi and MQTT connection is still managed as usual, and HTTP uploads are unaffected.
+     * @param messageTransport Transport to use, or nullptr for MQTT (the default).
+     */
+    void setMessageTransport(MessageTransport* messageTransport);
+
+    /**
+     * @brief Gets the scheduler running the acquisition and control jobs.
+     * @return Reference to the scheduler.
+     */
+    const Scheduler& getScheduler() const;
+
+    /**
+     * @brief Gets the scheduler running the MQTT and HTTP jobs.
+     * @return Reference to the scheduler.
+     */
+    const Scheduler& getNetworkScheduler() const;
+
+    /**
+     * @brief Gets the WiFi/MQTT connection state machine.
+     * @return Reference to the connection manager.
+     */
+    const ConnectionManager& getConnection() const;
+
+    /**
+     * @brief Gets how long update() has nothing to do: until the next job of either scheduler,
+     * or 1 ms while a DHT conversion is in progress, or 0 with servo commands waiting.
+     * Lets a host simulation jump over idle time instead of stepping through it.
+     * @return Milliseconds.
+     */
+    unsigned long timeUntilNextTask() const;
+
+    /**
+     * @brief Gets the most recent sensor sample. Safe to call from any task.
+     * @param sample Receives the sample.
+     * @return True if a sample has been taken already.
+     */
+    bool getLatestSample(SensorSample& sample) const;
+
     /**
      * @brief Handles events from sensors.
      * @param event The event to process.
@@ -90,6 +283,11 @@ public:
      */
     void handle(Command command) override;
 
+    /**
+     * @brief Handles a message on a subscribed topic. Called by the transport.
+     */
+    void onMessage(char* topic, uint8_t* payload, size_t length) override;
+
     /**
      * @brief Sets WiFi credentials.
      * @param ssid WiFi network name.
@@ -108,6 +306,98 @@ public:
     void setMQTTConfig(const char* broker, int port, const char* topicData, 
                        const char* topicServoCommand, const char* topicAlerts);
 
+    /**
+     * @brief Sets the MQTT client ID, also sent as the source of HTTP uploads.
+     *
+     * Brokers drop the older session when two clients connect with the same ID, so every
+     * device on a broker needs its own.
+     * @param id Client ID (default: "SmartSuite_ESP32").
+     */
+    void setClientId(const char* id);
+
+    /**
+     * @brief Selects the encoding of the data and alert topics.
+     *
+     * JSON is the default. CBOR (see TelemetrySchema) cuts a sample from about 150 bytes to
+     * about 25; subscribers then need TelemetryDecoder or any CBOR library. HTTP stays JSON.
+     * @param data Encoding of the sensor data topic.
+     * @param alerts Encoding of the alerts topic.
+     */
+    void setPayloadFormats(PayloadFormat data, PayloadFormat alerts);
+
+    /**
+     * @brief Enables report-by-exception publishing on the data topic.
+     *
+     * Instead of publishing every `mqttInterval`, the newest sample is checked every
+     * EXCEPTION_CHECK_PERIOD and published only when a reading moved beyond its deadband, the
+     * motion or a servo changed, or `maxSilence` elapsed since the last report. Offline samples
+     * are journaled under the same rule.
+     * @param enabled True to publish by exception, false to publish periodically.
+     * @param maxSilence Heartbeat interval in milliseconds.
+     */
+    void setReportByException(bool enabled, unsigned long maxSilence = ChangeDetector::DEFAULT_MAX_SILENCE);
+
+    /**
+     * @brief Sets the deadband of a reading in report-by-exception mode.
+     * @param field Reading to configure.
+     * @param absolute Change in the reading's units that triggers a report, 0 for none.
+     * @param percent Change in percent of the last reported value that triggers a report, 0 for none.
+     */
+    void setDeadband(ChangeDetector::Field field, float absolute, float percent);
+
+    /**
+     * @brief Enables batched publishing on the data topic.
+     *
+     * Every sample taken is collected, instead of only the newest one each `mqttInterval`, and
+     * published column-wise (see ColumnarBatchEncoder) once `maxSamples` are collected, the
+     * oldest one is `maxAge` old, the message would outgrow the MQTT buffer, or an alert is
+     * about to be published, so the data leading to it arrives first. Report-by-exception does
+     * not apply to batches. Grows the PubSubClient buffer to MQTT_BATCH_BUFFER_SIZE.
+     * @param enabled True to publish batches, false to publish single samples.
+     * @param maxSamples Samples per message (default: 20).
+     * @param maxAge Longest time a sample waits in milliseconds (default: 5000).
+     */
+    void setBatching(bool enabled, int maxSamples = 20, unsigned long maxAge = 5000);
+
+    /**
+     * @brief Sets the topic on which rule tables are received.
+     *
+     * A message with a RuleConfig JSON document replaces the control rules without a reboot
+     * and is kept in NVS, so it survives restarts; the compiled-in defaults apply until then.
+     * An invalid document is rejected and the current rules stay.
+     * @param topic Rules topic (default: "smartsuite/config/rules").
+     */
+    void setRulesTopic(const char* topic);
+
+    /**
+     * @brief Sets the topic on which span latency histograms are published.
+     *
+     * Every METRICS_PERIOD the statistics of the device's own Profiler are published as JSON
+     * and cleared. Nothing is published when built with PROFILING_ENABLED set to 0.
+     * @param topic Metrics topic (default: "smartsuite/metrics").
+     */
+    void setMetricsTopic(const char* topic);
+
+    /**
+     * @brief Sets the topic on which servo commands are answered.
+     *
+     * Each message on the command topic gets one JSON response: `accepted` with the servo and
+     * position once the command is queued for the control side, `busy` if the queue was full,
+     * or `rejected` with the parse error (`malformed`, `missing_field`, `out_of_range`).
+     * @param topic Response topic (default: "smartsuite/servo/response").
+     */
+    void setResponseTopic(const char* topic);
+
+    /**
+     * @brief Applies a rule action to the LEDs or servos. Called by the rule engine.
+     */
+    void applyRuleAction(const RuleAction& action) override;
+
+    /**
+     * @brief Raises the alert of a rule that became active. Called by the rule engine.
+     */
+    void raiseRuleAlert(const RuleAlert& alert, float value) override;
+
     /**
      * @brief Sets HTTP endpoint for data transmission.
      * @param endpoint HTTP endpoint URL.
@@ -115,18 +405,45 @@ public:
     void setHTTPEndpoint(const char* endpoint);
 
 private:
-    void setupWiFi();
-    void reconnectMQTT();
-    void handleMQTTMessage(char* topic, byte* payload, unsigned int length);
+    void onClimateRead(const Event& event);
+    void onMotionDetected(const Event& event);
+    void onMotionStopped(const Event& event);
+    void onGasDetected(const Event& event);
+    void onGasClear(const Event& event);
+    void onServoMoved(const Event& event);
+    void handleConnectionEvent(const Event& event);
+    void subscribeTopics();
+    void configureTopics();
+    void sendCommandResponse(const char* status, const ServoCommandRecord* command, CommandParseResult result);
     void sendSensorData();
     void sendSensorDataHTTP();
+    const uint8_t* encodeSample(const SensorSample& sample, TelemetryEncoder& jsonEncoder, size_t& length);
+    void journalSample(const SensorSample& sample);
+    void configureBatch();
+    void batchSample(const SensorSample& sample);
+    void flushBatch();
+    void replayJournal();
     void sendAlert(const char* type, const char* severity, const char* message);
     void processTemperatureHumidity();
     void processMotionDetection();
     void processGasDetection();
-    
-    static void mqttCallback(char* topic, byte* payload, unsigned int length);
-    static SmartSuiteDevice* instance;
+    void evaluateRules();
+    void loadRules();
+    void loadPendingRules();
+    void runTask(int taskId);
+    void reportTaskStats();
+    void reportSchedulerStats(const Scheduler& taskScheduler);
+    void publishSample();
+    void applyServoCommands();
+    void drainSamples();
+    void collectAlerts();
+    void publishAlerts();
+    void publishMetrics();
+    void runSensorSide();
+    void runNetworkSide();
+
+    static void sensorTask(void* parameter);
+    static void networkTask(void* parameter);
 };
 
 #endif // SMART_SUITE_DEVICE_H
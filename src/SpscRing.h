@@ -0,0 +1,91 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of fixed-size records.
+ *
+ * One thread (or core) calls `push()`, another calls `pop()`. Neither side ever blocks or
+ * allocates: a full ring rejects the new record and counts it as dropped. Records are copied
+ * by value, so `T` should be a small trivially copyable struct.
+ *
+ * @tparam T Record type.
+ * @tparam Capacity Number of slots, must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    /**
+     * @brief Appends a record. Producer side only.
+     * @param record The record to copy into the ring.
+     * @return True if stored, false if the ring was full and the record was dropped.
+     */
+    bool push(const T& record) {
+        uint32_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - tail.load(std::memory_order_acquire) >= Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[currentHead & (Capacity - 1)] = record;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest record. Consumer side only.
+     * @param record Receives the record.
+     * @return True if a record was available, false if the ring was empty.
+     */
+    bool pop(T& record) {
+        uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        record = slots[currentTail & (Capacity - 1)];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of records waiting. Exact only when called from either side.
+     */
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks whether no record is waiting.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Gets the number of records rejected because the ring was full.
+     */
+    uint32_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the number of slots in the ring.
+     */
+    static size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    T slots[Capacity];
+    std::atomic<uint32_t> head;    ///< Next slot to write, owned by the producer.
+    std::atomic<uint32_t> tail;    ///< Next slot to read, owned by the consumer.
+    std::atomic<uint32_t> dropped; ///< Records rejected on a full ring.
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,87 @@
+#ifndef STATIC_GRAPH_H
+#define STATIC_GRAPH_H
+
+#include "CommandHandler.h"
+
+/**
+ * @brief Compile-time list of components, the static counterpart of handler pointers.
+ *
+ * Holds references to components of unrelated types and applies a visitor to each of them.
+ * The recursion is resolved at compile time, so `forEach()` expands to one direct, inlinable
+ * call per component with no virtual dispatch. Build one with makeComponentList():
+ *
+ * @code
+ * ComponentList<PirSensor, Mq2Sensor, ServoActuator> parts(pir, mq2, servo);
+ * parts.forEach(BeginComponent());
+ * @endcode
+ *
+ * Components keep their runtime-polymorphic API (Sensor/Actuator and handlers), so the same
+ * objects can be wired statically in one device and dynamically in another.
+ */
+template<typename... Components>
+class ComponentList;
+
+template<>
+class ComponentList<> {
+public:
+    static const int SIZE = 0;
+
+    template<typename Visitor>
+    void forEach(const Visitor&) {}
+};
+
+template<typename First, typename... Rest>
+class ComponentList<First, Rest...> {
+public:
+    static const int SIZE = 1 + ComponentList<Rest...>::SIZE;
+
+    explicit ComponentList(First& first, Rest&... rest) : first(first), rest(rest...) {}
+
+    /**
+     * @brief Applies a visitor to every component, in declaration order.
+     * @param visitor Object with a `template<typename C> void operator()(C&) const`.
+     */
+    template<typename Visitor>
+    void forEach(const Visitor& visitor) {
+        visitor(first);
+        rest.forEach(visitor);
+    }
+
+private:
+    First& first;
+    ComponentList<Rest...> rest;
+};
+
+/**
+ * @brief Builds a ComponentList, deducing the component types.
+ */
+template<typename... Components>
+ComponentList<Components...> makeComponentList(Components&... components) {
+    return ComponentList<Components...>(components...);
+}
+
+/**
+ * @brief Visitor calling `begin()` on each component.
+ */
+struct BeginComponent {
+    template<typename Component>
+    void operator()(Component& component) const {
+        component.begin();
+    }
+};
+
+/**
+ * @brief Visitor applying the same command to each actuator without propagation.
+ */
+struct ApplyCommand {
+    Command command;
+
+    explicit ApplyCommand(Command command) : command(command) {}
+
+    template<typename Component>
+    void operator()(Component& component) const {
+        component.apply(command);
+    }
+};
+
+#endif // STATIC_GRAPH_H
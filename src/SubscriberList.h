@@ -0,0 +1,167 @@
+#ifndef SUBSCRIBER_LIST_H
+#define SUBSCRIBER_LIST_H
+
+#include <stddef.h>
+
+/**
+ * @brief Fixed-capacity list of subscribers, each receiving the messages its filter selects.
+ *
+ * A filter is one message ID or ANY_ID. A subscriber wanting several IDs subscribes once per
+ * ID. Nothing is allocated. Subscribing and unsubscribing are allowed from inside a dispatch,
+ * including by the subscriber being called:
+ * - a subscriber added during a dispatch starts with the next message;
+ * - one removed during a dispatch is not called again, even by that same dispatch.
+ * Removed entries are compacted once the outermost dispatch returns. Not thread-safe: use it
+ * from the task that dispatches.
+ *
+ * @tparam Subscriber EventHandler, CommandHandler or any class receiving the messages.
+ * @tparam Capacity Number of subscriptions.
+ */
+template<typename Subscriber, int Capacity>
+class SubscriberList {
+    static_assert(Capacity > 0, "a list needs room for at least one subscription");
+
+public:
+    static const int ANY_ID = -1; ///< Filter accepting every message.
+
+    SubscriberList() : count(0), depth(0), removed(false) {}
+
+    /**
+     * @brief Adds a subscription. Subscribing twice with the same filter has no effect.
+     * @param subscriber Receiver of the messages.
+     * @param id Message ID to receive, or ANY_ID for all of them.
+     * @return False if the subscriber is nullptr or the list is full.
+     */
+    bool subscribe(Subscriber* subscriber, int id = ANY_ID) {
+        if (subscriber == nullptr) {
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            if (entries[i].subscriber == subscriber && entries[i].id == id) {
+                return true;
+            }
+        }
+        if (count == Capacity) {
+            // Removed entries are only reclaimed when no dispatch is walking the list
+            if (depth > 0 || !compact()) {
+                return false;
+            }
+        }
+        entries[count].subscriber = subscriber;
+        entries[count].id = id;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Removes the subscriptions of a subscriber.
+     * @param subscriber Receiver to remove.
+     * @param id Filter to remove, or ANY_ID to remove every subscription of the subscriber.
+     * @return True if a subscription was removed.
+     */
+    bool unsubscribe(Subscriber* subscriber, int id = ANY_ID) {
+        return remove(subscriber, id, id == ANY_ID);
+    }
+
+    /**
+     * @brief Removes the one subscription whose filter is exactly `id`. Unlike unsubscribe(),
+     * ANY_ID only removes the subscription to every message, not the per-ID ones.
+     * @return True if the subscription existed.
+     */
+    bool unsubscribeFilter(Subscriber* subscriber, int id) {
+        return remove(subscriber, id, false);
+    }
+
+    /**
+     * @brief Removes every subscription.
+     */
+    void clear() {
+        for (int i = 0; i < count; i++) {
+            entries[i].subscriber = nullptr;
+        }
+        removed = true;
+        if (depth == 0) {
+            compact();
+        }
+    }
+
+    /**
+     * @brief Gets the number of subscriptions, counting removed ones until they are compacted.
+     */
+    int getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Calls a method of every subscriber whose filter accepts the message, in order of
+     * subscription.
+     * @param method Method to call, e.g. `&EventHandler::on`.
+     * @param message Message with an `int id` member.
+     * @return Number of subscribers called.
+     */
+    template<typename Message>
+    int dispatch(void (Subscriber::*method)(Message), const Message& message) {
+        // Subscriptions added by the subscribers wait for the next message
+        int end = count;
+        int delivered = 0;
+        depth++;
+        for (int i = 0; i < end; i++) {
+            Subscriber* subscriber = entries[i].subscriber;
+            if (subscriber != nullptr && (entries[i].id == ANY_ID || entries[i].id == message.id)) {
+                (subscriber->*method)(message);
+                delivered++;
+            }
+        }
+        depth--;
+        if (depth == 0 && removed) {
+            compact();
+        }
+        return delivered;
+    }
+
+private:
+    struct Entry {
+        Subscriber* subscriber; ///< nullptr once removed.
+        int id;
+    };
+
+    Entry entries[Capacity];
+    int count;
+    int depth;    ///< Nesting of dispatch() calls in progress.
+    bool removed; ///< Some entries wait for compact().
+
+    bool remove(Subscriber* subscriber, int id, bool everyFilter) {
+        bool found = false;
+        for (int i = 0; i < count; i++) {
+            if (entries[i].subscriber == subscriber && (everyFilter || entries[i].id == id)) {
+                entries[i].subscriber = nullptr;
+                found = true;
+            }
+        }
+        if (found) {
+            removed = true;
+            if (depth == 0) {
+                compact();
+            }
+        }
+        return found;
+    }
+
+    bool compact() {
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (entries[i].subscriber != nullptr) {
+                entries[kept++] = entries[i];
+            }
+        }
+        bool freed = kept < count;
+        count = kept;
+        removed = false;
+        return freed;
+    }
+};
+
+template<typename Subscriber, int Capacity>
+const int SubscriberList<Subscriber, Capacity>::ANY_ID;
+
+#endif // SUBSCRIBER_LIST_H
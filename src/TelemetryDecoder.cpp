@@ -0,0 +1,256 @@
+#include "TelemetryDecoder.h"
+#include <math.h>
+#include <string.h>
+
+bool TelemetryDecoder::decode(const uint8_t* data, size_t length, SensorSample& sample) {
+    Reader reader = {data, length, 0};
+    uint32_t entries;
+    if (!readMapHeader(reader, entries)) {
+        return false;
+    }
+
+    memset(&sample, 0, sizeof(sample));
+    sample.temperature = NAN;
+    sample.humidity = NAN;
+    for (uint32_t i = 0; i < entries; i++) {
+        Value key;
+        Value value;
+        if (!readValue(reader, key) || key.kind != Value::INTEGER || !readValue(reader, value)) {
+            return false;
+        }
+        switch (key.integer) {
+            case TelemetrySchema::KEY_TIMESTAMP:
+                sample.timestamp = (uint32_t)value.integer;
+                break;
+            case TelemetrySchema::KEY_TEMPERATURE:
+                sample.temperature = toReading(value);
+                break;
+            case TelemetrySchema::KEY_HUMIDITY:
+                sample.humidity = toReading(value);
+                break;
+            case TelemetrySchema::KEY_MOTION:
+                sample.motionDetected = value.kind == Value::BOOLEAN && value.integer != 0;
+                break;
+            case TelemetrySchema::KEY_SMOKE:
+                sample.smokeLevel = toReading(value);
+                break;
+            case TelemetrySchema::KEY_SERVO:
+                sample.servoPosition = (int16_t)value.integer;
+                break;
+            case TelemetrySchema::KEY_SERVO2:
+                sample.servo2Position = (int16_t)value.integer;
+                break;
+            default:
+                break; // Field from a newer schema revision
+        }
+    }
+    return reader.position == reader.length;
+}
+
+bool TelemetryDecoder::decode(const uint8_t* data, size_t length, AlertRecord& alert) {
+    Reader reader = {data, length, 0};
+    uint32_t entries;
+    if (!readMapHeader(reader, entries)) {
+        return false;
+    }
+
+    memset(&alert, 0, sizeof(alert));
+    for (uint32_t i = 0; i < entries; i++) {
+        Value key;
+        Value value;
+        if (!readValue(reader, key) || key.kind != Value::INTEGER || !readValue(reader, value)) {
+            return false;
+        }
+        switch (key.integer) {
+            case TelemetrySchema::KEY_TIMESTAMP:
+                alert.timestamp = (uint32_t)value.integer;
+                break;
+            case TelemetrySchema::KEY_ALERT_TYPE:
+                copyText(value, alert.type, sizeof(alert.type));
+                break;
+            case TelemetrySchema::KEY_ALERT_SEVERITY:
+                copyText(value, alert.severity, sizeof(alert.severity));
+                break;
+            case TelemetrySchema::KEY_ALERT_MESSAGE:
+                copyText(value, alert.message, sizeof(alert.message));
+                break;
+            default:
+                break;
+        }
+    }
+    return reader.position == reader.length;
+}
+
+int TelemetryDecoder::decodeBatch(const uint8_t* data, size_t length, SensorSample* samples, int maxSamples) {
+    Reader reader = {data, length, 0};
+    uint32_t entries;
+    if (!readMapHeader(reader, entries)) {
+        return -1;
+    }
+
+    uint32_t base = 0;
+    int64_t count = -1; // Every column must have the same length
+    for (uint32_t i = 0; i < entries; i++) {
+        Value key;
+        if (!readValue(reader, key) || key.kind != Value::INTEGER) {
+            return -1;
+        }
+        if (key.integer == TelemetrySchema::KEY_TIMESTAMP) {
+            Value value;
+            if (!readValue(reader, value) || value.kind != Value::INTEGER) {
+                return -1;
+            }
+            base = (uint32_t)value.integer;
+            continue;
+        }
+
+        uint8_t majorType;
+        uint32_t items;
+        if (!readHead(reader, majorType, items) || majorType != 4 || (count >= 0 && items != count)) {
+            return -1;
+        }
+        if (count < 0) {
+            count = items;
+            for (int j = 0; j < maxSamples && j < count; j++) {
+                memset(&samples[j], 0, sizeof(samples[j]));
+                samples[j].temperature = NAN;
+                samples[j].humidity = NAN;
+            }
+        }
+        for (uint32_t j = 0; j < items; j++) {
+            Value value;
+            if (!readValue(reader, value)) {
+                return -1;
+            }
+            if ((int64_t)j >= maxSamples) {
+                continue;
+            }
+            SensorSample& sample = samples[j];
+            switch (key.integer) {
+                case TelemetrySchema::KEY_TIME_DELTAS:
+                    sample.timestamp = (uint32_t)value.integer; // Made absolute below
+                    break;
+                case TelemetrySchema::KEY_TEMPERATURE:
+                    sample.temperature = toReading(value);
+                    break;
+                case TelemetrySchema::KEY_HUMIDITY:
+                    sample.humidity = toReading(value);
+                    break;
+                case TelemetrySchema::KEY_MOTION:
+                    sample.motionDetected = value.kind == Value::BOOLEAN && value.integer != 0;
+                    break;
+                case TelemetrySchema::KEY_SMOKE:
+                    sample.smokeLevel = toReading(value);
+                    break;
+                case TelemetrySchema::KEY_SERVO:
+                    sample.servoPosition = (int16_t)value.integer;
+                    break;
+                case TelemetrySchema::KEY_SERVO2:
+                    sample.servo2Position = (int16_t)value.integer;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    if (reader.position != reader.length || count < 0) {
+        return -1;
+    }
+
+    int stored = count < maxSamples ? (int)count : maxSamples;
+    uint32_t timestamp = base;
+    for (int j = 0; j < stored; j++) {
+        timestamp += samples[j].timestamp;
+        samples[j].timestamp = timestamp;
+    }
+    return stored;
+}
+
+bool TelemetryDecoder::readMapHeader(Reader& reader, uint32_t& entries) {
+    if (reader.length < 1 || reader.data[0] != TelemetrySchema::VERSION) {
+        return false;
+    }
+    reader.position = 1;
+    uint8_t majorType;
+    return readHead(reader, majorType, entries) && majorType == 5;
+}
+
+bool TelemetryDecoder::readHead(Reader& reader, uint8_t& majorType, uint32_t& argument) {
+    if (reader.position >= reader.length) {
+        return false;
+    }
+    uint8_t initial = reader.data[reader.position++];
+    majorType = initial >> 5;
+    uint8_t info = initial & 0x1F;
+
+    if (info < 24 || majorType == 7) {
+        argument = info; // Simple values keep their code in the initial byte
+        return majorType != 7 || info < 24;
+    }
+    // 64-bit arguments and indefinite lengths are never produced by the encoder
+    size_t size = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : 0;
+    if (size == 0 || reader.position + size > reader.length) {
+        return false;
+    }
+    argument = 0;
+    for (size_t i = 0; i < size; i++) {
+        argument = (argument << 8) | reader.data[reader.position++];
+    }
+    return true;
+}
+
+bool TelemetryDecoder::readValue(Reader& reader, Value& value) {
+    uint8_t majorType;
+    uint32_t argument;
+    if (!readHead(reader, majorType, argument)) {
+        return false;
+    }
+
+    switch (majorType) {
+        case 0:
+            value.kind = Value::INTEGER;
+            value.integer = argument;
+            return true;
+        case 1:
+            value.kind = Value::INTEGER;
+            value.integer = -1 - (int64_t)argument;
+            return true;
+        case 3:
+            if (argument > reader.length - reader.position) { // No overflow with a 32-bit size_t
+                return false;
+            }
+            value.kind = Value::TEXT;
+            value.text = (const char*)reader.data + reader.position;
+            value.textLength = argument;
+            reader.position += argument;
+            return true;
+        case 7:
+            if (argument == 20 || argument == 21) {
+                value.kind = Value::BOOLEAN;
+                value.integer = argument == 21;
+                return true;
+            }
+            if (argument == 22) {
+                value.kind = Value::NONE;
+                value.integer = 0;
+                return true;
+            }
+            return false;
+        default:
+            return false; // Byte strings, arrays, nested maps and tags are not part of the schema
+    }
+}
+
+float TelemetryDecoder::toReading(const Value& value) {
+    return value.kind == Value::INTEGER ? value.integer / 100.0f : NAN;
+}
+
+void TelemetryDecoder::copyText(const Value& value, char* destination, size_t size) {
+    if (value.kind != Value::TEXT) {
+        destination[0] = '\0';
+        return;
+    }
+    size_t count = value.textLength < size - 1 ? value.textLength : size - 1;
+    memcpy(destination, value.text, count);
+    destination[count] = '\0';
+}
@@ -0,0 +1,70 @@
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PipelineRecords.h"
+#include "TelemetrySchema.h"
+
+/**
+ * @brief Decoder for binary payloads written by BinaryTelemetryEncoder.
+ *
+ * Portable C++ without Arduino dependencies, meant for gateways and host tools consuming the
+ * data and alert topics. Unknown keys are skipped so older decoders keep working when fields
+ * are added; payloads with another schema version are rejected.
+ */
+class TelemetryDecoder {
+public:
+    /**
+     * @brief Decodes a sensor sample. Missing fields are left at zero, or NaN for readings.
+     * @param data Payload bytes.
+     * @param length Payload length.
+     * @param sample Receives the sample. Its sequence number is set to 0.
+     * @return True if the payload is a well-formed sample.
+     */
+    static bool decode(const uint8_t* data, size_t length, SensorSample& sample);
+
+    /**
+     * @brief Decodes an alert. Text fields are truncated to the record sizes.
+     * @param data Payload bytes.
+     * @param length Payload length.
+     * @param alert Receives the alert.
+     * @return True if the payload is a well-formed alert.
+     */
+    static bool decode(const uint8_t* data, size_t length, AlertRecord& alert);
+
+    /**
+     * @brief Decodes a columnar batch written by ColumnarBatchEncoder in CBOR.
+     * @param data Payload bytes.
+     * @param length Payload length.
+     * @param samples Receives the samples, oldest first, with absolute timestamps.
+     * @param maxSamples Size of `samples`; further samples are skipped.
+     * @return Number of samples stored, or -1 if the payload is not a well-formed batch.
+     */
+    static int decodeBatch(const uint8_t* data, size_t length, SensorSample* samples, int maxSamples);
+
+private:
+    struct Reader {
+        const uint8_t* data;
+        size_t length;
+        size_t position;
+    };
+
+    /**
+     * @brief Value of a map entry: an integer, a boolean, null or a text slice.
+     */
+    struct Value {
+        enum Kind { INTEGER, BOOLEAN, NONE, TEXT } kind;
+        int64_t integer;
+        const char* text;
+        size_t textLength;
+    };
+
+    static bool readMapHeader(Reader& reader, uint32_t& entries);
+    static bool readHead(Reader& reader, uint8_t& majorType, uint32_t& argument);
+    static bool readValue(Reader& reader, Value& value);
+    static float toReading(const Value& value);
+    static void copyText(const Value& value, char* destination, size_t size);
+};
+
+#endif // TELEMETRY_DECODER_H
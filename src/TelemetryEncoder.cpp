@@ -0,0 +1,184 @@
+#include "TelemetryEncoder.h"
+#include <math.h>
+
+// Key layout, fixed at compile time; each key carries the separator of the previous field
+static const char KEY_TEMPERATURE[] = "\"temperature\":";
+static const char KEY_HUMIDITY[] = ",\"humidity\":";
+static const char KEY_MOTION[] = ",\"motionDetected\":";
+static const char KEY_SMOKE[] = ",\"smokeLevel\":";
+static const char KEY_SERVO[] = ",\"servoPosition\":";
+static const char KEY_SERVO2[] = ",\"servo2Position\":";
+static const char KEY_TIMESTAMP[] = ",\"timestamp\":";
+
+// Largest magnitude formatFloat() writes: times 100 it still fits a 32-bit long
+static const float FLOAT_LIMIT = 10000000.0f;
+
+TelemetryEncoder::TelemetryEncoder()
+    : prefixLength(0), bodyEnd(0), encodedSequence(0), valid(false) {
+    setSourceInfo("", "");
+}
+
+void TelemetryEncoder::setSourceInfo(const char* deviceId, const char* source) {
+    size_t position = 0;
+    bool fits = appendLiteral(position, "{\"deviceId\":") &&
+                appendString(position, deviceId) &&
+                appendLiteral(position, ",\"source\":") &&
+                appendString(position, source);
+    prefixLength = fits ? position : 0;
+    valid = false;
+    encodedSequence = 0;
+}
+
+bool TelemetryEncoder::encode(const SensorSample& sample) {
+    if (valid && sample.sequence == encodedSequence) {
+        return true;
+    }
+
+    // Handle sensor failures with error values (-999)
+    float temperature = !isnan(sample.temperature) ? sample.temperature : ERROR_VALUE;
+    float humidity = !isnan(sample.humidity) ? sample.humidity : ERROR_VALUE;
+
+    size_t position = prefixLength + 1; // Leave room for the separator byte
+    valid = appendLiteral(position, KEY_TEMPERATURE) && appendFloat(position, temperature) &&
+            appendLiteral(position, KEY_HUMIDITY) && appendFloat(position, humidity) &&
+            appendLiteral(position, KEY_MOTION) && appendLiteral(position, sample.motionDetected ? "true" : "false") &&
+            appendLiteral(position, KEY_SMOKE) && appendFloat(position, sample.smokeLevel) &&
+            appendLiteral(position, KEY_SERVO) && appendInt(position, sample.servoPosition) &&
+            appendLiteral(position, KEY_SERVO2) && appendInt(position, sample.servo2Position) &&
+            appendLiteral(position, KEY_TIMESTAMP) && appendInt(position, sample.timestamp) &&
+            appendLiteral(position, "}");
+
+    bodyEnd = valid ? position : 0;
+    encodedSequence = valid ? sample.sequence : 0;
+    return valid;
+}
+
+bool TelemetryEncoder::encode(const AlertRecord& alert) {
+    size_t position = prefixLength + 1;
+    valid = appendLiteral(position, "\"type\":") && appendString(position, alert.type) &&
+            appendLiteral(position, ",\"severity\":") && appendString(position, alert.severity) &&
+            appendLiteral(position, ",\"message\":") && appendString(position, alert.message) &&
+            appendLiteral(position, KEY_TIMESTAMP) && appendInt(position, alert.timestamp) &&
+            appendLiteral(position, "}");
+
+    bodyEnd = valid ? position : 0;
+    encodedSequence = 0; // No sample is encoded any more
+    return valid;
+}
+
+const char* TelemetryEncoder::mqttPayload(size_t& length) {
+    if (!valid) {
+        length = 0;
+        return buffer;
+    }
+    buffer[prefixLength] = '{';
+    length = bodyEnd - prefixLength;
+    return buffer + prefixLength;
+}
+
+const char* TelemetryEncoder::httpPayload(size_t& length) {
+    if (!valid) {
+        length = 0;
+        return buffer;
+    }
+    buffer[prefixLength] = prefixLength > 0 ? ',' : '{';
+    length = bodyEnd;
+    return buffer;
+}
+
+uint32_t TelemetryEncoder::getEncodedSequence() const {
+    return valid ? encodedSequence : 0;
+}
+
+bool TelemetryEncoder::appendLiteral(size_t& position, const char* text) {
+    while (*text != '\0') {
+        if (position >= BUFFER_SIZE) {
+            return false;
+        }
+        buffer[position++] = *text++;
+    }
+    return true;
+}
+
+bool TelemetryEncoder::appendString(size_t& position, const char* text) {
+    if (!appendLiteral(position, "\"")) {
+        return false;
+    }
+    for (; *text != '\0'; text++) {
+        // Identifiers are plain ASCII; escape the two characters that would break the JSON
+        if ((*text == '"' || *text == '\\') && !appendLiteral(position, "\\")) {
+            return false;
+        }
+        if (position >= BUFFER_SIZE) {
+            return false;
+        }
+        buffer[position++] = *text;
+    }
+    return appendLiteral(position, "\"");
+}
+
+bool TelemetryEncoder::appendInt(size_t& position, long value) {
+    char text[NUMBER_SIZE];
+    formatInt(text, value);
+    return appendLiteral(position, text);
+}
+
+bool TelemetryEncoder::appendFloat(size_t& position, float value) {
+    char text[NUMBER_SIZE];
+    formatFloat(text, value);
+    return appendLiteral(position, text);
+}
+
+size_t TelemetryEncoder::formatInt(char* text, long value) {
+    char digits[24]; // 20 digits for a 64-bit long
+    int count = 0;
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        digits[count++] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    size_t length = 0;
+    if (value < 0) {
+        text[length++] = '-';
+    }
+    while (count > 0) {
+        text[length++] = digits[--count];
+    }
+    text[length] = '\0';
+    return length;
+}
+
+size_t TelemetryEncoder::formatFloat(char* text, float value) {
+    if (!isfinite(value)) {
+        return formatInt(text, ERROR_VALUE);
+    }
+
+    // Out of range, lroundf() is undefined; no sensor reads anywhere near the limit
+    if (value > FLOAT_LIMIT) {
+        value = FLOAT_LIMIT;
+    } else if (value < -FLOAT_LIMIT) {
+        value = -FLOAT_LIMIT;
+    }
+
+    // Two decimals are below the resolution of every sensor on the board
+    long scaled = lroundf(value * 100.0f);
+    size_t length = 0;
+    if (scaled < 0) {
+        text[length++] = '-';
+    }
+    unsigned long magnitude = scaled < 0 ? 0UL - (unsigned long)scaled : (unsigned long)scaled;
+    length += formatInt(text + length, magnitude / 100);
+
+    unsigned long fraction = magnitude % 100;
+    if (fraction == 0) {
+        return length; // Whole numbers are written without decimals, as ArduinoJson does
+    }
+    text[length++] = '.';
+    text[length++] = '0' + fraction / 10;
+    if (fraction % 10 != 0) {
+        text[length++] = '0' + fraction % 10;
+    }
+    text[length] = '\0';
+    return length;
+}
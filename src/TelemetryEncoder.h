@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_ENCODER_H
+#define TELEMETRY_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PipelineRecords.h"
+
+/**
+ * @brief Serialize-once JSON encoder for sensor samples.
+ *
+ * Writes a sample straight into a fixed buffer owned by the encoder, with the key layout
+ * fixed at compile time, so publishing never allocates. The same encoded body serves both
+ * transports: the HTTP view adds `deviceId` and `source` through a prefix written once by
+ * setSourceInfo(), so only one byte differs between the two views.
+ *
+ * Layout: `{"deviceId":"..","source":".."` + separator + `"temperature":..,...}`.
+ * The separator is `{` for the MQTT view and `,` for the HTTP view.
+ *
+ * Alerts share the buffer: encoding one replaces the encoded sample, which is then written
+ * again on its next encode().
+ */
+class TelemetryEncoder {
+public:
+    static const size_t BUFFER_SIZE = 320; ///< Room for the HTTP prefix and the largest body.
+    static const int ERROR_VALUE = -999;   ///< Sent in place of a missing DHT reading.
+    static const size_t NUMBER_SIZE = 24;  ///< Room for any number written by the format functions.
+
+    TelemetryEncoder();
+
+    /**
+     * @brief Sets the identification fields added to the HTTP view.
+     * @param deviceId Device identifier.
+     * @param source Source tag.
+     */
+    void setSourceInfo(const char* deviceId, const char* source);
+
+    /**
+     * @brief Encodes a sample unless it is the one already encoded.
+     * @param sample The sample to encode.
+     * @return True if the buffer holds a valid encoding of the sample.
+     */
+    bool encode(const SensorSample& sample);
+
+    /**
+     * @brief Encodes an alert as `{"type":..,"severity":..,"message":..,"timestamp":..}`.
+     *
+     * Read the result through mqttPayload().
+     * @param alert The alert to encode.
+     * @return True if the alert fit in the buffer.
+     */
+    bool encode(const AlertRecord& alert);
+
+    /**
+     * @brief Gets the MQTT view of the last encoded sample.
+     *
+     * The returned pointer stays valid until the next call to encode() or httpPayload().
+     * @param length Receives the payload length.
+     * @return Pointer to the payload, not null-terminated.
+     */
+    const char* mqttPayload(size_t& length);
+
+    /**
+     * @brief Gets the HTTP view (with deviceId and source) of the last encoded sample.
+     *
+     * The returned pointer stays valid until the next call to encode() or mqttPayload().
+     * @param length Receives the payload length.
+     * @return Pointer to the payload, not null-terminated.
+     */
+    const char* httpPayload(size_t& length);
+
+    /**
+     * @brief Gets the sequence number of the encoded sample, 0 if none.
+     */
+    uint32_t getEncodedSequence() const;
+
+    /**
+     * @brief Writes an integer as null-terminated decimal text.
+     * @param text Destination with room for NUMBER_SIZE characters.
+     * @param value Value to write.
+     * @return Number of characters written, without the terminator.
+     */
+    static size_t formatInt(char* text, long value);
+
+    /**
+     * @brief Writes a reading with at most two decimals, or ERROR_VALUE if it is not finite.
+     *
+     * Readings beyond ±10000000 are clamped to it, so the scaled value fits a 32-bit long.
+     * @param text Destination with room for NUMBER_SIZE characters.
+     * @param value Value to write.
+     * @return Number of characters written, without the terminator.
+     */
+    static size_t formatFloat(char* text, float value);
+
+private:
+    char buffer[BUFFER_SIZE];
+    size_t prefixLength; ///< Position of the separator byte.
+    size_t bodyEnd;      ///< Length of the whole buffer content.
+    uint32_t encodedSequence;
+    bool valid;
+
+    bool appendLiteral(size_t& position, const char* text);
+    bool appendString(size_t& position, const char* text);
+    bool appendInt(size_t& position, long value);
+    bool appendFloat(size_t& position, float value);
+};
+
+#endif // TELEMETRY_ENCODER_H
@@ -0,0 +1,276 @@
+#include "TelemetryJournal.h"
+#include <math.h>
+#include <string.h>
+
+// Record layout, little endian:
+//   0 state | 1 version | 2-3 CRC16 of bytes 4..31 | 4-7 journal sequence | 8-11 timestamp
+//   12-13 temperature x100 | 14-15 humidity x100 | 16-19 smoke level x100
+//   20-21 servo position | 22-23 servo 2 position | 24 flags | 25-31 reserved (0xFF)
+static const uint8_t STATE_BLANK = 0xFF;
+static const uint8_t STATE_WRITTEN = 0xFE;  // One bit cleared after the payload is programmed
+static const uint8_t STATE_REPLAYED = 0xFC; // A second bit cleared once published
+static const uint8_t RECORD_VERSION = 1;
+static const uint8_t FLAG_MOTION = 0x01;
+static const int16_t MISSING_VALUE = INT16_MIN; // Stands for a NaN DHT reading
+static const float READING_LIMIT = 10000000.0f; // Times 100 it still fits a 32-bit long
+
+static uint16_t crc16(const uint8_t* data, size_t length) {
+    // CRC-16/CCITT-FALSE
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void putU16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t value) {
+    putU16(p, value & 0xFFFF);
+    putU16(p + 2, value >> 16);
+}
+
+static uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static long scaleClamped(float value) {
+    // Out of range, lroundf() is undefined
+    if (value > READING_LIMIT) {
+        value = READING_LIMIT;
+    } else if (value < -READING_LIMIT) {
+        value = -READING_LIMIT;
+    }
+    return lroundf(value * 100.0f);
+}
+
+static int16_t scaleReading(float value) {
+    if (isnan(value)) {
+        return MISSING_VALUE;
+    }
+    long scaled = scaleClamped(value);
+    if (scaled > INT16_MAX) {
+        return INT16_MAX;
+    }
+    return scaled <= MISSING_VALUE ? MISSING_VALUE + 1 : (int16_t)scaled;
+}
+
+static float unscaleReading(int16_t value) {
+    return value == MISSING_VALUE ? NAN : value / 100.0f;
+}
+
+const size_t TelemetryJournal::RECORD_SIZE;
+
+TelemetryJournal::TelemetryJournal(JournalStorage* storage)
+    : storage(storage), ready(false), slotCount(0), slotsPerSector(0), head(0), replay(0),
+      nextSequence(1), pendingCount(0), overwrittenCount(0), corruptCount(0) {}
+
+void TelemetryJournal::setStorage(JournalStorage* storage) {
+    this->storage = storage;
+    ready = false;
+}
+
+bool TelemetryJournal::begin() {
+    ready = false;
+    if (storage == nullptr || !storage->begin()) {
+        return false;
+    }
+
+    size_t sectorSize = storage->sectorSize();
+    if (sectorSize < RECORD_SIZE || sectorSize % RECORD_SIZE != 0 || storage->size() < 2 * sectorSize) {
+        return false; // Wrapping needs a second sector to move to
+    }
+    slotsPerSector = sectorSize / RECORD_SIZE;
+    slotCount = (storage->size() / sectorSize) * slotsPerSector;
+
+    recover();
+    ready = true;
+    return true;
+}
+
+bool TelemetryJournal::isReady() const {
+    return ready;
+}
+
+bool TelemetryJournal::append(const SensorSample& sample) {
+    if (!ready || !prepareHead()) {
+        return false;
+    }
+
+    uint8_t record[RECORD_SIZE];
+    memset(record, 0xFF, sizeof(record));
+    record[1] = RECORD_VERSION;
+    putU32(record + 4, nextSequence);
+    putU32(record + 8, sample.timestamp);
+    putU16(record + 12, (uint16_t)scaleReading(sample.temperature));
+    putU16(record + 14, (uint16_t)scaleReading(sample.humidity));
+    bool noSmoke = isnan(sample.smokeLevel) || sample.smokeLevel < 0;
+    putU32(record + 16, noSmoke ? 0 : (uint32_t)scaleClamped(sample.smokeLevel));
+    putU16(record + 20, (uint16_t)sample.servoPosition);
+    putU16(record + 22, (uint16_t)sample.servo2Position);
+    record[24] = sample.motionDetected ? FLAG_MOTION : 0;
+    putU16(record + 2, crc16(record + 4, RECORD_SIZE - 4));
+
+    // Payload first, state byte last: a power loss in between leaves a blank-state record
+    size_t offset = head * RECORD_SIZE;
+    uint8_t state = STATE_WRITTEN;
+    if (!storage->write(offset, record, RECORD_SIZE) || !storage->write(offset, &state, 1)) {
+        head = nextSlot(head); // Never program the same slot twice
+        return false;
+    }
+
+    if (pendingCount == 0) {
+        replay = head;
+    }
+    head = nextSlot(head);
+    nextSequence++;
+    pendingCount++;
+    return true;
+}
+
+bool TelemetryJournal::peek(SensorSample& sample) {
+    uint8_t record[RECORD_SIZE];
+    while (ready && pendingCount > 0) {
+        if (replay == head) {
+            pendingCount = 0; // Everything left was lost or unreadable
+            break;
+        }
+        if (readSlot(replay, record) && record[0] == STATE_WRITTEN && isValid(record)) {
+            sample.sequence = getU32(record + 4);
+            sample.timestamp = getU32(record + 8);
+            sample.temperature = unscaleReading((int16_t)getU16(record + 12));
+            sample.humidity = unscaleReading((int16_t)getU16(record + 14));
+            sample.smokeLevel = getU32(record + 16) / 100.0f;
+            sample.servoPosition = (int16_t)getU16(record + 20);
+            sample.servo2Position = (int16_t)getU16(record + 22);
+            sample.motionDetected = (record[24] & FLAG_MOTION) != 0;
+            return true;
+        }
+        replay = nextSlot(replay);
+    }
+    return false;
+}
+
+void TelemetryJournal::markReplayed() {
+    if (!ready || pendingCount == 0 || replay == head) {
+        return;
+    }
+    uint8_t state = STATE_REPLAYED;
+    storage->write(replay * RECORD_SIZE, &state, 1);
+    replay = nextSlot(replay);
+    pendingCount--;
+}
+
+uint32_t TelemetryJournal::getPendingCount() const {
+    return pendingCount;
+}
+
+uint32_t TelemetryJournal::getOverwrittenCount() const {
+    return overwrittenCount;
+}
+
+uint32_t TelemetryJournal::getCorruptCount() const {
+    return corruptCount;
+}
+
+bool TelemetryJournal::readSlot(size_t slot, uint8_t* record) {
+    return storage->read(slot * RECORD_SIZE, record, RECORD_SIZE);
+}
+
+bool TelemetryJournal::isBlank(const uint8_t* record) const {
+    for (size_t i = 0; i < RECORD_SIZE; i++) {
+        if (record[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TelemetryJournal::isValid(const uint8_t* record) {
+    return record[1] == RECORD_VERSION && getU16(record + 2) == crc16(record + 4, RECORD_SIZE - 4);
+}
+
+void TelemetryJournal::recover() {
+    // One pass over the log: the newest record gives the write position, the oldest pending
+    // record the replay position. Sequence numbers are compared with wrap-around arithmetic.
+    bool found = false;
+    bool foundPending = false;
+    uint32_t newestSequence = 0;
+    uint32_t oldestPendingSequence = 0;
+    size_t newestSlot = 0;
+    pendingCount = 0;
+
+    uint8_t record[RECORD_SIZE];
+    for (size_t slot = 0; slot < slotCount; slot++) {
+        if (!readSlot(slot, record) || record[0] == STATE_BLANK) {
+            continue; // Blank, or torn by a power loss before the commit
+        }
+        if ((record[0] != STATE_WRITTEN && record[0] != STATE_REPLAYED) || !isValid(record)) {
+            corruptCount++;
+            continue;
+        }
+
+        uint32_t sequence = getU32(record + 4);
+        if (!found || (int32_t)(sequence - newestSequence) > 0) {
+            newestSequence = sequence;
+            newestSlot = slot;
+            found = true;
+        }
+        if (record[0] == STATE_WRITTEN) {
+            pendingCount++;
+            if (!foundPending || (int32_t)(sequence - oldestPendingSequence) < 0) {
+                oldestPendingSequence = sequence;
+                replay = slot;
+                foundPending = true;
+            }
+        }
+    }
+
+    head = found ? nextSlot(newestSlot) : 0;
+    nextSequence = found ? newestSequence + 1 : 1;
+    if (!foundPending) {
+        replay = head;
+    }
+}
+
+bool TelemetryJournal::prepareHead() {
+    uint8_t record[RECORD_SIZE];
+    for (size_t attempts = 0; attempts < slotsPerSector; attempts++) {
+        if (head % slotsPerSector == 0) {
+            // Entering a sector: it holds the oldest records of the log, drop them
+            size_t sector = head / slotsPerSector;
+            bool replayInSector = pendingCount > 0 && replay / slotsPerSector == sector;
+            for (size_t slot = head; slot < head + slotsPerSector && pendingCount > 0; slot++) {
+                if (readSlot(slot, record) && record[0] == STATE_WRITTEN) {
+                    pendingCount--;
+                    overwrittenCount++;
+                }
+            }
+            if (replayInSector) {
+                replay = pendingCount > 0 ? nextSlot(head + slotsPerSector - 1) : head;
+            }
+            return storage->eraseSector(sector);
+        }
+
+        // Mid-sector, as after a reboot: skip slots left dirty by a torn write
+        if (readSlot(head, record) && isBlank(record)) {
+            return true;
+        }
+        head = nextSlot(head);
+    }
+    return false;
+}
+
+size_t TelemetryJournal::nextSlot(size_t slot) const {
+    return (slot + 1) % slotCount;
+}
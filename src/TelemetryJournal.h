@@ -0,0 +1,87 @@
+#ifndef TELEMETRY_JOURNAL_H
+#define TELEMETRY_JOURNAL_H
+
+#include "JournalStorage.h"
+#include "PipelineRecords.h"
+
+/**
+ * @brief Store-and-forward journal of sensor samples that could not be published.
+ *
+ * Samples are appended as fixed 32-byte records to a circular log over a JournalStorage,
+ * sector by sector, so flash wear is spread evenly. Each record is protected by a CRC and
+ * committed by clearing bits of its state byte after the payload is written, which keeps the
+ * log consistent across a power loss at any point: a torn record is simply skipped on
+ * recovery. Replayed records are marked in place the same way, without erasing. When the log
+ * is full the oldest sector is erased, dropping its unreplayed samples.
+ */
+class TelemetryJournal {
+public:
+    static const size_t RECORD_SIZE = 32;
+
+    /**
+     * @brief Constructs a TelemetryJournal.
+     * @param storage Storage to keep the log in (default: nullptr, journal disabled).
+     */
+    explicit TelemetryJournal(JournalStorage* storage = nullptr);
+
+    /**
+     * @brief Opens the storage and recovers the log position and pending samples.
+     * @return True if the journal is usable.
+     */
+    bool begin();
+
+    /**
+     * @brief Sets the storage. Must be called before begin().
+     * @param storage Storage to keep the log in.
+     */
+    void setStorage(JournalStorage* storage);
+
+    bool isReady() const; ///< True after a successful begin().
+
+    /**
+     * @brief Appends a sample to the log.
+     * @param sample The sample to keep.
+     * @return True if the sample was written.
+     */
+    bool append(const SensorSample& sample);
+
+    /**
+     * @brief Reads the oldest sample not yet replayed, without consuming it.
+     *
+     * The returned sample carries the journal sequence number, unique across reboots, in place
+     * of the original one.
+     * @param sample Receives the sample.
+     * @return True if a sample is pending.
+     */
+    bool peek(SensorSample& sample);
+
+    /**
+     * @brief Marks the sample returned by peek() as replayed.
+     */
+    void markReplayed();
+
+    uint32_t getPendingCount() const;     ///< Samples written and not yet replayed.
+    uint32_t getOverwrittenCount() const; ///< Pending samples lost because the log wrapped.
+    uint32_t getCorruptCount() const;     ///< Records skipped on recovery because of a bad CRC.
+
+private:
+    JournalStorage* storage;
+    bool ready;
+    size_t slotCount;
+    size_t slotsPerSector;
+    size_t head;     ///< Next slot to write.
+    size_t replay;   ///< Oldest slot that may still be pending.
+    uint32_t nextSequence;
+    uint32_t pendingCount;
+    uint32_t overwrittenCount;
+    uint32_t corruptCount;
+
+    bool readSlot(size_t slot, uint8_t* record);
+    bool isBlank(const uint8_t* record) const;
+    bool isValid(const uint8_t* record);
+    void recover();
+    bool prepareHead();
+    size_t nextSlot(size_t slot) const;
+};
+
+#endif // TELEMETRY_JOURNAL_H
@@ -0,0 +1,40 @@
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+#include <stdint.h>
+
+/**
+ * @brief Encoding used on an MQTT topic.
+ */
+enum PayloadFormat {
+    PAYLOAD_JSON, ///< Named keys, readable by any client (default).
+    PAYLOAD_CBOR  ///< Schema version byte followed by a CBOR map with integer keys.
+};
+
+/**
+ * @brief Integer keys and version of the binary telemetry schema.
+ *
+ * A binary payload is one raw version byte followed by a CBOR map (RFC 8949). Readings are
+ * sent as integers scaled by 100 and a missing DHT reading as null. Keys may be added in later
+ * versions; decoders skip keys they do not know. Alert keys do not overlap sample keys.
+ */
+struct TelemetrySchema {
+    static const uint8_t VERSION = 1;
+
+    // Sensor samples
+    static const uint8_t KEY_TIMESTAMP = 1;      ///< Milliseconds, unsigned.
+    static const uint8_t KEY_TEMPERATURE = 2;    ///< Celsius x100, or null.
+    static const uint8_t KEY_HUMIDITY = 3;       ///< Percent x100, or null.
+    static const uint8_t KEY_MOTION = 4;         ///< Boolean.
+    static const uint8_t KEY_SMOKE = 5;          ///< PPM x100.
+    static const uint8_t KEY_SERVO = 6;          ///< Degrees.
+    static const uint8_t KEY_SERVO2 = 7;         ///< Degrees.
+    static const uint8_t KEY_TIME_DELTAS = 8;    ///< Batches: milliseconds since the previous sample.
+
+    // Alerts
+    static const uint8_t KEY_ALERT_TYPE = 16;     ///< Text.
+    static const uint8_t KEY_ALERT_SEVERITY = 17; ///< Text.
+    static const uint8_t KEY_ALERT_MESSAGE = 18;  ///< Text.
+};
+
+#endif // TELEMETRY_SCHEMA_H
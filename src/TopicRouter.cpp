@@ -0,0 +1,39 @@
+#include "TopicRouter.h"
+#include <string.h>
+
+TopicRouter::TopicRouter() : routeCount(0) {}
+
+void TopicRouter::clear() {
+    routeCount = 0;
+}
+
+bool TopicRouter::add(const char* topic, int id) {
+    if (routeCount >= MAX_ROUTES) {
+        return false;
+    }
+    routes[routeCount].hash = hash(topic);
+    routes[routeCount].topic = topic;
+    routes[routeCount].id = id;
+    routeCount++;
+    return true;
+}
+
+int TopicRouter::route(const char* topic) const {
+    uint32_t topicHash = hash(topic);
+    for (int i = 0; i < routeCount; i++) {
+        // The hash rejects mismatches; the compare rules out collisions
+        if (routes[i].hash == topicHash && strcmp(routes[i].topic, topic) == 0) {
+            return routes[i].id;
+        }
+    }
+    return NO_ROUTE;
+}
+
+uint32_t TopicRouter::hash(const char* text) {
+    uint32_t value = 2166136261u;
+    while (*text != '\0') {
+        value ^= (uint8_t)*text++;
+        value *= 16777619u;
+    }
+    return value;
+}
@@ -0,0 +1,57 @@
+#ifndef TOPIC_ROUTER_H
+#define TOPIC_ROUTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maps subscribed MQTT topics to small integer IDs.
+ *
+ * The FNV-1a hash of each topic is computed once when it is added, so routing an incoming
+ * message costs one pass over its topic plus a compare against the entry whose hash matches,
+ * instead of building a String per candidate. Topics are kept by pointer and must outlive
+ * the router.
+ */
+class TopicRouter {
+public:
+    static const int MAX_ROUTES = 8;
+    static const int NO_ROUTE = -1;
+
+    TopicRouter();
+
+    /**
+     * @brief Removes all routes.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a route.
+     * @param topic Topic to match exactly.
+     * @param id ID returned by route() for the topic.
+     * @return False if the table is full.
+     */
+    bool add(const char* topic, int id);
+
+    /**
+     * @brief Finds the ID of a topic.
+     * @param topic Topic of the incoming message.
+     * @return The ID given to add(), or NO_ROUTE.
+     */
+    int route(const char* topic) const;
+
+    /**
+     * @brief Computes the 32-bit FNV-1a hash of a NUL-terminated string.
+     */
+    static uint32_t hash(const char* text);
+
+private:
+    struct Route {
+        uint32_t hash;
+        const char* topic;
+        int id;
+    };
+
+    Route routes[MAX_ROUTES];
+    int routeCount;
+};
+
+#endif // TOPIC_ROUTER_H
@@ -0,0 +1,126 @@
+#include "WiFiMqttTransport.h"
+
+WiFiMqttTransport::WiFiMqttTransport(PubSubClient& mqttClient)
+    : mqttClient(mqttClient), ssid(""), password(""), clientId(""), connectTask(nullptr),
+      attemptState(ATTEMPT_IDLE) {}
+
+void WiFiMqttTransport::setCredentials(const char* ssid, const char* password) {
+    this->ssid = ssid;
+    this->password = password;
+}
+
+void WiFiMqttTransport::setClientId(const char* clientId) {
+    this->clientId = clientId;
+}
+
+bool WiFiMqttTransport::startTask(int core, int priority) {
+#ifdef ESP32
+    if (connectTask != nullptr) {
+        return true;
+    }
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(attemptTask, "mqtt-connect", 4096, this, priority, &handle, core) != pdPASS) {
+        return false;
+    }
+    connectTask = handle;
+    return true;
+#else
+    (void)core;
+    (void)priority;
+    return false;
+#endif
+}
+
+void WiFiMqttTransport::beginWiFi(const uint8_t* bssid, int32_t channel) {
+    discardAttempt();
+    // Reconnection is driven by the ConnectionManager, not by the WiFi driver
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+    if (bssid != nullptr) {
+        WiFi.begin(ssid, password, channel, bssid);
+    } else {
+        WiFi.begin(ssid, password);
+    }
+}
+
+void WiFiMqttTransport::disconnectWiFi() {
+    WiFi.disconnect();
+}
+
+bool WiFiMqttTransport::isWiFiConnected() {
+    return WiFi.status() == WL_CONNECTED;
+}
+
+bool WiFiMqttTransport::getWiFiInfo(uint8_t* bssid, int32_t& channel) {
+    uint8_t* current = WiFi.BSSID();
+    if (current == nullptr) {
+        return false;
+    }
+    memcpy(bssid, current, 6);
+    channel = WiFi.channel();
+    return true;
+}
+
+ConnectionTransport::MqttAttempt WiFiMqttTransport::connectMqtt() {
+#ifdef ESP32
+    if (connectTask != nullptr) {
+        int state = attemptState.load(std::memory_order_acquire);
+        if (state == ATTEMPT_IDLE) {
+            attemptState.store(ATTEMPT_RUNNING, std::memory_order_relaxed);
+            xTaskNotifyGive(static_cast<TaskHandle_t>(connectTask));
+            return MQTT_ATTEMPT_PENDING;
+        }
+        if (state == ATTEMPT_RUNNING || state == ATTEMPT_ABANDONED) {
+            // An abandoned attempt still holds the client; the next one starts once it is over
+            return MQTT_ATTEMPT_PENDING;
+        }
+        attemptState.store(ATTEMPT_IDLE, std::memory_order_relaxed);
+        return state == ATTEMPT_ACCEPTED ? MQTT_ATTEMPT_ACCEPTED : MQTT_ATTEMPT_FAILED;
+    }
+#endif
+    return mqttClient.connect(clientId) ? MQTT_ATTEMPT_ACCEPTED : MQTT_ATTEMPT_FAILED;
+}
+
+bool WiFiMqttTransport::isMqttConnected() {
+    // The attempt task owns the client until it publishes the outcome
+    int state = attemptState.load(std::memory_order_acquire);
+    if (state == ATTEMPT_RUNNING || state == ATTEMPT_ABANDONED) {
+        return false;
+    }
+    return mqttClient.connected();
+}
+
+void WiFiMqttTransport::loopMqtt() {
+    mqttClient.loop();
+}
+
+void WiFiMqttTransport::discardAttempt() {
+    int state = ATTEMPT_RUNNING;
+    if (attemptState.compare_exchange_strong(state, ATTEMPT_ABANDONED, std::memory_order_acq_rel)) {
+        return; // The task drops the outcome when the attempt returns
+    }
+    if (state == ATTEMPT_ACCEPTED || state == ATTEMPT_FAILED) {
+        attemptState.store(ATTEMPT_IDLE, std::memory_order_relaxed);
+    }
+}
+
+void WiFiMqttTransport::attemptTask(void* parameter) {
+#ifdef ESP32
+    WiFiMqttTransport* transport = static_cast<WiFiMqttTransport*>(parameter);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool accepted = transport->mqttClient.connect(transport->clientId);
+        int state = ATTEMPT_RUNNING;
+        if (!transport->attemptState.compare_exchange_strong(state, accepted ? ATTEMPT_ACCEPTED : ATTEMPT_FAILED,
+                                                             std::memory_order_acq_rel)) {
+            // Abandoned: a session opened over the old link is closed before the client is handed back
+            if (accepted) {
+                transport->mqttClient.disconnect();
+            }
+            transport->attemptState.store(ATTEMPT_IDLE, std::memory_order_release);
+        }
+    }
+#else
+    (void)parameter;
+#endif
+}
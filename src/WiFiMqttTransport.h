@@ -0,0 +1,78 @@
+#ifndef WIFI_MQTT_TRANSPORT_H
+#define WIFI_MQTT_TRANSPORT_H
+
+#include "ConnectionTransport.h"
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <atomic>
+
+/**
+ * @brief ConnectionTransport over the ESP32 WiFi station and a PubSubClient.
+ *
+ * PubSubClient::connect() blocks for the TCP handshake and the CONNACK, up to the socket
+ * timeout. Once `startTask()` has run, connectMqtt() hands the attempt to a dedicated task
+ * and returns at once, so the task driving the ConnectionManager keeps running. The client
+ * must not be used elsewhere meanwhile: isMqttConnected() reports false until the attempt
+ * is over, and an MqttMessageTransport given this transport as its link checks it first.
+ * Starting a new association discards the outcome of an attempt made over the previous link,
+ * even one still in flight, so it is never reported to a later poll.
+ */
+class WiFiMqttTransport : public ConnectionTransport {
+private:
+    enum AttemptState {
+        ATTEMPT_IDLE,
+        ATTEMPT_RUNNING,
+        ATTEMPT_ACCEPTED,
+        ATTEMPT_FAILED,
+        ATTEMPT_ABANDONED ///< Still running, but its link is gone; the task drops the outcome.
+    };
+
+    PubSubClient& mqttClient;
+    const char* ssid;
+    const char* password;
+    const char* clientId;
+    void* connectTask;                ///< FreeRTOS handle of the attempt task, nullptr if not started.
+    std::atomic<int> attemptState;    ///< AttemptState, handed between the two tasks.
+
+    void discardAttempt();
+    static void attemptTask(void* parameter);
+
+public:
+    /**
+     * @brief Constructs a WiFiMqttTransport.
+     * @param mqttClient MQTT client to connect; its server must be configured separately.
+     */
+    explicit WiFiMqttTransport(PubSubClient& mqttClient);
+
+    /**
+     * @brief Sets the WiFi credentials used by the next association.
+     * @param ssid WiFi network name.
+     * @param password WiFi password.
+     */
+    void setCredentials(const char* ssid, const char* password);
+
+    /**
+     * @brief Sets the MQTT client ID used by the next connection attempt.
+     * @param clientId MQTT client identifier.
+     */
+    void setClientId(const char* clientId);
+
+    /**
+     * @brief Starts the task making the MQTT attempts. ESP32 only; returns false elsewhere,
+     * where connectMqtt() blocks for each attempt.
+     * @param core Core to pin the task to.
+     * @param priority FreeRTOS priority.
+     * @return True if the task was created.
+     */
+    bool startTask(int core, int priority);
+
+    void beginWiFi(const uint8_t* bssid, int32_t channel) override;
+    void disconnectWiFi() override;
+    bool isWiFiConnected() override;
+    bool getWiFiInfo(uint8_t* bssid, int32_t& channel) override;
+    MqttAttempt connectMqtt() override;
+    bool isMqttConnected() override;
+    void loopMqtt() override;
+};
+
+#endif // WIFI_MQTT_TRANSPORT_H
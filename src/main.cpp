@@ -1,11 +1,54 @@
 #include "ModestIoT.h"
+#ifndef ESP32
+#include "FleetSimulator.h"
+#include "NativeHal.h"
+#endif
 
 // Create the main device instance
 SmartSuiteDevice smartSuite;
 
+#ifdef ESP32
+// Flash partition holding telemetry that could not be sent (see partitions.csv)
+PartitionJournalStorage journalStorage("journal");
+#else
+// Native build: the same journal in a file, by default next to the program (see --journal)
+MappedFileJournalStorage journalStorage("journal.bin", 64 * 1024);
+
+// Lets trace replays jump over the time the device has nothing to do
+static unsigned long timeUntilNextTask() {
+    return smartSuite.timeUntilNextTask();
+}
+
+// One device of a --fleet run, with the room's own client ID and topics
+static VirtualDevice* createFleetDevice(const FleetRoom& room) {
+    FleetDevice<SmartSuiteDevice>* member = new FleetDevice<SmartSuiteDevice>();
+    SmartSuiteDevice& device = member->get();
+    device.setClientId(room.clientId);
+    device.setMQTTConfig("192.168.0.237", 1883, room.dataTopic, room.commandTopic, room.alertTopic);
+    device.setResponseTopic(room.responseTopic);
+    device.setRulesTopic(room.rulesTopic);
+    device.setMetricsTopic(room.metricsTopic);
+    return member;
+}
+
+static const bool fleetReady = FleetSimulator::setFactory(createFleetDevice);
+#endif
+
 void setup() {
+    // Optional: run sensors and network on separate cores
+    // smartSuite.setPipelined(true);
+
+    // Keep samples in flash while offline and replay them on reconnect
+#ifndef ESP32
+    journalStorage.setPath(NativeHal::getJournalPath());
+#endif
+    smartSuite.setJournalStorage(&journalStorage);
+
     // Initialize the SmartSuite device
     smartSuite.begin();
+#ifndef ESP32
+    NativeHal::setIdleHint(timeUntilNextTask);
+#endif
     
     // WiFi and MQTT configuration (these are the same defaults but shown for customization)
     smartSuite.setWiFiCredentials("Las4as.pe", "L@s4as.pe");
@@ -14,15 +57,27 @@ void setup() {
                             "smartsuite/servo/command", 
                             "smartsuite/alerts");
     
+    // Optional: compact binary payloads on the data and alert topics
+    // smartSuite.setPayloadFormats(PAYLOAD_CBOR, PAYLOAD_CBOR);
+    
+    // Optional: publish only when readings change, with a heartbeat every minute
+    // smartSuite.setReportByException(true);
+    
+    // Optional: collect every sample and publish them 20 at a time
+    // smartSuite.setBatching(true);
+    
+    // Optional: print the logs as text instead of binary records for tools/log_decode.py
+    // Logger::setTextOutput(true);
+    
     // HTTP endpoint configuration
     smartSuite.setHTTPEndpoint("https://jsonplaceholder.typicode.com/posts");
     
-    Serial.println("=== SmartSuite ESP32 Ready ===");
-    Serial.println("Using ModestIoT Nano-framework");
-    Serial.println("Sensors: DHT11, PIR, MQ2");
-    Serial.println("Actuators: 5 LEDs, 2 Servos");
-    Serial.println("Connectivity: WiFi + MQTT + HTTP");
-    Serial.println("===============================");
+    LOG_INFO("=== SmartSuite ESP32 Ready ===");
+    LOG_INFO("Using ModestIoT Nano-framework");
+    LOG_INFO("Sensors: DHT11, PIR, MQ2");
+    LOG_INFO("Actuators: 5 LEDs, 2 Servos");
+    LOG_INFO("Connectivity: WiFi + MQTT + HTTP");
+    LOG_INFO("===============================");
 }
 
 void loop() {
@@ -0,0 +1,237 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "AlertAggregator.h"
+
+static AlertAggregator* aggregator;
+
+void setUp() {
+    aggregator = new AlertAggregator();
+}
+
+void tearDown() {
+    delete aggregator;
+}
+
+static AlertRecord makeAlert(const char* type, const char* severity, const char* message, uint32_t timestamp) {
+    AlertRecord alert;
+    memset(&alert, 0, sizeof(alert));
+    strncpy(alert.type, type, sizeof(alert.type) - 1);
+    strncpy(alert.severity, severity, sizeof(alert.severity) - 1);
+    strncpy(alert.message, message, sizeof(alert.message) - 1);
+    alert.timestamp = timestamp;
+    return alert;
+}
+
+static void submit(const char* type, const char* severity, const char* message, uint32_t now) {
+    aggregator->submit(makeAlert(type, severity, message, now), now);
+}
+
+// Pops the next alert and checks its type, severity and message
+static void expectNext(const char* type, const char* severity, const char* message) {
+    const AlertRecord* alert = aggregator->peek();
+    TEST_ASSERT_NOT_NULL(alert);
+    TEST_ASSERT_EQUAL_STRING(type, alert->type);
+    TEST_ASSERT_EQUAL_STRING(severity, alert->severity);
+    TEST_ASSERT_EQUAL_STRING(message, alert->message);
+    aggregator->pop();
+}
+
+void test_repeats_are_folded_into_one_summary() {
+    submit("smoke", "medium", "Smoke 420 ppm", 1000);
+    submit("smoke", "medium", "Smoke 430 ppm", 2000);
+    submit("smoke", "medium", "Smoke 445 ppm", 30000);
+    submit("smoke", "medium", "Smoke 450 ppm", 60999);
+    expectNext("smoke", "medium", "Smoke 420 ppm");
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+
+    aggregator->update(60999);
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+    aggregator->update(61000);
+    expectNext("smoke", "medium", "Smoke 450 ppm (x3 in 60 s)");
+
+    AlertStats stats = aggregator->getStats();
+    TEST_ASSERT_EQUAL(4, stats.received);
+    TEST_ASSERT_EQUAL(2, stats.queued);
+    TEST_ASSERT_EQUAL(3, stats.suppressed);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+}
+
+void test_suppression_continues_while_repeats_keep_coming() {
+    submit("smoke", "high", "a", 0);
+    submit("smoke", "high", "b", 10000);
+    aggregator->update(60000);
+    submit("smoke", "high", "c", 70000);
+    submit("smoke", "high", "d", 80000);
+    aggregator->update(120000);
+    expectNext("smoke", "high", "a");
+    expectNext("smoke", "high", "b (x1 in 60 s)");
+    expectNext("smoke", "high", "d (x2 in 60 s)");
+
+    // A quiet window closes without a summary, and the next alert goes straight out
+    aggregator->update(180000);
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+    submit("smoke", "high", "e", 190000);
+    expectNext("smoke", "high", "e");
+}
+
+void test_window_closes_on_submit_without_update() {
+    submit("smoke", "medium", "a", 0);
+    submit("smoke", "medium", "b", 100);
+    submit("smoke", "medium", "c", 60000);
+    expectNext("smoke", "medium", "a");
+    expectNext("smoke", "medium", "b (x1 in 60 s)");
+    TEST_ASSERT_TRUE(aggregator->isEmpty()); // "c" opened the next window
+}
+
+void test_escalation_is_not_held_back_by_a_lower_window() {
+    submit("smoke", "medium", "medium", 0);
+    submit("smoke", "high", "high", 500);
+    expectNext("smoke", "high", "high");
+    expectNext("smoke", "medium", "medium");
+}
+
+void test_type_windows() {
+    TEST_ASSERT_TRUE(aggregator->setWindow("motion", 10000));
+    TEST_ASSERT_TRUE(aggregator->setWindow("door", 0));
+    submit("motion", "low", "m1", 0);
+    submit("motion", "low", "m2", 5000);
+    submit("door", "low", "d1", 5000);
+    submit("door", "low", "d2", 5001);
+    aggregator->update(10000);
+    expectNext("motion", "low", "m1");
+    expectNext("door", "low", "d1");
+    expectNext("door", "low", "d2");
+    expectNext("motion", "low", "m2 (x1 in 10 s)");
+
+    // Setting a type again replaces its window; the table holds MAX_WINDOWS types
+    TEST_ASSERT_TRUE(aggregator->setWindow("motion", 20000));
+    TEST_ASSERT_TRUE(aggregator->setWindow("gas", 1000));
+    TEST_ASSERT_TRUE(aggregator->setWindow("water", 1000));
+    TEST_ASSERT_FALSE(aggregator->setWindow("fire", 1000));
+}
+
+void test_release_order_is_severity_then_arrival() {
+    TEST_ASSERT_TRUE(aggregator->setWindow("t", 0));
+    submit("t", "low", "low 1", 0);
+    submit("t", "high", "high 1", 1);
+    submit("t", "medium", "medium 1", 2);
+    submit("t", "high", "high 2", 3);
+    submit("t", "unknown", "unknown", 4);
+    submit("t", "low", "low 2", 5);
+    expectNext("t", "high", "high 1");
+    expectNext("t", "high", "high 2");
+    expectNext("t", "medium", "medium 1");
+    expectNext("t", "low", "low 1");
+    expectNext("t", "unknown", "unknown");
+    expectNext("t", "low", "low 2");
+    TEST_ASSERT_NULL(aggregator->peek());
+}
+
+void test_full_queue_sheds_the_least_urgent_newest_alert() {
+    TEST_ASSERT_TRUE(aggregator->setWindow("t", 0));
+    char message[16];
+    for (int i = 0; i < AlertAggregator::QUEUE_CAPACITY; i++) {
+        snprintf(message, sizeof(message), "low %d", i);
+        submit("t", "low", message, i);
+    }
+    TEST_ASSERT_EQUAL(AlertAggregator::QUEUE_CAPACITY, aggregator->getQueuedCount());
+
+    // A more urgent alert replaces the newest low one; another low one is itself dropped
+    submit("t", "high", "high", 100);
+    submit("t", "low", "late low", 101);
+    TEST_ASSERT_EQUAL(AlertAggregator::QUEUE_CAPACITY, aggregator->getQueuedCount());
+    TEST_ASSERT_EQUAL(2, aggregator->getStats().dropped);
+
+    expectNext("t", "high", "high");
+    for (int i = 0; i < AlertAggregator::QUEUE_CAPACITY - 1; i++) {
+        snprintf(message, sizeof(message), "low %d", i);
+        expectNext("t", "low", message);
+    }
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+}
+
+void test_full_queue_of_urgent_alerts_drops_an_equal_newcomer() {
+    TEST_ASSERT_TRUE(aggregator->setWindow("t", 0));
+    for (int i = 0; i < AlertAggregator::QUEUE_CAPACITY; i++) {
+        submit("t", "high", "old", i);
+    }
+    submit("t", "high", "new", 100);
+    TEST_ASSERT_EQUAL(1, aggregator->getStats().dropped);
+    for (int i = 0; i < AlertAggregator::QUEUE_CAPACITY; i++) {
+        expectNext("t", "high", "old");
+    }
+}
+
+void test_summary_keeps_its_suffix_on_long_messages() {
+    char longMessage[AlertRecord::MESSAGE_SIZE];
+    memset(longMessage, 'x', sizeof(longMessage) - 1);
+    longMessage[sizeof(longMessage) - 1] = '\0';
+    submit("smoke", "high", longMessage, 0);
+    submit("smoke", "high", longMessage, 1);
+    aggregator->update(60000);
+    aggregator->pop();
+    const AlertRecord* summary = aggregator->peek();
+    TEST_ASSERT_NOT_NULL(summary);
+    size_t length = strlen(summary->message);
+    TEST_ASSERT_TRUE(length < sizeof(summary->message));
+    const char* suffix = " (x1 in 60 s)";
+    TEST_ASSERT_EQUAL_STRING(suffix, summary->message + length - strlen(suffix));
+}
+
+void test_tracking_a_new_pair_flushes_the_oldest_window() {
+    char type[16];
+    for (int i = 0; i < AlertAggregator::MAX_KEYS; i++) {
+        snprintf(type, sizeof(type), "type%d", i);
+        submit(type, "low", "first", i * 1000);
+    }
+    submit("type0", "low", "repeat", 9000);
+    while (!aggregator->isEmpty()) {
+        aggregator->pop();
+    }
+
+    // No free pair left: type0, open longest, is closed and its summary queued
+    submit("extra", "low", "extra", 10000);
+    expectNext("type0", "low", "repeat (x1 in 60 s)");
+    expectNext("extra", "low", "extra");
+
+    // type0 is new again; type1 gives way, with no repeats to summarize
+    submit("type0", "low", "again", 11000);
+    expectNext("type0", "low", "again");
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+}
+
+void test_severity_rank() {
+    TEST_ASSERT_EQUAL(0, AlertAggregator::severityRank("low"));
+    TEST_ASSERT_EQUAL(1, AlertAggregator::severityRank("medium"));
+    TEST_ASSERT_EQUAL(2, AlertAggregator::severityRank("high"));
+    TEST_ASSERT_EQUAL(0, AlertAggregator::severityRank("critical"));
+}
+
+void test_windows_survive_the_clock_wrap() {
+    uint32_t start = 0xFFFFFFFFu - 1000;
+    submit("smoke", "medium", "a", start);
+    submit("smoke", "medium", "b", start + 500);
+    aggregator->update(start + 59999);
+    aggregator->pop();
+    TEST_ASSERT_TRUE(aggregator->isEmpty());
+    aggregator->update(start + 60000);
+    expectNext("smoke", "medium", "b (x1 in 60 s)");
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_repeats_are_folded_into_one_summary);
+    RUN_TEST(test_suppression_continues_while_repeats_keep_coming);
+    RUN_TEST(test_window_closes_on_submit_without_update);
+    RUN_TEST(test_escalation_is_not_held_back_by_a_lower_window);
+    RUN_TEST(test_type_windows);
+    RUN_TEST(test_release_order_is_severity_then_arrival);
+    RUN_TEST(test_full_queue_sheds_the_least_urgent_newest_alert);
+    RUN_TEST(test_full_queue_of_urgent_alerts_drops_an_equal_newcomer);
+    RUN_TEST(test_summary_keeps_its_suffix_on_long_messages);
+    RUN_TEST(test_tracking_a_new_pair_flushes_the_oldest_window);
+    RUN_TEST(test_severity_rank);
+    RUN_TEST(test_windows_survive_the_clock_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "ChangeDetector.h"
+
+/**
+ * @brief One step of a sensor trace.
+ */
+struct TraceStep {
+    unsigned long time;
+    float temperature;
+    float humidity;
+    float smoke;
+    bool expectReport;
+};
+
+static ChangeDetector* detector;
+
+void setUp() {
+    detector = new ChangeDetector();
+}
+
+void tearDown() {
+    delete detector;
+}
+
+static SensorSample makeSample(float temperature, float humidity, float smoke) {
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.temperature = temperature;
+    sample.humidity = humidity;
+    sample.smokeLevel = smoke;
+    return sample;
+}
+
+// Feeds the trace as the telemetry task does: publish, then mark, whenever a report is due
+static void runTrace(const TraceStep* steps, int count) {
+    for (int i = 0; i < count; i++) {
+        SensorSample sample = makeSample(steps[i].temperature, steps[i].humidity, steps[i].smoke);
+        bool report = detector->shouldReport(sample, steps[i].time);
+        char message[48];
+        snprintf(message, sizeof(message), "step %d at %lu ms", i, steps[i].time);
+        TEST_ASSERT_TRUE_MESSAGE(report == steps[i].expectReport, message);
+        if (report) {
+            detector->markReported(sample, steps[i].time);
+        }
+    }
+}
+
+void test_first_sample_is_always_reported() {
+    TEST_ASSERT_TRUE(detector->shouldReport(makeSample(22, 50, 300), 0));
+}
+
+void test_temperature_deadband_is_measured_from_the_last_report() {
+    // Slow drift: every step is below the band, the accumulated change is not
+    const TraceStep trace[] = {
+        {0, 22.0f, 50, 300, true},
+        {100, 22.2f, 50, 300, false},
+        {200, 22.4f, 50, 300, false},
+        {300, 22.5f, 50, 300, true},
+        {400, 22.7f, 50, 300, false},
+        {500, 22.3f, 50, 300, false},
+        {600, 22.0f, 50, 300, true},
+        {700, 22.0f, 50, 300, false},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_humidity_deadband() {
+    const TraceStep trace[] = {
+        {0, 22, 50.0f, 300, true},
+        {100, 22, 51.9f, 300, false},
+        {200, 22, 48.0f, 300, true},
+        {300, 22, 49.0f, 300, false},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_smoke_band_is_relative_with_an_absolute_floor() {
+    const TraceStep trace[] = {
+        {0, 22, 50, 300.0f, true},
+        {100, 22, 50, 329.0f, false}, // 10 % of 300 is 30
+        {200, 22, 50, 330.0f, true},
+        {300, 22, 50, 50.0f, true},
+        {400, 22, 50, 55.0f, false},  // 10 % of 50 is 5, the 10 ppm floor applies
+        {500, 22, 50, 59.0f, false},
+        {600, 22, 50, 60.0f, true},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_unchanged_readings_report_at_the_deadline() {
+    detector->setMaxSilence(5000);
+    int reports = 0;
+    unsigned long reportTimes[4];
+    for (unsigned long now = 0; now <= 12000; now += 1000) {
+        SensorSample sample = makeSample(22, 50, 300);
+        if (detector->shouldReport(sample, now)) {
+            detector->markReported(sample, now);
+            if (reports < 4) {
+                reportTimes[reports] = now;
+            }
+            reports++;
+        }
+    }
+    TEST_ASSERT_EQUAL(3, reports);
+    TEST_ASSERT_EQUAL(0, reportTimes[0]);
+    TEST_ASSERT_EQUAL(5000, reportTimes[1]);
+    TEST_ASSERT_EQUAL(10000, reportTimes[2]);
+}
+
+void test_a_change_restarts_the_deadline() {
+    detector->setMaxSilence(5000);
+    const TraceStep trace[] = {
+        {0, 22.0f, 50, 300, true},
+        {3000, 23.0f, 50, 300, true},
+        {7000, 23.0f, 50, 300, false},
+        {8000, 23.0f, 50, 300, true},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_deadline_survives_the_clock_wrapping() {
+    detector->setMaxSilence(5000);
+    SensorSample sample = makeSample(22, 50, 300);
+    unsigned long start = (unsigned long)-2000;
+    detector->markReported(sample, start);
+    TEST_ASSERT_FALSE(detector->shouldReport(sample, start + 4999));
+    TEST_ASSERT_TRUE(detector->shouldReport(sample, start + 5000));
+}
+
+void test_discrete_fields_always_report() {
+    SensorSample sample = makeSample(22, 50, 300);
+    detector->markReported(sample, 0);
+    sample.motionDetected = true;
+    TEST_ASSERT_TRUE(detector->shouldReport(sample, 1));
+    sample.motionDetected = false;
+    sample.servoPosition = 1;
+    TEST_ASSERT_TRUE(detector->shouldReport(sample, 1));
+    sample.servoPosition = 0;
+    sample.servo2Position = 90;
+    TEST_ASSERT_TRUE(detector->shouldReport(sample, 1));
+}
+
+void test_sensor_failing_and_recovering_is_reported() {
+    const TraceStep trace[] = {
+        {0, 22.0f, 50, 300, true},
+        {100, NAN, 50, 300, true},
+        {200, NAN, 50, 300, false},
+        {300, 22.0f, 50, 300, true},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_reset_forces_the_next_report() {
+    SensorSample sample = makeSample(22, 50, 300);
+    detector->markReported(sample, 0);
+    TEST_ASSERT_FALSE(detector->shouldReport(sample, 1));
+    detector->reset();
+    TEST_ASSERT_TRUE(detector->shouldReport(sample, 1));
+}
+
+void test_zero_deadband_reports_any_change_but_not_repeats() {
+    detector->setDeadband(ChangeDetector::TEMPERATURE, 0, 0);
+    const TraceStep trace[] = {
+        {0, 22.00f, 50, 300, true},
+        {100, 22.00f, 50, 300, false},
+        {200, 22.01f, 50, 300, true},
+    };
+    runTrace(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_is_always_reported);
+    RUN_TEST(test_temperature_deadband_is_measured_from_the_last_report);
+    RUN_TEST(test_humidity_deadband);
+    RUN_TEST(test_smoke_band_is_relative_with_an_absolute_floor);
+    RUN_TEST(test_unchanged_readings_report_at_the_deadline);
+    RUN_TEST(test_a_change_restarts_the_deadline);
+    RUN_TEST(test_deadline_survives_the_clock_wrapping);
+    RUN_TEST(test_discrete_fields_always_report);
+    RUN_TEST(test_sensor_failing_and_recovering_is_reported);
+    RUN_TEST(test_reset_forces_the_next_report);
+    RUN_TEST(test_zero_deadband_reports_any_change_but_not_repeats);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include "ColumnarBatchEncoder.h"
+#include "TelemetryDecoder.h"
+
+static ColumnarBatchEncoder* batch;
+
+void setUp() {
+    batch = new ColumnarBatchEncoder();
+}
+
+void tearDown() {
+    delete batch;
+}
+
+static SensorSample makeSample(int index) {
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.sequence = index + 1;
+    // Irregular spacing, so deltas cross the one- and two-byte CBOR forms
+    sample.timestamp = 1000000 + index * 1000 + (index % 3) * 17 + (index % 5 == 0 ? 300 : 0);
+    sample.temperature = index % 7 == 3 ? NAN : 20.0f + index * 0.25f;
+    sample.humidity = 45.5f - index * 0.5f;
+    sample.smokeLevel = 300.0f + index * 12.34f;
+    sample.servoPosition = (int16_t)(index * 7 - 90);
+    sample.servo2Position = (int16_t)(180 - index * 3);
+    sample.motionDetected = index % 4 == 1;
+    return sample;
+}
+
+static void assertSameSample(const SensorSample& expected, const SensorSample& actual) {
+    TEST_ASSERT_EQUAL(expected.timestamp, actual.timestamp);
+    if (isnan(expected.temperature)) {
+        TEST_ASSERT_TRUE(isnan(actual.temperature));
+    } else {
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, expected.temperature, actual.temperature);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, expected.humidity, actual.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, expected.smokeLevel, actual.smokeLevel);
+    TEST_ASSERT_EQUAL(expected.servoPosition, actual.servoPosition);
+    TEST_ASSERT_EQUAL(expected.servo2Position, actual.servo2Position);
+    TEST_ASSERT_EQUAL(expected.motionDetected, actual.motionDetected);
+}
+
+void test_cbor_batch_round_trips_through_the_decoder() {
+    batch->configure(PAYLOAD_CBOR, ColumnarBatchEncoder::BUFFER_SIZE);
+    const int count = 30;
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(batch->add(makeSample(i)));
+    }
+    size_t length;
+    const uint8_t* payload = batch->encode(length);
+    TEST_ASSERT_GREATER_THAN(0, length);
+
+    SensorSample decoded[ColumnarBatchEncoder::MAX_SAMPLES];
+    TEST_ASSERT_EQUAL(count, TelemetryDecoder::decodeBatch(payload, length, decoded, ColumnarBatchEncoder::MAX_SAMPLES));
+    for (int i = 0; i < count; i++) {
+        assertSameSample(makeSample(i), decoded[i]);
+    }
+}
+
+void test_single_sample_batch_round_trips() {
+    batch->configure(PAYLOAD_CBOR, 256);
+    TEST_ASSERT_TRUE(batch->add(makeSample(3)));
+    size_t length;
+    const uint8_t* payload = batch->encode(length);
+    SensorSample decoded;
+    TEST_ASSERT_EQUAL(1, TelemetryDecoder::decodeBatch(payload, length, &decoded, 1));
+    assertSameSample(makeSample(3), decoded);
+}
+
+void test_decoder_keeps_the_samples_that_fit() {
+    batch->configure(PAYLOAD_CBOR, ColumnarBatchEncoder::BUFFER_SIZE);
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(batch->add(makeSample(i)));
+    }
+    size_t length;
+    const uint8_t* payload = batch->encode(length);
+    SensorSample decoded[4];
+    TEST_ASSERT_EQUAL(4, TelemetryDecoder::decodeBatch(payload, length, decoded, 4));
+    for (int i = 0; i < 4; i++) {
+        assertSameSample(makeSample(i), decoded[i]);
+    }
+}
+
+void test_json_batch_layout() {
+    SensorSample first = makeSample(0);
+    SensorSample second = makeSample(1);
+    first.temperature = 21.5f;
+    second.temperature = NAN;
+    TEST_ASSERT_TRUE(batch->add(first));
+    TEST_ASSERT_TRUE(batch->add(second));
+    size_t length;
+    const uint8_t* payload = batch->encode(length);
+    const char expected[] = "{\"t0\":1000300,\"dt\":[0,717],\"temperature\":[21.5,-999],\"humidity\":[45.5,45],"
+                            "\"motionDetected\":[false,true],\"smokeLevel\":[300,312.34],"
+                            "\"servoPosition\":[-90,-83],\"servo2Position\":[180,177]}";
+    std::string text((const char*)payload, length);
+    TEST_ASSERT_EQUAL_STRING(expected, text.c_str());
+}
+
+void test_encoded_size_is_exact_for_every_count() {
+    const PayloadFormat formats[] = {PAYLOAD_JSON, PAYLOAD_CBOR};
+    for (int f = 0; f < 2; f++) {
+        batch->configure(formats[f], ColumnarBatchEncoder::BUFFER_SIZE);
+        for (int i = 0; i < ColumnarBatchEncoder::MAX_SAMPLES; i++) {
+            if (!batch->add(makeSample(i))) {
+                break;
+            }
+            size_t length;
+            batch->encode(length);
+            TEST_ASSERT_EQUAL(batch->getEncodedSize(), length);
+        }
+        TEST_ASSERT_GREATER_THAN(24, batch->getCount()); // Past the wider CBOR array headers
+    }
+}
+
+void test_batch_stops_at_the_payload_limit() {
+    batch->configure(PAYLOAD_JSON, 400);
+    int added = 0;
+    while (batch->add(makeSample(added))) {
+        added++;
+    }
+    TEST_ASSERT_GREATER_THAN(1, added);
+    TEST_ASSERT_EQUAL(added, batch->getCount());
+    size_t length;
+    batch->encode(length);
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_LESS_OR_EQUAL(400, length);
+
+    // The rejected sample starts the next batch
+    batch->clear();
+    TEST_ASSERT_TRUE(batch->add(makeSample(added)));
+    TEST_ASSERT_EQUAL(1, batch->getCount());
+}
+
+void test_sample_larger_than_the_limit_is_refused() {
+    batch->configure(PAYLOAD_CBOR, 16);
+    TEST_ASSERT_FALSE(batch->add(makeSample(0)));
+    TEST_ASSERT_TRUE(batch->isEmpty());
+    size_t length;
+    batch->encode(length);
+    TEST_ASSERT_EQUAL(0, length);
+}
+
+void test_limit_is_capped_at_the_buffer_size() {
+    batch->configure(PAYLOAD_JSON, 1000000);
+    int added = 0;
+    while (added < ColumnarBatchEncoder::MAX_SAMPLES && batch->add(makeSample(added))) {
+        added++;
+    }
+    size_t length;
+    batch->encode(length);
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_LESS_OR_EQUAL(ColumnarBatchEncoder::BUFFER_SIZE, length);
+}
+
+void test_batch_holds_at_most_max_samples() {
+    batch->configure(PAYLOAD_CBOR, ColumnarBatchEncoder::BUFFER_SIZE);
+    for (int i = 0; i < ColumnarBatchEncoder::MAX_SAMPLES; i++) {
+        TEST_ASSERT_TRUE(batch->add(makeSample(i)));
+    }
+    TEST_ASSERT_FALSE(batch->add(makeSample(ColumnarBatchEncoder::MAX_SAMPLES)));
+    TEST_ASSERT_EQUAL(ColumnarBatchEncoder::MAX_SAMPLES, batch->getCount());
+}
+
+void test_configure_drops_the_batch() {
+    TEST_ASSERT_TRUE(batch->add(makeSample(0)));
+    batch->configure(PAYLOAD_CBOR, 512);
+    TEST_ASSERT_TRUE(batch->isEmpty());
+    TEST_ASSERT_EQUAL(0, batch->getEncodedSize());
+}
+
+void test_columns_of_different_lengths_are_rejected() {
+    // Version, map(2), key 8: [0, 10], key 2: [2150]
+    const uint8_t payload[] = {TelemetrySchema::VERSION, 0xA2, 0x08, 0x82, 0x00, 0x0A, 0x02, 0x81, 0x19, 0x08, 0x66};
+    SensorSample decoded[2];
+    TEST_ASSERT_EQUAL(-1, TelemetryDecoder::decodeBatch(payload, sizeof(payload), decoded, 2));
+}
+
+void test_truncated_batch_is_rejected() {
+    batch->configure(PAYLOAD_CBOR, ColumnarBatchEncoder::BUFFER_SIZE);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(batch->add(makeSample(i)));
+    }
+    size_t length;
+    const uint8_t* payload = batch->encode(length);
+    SensorSample decoded[5];
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_EQUAL(-1, TelemetryDecoder::decodeBatch(payload, cut, decoded, 5));
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_cbor_batch_round_trips_through_the_decoder);
+    RUN_TEST(test_single_sample_batch_round_trips);
+    RUN_TEST(test_decoder_keeps_the_samples_that_fit);
+    RUN_TEST(test_json_batch_layout);
+    RUN_TEST(test_encoded_size_is_exact_for_every_count);
+    RUN_TEST(test_batch_stops_at_the_payload_limit);
+    RUN_TEST(test_sample_larger_than_the_limit_is_refused);
+    RUN_TEST(test_limit_is_capped_at_the_buffer_size);
+    RUN_TEST(test_batch_holds_at_most_max_samples);
+    RUN_TEST(test_configure_drops_the_batch);
+    RUN_TEST(test_columns_of_different_lengths_are_rejected);
+    RUN_TEST(test_truncated_batch_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CommandParser.h"
+
+/**
+ * @brief One payload of the corpus and what the parser must make of it.
+ */
+struct CorpusEntry {
+    const char* payload;
+    CommandParseResult result;
+    uint8_t servo;    ///< Checked when the result is COMMAND_PARSE_OK.
+    int16_t position;
+};
+
+static const CorpusEntry CORPUS[] = {
+    {"{\"servo\": 2, \"position\": 90}", COMMAND_PARSE_OK, 2, 90},
+    {"{\"position\":45}", COMMAND_PARSE_OK, 1, 45},
+    {" \r\n{ \"position\" : 180 ,\t\"servo\" : 1 } ", COMMAND_PARSE_OK, 1, 180},
+    {"{\"position\": 0}", COMMAND_PARSE_OK, 1, 0},
+    {"{\"position\": 90.9}", COMMAND_PARSE_OK, 1, 90},
+    {"{\"position\": 1e2}", COMMAND_PARSE_OK, 1, 100},
+    {"{\"position\": 9E1, \"servo\": 2.0}", COMMAND_PARSE_OK, 2, 90},
+    {"{\"position\": 1800e-1}", COMMAND_PARSE_OK, 1, 180},
+    {"{\"id\": \"a}\\\"b\", \"extra\": {\"position\": 999, \"list\": [1, [2], \"]\"]}, \"position\": 30}",
+        COMMAND_PARSE_OK, 1, 30},
+    {"{\"flag\": true, \"none\": null, \"off\": false, \"position\": 10}", COMMAND_PARSE_OK, 1, 10},
+    {"{\"position\": 10, \"position\": 20}", COMMAND_PARSE_OK, 1, 20},
+    {"{\"position\": 181}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{\"position\": -1}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{\"position\": 99999999999999999999}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{\"position\": 1e99}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{\"position\": 90, \"servo\": 3}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{\"position\": 90, \"servo\": 0}", COMMAND_PARSE_OUT_OF_RANGE, 0, 0},
+    {"{}", COMMAND_PARSE_MISSING_FIELD, 0, 0},
+    {"{\"servo\": 1}", COMMAND_PARSE_MISSING_FIELD, 0, 0},
+    {"{\"position\": \"90\"}", COMMAND_PARSE_MISSING_FIELD, 0, 0},
+    {"{\"position\": null}", COMMAND_PARSE_MISSING_FIELD, 0, 0},
+    {"{\"position\": 90, \"servo\": \"two\"}", COMMAND_PARSE_MISSING_FIELD, 0, 0},
+    {"", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"90", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"[\"position\", 90]", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": 90", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\" 90}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": 90,}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": 90 \"servo\": 1}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": -}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": 9.}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": 9e}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"position\": tru}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"extra\": [1, 2, \"position\": 90}", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"posit", COMMAND_PARSE_MALFORMED, 0, 0},
+    {"{\"a\\", COMMAND_PARSE_MALFORMED, 0, 0},
+};
+static const int CORPUS_SIZE = sizeof(CORPUS) / sizeof(CORPUS[0]);
+
+static const unsigned long FUZZ_INPUTS = 200000;
+static const size_t FUZZ_MAX_LENGTH = 96;
+
+void setUp() {}
+
+void tearDown() {}
+
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Parses from an exactly sized heap copy, so that a sanitizer catches any read past the end
+static CommandParseResult parse(const uint8_t* payload, size_t length, ServoCommandRecord& command) {
+    uint8_t* copy = (uint8_t*)malloc(length > 0 ? length : 1);
+    memcpy(copy, payload, length);
+    CommandParseResult result = CommandParser::parseServoCommand(copy, length, command);
+    free(copy);
+    return result;
+}
+
+void test_corpus() {
+    for (int i = 0; i < CORPUS_SIZE; i++) {
+        ServoCommandRecord command = {0, 0};
+        const CorpusEntry& entry = CORPUS[i];
+        CommandParseResult result = parse((const uint8_t*)entry.payload, strlen(entry.payload), command);
+        char message[160];
+        snprintf(message, sizeof(message), "corpus %d: %s", i, entry.payload);
+        TEST_ASSERT_EQUAL_MESSAGE(entry.result, result, message);
+        if (entry.result == COMMAND_PARSE_OK) {
+            TEST_ASSERT_EQUAL_MESSAGE(entry.servo, command.servo, message);
+            TEST_ASSERT_EQUAL_MESSAGE(entry.position, command.position, message);
+        }
+    }
+}
+
+void test_rejected_command_leaves_the_record_untouched() {
+    ServoCommandRecord command = {2, 77};
+    const char* payload = "{\"position\": 181, \"servo\": 1}";
+    TEST_ASSERT_EQUAL(COMMAND_PARSE_OUT_OF_RANGE, parse((const uint8_t*)payload, strlen(payload), command));
+    TEST_ASSERT_EQUAL(2, command.servo);
+    TEST_ASSERT_EQUAL(77, command.position);
+}
+
+void test_every_truncation_of_a_valid_command_is_rejected() {
+    const char* payload = "{\"servo\": 2, \"extra\": [\"}\"], \"position\": 90}";
+    size_t length = strlen(payload);
+    for (size_t cut = 0; cut < length; cut++) {
+        ServoCommandRecord command;
+        TEST_ASSERT_NOT_EQUAL(COMMAND_PARSE_OK, parse((const uint8_t*)payload, cut, command));
+    }
+}
+
+void test_mutated_corpus_never_yields_an_out_of_range_command() {
+    // Byte flips, JSON punctuation, insertions, deletions and truncations of the corpus entries
+    static const char TOKENS[] = "{}[]\":,.-+eE0123456789 \\tnf";
+    uint32_t state = 12345;
+    uint8_t input[FUZZ_MAX_LENGTH];
+    unsigned long accepted = 0;
+    for (unsigned long n = 0; n < FUZZ_INPUTS; n++) {
+        const char* seed = CORPUS[nextRandom(state) % CORPUS_SIZE].payload;
+        size_t length = strlen(seed);
+        memcpy(input, seed, length);
+        int mutations = 1 + nextRandom(state) % 4;
+        for (int m = 0; m < mutations; m++) {
+            size_t at = length > 0 ? nextRandom(state) % length : 0;
+            switch (nextRandom(state) % 5) {
+                case 0:
+                    if (length > 0) {
+                        input[at] ^= (uint8_t)(1 << (nextRandom(state) % 8));
+                    }
+                    break;
+                case 1:
+                    if (length > 0) {
+                        input[at] = TOKENS[nextRandom(state) % (sizeof(TOKENS) - 1)];
+                    }
+                    break;
+                case 2:
+                    if (length < FUZZ_MAX_LENGTH) {
+                        memmove(input + at + 1, input + at, length - at);
+                        input[at] = TOKENS[nextRandom(state) % (sizeof(TOKENS) - 1)];
+                        length++;
+                    }
+                    break;
+                case 3:
+                    if (length > 0) {
+                        memmove(input + at, input + at + 1, length - at - 1);
+                        length--;
+                    }
+                    break;
+                default:
+                    length = at;
+                    break;
+            }
+        }
+
+        ServoCommandRecord command = {0, 0};
+        CommandParseResult result = parse(input, length, command);
+        TEST_ASSERT_TRUE(result >= COMMAND_PARSE_OK && result <= COMMAND_PARSE_OUT_OF_RANGE);
+        if (result == COMMAND_PARSE_OK) {
+            accepted++;
+            TEST_ASSERT_TRUE(command.servo == 1 || command.servo == 2);
+            TEST_ASSERT_TRUE(command.position >= 0 && command.position <= 180);
+        }
+    }
+    // The mutations must leave enough valid commands for the range check to mean something
+    TEST_ASSERT_TRUE(accepted > FUZZ_INPUTS / 50);
+}
+
+void test_random_bytes_are_safe_input() {
+    uint32_t state = 777;
+    uint8_t input[FUZZ_MAX_LENGTH];
+    for (unsigned long n = 0; n < FUZZ_INPUTS / 4; n++) {
+        size_t length = nextRandom(state) % FUZZ_MAX_LENGTH;
+        for (size_t i = 0; i < length; i++) {
+            input[i] = (uint8_t)nextRandom(state);
+        }
+        if (length > 0) {
+            input[0] = '{';
+        }
+        ServoCommandRecord command;
+        CommandParseResult result = parse(input, length, command);
+        if (result == COMMAND_PARSE_OK) {
+            TEST_ASSERT_TRUE(command.servo == 1 || command.servo == 2);
+            TEST_ASSERT_TRUE(command.position >= 0 && command.position <= 180);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus);
+    RUN_TEST(test_rejected_command_leaves_the_record_untouched);
+    RUN_TEST(test_every_truncation_of_a_valid_command_is_rejected);
+    RUN_TEST(test_mutated_corpus_never_yields_an_out_of_range_command);
+    RUN_TEST(test_random_bytes_are_safe_input);
+    return UNITY_END();
+}
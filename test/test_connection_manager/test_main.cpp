@@ -0,0 +1,278 @@
+#include <unity.h>
+#include <string.h>
+#include "ConnectionManager.h"
+
+// Link layer whose WiFi and broker outcomes the test decides
+class FakeTransport : public ConnectionTransport {
+public:
+    bool wifiUp;
+    bool mqttUp;
+    bool brokerAccepts;
+    int pendingPolls;         ///< connectMqtt() calls answered MQTT_ATTEMPT_PENDING first.
+    int wifiStarts;
+    bool lastStartUsedBssid;
+    int mqttAttempts;
+    int discardedAttempts;    ///< Pending attempts dropped by beginWiFi().
+
+    FakeTransport()
+        : wifiUp(false), mqttUp(false), brokerAccepts(false), pendingPolls(0), wifiStarts(0),
+          lastStartUsedBssid(false), mqttAttempts(0), discardedAttempts(0) {}
+
+    void beginWiFi(const uint8_t* bssid, int32_t channel) override {
+        (void)channel;
+        wifiStarts++;
+        lastStartUsedBssid = bssid != nullptr;
+        if (pendingPolls > 0) {
+            discardedAttempts++;
+            pendingPolls = 0;
+        }
+    }
+    void disconnectWiFi() override { wifiUp = false; }
+    bool isWiFiConnected() override { return wifiUp; }
+    bool getWiFiInfo(uint8_t* bssid, int32_t& channel) override {
+        memset(bssid, 0xAB, 6);
+        channel = 6;
+        return true;
+    }
+    MqttAttempt connectMqtt() override {
+        if (pendingPolls > 0) {
+            pendingPolls--;
+            return MQTT_ATTEMPT_PENDING;
+        }
+        mqttAttempts++;
+        mqttUp = brokerAccepts;
+        return brokerAccepts ? MQTT_ATTEMPT_ACCEPTED : MQTT_ATTEMPT_FAILED;
+    }
+    bool isMqttConnected() override { return mqttUp; }
+    void loopMqtt() override {}
+};
+
+class RecordingHandler : public EventHandler {
+public:
+    int events[16];
+    int count;
+    RecordingHandler() : count(0) {}
+    void on(Event event) override {
+        if (count < 16) {
+            events[count++] = event.id;
+        }
+    }
+};
+
+static unsigned long now;
+static uint32_t randomValue;
+
+static unsigned long fakeClock() {
+    return now;
+}
+
+static uint32_t fakeRandom() {
+    return randomValue;
+}
+
+static FakeTransport* transport;
+static RecordingHandler* handler;
+static ConnectionManager* manager;
+
+void setUp() {
+    now = 1000;
+    randomValue = 0;
+    transport = new FakeTransport();
+    handler = new RecordingHandler();
+    manager = new ConnectionManager(transport, handler, fakeClock, fakeRandom);
+    manager->setBackoff(1000, 8000);
+}
+
+void tearDown() {
+    delete manager;
+    delete handler;
+    delete transport;
+}
+
+static void bringUpWiFi() {
+    manager->begin();
+    transport->wifiUp = true;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_CONNECTING, manager->getState());
+}
+
+void test_association_raises_wifi_connected() {
+    manager->begin();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+    TEST_ASSERT_FALSE(transport->lastStartUsedBssid);
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+
+    transport->wifiUp = true;
+    manager->update();
+    TEST_ASSERT_TRUE(manager->isWiFiConnected());
+    TEST_ASSERT_EQUAL(1, handler->count);
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTED_EVENT_ID, handler->events[0]);
+}
+
+void test_broker_accepting_connects() {
+    bringUpWiFi();
+    transport->brokerAccepts = true;
+    manager->update();
+    TEST_ASSERT_TRUE(manager->isConnected());
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_CONNECTED_EVENT_ID, handler->events[1]);
+    TEST_ASSERT_EQUAL(0, manager->getFailedAttempts());
+}
+
+void test_pending_attempt_waits_without_backoff() {
+    bringUpWiFi();
+    transport->brokerAccepts = true;
+    transport->pendingPolls = 3;
+    for (int i = 0; i < 3; i++) {
+        manager->update();
+        TEST_ASSERT_EQUAL(ConnectionManager::MQTT_CONNECTING, manager->getState());
+        TEST_ASSERT_EQUAL(0, manager->getRetryDelay());
+    }
+    manager->update();
+    TEST_ASSERT_TRUE(manager->isConnected());
+    TEST_ASSERT_EQUAL(1, transport->mqttAttempts);
+}
+
+void test_wifi_loss_discards_the_pending_attempt() {
+    bringUpWiFi();
+    transport->brokerAccepts = true;
+    transport->pendingPolls = 3;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_CONNECTING, manager->getState());
+
+    // The link drops mid-attempt: the association restarts and drops the attempt with it
+    transport->wifiUp = false;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+    TEST_ASSERT_EQUAL(2, transport->wifiStarts);
+    TEST_ASSERT_EQUAL(1, transport->discardedAttempts);
+
+    // The new link gets a fresh attempt, not the outcome of the old one
+    transport->brokerAccepts = false;
+    transport->wifiUp = true;
+    manager->update();
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_BACKOFF, manager->getState());
+    TEST_ASSERT_EQUAL(1, transport->mqttAttempts);
+}
+
+void test_backoff_doubles_up_to_the_maximum() {
+    bringUpWiFi();
+    // Lowest jitter: half of the ceiling
+    const unsigned long expected[] = {500, 1000, 2000, 4000, 4000, 4000};
+    for (int i = 0; i < 6; i++) {
+        manager->update();
+        TEST_ASSERT_EQUAL(ConnectionManager::MQTT_BACKOFF, manager->getState());
+        TEST_ASSERT_EQUAL(expected[i], manager->getRetryDelay());
+        TEST_ASSERT_EQUAL(i + 1, manager->getFailedAttempts());
+
+        now += expected[i] - 1;
+        manager->update();
+        TEST_ASSERT_EQUAL(ConnectionManager::MQTT_BACKOFF, manager->getState());
+        now += 1;
+        manager->update();
+        TEST_ASSERT_EQUAL(ConnectionManager::MQTT_CONNECTING, manager->getState());
+    }
+}
+
+void test_highest_jitter_reaches_the_ceiling() {
+    bringUpWiFi();
+    const unsigned long ceilings[] = {1000, 2000, 4000, 8000, 8000};
+    for (int i = 0; i < 5; i++) {
+        // ceiling / 2 is the largest value the modulo lets through
+        randomValue = ceilings[i] / 2;
+        manager->update();
+        TEST_ASSERT_EQUAL(ceilings[i], manager->getRetryDelay());
+        now += ceilings[i];
+        manager->update();
+    }
+}
+
+void test_jitter_stays_within_half_and_full_ceiling() {
+    bringUpWiFi();
+    uint32_t seed = 12345;
+    unsigned long ceiling = 1000;
+    unsigned long lowest = 8000;
+    unsigned long highest = 0;
+    for (int i = 0; i < 200; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        randomValue = seed;
+        manager->update();
+        unsigned long delay = manager->getRetryDelay();
+        TEST_ASSERT_GREATER_OR_EQUAL(ceiling / 2, delay);
+        TEST_ASSERT_LESS_OR_EQUAL(ceiling, delay);
+        if (ceiling == 8000) {
+            lowest = delay < lowest ? delay : lowest;
+            highest = delay > highest ? delay : highest;
+        }
+        now += delay;
+        manager->update();
+        if (ceiling < 8000) {
+            ceiling *= 2;
+        }
+    }
+    // Spread over the range, so devices do not retry in lockstep
+    TEST_ASSERT_LESS_THAN(5000, lowest);
+    TEST_ASSERT_GREATER_THAN(7000, highest);
+}
+
+void test_no_random_source_waits_the_full_ceiling() {
+    delete manager;
+    manager = new ConnectionManager(transport, handler, fakeClock, nullptr);
+    manager->setBackoff(1000, 8000);
+    bringUpWiFi();
+    manager->update();
+    TEST_ASSERT_EQUAL(1000, manager->getRetryDelay());
+}
+
+void test_cached_access_point_times_out_fast_then_scans() {
+    bringUpWiFi();
+    transport->brokerAccepts = true;
+    manager->update();
+    TEST_ASSERT_TRUE(manager->isConnected());
+
+    // The link drops: the cached BSSID is tried first
+    transport->wifiUp = false;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+    TEST_ASSERT_TRUE(transport->lastStartUsedBssid);
+
+    now += ConnectionManager::WIFI_FAST_CONNECT_TIMEOUT;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_BACKOFF, manager->getState());
+    now += manager->getRetryDelay();
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+    TEST_ASSERT_FALSE(transport->lastStartUsedBssid);
+
+    // A full scan gets the longer timeout
+    now += ConnectionManager::WIFI_FAST_CONNECT_TIMEOUT;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, manager->getState());
+}
+
+void test_lost_session_backs_off_and_reports_it() {
+    bringUpWiFi();
+    transport->brokerAccepts = true;
+    manager->update();
+    transport->mqttUp = false;
+    manager->update();
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_BACKOFF, manager->getState());
+    TEST_ASSERT_EQUAL(ConnectionManager::MQTT_DISCONNECTED_EVENT_ID, handler->events[handler->count - 1]);
+    TEST_ASSERT_TRUE(manager->isWiFiConnected());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_association_raises_wifi_connected);
+    RUN_TEST(test_broker_accepting_connects);
+    RUN_TEST(test_pending_attempt_waits_without_backoff);
+    RUN_TEST(test_wifi_loss_discards_the_pending_attempt);
+    RUN_TEST(test_backoff_doubles_up_to_the_maximum);
+    RUN_TEST(test_highest_jitter_reaches_the_ceiling);
+    RUN_TEST(test_jitter_stays_within_half_and_full_ceiling);
+    RUN_TEST(test_no_random_source_waits_the_full_ceiling);
+    RUN_TEST(test_cached_access_point_times_out_fast_then_scans);
+    RUN_TEST(test_lost_session_backs_off_and_reports_it);
+    return UNITY_END();
+}
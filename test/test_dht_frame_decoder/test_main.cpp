@@ -0,0 +1,129 @@
+#include <unity.h>
+#include "DhtFrameDecoder.h"
+
+// Transitions of a DHT22 frame as the capture ISR timestamps them, with the sensor's jitter:
+// host release, 80 us response, then 40 bits of ~50 us low and ~26/~70 us high.
+// 65.2 %RH, -10.1 C: bytes 02 8C 80 65, checksum 73. The line level alternates from high.
+static const uint32_t FRAME_EDGES[] = {
+    0, 31, 112, 191, 239, 263, 309, 339, 392, 415,
+    462, 493, 544, 566, 615, 640, 686, 756, 804, 833,
+    885, 950, 996, 1026, 1076, 1101, 1153, 1177, 1225, 1291,
+    1345, 1419, 1465, 1491, 1542, 1567, 1615, 1686, 1736, 1767,
+    1821, 1844, 1894, 1919, 1967, 1994, 2040, 2066, 2120, 2141,
+    2193, 2218, 2272, 2297, 2351, 2422, 2474, 2549, 2597, 2622,
+    2673, 2700, 2746, 2815, 2869, 2898, 2952, 3023, 3077, 3104,
+    3151, 3217, 3270, 3340, 3387, 3458, 3510, 3531, 3580, 3609,
+    3658, 3729, 3775, 3841, 3893,
+};
+static const int FRAME_EDGE_COUNT = sizeof(FRAME_EDGES) / sizeof(FRAME_EDGES[0]);
+static const int FIRST_BIT_FALL = 5; ///< Edge ending the high phase of the first data bit.
+
+static uint8_t levels[FRAME_EDGE_COUNT];
+static uint32_t edges[FRAME_EDGE_COUNT];
+static uint16_t pulses[64];
+
+void setUp() {
+    for (int i = 0; i < FRAME_EDGE_COUNT; i++) {
+        edges[i] = FRAME_EDGES[i];
+        levels[i] = (i % 2 == 0) ? 1 : 0;
+    }
+}
+
+void tearDown() {}
+
+static DhtDecodeResult decodeEdges(int edgeCount, uint8_t dhtType, DhtReading& reading) {
+    int count = DhtFrameDecoder::highPulsesFromEdges(edges, levels, edgeCount, pulses, 64);
+    return DhtFrameDecoder::decode(pulses, count, dhtType, reading);
+}
+
+// Widths of a frame carrying the given bytes, as decodeBytes() expects them
+static int pulsesForBytes(const uint8_t data[5], uint16_t* out) {
+    int count = 0;
+    out[count++] = 80; // Sensor response
+    for (int i = 0; i < DhtFrameDecoder::FRAME_BITS; i++) {
+        out[count++] = (data[i / 8] & (0x80 >> (i % 8))) ? 70 : 26;
+    }
+    return count;
+}
+
+void test_edges_yield_response_and_data_pulses() {
+    int count = DhtFrameDecoder::highPulsesFromEdges(edges, levels, FRAME_EDGE_COUNT, pulses, 64);
+    // Host release and sensor response precede the 40 data bits
+    TEST_ASSERT_EQUAL(2 + DhtFrameDecoder::FRAME_BITS, count);
+    TEST_ASSERT_EQUAL(31, pulses[0]);
+    TEST_ASSERT_EQUAL(79, pulses[1]);
+}
+
+void test_valid_dht22_frame_decodes() {
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, decodeEdges(FRAME_EDGE_COUNT, 22, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 65.2f, reading.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -10.1f, reading.temperature);
+}
+
+void test_bad_checksum_is_reported() {
+    // Stretch the high phase of the first bit so a 0 reads as a 1
+    for (int i = FIRST_BIT_FALL; i < FRAME_EDGE_COUNT; i++) {
+        edges[i] += 45;
+    }
+    uint8_t data[5];
+    int count = DhtFrameDecoder::highPulsesFromEdges(edges, levels, FRAME_EDGE_COUNT, pulses, 64);
+    TEST_ASSERT_EQUAL(DHT_DECODE_CHECKSUM_ERROR, DhtFrameDecoder::decodeBytes(pulses, count, data));
+    TEST_ASSERT_EQUAL_HEX8(0x82, data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x73, data[4]);
+}
+
+void test_truncated_frame_times_out() {
+    DhtReading reading = {1.0f, 2.0f};
+    // The capture stopped ten bits early
+    TEST_ASSERT_EQUAL(DHT_DECODE_TIMEOUT, decodeEdges(FRAME_EDGE_COUNT - 20, 22, reading));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, reading.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, reading.humidity);
+    TEST_ASSERT_EQUAL(DHT_DECODE_TIMEOUT, decodeEdges(0, 22, reading));
+}
+
+void test_leading_glitch_is_ignored() {
+    uint8_t expected[5] = {0x02, 0x8C, 0x80, 0x65, 0x73};
+    uint16_t widths[64];
+    widths[0] = 3; // Glitch before the response
+    int count = 1 + pulsesForBytes(expected, widths + 1);
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, DhtFrameDecoder::decodeBytes(widths, count, data));
+    TEST_ASSERT_EQUAL_MEMORY(expected, data, 5);
+}
+
+void test_threshold_separates_zero_and_one() {
+    uint8_t data[5];
+    uint16_t widths[DhtFrameDecoder::FRAME_BITS];
+    for (int i = 0; i < DhtFrameDecoder::FRAME_BITS; i++) {
+        widths[i] = DhtFrameDecoder::ONE_THRESHOLD_US;
+    }
+    widths[7] = DhtFrameDecoder::ONE_THRESHOLD_US + 1;  // Byte 0 = 0x01
+    widths[39] = DhtFrameDecoder::ONE_THRESHOLD_US + 1; // Checksum = 0x01
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, DhtFrameDecoder::decodeBytes(widths, DhtFrameDecoder::FRAME_BITS, data));
+    TEST_ASSERT_EQUAL_HEX8(0x01, data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, data[1]);
+}
+
+void test_dht11_frame_decodes_with_negative_decimal_sign() {
+    uint8_t frame[5] = {45, 0, 3, 0x85, 0};
+    frame[4] = (uint8_t)(frame[0] + frame[1] + frame[2] + frame[3]);
+    uint16_t widths[64];
+    int count = pulsesForBytes(frame, widths);
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_DECODE_OK, DhtFrameDecoder::decode(widths, count, 11, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 45.0f, reading.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -3.5f, reading.temperature);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_edges_yield_response_and_data_pulses);
+    RUN_TEST(test_valid_dht22_frame_decodes);
+    RUN_TEST(test_bad_checksum_is_reported);
+    RUN_TEST(test_truncated_frame_times_out);
+    RUN_TEST(test_leading_glitch_is_ignored);
+    RUN_TEST(test_threshold_separates_zero_and_one);
+    RUN_TEST(test_dht11_frame_decodes_with_negative_decimal_sign);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "FleetSimulator.h"
+#include "NativeHal.h"
+#include "SmartSuiteDevice.h"
+
+static const uint8_t PROBE_PIN = 35; ///< ADC pin no firmware part uses.
+static const int MAX_PROBES = 8;
+
+/**
+ * @brief Device that asks for a fixed wake-up period and checks it runs on its own board.
+ */
+class ProbeDevice : public VirtualDevice {
+public:
+    int index;
+    unsigned long period;
+    std::vector<unsigned long> updates; ///< millis() of every update().
+    int foreignBoardReads;
+
+    void begin() override {
+        NativeHal::setAnalogInput(PROBE_PIN, 100 + index);
+    }
+
+    void update() override {
+        if (analogRead(PROBE_PIN) != 100 + index) {
+            foreignBoardReads++;
+        }
+        updates.push_back(millis());
+    }
+
+    unsigned long timeUntilNextTask() const override {
+        return period;
+    }
+
+    size_t getSize() const override {
+        return sizeof(*this);
+    }
+};
+
+static ProbeDevice probes[MAX_PROBES];
+static unsigned long periods[MAX_PROBES];
+
+static VirtualDevice* createProbe(const FleetRoom& room) {
+    ProbeDevice& probe = probes[room.index];
+    probe.index = room.index;
+    probe.period = periods[room.index];
+    probe.updates.clear();
+    probe.foreignBoardReads = 0;
+    return &probe;
+}
+
+/** @brief Records what is published on one topic. */
+class TopicLog : public BoardObserver {
+public:
+    std::string topic;
+    std::vector<std::string> payloads;
+
+    void onPublish(const char* published, const uint8_t* payload, size_t length) override {
+        if (topic == published) {
+            payloads.push_back(std::string((const char*)payload, length));
+        }
+    }
+};
+
+void setUp() {
+    NativeHal::setSerialEcho(false);
+    FleetSimulator::setFactory(createProbe);
+}
+
+void tearDown() {
+    NativeHal::setRealTime(false);
+}
+
+void test_each_device_runs_on_its_own_board() {
+    for (int i = 0; i < MAX_PROBES; i++) {
+        periods[i] = 5;
+    }
+    // Static, as boards live until the process ends
+    static FleetSimulator fleet;
+    TEST_ASSERT_TRUE(fleet.begin(MAX_PROBES));
+    fleet.run(3, 0.3);
+
+    for (int i = 0; i < MAX_PROBES; i++) {
+        TEST_ASSERT_GREATER_THAN(1, (int)probes[i].updates.size());
+        TEST_ASSERT_EQUAL(0, probes[i].foreignBoardReads);
+    }
+    // Workers give the board back after each device
+    TEST_ASSERT_EQUAL(0, analogRead(PROBE_PIN));
+}
+
+void test_devices_wake_when_their_timer_is_due() {
+    const double seconds = 0.5;
+    periods[0] = 20;
+    periods[1] = 100;
+    periods[2] = 45;
+    static FleetSimulator fleet;
+    TEST_ASSERT_TRUE(fleet.begin(3));
+    fleet.run(1, seconds);
+
+    for (int i = 0; i < 3; i++) {
+        const std::vector<unsigned long>& updates = probes[i].updates;
+        // Never before the device asked, which also bounds the count from above...
+        for (size_t u = 1; u < updates.size(); u++) {
+            TEST_ASSERT_GREATER_OR_EQUAL(periods[i], updates[u] - updates[u - 1] + 1);
+        }
+        int most = 1 + (int)(seconds * 1000 / periods[i]) + 1;
+        TEST_ASSERT_LESS_OR_EQUAL(most, (int)updates.size());
+        // ...and not far behind, loosely, as the host may be busy
+        TEST_ASSERT_GREATER_OR_EQUAL(most / 3, (int)updates.size());
+    }
+}
+
+void test_busy_device_does_not_hold_the_worker() {
+    periods[0] = 0; // Always has work
+    periods[1] = 10;
+    static FleetSimulator fleet;
+    TEST_ASSERT_TRUE(fleet.begin(2));
+    fleet.run(1, 0.3);
+
+    // The busy device goes back in the queue after MAX_UPDATES_PER_WAKE, so the other keeps its pace
+    TEST_ASSERT_GREATER_THAN(FleetSimulator::MAX_UPDATES_PER_WAKE, (int)probes[0].updates.size());
+    TEST_ASSERT_GREATER_OR_EQUAL(10, (int)probes[1].updates.size());
+}
+
+void test_device_answers_commands_on_its_response_topic() {
+    NativeHal::setRealTime(false);
+    FleetRoom room;
+    memset(&room, 0, sizeof(room));
+    strcpy(room.clientId, "SmartSuite_0007");
+    strcpy(room.dataTopic, "smartsuite/room-0007/sensors/data");
+    strcpy(room.commandTopic, "smartsuite/room-0007/servo/command");
+    strcpy(room.responseTopic, "smartsuite/room-0007/servo/response");
+    strcpy(room.alertTopic, "smartsuite/room-0007/alerts");
+    strcpy(room.rulesTopic, "smartsuite/room-0007/config/rules");
+    strcpy(room.metricsTopic, "smartsuite/room-0007/metrics");
+
+    FleetDevice<SmartSuiteDevice>* member = new FleetDevice<SmartSuiteDevice>();
+    SmartSuiteDevice& device = member->get();
+    device.setClientId(room.clientId);
+    device.setMQTTConfig("broker", 1883, room.dataTopic, room.commandTopic, room.alertTopic);
+    device.setResponseTopic(room.responseTopic);
+    device.setRulesTopic(room.rulesTopic);
+    device.setMetricsTopic(room.metricsTopic);
+    TopicLog log;
+    log.topic = room.responseTopic;
+    NativeHal::setObserver(&log);
+    member->begin();
+    for (int i = 0; i < 10000; i++) { // Ten seconds to connect
+        member->update();
+        NativeHal::advance(1000);
+    }
+
+    const char* commands[] = {"{\"servo\":2,\"position\":45}", "{\"servo\":1,\"position\":400}", "{\"servo\":"};
+    for (int c = 0; c < 3; c++) {
+        NativeHal::publish(room.commandTopic, (const uint8_t*)commands[c], strlen(commands[c]));
+        for (int i = 0; i < 100; i++) {
+            member->update();
+            NativeHal::advance(1000);
+        }
+    }
+    NativeHal::setObserver(nullptr);
+
+    TEST_ASSERT_EQUAL(3, (int)log.payloads.size());
+    TEST_ASSERT_EQUAL_STRING("{\"servo\":2,\"position\":45,\"status\":\"accepted\"}", log.payloads[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"status\":\"rejected\",\"reason\":\"out_of_range\"}", log.payloads[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"status\":\"rejected\",\"reason\":\"malformed\"}", log.payloads[2].c_str());
+    delete member;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_each_device_runs_on_its_own_board);
+    RUN_TEST(test_devices_wake_when_their_timer_is_due);
+    RUN_TEST(test_busy_device_does_not_hold_the_worker);
+    RUN_TEST(test_device_answers_commands_on_its_response_topic);
+    return UNITY_END();
+}
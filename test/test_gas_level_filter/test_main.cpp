@@ -0,0 +1,208 @@
+#include <unity.h>
+#include "GasLevelFilter.h"
+
+static const uint16_t MEDIUM = 1000;
+static const uint16_t HIGH_LEVEL = 2000;
+static const uint16_t BAND = 50;
+
+void setUp() {}
+
+void tearDown() {}
+
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+void test_first_block_primes_the_filter() {
+    GasLevelFilter filter;
+    TEST_ASSERT_FALSE(filter.isPrimed());
+    TEST_ASSERT_EQUAL_UINT16(1234, filter.push(1234));
+    TEST_ASSERT_TRUE(filter.isPrimed());
+    TEST_ASSERT_EQUAL_UINT16(1234, filter.getValue());
+}
+
+void test_median_rejects_isolated_spikes() {
+    GasLevelFilter filter;
+    for (int i = 0; i < GasLevelFilter::MEDIAN_WINDOW; i++) {
+        filter.push(1000);
+    }
+    // Up to two spikes in the window of five never reach the median
+    TEST_ASSERT_EQUAL_UINT16(1000, filter.push(4095));
+    TEST_ASSERT_EQUAL_UINT16(1000, filter.push(0));
+    TEST_ASSERT_EQUAL_UINT16(1000, filter.push(1000));
+    TEST_ASSERT_EQUAL_UINT16(1000, filter.push(4095));
+    TEST_ASSERT_EQUAL_UINT16(1000, filter.push(1000));
+}
+
+void test_step_is_smoothed_and_settles_exactly() {
+    GasLevelFilter filter(3);
+    for (int i = 0; i < GasLevelFilter::MEDIAN_WINDOW; i++) {
+        filter.push(1000);
+    }
+    uint16_t previous = filter.getValue();
+    bool intermediate = false;
+    for (int i = 0; i < 200; i++) {
+        uint16_t value = filter.push(2000);
+        TEST_ASSERT_TRUE(value >= previous);
+        TEST_ASSERT_TRUE(value <= 2000);
+        intermediate = intermediate || (value > 1000 && value < 2000);
+        previous = value;
+    }
+    TEST_ASSERT_TRUE(intermediate);
+    TEST_ASSERT_EQUAL_UINT16(2000, previous);
+
+    // And back down
+    for (int i = 0; i < 200; i++) {
+        previous = filter.push(1000);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1000, previous);
+}
+
+void test_zero_shift_passes_the_median_through() {
+    GasLevelFilter filter(0);
+    filter.push(100);
+    filter.push(300);
+    TEST_ASSERT_EQUAL_UINT16(100, filter.getValue()); // Lower middle while the window fills
+    TEST_ASSERT_EQUAL_UINT16(200, filter.push(200));
+}
+
+void test_block_mean_is_rounded() {
+    GasLevelFilter filter;
+    const uint16_t block[] = {100, 101, 101, 101};
+    TEST_ASSERT_EQUAL_UINT16(101, filter.pushBlock(block, 4));
+    const uint16_t single[] = {77};
+    filter.reset();
+    TEST_ASSERT_EQUAL_UINT16(77, filter.pushBlock(single, 1));
+}
+
+void test_reset_primes_again() {
+    GasLevelFilter filter;
+    filter.push(3000);
+    filter.push(3000);
+    filter.reset();
+    TEST_ASSERT_FALSE(filter.isPrimed());
+    TEST_ASSERT_EQUAL_UINT16(500, filter.push(500));
+}
+
+void test_noise_is_attenuated() {
+    GasLevelFilter filter(3);
+    uint32_t state = 5;
+    uint16_t low = 0xFFFF;
+    uint16_t high = 0;
+    for (int i = 0; i < 1000; i++) {
+        uint16_t value = filter.push((uint16_t)(1500 - 40 + nextRandom(state) % 81));
+        if (i >= 50) {
+            low = value < low ? value : low;
+            high = value > high ? value : high;
+        }
+    }
+    TEST_ASSERT_TRUE(low >= 1500 - 20);
+    TEST_ASSERT_TRUE(high <= 1500 + 20);
+}
+
+void test_levels_rise_at_their_thresholds() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    TEST_ASSERT_EQUAL(GAS_LEVEL_NONE, classifier.getLevel());
+    TEST_ASSERT_FALSE(classifier.update(0));
+    TEST_ASSERT_TRUE(classifier.update(1));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_PRESENT, classifier.getLevel());
+    TEST_ASSERT_FALSE(classifier.update(MEDIUM - 1));
+    TEST_ASSERT_TRUE(classifier.update(MEDIUM));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_MEDIUM, classifier.getLevel());
+    TEST_ASSERT_TRUE(classifier.update(HIGH_LEVEL));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_HIGH, classifier.getLevel());
+}
+
+void test_rise_can_skip_levels() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    TEST_ASSERT_TRUE(classifier.update(3000));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_HIGH, classifier.getLevel());
+}
+
+void test_level_is_left_only_below_the_band() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    classifier.update(MEDIUM);
+    TEST_ASSERT_FALSE(classifier.update(MEDIUM - BAND));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_MEDIUM, classifier.getLevel());
+    TEST_ASSERT_TRUE(classifier.update(MEDIUM - BAND - 1));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_PRESENT, classifier.getLevel());
+}
+
+void test_high_falls_to_medium_within_its_band() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    classifier.update(HIGH_LEVEL);
+    TEST_ASSERT_FALSE(classifier.update(HIGH_LEVEL - BAND));
+    TEST_ASSERT_TRUE(classifier.update(HIGH_LEVEL - BAND - 1));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_MEDIUM, classifier.getLevel());
+}
+
+void test_high_falls_past_medium_in_one_step() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    classifier.update(HIGH_LEVEL);
+    TEST_ASSERT_TRUE(classifier.update(MEDIUM - BAND - 1));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_PRESENT, classifier.getLevel());
+    TEST_ASSERT_TRUE(classifier.update(0));
+    TEST_ASSERT_EQUAL(GAS_LEVEL_NONE, classifier.getLevel());
+}
+
+void test_noise_around_a_threshold_gives_one_transition() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    classifier.update(500);
+    uint32_t state = 9;
+    int transitions = 0;
+    for (int i = 0; i < 1000; i++) {
+        uint16_t value = (uint16_t)(MEDIUM - BAND / 2 + nextRandom(state) % BAND);
+        transitions += classifier.update(value);
+    }
+    TEST_ASSERT_EQUAL(1, transitions);
+    TEST_ASSERT_EQUAL(GAS_LEVEL_MEDIUM, classifier.getLevel());
+}
+
+void test_filtered_trace_crosses_each_threshold_once() {
+    // Gas building up with noise and spikes, then back to clean air, as the MQ2 task feeds the pair
+    GasLevelFilter filter;
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    uint32_t state = 21;
+    int changes = 0;
+    for (int i = 0; i < 3000; i++) {
+        int level = i < 1500 ? 400 + i : 1900 - (i - 1500) * 2;
+        level = level < 200 ? 200 : level;
+        int noisy = level - 30 + (int)(nextRandom(state) % 61);
+        if (i % 97 == 50) {
+            noisy = 4095;
+        }
+        changes += classifier.update(filter.push((uint16_t)noisy));
+    }
+    // PRESENT, MEDIUM, then back to PRESENT: the ramp peaks below HIGH
+    TEST_ASSERT_EQUAL(3, changes);
+    TEST_ASSERT_EQUAL(GAS_LEVEL_PRESENT, classifier.getLevel());
+}
+
+void test_reset_returns_to_none() {
+    GasLevelClassifier classifier(MEDIUM, HIGH_LEVEL, BAND);
+    classifier.update(HIGH_LEVEL);
+    classifier.reset();
+    TEST_ASSERT_EQUAL(GAS_LEVEL_NONE, classifier.getLevel());
+    TEST_ASSERT_TRUE(classifier.update(MEDIUM));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_block_primes_the_filter);
+    RUN_TEST(test_median_rejects_isolated_spikes);
+    RUN_TEST(test_step_is_smoothed_and_settles_exactly);
+    RUN_TEST(test_zero_shift_passes_the_median_through);
+    RUN_TEST(test_block_mean_is_rounded);
+    RUN_TEST(test_reset_primes_again);
+    RUN_TEST(test_noise_is_attenuated);
+    RUN_TEST(test_levels_rise_at_their_thresholds);
+    RUN_TEST(test_rise_can_skip_levels);
+    RUN_TEST(test_level_is_left_only_below_the_band);
+    RUN_TEST(test_high_falls_to_medium_within_its_band);
+    RUN_TEST(test_high_falls_past_medium_in_one_step);
+    RUN_TEST(test_noise_around_a_threshold_gives_one_transition);
+    RUN_TEST(test_filtered_trace_crosses_each_threshold_once);
+    RUN_TEST(test_reset_returns_to_none);
+    return UNITY_END();
+}
@@ -0,0 +1,291 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HttpUploader.h"
+#include "NativeHal.h"
+
+/**
+ * @brief HTTP/1.1 server on a loopback port, answering every POST with a scripted status.
+ *
+ * Serves one connection at a time, which is all the uploader opens, and records each request
+ * and the number of connections accepted.
+ */
+class StandInServer {
+public:
+    static const int MAX_STATUSES = 8;
+
+    StandInServer() : listener(-1), port(0), closeAfterResponse(false), running(false), connections(0),
+                      statusCount(0), nextStatus(0) {}
+
+    bool start() {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0; // Any free port
+        socklen_t size = sizeof(address);
+        if (listener < 0 || bind(listener, (sockaddr*)&address, size) != 0 || listen(listener, 4) != 0 ||
+            getsockname(listener, (sockaddr*)&address, &size) != 0) {
+            return false;
+        }
+        port = ntohs(address.sin_port);
+        running = true;
+        worker = std::thread(&StandInServer::serve, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) {
+            worker.join();
+        }
+        if (listener >= 0) {
+            close(listener);
+            listener = -1;
+        }
+    }
+
+    /** @brief Sets the statuses of the next responses; the last one repeats. */
+    void script(const int* statuses, int count) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < count && i < MAX_STATUSES; i++) {
+            this->statuses[i] = statuses[i];
+        }
+        statusCount = count;
+        nextStatus = 0;
+    }
+
+    int getConnections() {
+        std::lock_guard<std::mutex> guard(lock);
+        return connections;
+    }
+
+    std::vector<std::string> getRequests() {
+        std::lock_guard<std::mutex> guard(lock);
+        return requests;
+    }
+
+    std::vector<std::string> getBodies() {
+        std::lock_guard<std::mutex> guard(lock);
+        return bodies;
+    }
+
+    int listener;
+    uint16_t port;
+    std::atomic<bool> closeAfterResponse; ///< Answer with `Connection: close` and hang up.
+
+private:
+    std::thread worker;
+    std::atomic<bool> running;
+    std::mutex lock;
+    int connections;
+    int statuses[MAX_STATUSES];
+    int statusCount;
+    int nextStatus;
+    std::vector<std::string> requests; ///< Request line and headers.
+    std::vector<std::string> bodies;
+
+    static bool waitReadable(int fd) {
+        pollfd entry = {fd, POLLIN, 0};
+        return poll(&entry, 1, 20) > 0;
+    }
+
+    void serve() {
+        while (running) {
+            if (!waitReadable(listener)) {
+                continue;
+            }
+            int connection = accept(listener, nullptr, nullptr);
+            if (connection < 0) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                connections++;
+            }
+            while (running && handleRequest(connection)) {}
+            close(connection);
+        }
+    }
+
+    /** @brief Answers one request. @return False once the connection is over. */
+    bool handleRequest(int connection) {
+        std::string data;
+        size_t headerEnd;
+        char chunk[512];
+        while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+            if (!running) {
+                return false;
+            }
+            if (!waitReadable(connection)) {
+                continue;
+            }
+            ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            data.append(chunk, received);
+        }
+        size_t lengthField = data.find("Content-Length: ");
+        size_t bodyLength = lengthField < headerEnd ? strtoul(data.c_str() + lengthField + 16, nullptr, 10) : 0;
+        while (data.size() < headerEnd + 4 + bodyLength) {
+            ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            data.append(chunk, received);
+        }
+
+        int status = 200;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            requests.push_back(data.substr(0, headerEnd));
+            bodies.push_back(data.substr(headerEnd + 4, bodyLength));
+            if (statusCount > 0) {
+                status = statuses[nextStatus];
+                if (nextStatus < statusCount - 1) {
+                    nextStatus++;
+                }
+            }
+        }
+        char response[128];
+        int length = snprintf(response, sizeof(response), "HTTP/1.1 %d Stand-in\r\nContent-Length: 2\r\n%s\r\nok",
+                              status, closeAfterResponse ? "Connection: close\r\n" : "");
+        send(connection, response, length, MSG_NOSIGNAL);
+        return !closeAfterResponse;
+    }
+};
+
+static StandInServer* server;
+static HttpUploader* uploader;
+static char endpoint[64];
+
+void setUp() {
+    NativeHal::setRealTime(false);
+    NativeHal::setSerialEcho(false);
+    WiFi.begin("ssid", "password");
+    server = new StandInServer();
+    TEST_ASSERT_TRUE(server->start());
+    snprintf(endpoint, sizeof(endpoint), "http://127.0.0.1:%u/posts", (unsigned)server->port);
+    uploader = new HttpUploader();
+    uploader->setEndpoint(endpoint);
+    uploader->setSourceInfo("device", "test");
+    uploader->setLinkAvailable(true);
+}
+
+void tearDown() {
+    delete uploader;
+    server->stop();
+    delete server;
+}
+
+static void enqueueRange(uint32_t first, uint32_t last) {
+    for (uint32_t timestamp = first; timestamp <= last; timestamp++) {
+        SensorSample sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.sequence = timestamp;
+        sample.timestamp = timestamp;
+        sample.temperature = 21.5f;
+        sample.humidity = 40.0f;
+        uploader->enqueue(sample);
+    }
+}
+
+static int countSamples(const std::string& body) {
+    int count = 0;
+    for (size_t position = 0; (position = body.find("\"timestamp\":", position)) != std::string::npos; position++) {
+        count++;
+    }
+    return count;
+}
+
+void test_batches_share_one_kept_alive_connection() {
+    enqueueRange(1, 6);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_FALSE(uploader->update());
+
+    TEST_ASSERT_EQUAL(1, server->getConnections());
+    std::vector<std::string> requests = server->getRequests();
+    std::vector<std::string> bodies = server->getBodies();
+    TEST_ASSERT_EQUAL(2, (int)bodies.size());
+    TEST_ASSERT_EQUAL(0, (int)requests[0].find("POST /posts HTTP/1.1"));
+    TEST_ASSERT_TRUE(requests[0].find("Content-Type: application/json") != std::string::npos);
+
+    // A backed-up queue goes out as JSON arrays of up to MAX_BATCH samples
+    TEST_ASSERT_EQUAL('[', bodies[0][0]);
+    TEST_ASSERT_EQUAL(HttpUploader::MAX_BATCH, countSamples(bodies[0]));
+    TEST_ASSERT_TRUE(bodies[0].find("\"deviceId\":\"device\"") != std::string::npos);
+    TEST_ASSERT_EQUAL('[', bodies[1][0]);
+    TEST_ASSERT_EQUAL(2, countSamples(bodies[1]));
+
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(2, stats.requests);
+    TEST_ASSERT_EQUAL(6, stats.samplesSent);
+    TEST_ASSERT_EQUAL(0, stats.failures);
+}
+
+void test_server_error_is_retried_over_the_same_connection() {
+    const int statuses[] = {503, 200};
+    server->script(statuses, 2);
+    enqueueRange(1, 3);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_EQUAL(3, uploader->getQueuedCount());
+
+    NativeHal::advance(HttpUploader::RETRY_DELAY * 1000ULL);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_EQUAL(0, uploader->getQueuedCount());
+
+    std::vector<std::string> bodies = server->getBodies();
+    TEST_ASSERT_EQUAL(2, (int)bodies.size());
+    TEST_ASSERT_TRUE(bodies[0] == bodies[1]);
+    TEST_ASSERT_EQUAL(1, server->getConnections());
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(1, stats.failures);
+    TEST_ASSERT_EQUAL(3, stats.retried);
+    TEST_ASSERT_EQUAL(3, stats.samplesSent);
+}
+
+void test_connection_closed_by_the_server_is_reopened() {
+    server->closeAfterResponse = true;
+    enqueueRange(1, 1);
+    TEST_ASSERT_TRUE(uploader->update());
+    enqueueRange(2, 2);
+    TEST_ASSERT_TRUE(uploader->update());
+
+    TEST_ASSERT_EQUAL(2, (int)server->getBodies().size());
+    TEST_ASSERT_EQUAL(2, server->getConnections());
+    TEST_ASSERT_EQUAL(0, uploader->getStats().failures);
+}
+
+void test_server_down_keeps_the_samples() {
+    server->stop();
+    enqueueRange(1, 2);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_EQUAL(2, uploader->getQueuedCount());
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(1, stats.failures);
+    TEST_ASSERT_EQUAL(2, stats.retried);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_batches_share_one_kept_alive_connection);
+    RUN_TEST(test_server_error_is_retried_over_the_same_connection);
+    RUN_TEST(test_connection_closed_by_the_server_is_reopened);
+    RUN_TEST(test_server_down_keeps_the_samples);
+    return UNITY_END();
+}
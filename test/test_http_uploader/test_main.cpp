@@ -0,0 +1,220 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "HttpUploader.h"
+#include "NativeHal.h"
+
+/**
+ * @brief Records the timestamps of the samples in every request body, and can queue more
+ * samples while a request is in flight.
+ */
+class RequestLog : public BoardObserver {
+public:
+    static const int MAX_REQUESTS = 16;
+    static const int MAX_SAMPLES = 8;
+
+    int requests;
+    int sampleCounts[MAX_REQUESTS];
+    long timestamps[MAX_REQUESTS][MAX_SAMPLES];
+    HttpUploader* uploader;
+    int enqueueDuringRequest; ///< Samples queued from inside the next request.
+
+    RequestLog() : requests(0), uploader(nullptr), enqueueDuringRequest(0) {}
+
+    void onHttpRequest(const uint8_t* body, size_t length) override {
+        if (requests == MAX_REQUESTS) {
+            return;
+        }
+        std::string text((const char*)body, length);
+        int count = 0;
+        size_t position = 0;
+        while ((position = text.find("\"timestamp\":", position)) != std::string::npos && count < MAX_SAMPLES) {
+            position += 12;
+            timestamps[requests][count++] = atol(text.c_str() + position);
+        }
+        sampleCounts[requests++] = count;
+
+        for (int i = 0; i < enqueueDuringRequest; i++) {
+            uploader->enqueue(makeSample(100 + i));
+        }
+        enqueueDuringRequest = 0;
+    }
+
+    static SensorSample makeSample(uint32_t timestamp) {
+        SensorSample sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.sequence = timestamp;
+        sample.timestamp = timestamp;
+        sample.temperature = 21.5f;
+        sample.humidity = 40.0f;
+        sample.smokeLevel = 300.0f;
+        return sample;
+    }
+};
+
+static HttpUploader* uploader;
+static RequestLog* requestLog;
+
+void setUp() {
+    NativeHal::setRealTime(false);
+    NativeHal::setSerialEcho(false);
+    NativeHal::setHttpResponse(200);
+    WiFi.begin("ssid", "password");
+    uploader = new HttpUploader();
+    uploader->setEndpoint("http://example.com/posts");
+    uploader->setSourceInfo("device", "test");
+    uploader->setLinkAvailable(true);
+    requestLog = new RequestLog();
+    requestLog->uploader = uploader;
+    NativeHal::setObserver(requestLog);
+}
+
+void tearDown() {
+    NativeHal::setObserver(nullptr);
+    delete requestLog;
+    delete uploader;
+}
+
+static void enqueueRange(uint32_t first, uint32_t last) {
+    for (uint32_t timestamp = first; timestamp <= last; timestamp++) {
+        uploader->enqueue(RequestLog::makeSample(timestamp));
+    }
+}
+
+static void assertRequest(int request, const long* expected, int count) {
+    TEST_ASSERT_GREATER_THAN(request, requestLog->requests);
+    TEST_ASSERT_EQUAL(count, requestLog->sampleCounts[request]);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(expected[i], requestLog->timestamps[request][i]);
+    }
+}
+
+void test_nothing_is_sent_without_link_or_samples() {
+    TEST_ASSERT_FALSE(uploader->update());
+    enqueueRange(1, 2);
+    uploader->setLinkAvailable(false);
+    TEST_ASSERT_FALSE(uploader->update());
+    TEST_ASSERT_EQUAL(0, requestLog->requests);
+    TEST_ASSERT_EQUAL(2, uploader->getQueuedCount());
+}
+
+void test_samples_go_out_in_order_in_batches() {
+    enqueueRange(1, 6);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_FALSE(uploader->update());
+
+    const long first[] = {1, 2, 3, 4};
+    const long second[] = {5, 6};
+    assertRequest(0, first, HttpUploader::MAX_BATCH);
+    assertRequest(1, second, 2);
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(2, stats.requests);
+    TEST_ASSERT_EQUAL(6, stats.samplesSent);
+    TEST_ASSERT_EQUAL(0, stats.failures);
+}
+
+void test_full_queue_drops_the_oldest_sample() {
+    enqueueRange(1, HttpUploader::QUEUE_CAPACITY + 2);
+    TEST_ASSERT_EQUAL(HttpUploader::QUEUE_CAPACITY, uploader->getQueuedCount());
+    TEST_ASSERT_EQUAL(2, uploader->getStats().dropped);
+    uploader->update();
+    const long expected[] = {3, 4, 5, 6};
+    assertRequest(0, expected, 4);
+}
+
+void test_transient_failure_requeues_the_batch_and_waits() {
+    enqueueRange(1, 4);
+    NativeHal::setHttpResponse(503);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_EQUAL(4, uploader->getQueuedCount());
+    enqueueRange(5, 5);
+
+    // Nothing is tried again before RETRY_DELAY
+    NativeHal::setHttpResponse(200);
+    NativeHal::advance((HttpUploader::RETRY_DELAY - 1) * 1000ULL);
+    TEST_ASSERT_FALSE(uploader->update());
+    NativeHal::advance(1000);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_TRUE(uploader->update());
+
+    // The failed batch goes first, ahead of the sample queued meanwhile
+    const long batch[] = {1, 2, 3, 4};
+    const long rest[] = {5};
+    assertRequest(1, batch, 4);
+    assertRequest(2, rest, 1);
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(1, stats.failures);
+    TEST_ASSERT_EQUAL(4, stats.retried);
+    TEST_ASSERT_EQUAL(5, stats.samplesSent);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+}
+
+void test_unreachable_server_is_transient() {
+    enqueueRange(1, 2);
+    NativeHal::setHttpResponse(-1);
+    uploader->update();
+    TEST_ASSERT_EQUAL(2, uploader->getQueuedCount());
+    TEST_ASSERT_EQUAL(2, uploader->getStats().retried);
+}
+
+void test_permanent_failure_drops_the_batch() {
+    enqueueRange(1, 3);
+    NativeHal::setHttpResponse(400);
+    TEST_ASSERT_TRUE(uploader->update());
+    TEST_ASSERT_EQUAL(0, uploader->getQueuedCount());
+    TEST_ASSERT_EQUAL(0, uploader->getStats().retried);
+
+    // No retry delay after a permanent error
+    NativeHal::setHttpResponse(200);
+    enqueueRange(4, 4);
+    TEST_ASSERT_TRUE(uploader->update());
+}
+
+void test_requeue_keeps_the_newest_samples_that_fit() {
+    enqueueRange(1, 4);
+    NativeHal::setHttpResponse(500);
+    // While the request is in flight the producer nearly fills the queue
+    requestLog->enqueueDuringRequest = HttpUploader::QUEUE_CAPACITY - 2;
+    uploader->update();
+
+    TEST_ASSERT_EQUAL(HttpUploader::QUEUE_CAPACITY, uploader->getQueuedCount());
+    UploadStats stats = uploader->getStats();
+    TEST_ASSERT_EQUAL(2, stats.retried);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+
+    NativeHal::setHttpResponse(200);
+    NativeHal::advance(HttpUploader::RETRY_DELAY * 1000ULL);
+    uploader->update();
+    const long expected[] = {3, 4, 100, 101};
+    assertRequest(1, expected, 4);
+}
+
+void test_batch_that_does_not_encode_is_counted_as_dropped() {
+    // A device ID this long leaves no room for the sample in the encoder buffer
+    char deviceId[281];
+    memset(deviceId, 'd', sizeof(deviceId) - 1);
+    deviceId[sizeof(deviceId) - 1] = '\0';
+    uploader->setSourceInfo(deviceId, "test");
+    enqueueRange(1, 2);
+    TEST_ASSERT_FALSE(uploader->update());
+    TEST_ASSERT_EQUAL(0, requestLog->requests);
+    TEST_ASSERT_EQUAL(0, uploader->getQueuedCount());
+    TEST_ASSERT_EQUAL(2, uploader->getStats().dropped);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_is_sent_without_link_or_samples);
+    RUN_TEST(test_samples_go_out_in_order_in_batches);
+    RUN_TEST(test_full_queue_drops_the_oldest_sample);
+    RUN_TEST(test_transient_failure_requeues_the_batch_and_waits);
+    RUN_TEST(test_unreachable_server_is_transient);
+    RUN_TEST(test_permanent_failure_drops_the_batch);
+    RUN_TEST(test_requeue_keeps_the_newest_samples_that_fit);
+    RUN_TEST(test_batch_that_does_not_encode_is_counted_as_dropped);
+    return UNITY_END();
+}
@@ -0,0 +1,313 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Logger.h"
+#include "NativeHal.h"
+
+/** @brief Keeps every byte written to Serial. */
+class SerialCapture : public BoardObserver {
+public:
+    std::vector<uint8_t> bytes;
+
+    void onSerialWrite(const uint8_t* buffer, size_t size) override {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+    }
+};
+
+/** @brief Splits captured bytes into record bodies; fails on anything that is not a valid frame. */
+static std::vector<std::vector<uint8_t>> splitFrames(const std::vector<uint8_t>& bytes) {
+    std::vector<std::vector<uint8_t>> frames;
+    size_t position = 0;
+    while (position < bytes.size()) {
+        TEST_ASSERT_EQUAL_HEX8(Logger::FRAME_SYNC, bytes[position]);
+        TEST_ASSERT_TRUE(position + 2 <= bytes.size());
+        size_t length = bytes[position + 1];
+        TEST_ASSERT_TRUE(position + length + 3 <= bytes.size());
+        uint8_t checksum = 0;
+        for (size_t i = 0; i < length; i++) {
+            checksum ^= bytes[position + 2 + i];
+        }
+        TEST_ASSERT_EQUAL_HEX8(checksum, bytes[position + 2 + length]);
+        frames.push_back(std::vector<uint8_t>(bytes.begin() + position + 2, bytes.begin() + position + 2 + length));
+        position += length + 3;
+    }
+    return frames;
+}
+
+static uint32_t readWord(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static const char* formatAddress(const std::vector<uint8_t>& record) {
+    uintptr_t address = 0;
+    for (size_t i = 0; i < sizeof(address); i++) {
+        address |= (uintptr_t)record[5 + i] << (8 * i);
+    }
+    return (const char*)address;
+}
+
+static SerialCapture* capture;
+static char text[160];
+
+void setUp() {
+    NativeHal::setRealTime(false);
+    NativeHal::setSerialEcho(false);
+    Logger::setTextOutput(false);
+    Logger::drain();
+    Logger::drain(); // Also the drop warning the previous test may have left
+    capture = new SerialCapture();
+    NativeHal::setObserver(capture);
+}
+
+void tearDown() {
+    NativeHal::setObserver(nullptr);
+    delete capture;
+}
+
+void test_record_layout_and_type_tags() {
+    static const char format[] = "%d %u %f %s";
+    LogRecord record(LOG_LEVEL_WARN, 0x01020304, format);
+    TEST_ASSERT_EQUAL(LogRecord::HEADER_SIZE, record.size());
+    record.add(-5);
+    record.add(7u);
+    record.add(2.5);
+    record.add("hi");
+    record.add(true);
+    record.add('x');
+    record.add(-7L);
+    record.add(4000000000UL);
+
+    const uint8_t* bytes = record.data();
+    TEST_ASSERT_EQUAL(LOG_LEVEL_WARN, bytes[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, readWord(bytes + 1));
+    std::vector<uint8_t> header(bytes, bytes + LogRecord::HEADER_SIZE);
+    TEST_ASSERT_EQUAL_PTR(format, formatAddress(header));
+
+    const uint8_t* argument = bytes + LogRecord::HEADER_SIZE;
+    TEST_ASSERT_EQUAL(LOG_ARG_INT, argument[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFB, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_UINT, argument[0]);
+    TEST_ASSERT_EQUAL(7, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_FLOAT, argument[0]);
+    float value = 2.5f;
+    uint32_t word;
+    memcpy(&word, &value, sizeof(word));
+    TEST_ASSERT_EQUAL_HEX32(word, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_STRING, argument[0]);
+    TEST_ASSERT_EQUAL(2, argument[1]);
+    TEST_ASSERT_EQUAL('h', argument[2]);
+    TEST_ASSERT_EQUAL('i', argument[3]);
+    argument += 4;
+    TEST_ASSERT_EQUAL(LOG_ARG_INT, argument[0]); // bool
+    TEST_ASSERT_EQUAL(1, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_INT, argument[0]); // char
+    TEST_ASSERT_EQUAL('x', readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_INT, argument[0]); // long
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFF9, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(LOG_ARG_UINT, argument[0]); // unsigned long
+    TEST_ASSERT_EQUAL_HEX32(4000000000UL, readWord(argument + 1));
+    argument += 5;
+    TEST_ASSERT_EQUAL(argument - bytes, record.size());
+}
+
+void test_format_renders_every_type() {
+    LogRecord record(LOG_LEVEL_WARN, 1234, "n=%d u=%u f=%.2f s=%s c=%c x=%04x ld=%ld lu=%lu 100%%");
+    record.add(-5);
+    record.add(7u);
+    record.add(2.5);
+    record.add("hi");
+    record.add('x');
+    record.add(255);
+    record.add(-7L);
+    record.add(4000000000UL);
+    size_t length = LogRecord::format(record.data(), record.size(), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("[W 1234] n=-5 u=7 f=2.50 s=hi c=x x=00ff ld=-7 lu=4000000000 100%", text);
+    TEST_ASSERT_EQUAL(strlen(text), length);
+}
+
+void test_long_string_is_cut_to_max_string() {
+    const char longText[] = "0123456789abcdefghijklmnopqrstuvwxyzABCD";
+    TEST_ASSERT_GREATER_THAN(LogRecord::MAX_STRING, strlen(longText));
+    LogRecord record(LOG_LEVEL_INFO, 0, "%s|");
+    record.add(longText);
+    TEST_ASSERT_EQUAL(LogRecord::HEADER_SIZE + 2 + LogRecord::MAX_STRING, record.size());
+    TEST_ASSERT_EQUAL(LogRecord::MAX_STRING, record.data()[LogRecord::HEADER_SIZE + 1]);
+    LogRecord::format(record.data(), record.size(), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("[I 0] 0123456789abcdefghijklmnopqrstuv|", text);
+
+    LogRecord empty(LOG_LEVEL_INFO, 0, "%s");
+    empty.add((const char*)nullptr);
+    LogRecord::format(empty.data(), empty.size(), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("[I 0] (null)", text);
+}
+
+void test_arguments_that_do_not_fit_are_left_out() {
+    LogRecord record(LOG_LEVEL_INFO, 0, "%d");
+    int fitting = (LogRecord::MAX_SIZE - LogRecord::HEADER_SIZE) / 5;
+    for (int i = 0; i < fitting + 3; i++) {
+        record.add(i);
+    }
+    TEST_ASSERT_EQUAL(LogRecord::HEADER_SIZE + fitting * 5, record.size());
+    size_t before = record.size();
+    record.add("no room");
+    TEST_ASSERT_EQUAL(before, record.size());
+}
+
+void test_mismatched_or_missing_argument_renders_a_marker() {
+    LogRecord swapped(LOG_LEVEL_ERROR, 5, "%s and %d");
+    swapped.add(3);
+    swapped.add("text");
+    LogRecord::format(swapped.data(), swapped.size(), text, sizeof(text));
+    // Arguments are not consumed past a mismatch, so the rest is marked too
+    TEST_ASSERT_EQUAL_STRING("[E 5] <?> and <?>", text);
+
+    LogRecord missing(LOG_LEVEL_ERROR, 5, "%d then %d");
+    missing.add(1);
+    LogRecord::format(missing.data(), missing.size(), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("[E 5] 1 then <?>", text);
+
+    LogRecord floatForInt(LOG_LEVEL_ERROR, 5, "%d");
+    floatForInt.add(1.5);
+    LogRecord::format(floatForInt.data(), floatForInt.size(), text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("[E 5] <?>", text);
+}
+
+void test_format_stays_inside_the_destination() {
+    LogRecord record(LOG_LEVEL_INFO, 42, "value %d and a long tail of text");
+    record.add(123456);
+    char small[16];
+    memset(small, 'z', sizeof(small));
+    size_t length = LogRecord::format(record.data(), record.size(), small, sizeof(small));
+    TEST_ASSERT_EQUAL(sizeof(small) - 1, length);
+    TEST_ASSERT_EQUAL_STRING("[I 42] value 12", small);
+
+    TEST_ASSERT_EQUAL(0, LogRecord::format(record.data(), record.size(), small, 0));
+    TEST_ASSERT_EQUAL(0, LogRecord::format(record.data(), LogRecord::HEADER_SIZE - 1, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("", small);
+}
+
+void test_drain_writes_binary_frames() {
+    LogRecord record(LOG_LEVEL_INFO, 77, "Servo %d at %f deg");
+    record.add(2);
+    record.add(90.0);
+    Logger::write(record);
+    Logger::write(record);
+    Logger::drain();
+
+    std::vector<std::vector<uint8_t>> frames = splitFrames(capture->bytes);
+    TEST_ASSERT_EQUAL(2, (int)frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        TEST_ASSERT_EQUAL(record.size(), frames[i].size());
+        TEST_ASSERT_EQUAL_MEMORY(record.data(), frames[i].data(), record.size());
+    }
+
+    // Nothing left
+    capture->bytes.clear();
+    Logger::drain();
+    TEST_ASSERT_EQUAL(0, (int)capture->bytes.size());
+}
+
+void test_full_ring_drops_and_reports() {
+    LogRecord record(LOG_LEVEL_INFO, 0, "%d");
+    record.add(1);
+    unsigned long droppedBefore = Logger::getDroppedCount();
+    int fitting = LOG_BUFFER_SIZE / (record.size() + 1);
+    for (int i = 0; i < fitting + 10; i++) {
+        Logger::write(record);
+    }
+    TEST_ASSERT_EQUAL(droppedBefore + 10, Logger::getDroppedCount());
+
+    Logger::drain();
+    TEST_ASSERT_EQUAL(fitting, (int)splitFrames(capture->bytes).size());
+
+    // The warning about the drops goes out with the next pass
+    capture->bytes.clear();
+    Logger::drain();
+    std::vector<std::vector<uint8_t>> frames = splitFrames(capture->bytes);
+    TEST_ASSERT_EQUAL(1, (int)frames.size());
+    TEST_ASSERT_EQUAL(LOG_LEVEL_WARN, frames[0][0]);
+    LogRecord::format(frames[0].data(), frames[0].size(), text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "records dropped so far"));
+}
+
+static const char WRITER_FORMAT[] = "writer %d record %d";
+
+void test_concurrent_writers_keep_every_record_intact() {
+    // Run under ThreadSanitizer to check the reservation and hand-off
+    const int writers = 4;
+    const int records = 3000;
+    std::atomic<int> running(writers);
+    unsigned long droppedBefore = Logger::getDroppedCount();
+    std::thread drainer([&running]() {
+        while (running.load() > 0) {
+            Logger::drain();
+        }
+        Logger::drain();
+    });
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; w++) {
+        threads.push_back(std::thread([&running, w]() {
+            for (int i = 0; i < records; i++) {
+                LogRecord record(LOG_LEVEL_DEBUG, 0, WRITER_FORMAT);
+                record.add(w);
+                record.add(i);
+                Logger::write(record);
+            }
+            running--;
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    drainer.join();
+    unsigned long dropped = Logger::getDroppedCount() - droppedBefore;
+
+    // Every record that got in arrives whole, and each writer's records in order
+    int received[writers] = {0};
+    int last[writers] = {-1, -1, -1, -1};
+    std::vector<std::vector<uint8_t>> frames = splitFrames(capture->bytes);
+    for (size_t f = 0; f < frames.size(); f++) {
+        if (formatAddress(frames[f]) != WRITER_FORMAT) {
+            continue; // Drop warnings
+        }
+        TEST_ASSERT_EQUAL(LogRecord::HEADER_SIZE + 10, frames[f].size());
+        TEST_ASSERT_EQUAL(LOG_ARG_INT, frames[f][LogRecord::HEADER_SIZE]);
+        int writer = (int)readWord(&frames[f][LogRecord::HEADER_SIZE + 1]);
+        int index = (int)readWord(&frames[f][LogRecord::HEADER_SIZE + 6]);
+        TEST_ASSERT_TRUE(writer >= 0 && writer < writers);
+        TEST_ASSERT_GREATER_THAN(last[writer], index);
+        last[writer] = index;
+        received[writer]++;
+    }
+    int total = 0;
+    for (int w = 0; w < writers; w++) {
+        total += received[w];
+    }
+    TEST_ASSERT_GREATER_THAN(0, total);
+    // The count also includes drop warnings that found the ring full
+    TEST_ASSERT_LESS_OR_EQUAL(writers * records, total);
+    TEST_ASSERT_GREATER_OR_EQUAL(writers * records, total + (int)dropped);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_layout_and_type_tags);
+    RUN_TEST(test_format_renders_every_type);
+    RUN_TEST(test_long_string_is_cut_to_max_string);
+    RUN_TEST(test_arguments_that_do_not_fit_are_left_out);
+    RUN_TEST(test_mismatched_or_missing_argument_renders_a_marker);
+    RUN_TEST(test_format_stays_inside_the_destination);
+    RUN_TEST(test_drain_writes_binary_frames);
+    RUN_TEST(test_full_ring_drops_and_reports);
+    RUN_TEST(test_concurrent_writers_keep_every_record_intact);
+    return UNITY_END();
+}
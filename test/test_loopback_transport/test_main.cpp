@@ -0,0 +1,206 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "LoopbackTransport.h"
+
+/**
+ * @brief Records every message, and optionally publishes a reply to each one.
+ */
+class RecordingHandler : public MessageHandler {
+public:
+    RecordingHandler() : transport(nullptr), replyTopic(nullptr) {}
+
+    void onMessage(char* topic, uint8_t* payload, size_t length) override {
+        topics.push_back(topic);
+        payloads.push_back(std::string((const char*)payload, length));
+        addresses.push_back(payload);
+        if (transport != nullptr && replyTopic != nullptr) {
+            transport->publish(replyTopic, payload, length);
+        }
+    }
+
+    MessageTransport* transport;
+    const char* replyTopic;
+    std::vector<std::string> topics;
+    std::vector<std::string> payloads;
+    std::vector<const uint8_t*> addresses;
+};
+
+static LoopbackTransport* transport;
+static RecordingHandler* handler;
+
+void setUp() {
+    transport = new LoopbackTransport();
+    handler = new RecordingHandler();
+    transport->setHandler(handler);
+    TEST_ASSERT_TRUE(transport->subscribe("room/a"));
+}
+
+void tearDown() {
+    delete transport;
+    delete handler;
+}
+
+static bool commitText(const char* topic, const char* text) {
+    size_t capacity = 0;
+    uint8_t* buffer = transport->acquire(capacity);
+    if (buffer == nullptr) {
+        return false;
+    }
+    size_t length = strlen(text);
+    memcpy(buffer, text, length);
+    return transport->commit(topic, length);
+}
+
+void test_committed_message_is_delivered_from_the_lent_buffer() {
+    size_t capacity = 0;
+    uint8_t* buffer = transport->acquire(capacity);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_EQUAL(LoopbackTransport::MAX_PAYLOAD, capacity);
+    memcpy(buffer, "21.5", 4);
+    TEST_ASSERT_TRUE(transport->commit("room/a", 4));
+    TEST_ASSERT_EQUAL(1, transport->pending());
+
+    transport->loop();
+    TEST_ASSERT_EQUAL(1, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL_STRING("room/a", handler->topics[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("21.5", handler->payloads[0].c_str());
+    // Handed over without a copy: the handler reads the bytes where they were written
+    TEST_ASSERT_TRUE(handler->addresses[0] == buffer);
+    TEST_ASSERT_EQUAL(0, transport->pending());
+
+    LoopbackTransport::Stats stats = transport->getStats();
+    TEST_ASSERT_EQUAL(1, stats.committed);
+    TEST_ASSERT_EQUAL(1, stats.delivered);
+    TEST_ASSERT_EQUAL(4, (int)stats.bytesCommitted);
+    TEST_ASSERT_EQUAL(4, (int)stats.bytesDelivered);
+}
+
+void test_one_buffer_is_lent_at_a_time() {
+    size_t capacity = 0;
+    TEST_ASSERT_NOT_NULL(transport->acquire(capacity));
+    TEST_ASSERT_NULL(transport->acquire(capacity));
+    const uint8_t payload[] = {1};
+    TEST_ASSERT_FALSE(transport->publish("room/a", payload, sizeof(payload)));
+    TEST_ASSERT_TRUE(transport->commit("room/a", 0));
+    TEST_ASSERT_NOT_NULL(transport->acquire(capacity));
+}
+
+void test_release_without_commit_sends_nothing() {
+    size_t capacity = 0;
+    uint8_t* buffer = transport->acquire(capacity);
+    TEST_ASSERT_NOT_NULL(buffer);
+    memcpy(buffer, "discarded", 9);
+    transport->release();
+    TEST_ASSERT_EQUAL(0, transport->pending());
+    TEST_ASSERT_FALSE(transport->commit("room/a", 9)); // Nothing lent any more
+
+    // The same slot is lent again, and the next message overwrites it
+    TEST_ASSERT_TRUE(transport->acquire(capacity) == buffer);
+    memcpy(buffer, "kept", 4);
+    TEST_ASSERT_TRUE(transport->commit("room/a", 4));
+    transport->loop();
+    TEST_ASSERT_EQUAL(1, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL_STRING("kept", handler->payloads[0].c_str());
+    TEST_ASSERT_EQUAL(1, transport->getStats().committed);
+}
+
+void test_commit_without_acquire_is_refused() {
+    TEST_ASSERT_FALSE(transport->commit("room/a", 0));
+    TEST_ASSERT_EQUAL(0, transport->pending());
+    TEST_ASSERT_EQUAL(0, transport->getStats().committed);
+}
+
+void test_published_payload_is_copied() {
+    char payload[] = "on";
+    TEST_ASSERT_TRUE(transport->publish("room/a", (const uint8_t*)payload, 2));
+    payload[0] = 'x';
+    transport->loop();
+    TEST_ASSERT_EQUAL(1, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL_STRING("on", handler->payloads[0].c_str());
+}
+
+void test_messages_are_delivered_in_order_and_unsubscribed_topics_dropped() {
+    TEST_ASSERT_TRUE(commitText("room/a", "first"));
+    TEST_ASSERT_TRUE(commitText("room/b", "elsewhere"));
+    TEST_ASSERT_TRUE(commitText("room/a", "second"));
+    transport->loop();
+
+    TEST_ASSERT_EQUAL(2, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL_STRING("first", handler->payloads[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("second", handler->payloads[1].c_str());
+    LoopbackTransport::Stats stats = transport->getStats();
+    TEST_ASSERT_EQUAL(3, stats.committed);
+    TEST_ASSERT_EQUAL(2, stats.delivered);
+    TEST_ASSERT_EQUAL(1, stats.dropped);
+}
+
+void test_full_queue_refuses_until_loop_frees_it() {
+    for (int i = 0; i < LoopbackTransport::SLOT_COUNT; i++) {
+        TEST_ASSERT_TRUE(commitText("room/a", "x"));
+    }
+    size_t capacity = 0;
+    TEST_ASSERT_NULL(transport->acquire(capacity));
+    const uint8_t payload[] = {1};
+    TEST_ASSERT_FALSE(transport->publish("room/a", payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL(1, transport->getStats().dropped);
+
+    transport->loop();
+    TEST_ASSERT_EQUAL(LoopbackTransport::SLOT_COUNT, (int)handler->payloads.size());
+    TEST_ASSERT_NOT_NULL(transport->acquire(capacity));
+}
+
+void test_oversized_message_is_refused() {
+    static uint8_t payload[LoopbackTransport::MAX_PAYLOAD + 1];
+    TEST_ASSERT_FALSE(transport->publish("room/a", payload, sizeof(payload)));
+
+    char topic[LoopbackTransport::MAX_TOPIC + 2];
+    memset(topic, 'a', sizeof(topic) - 1);
+    topic[sizeof(topic) - 1] = '\0';
+    size_t capacity = 0;
+    TEST_ASSERT_NOT_NULL(transport->acquire(capacity));
+    TEST_ASSERT_FALSE(transport->commit(topic, 1));
+
+    TEST_ASSERT_EQUAL(0, transport->pending());
+    TEST_ASSERT_EQUAL(2, transport->getStats().dropped);
+}
+
+void test_reply_published_by_the_handler_waits_for_the_next_loop() {
+    TEST_ASSERT_TRUE(transport->subscribe("room/reply"));
+    handler->transport = transport;
+    handler->replyTopic = "room/reply";
+    TEST_ASSERT_TRUE(commitText("room/a", "ping"));
+
+    transport->loop();
+    TEST_ASSERT_EQUAL(1, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL(1, transport->pending());
+
+    handler->replyTopic = nullptr;
+    transport->loop();
+    TEST_ASSERT_EQUAL(2, (int)handler->payloads.size());
+    TEST_ASSERT_EQUAL_STRING("room/reply", handler->topics[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("ping", handler->payloads[1].c_str());
+}
+
+void test_subscribing_twice_keeps_one_route() {
+    TEST_ASSERT_TRUE(transport->subscribe("room/a"));
+    TEST_ASSERT_TRUE(commitText("room/a", "once"));
+    transport->loop();
+    TEST_ASSERT_EQUAL(1, (int)handler->payloads.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_committed_message_is_delivered_from_the_lent_buffer);
+    RUN_TEST(test_one_buffer_is_lent_at_a_time);
+    RUN_TEST(test_release_without_commit_sends_nothing);
+    RUN_TEST(test_commit_without_acquire_is_refused);
+    RUN_TEST(test_published_payload_is_copied);
+    RUN_TEST(test_messages_are_delivered_in_order_and_unsubscribed_topics_dropped);
+    RUN_TEST(test_full_queue_refuses_until_loop_frees_it);
+    RUN_TEST(test_oversized_message_is_refused);
+    RUN_TEST(test_reply_published_by_the_handler_waits_for_the_next_loop);
+    RUN_TEST(test_subscribing_twice_keeps_one_route);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include <unity.h>
+#include "MotionDebouncer.h"
+
+static const uint32_t DEBOUNCE = 10000;   ///< 10 ms.
+static const uint32_t RETRIGGER = 2000000; ///< 2 s.
+static const int MAX_TRANSITIONS = 8;
+
+static MotionDebouncer* debouncer;
+static MotionTransition transitions[MAX_TRANSITIONS];
+static int transitionCount;
+
+void setUp() {
+    debouncer = new MotionDebouncer(DEBOUNCE, RETRIGGER);
+    transitionCount = 0;
+}
+
+void tearDown() {
+    delete debouncer;
+}
+
+static void record(const MotionTransition& transition) {
+    TEST_ASSERT_TRUE_MESSAGE(transitionCount < MAX_TRANSITIONS, "too many transitions");
+    transitions[transitionCount++] = transition;
+}
+
+// Feeds the edges as the PIR task drains them from the ISR queue, then polls once at `end`
+static void runStream(const EdgeRecord* edges, int count, uint32_t end) {
+    MotionTransition transition;
+    for (int i = 0; i < count; i++) {
+        if (debouncer->push(edges[i], transition)) {
+            record(transition);
+        }
+    }
+    if (debouncer->poll(end, transition)) {
+        record(transition);
+    }
+}
+
+static void assertTransition(int index, bool motion, uint32_t edgeTime) {
+    TEST_ASSERT_TRUE(index < transitionCount);
+    TEST_ASSERT_EQUAL(motion, transitions[index].motion);
+    TEST_ASSERT_EQUAL_UINT32(edgeTime, transitions[index].edgeTime);
+}
+
+void test_glitch_shorter_than_debounce_is_ignored() {
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {104000, 0},
+    };
+    runStream(edges, 2, 5000000);
+    TEST_ASSERT_EQUAL(0, transitionCount);
+    TEST_ASSERT_FALSE(debouncer->getState());
+}
+
+void test_motion_is_reported_once_the_level_holds() {
+    const EdgeRecord edges[] = {
+        {100000, 1},
+    };
+    runStream(edges, 1, 100000 + DEBOUNCE - 1);
+    TEST_ASSERT_EQUAL(0, transitionCount);
+
+    MotionTransition transition;
+    TEST_ASSERT_TRUE(debouncer->poll(100000 + DEBOUNCE, transition));
+    TEST_ASSERT_TRUE(transition.motion);
+    TEST_ASSERT_EQUAL_UINT32(100000, transition.edgeTime);
+    TEST_ASSERT_TRUE(debouncer->getState());
+    TEST_ASSERT_FALSE(debouncer->poll(100000 + 2 * DEBOUNCE, transition));
+}
+
+void test_bouncing_rising_edge_reports_one_motion_from_the_last_edge() {
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {101000, 0},
+        {102000, 1},
+        {102500, 0},
+        {103000, 1},
+    };
+    runStream(edges, 5, 103000 + DEBOUNCE);
+    TEST_ASSERT_EQUAL(1, transitionCount);
+    assertTransition(0, true, 103000);
+}
+
+void test_next_edge_settles_the_previous_level() {
+    // No poll in between: the falling edge itself completes the detection
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {300000, 0},
+    };
+    runStream(edges, 2, 300000 + 1000);
+    TEST_ASSERT_EQUAL(1, transitionCount);
+    assertTransition(0, true, 100000);
+    TEST_ASSERT_TRUE(debouncer->getState());
+}
+
+void test_motion_ends_only_after_the_retrigger_window() {
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {500000, 0},
+    };
+    runStream(edges, 2, 500000 + RETRIGGER - 1);
+    TEST_ASSERT_EQUAL(1, transitionCount);
+    TEST_ASSERT_TRUE(debouncer->getState());
+
+    MotionTransition transition;
+    TEST_ASSERT_TRUE(debouncer->poll(500000 + RETRIGGER, transition));
+    TEST_ASSERT_FALSE(transition.motion);
+    TEST_ASSERT_EQUAL_UINT32(500000, transition.edgeTime);
+}
+
+void test_retrigger_within_the_window_is_one_continuous_motion() {
+    // A PIR dropping for 1.5 s between two detections, then a real stop
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {3000000, 0},
+        {4500000, 1},
+        {7000000, 0},
+        {8000000, 1},
+        {9000000, 0},
+    };
+    runStream(edges, 6, 9000000 + RETRIGGER);
+    TEST_ASSERT_EQUAL(2, transitionCount);
+    assertTransition(0, true, 100000);
+    assertTransition(1, false, 9000000);
+}
+
+void test_retrigger_after_the_window_is_a_new_motion() {
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {1000000, 0},
+        {1000000 + RETRIGGER + 1000, 1},
+    };
+    runStream(edges, 3, 1000000 + RETRIGGER + 1000 + DEBOUNCE);
+    TEST_ASSERT_EQUAL(3, transitionCount);
+    assertTransition(0, true, 100000);
+    assertTransition(1, false, 1000000);
+    assertTransition(2, true, 1000000 + RETRIGGER + 1000);
+}
+
+void test_short_window_falls_back_to_the_debounce_time() {
+    debouncer->configure(DEBOUNCE, 1000);
+    const EdgeRecord edges[] = {
+        {100000, 1},
+        {200000, 0},
+    };
+    runStream(edges, 2, 200000 + DEBOUNCE - 1);
+    TEST_ASSERT_EQUAL(1, transitionCount);
+
+    MotionTransition transition;
+    TEST_ASSERT_TRUE(debouncer->poll(200000 + DEBOUNCE, transition));
+    TEST_ASSERT_FALSE(transition.motion);
+}
+
+void test_stream_across_the_clock_wrap() {
+    const uint32_t start = 0xFFFFFFFFu - 5000;
+    const EdgeRecord edges[] = {
+        {start, 1},
+        {start + 500000, 0},
+    };
+    runStream(edges, 2, start + 500000 + RETRIGGER);
+    TEST_ASSERT_EQUAL(2, transitionCount);
+    assertTransition(0, true, start);
+    assertTransition(1, false, start + 500000);
+}
+
+void test_reset_reports_the_given_level_as_current() {
+    debouncer->reset(true, 100000);
+    TEST_ASSERT_TRUE(debouncer->getState());
+    const EdgeRecord edges[] = {
+        {200000, 1},
+    };
+    runStream(edges, 1, 200000 + RETRIGGER);
+    TEST_ASSERT_EQUAL(0, transitionCount);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_glitch_shorter_than_debounce_is_ignored);
+    RUN_TEST(test_motion_is_reported_once_the_level_holds);
+    RUN_TEST(test_bouncing_rising_edge_reports_one_motion_from_the_last_edge);
+    RUN_TEST(test_next_edge_settles_the_previous_level);
+    RUN_TEST(test_motion_ends_only_after_the_retrigger_window);
+    RUN_TEST(test_retrigger_within_the_window_is_one_continuous_motion);
+    RUN_TEST(test_retrigger_after_the_window_is_a_new_motion);
+    RUN_TEST(test_short_window_falls_back_to_the_debounce_time);
+    RUN_TEST(test_stream_across_the_clock_wrap);
+    RUN_TEST(test_reset_reports_the_given_level_as_current);
+    return UNITY_END();
+}
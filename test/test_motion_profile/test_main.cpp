@@ -0,0 +1,177 @@
+#include <unity.h>
+#include <math.h>
+#include "MotionProfile.h"
+
+static const float MAX_VELOCITY = 180.0f; ///< Degrees per second, as on the device.
+static const float ACCELERATION = 360.0f; ///< Degrees per second squared.
+static const float STEP = 0.02f;          ///< The device's 20 ms servo task.
+static const float TOLERANCE = 1e-3f;
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief What a run of the profile did.
+ */
+struct MoveTrace {
+    int steps;           ///< Steps until arrival, or -1.
+    float minPosition;
+    float maxPosition;
+    float maxSpeed;
+    float maxSpeedChange; ///< Per step, up to the step before arrival.
+};
+
+// Advances until arrival or `maxSteps`, checking the limits on every step
+static MoveTrace runMove(MotionProfile& profile, int maxSteps) {
+    MoveTrace trace = {-1, profile.getPosition(), profile.getPosition(), 0, 0};
+    float velocity = profile.getVelocity();
+    for (int i = 1; i <= maxSteps; i++) {
+        bool arrived = profile.advance(STEP);
+        float position = profile.getPosition();
+        trace.minPosition = fminf(trace.minPosition, position);
+        trace.maxPosition = fmaxf(trace.maxPosition, position);
+        if (arrived) {
+            // The arriving step reports the stop, not the velocity it moved at
+            trace.steps = i;
+            return trace;
+        }
+        trace.maxSpeed = fmaxf(trace.maxSpeed, fabsf(profile.getVelocity()));
+        trace.maxSpeedChange = fmaxf(trace.maxSpeedChange, fabsf(profile.getVelocity() - velocity));
+        velocity = profile.getVelocity();
+    }
+    return trace;
+}
+
+void test_move_arrives_on_target_without_overshoot() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(90);
+    TEST_ASSERT_TRUE(profile.isMoving());
+    MoveTrace trace = runMove(profile, 500);
+
+    TEST_ASSERT_TRUE(trace.steps > 0);
+    TEST_ASSERT_EQUAL_FLOAT(90.0f, profile.getPosition());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, profile.getVelocity());
+    TEST_ASSERT_FALSE(profile.isMoving());
+    TEST_ASSERT_TRUE(trace.maxPosition <= 90.0f + TOLERANCE);
+    TEST_ASSERT_TRUE(trace.minPosition >= 0.0f);
+    // 0.5 s accelerating, 0 s cruising, 0.5 s braking, plus the discrete steps
+    float duration = trace.steps * STEP;
+    TEST_ASSERT_TRUE(duration >= 1.0f && duration <= 1.1f);
+}
+
+void test_limits_hold_on_every_step() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(180);
+    MoveTrace trace = runMove(profile, 500);
+    TEST_ASSERT_TRUE(trace.steps > 0);
+    TEST_ASSERT_TRUE(trace.maxSpeed <= MAX_VELOCITY + TOLERANCE);
+    TEST_ASSERT_TRUE(trace.maxSpeed >= MAX_VELOCITY - TOLERANCE); // A long move reaches cruise
+    TEST_ASSERT_TRUE(trace.maxSpeedChange <= ACCELERATION * STEP + TOLERANCE);
+}
+
+void test_move_down_mirrors_the_move_up() {
+    MotionProfile up(MAX_VELOCITY, ACCELERATION);
+    MotionProfile down(MAX_VELOCITY, ACCELERATION);
+    down.reset(90);
+    up.setTarget(90);
+    down.setTarget(0);
+    MoveTrace upTrace = runMove(up, 500);
+    MoveTrace downTrace = runMove(down, 500);
+    TEST_ASSERT_EQUAL(upTrace.steps, downTrace.steps);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, down.getPosition());
+    TEST_ASSERT_TRUE(downTrace.minPosition >= -TOLERANCE);
+}
+
+void test_short_move_arrives_without_overshoot() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.reset(45);
+    profile.setTarget(46);
+    MoveTrace trace = runMove(profile, 100);
+    TEST_ASSERT_TRUE(trace.steps > 0);
+    TEST_ASSERT_TRUE(trace.maxPosition <= 46.0f + TOLERANCE);
+    TEST_ASSERT_EQUAL_FLOAT(46.0f, profile.getPosition());
+}
+
+void test_retarget_further_keeps_moving() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(90);
+    for (int i = 0; i < 30; i++) {
+        profile.advance(STEP);
+    }
+    float speed = profile.getVelocity();
+    TEST_ASSERT_TRUE(speed > 0);
+    profile.setTarget(170);
+    profile.advance(STEP);
+    TEST_ASSERT_TRUE(profile.getVelocity() >= speed - ACCELERATION * STEP - TOLERANCE);
+    MoveTrace trace = runMove(profile, 500);
+    TEST_ASSERT_TRUE(trace.steps > 0);
+    TEST_ASSERT_TRUE(trace.maxPosition <= 170.0f + TOLERANCE);
+    TEST_ASSERT_EQUAL_FLOAT(170.0f, profile.getPosition());
+}
+
+void test_reversing_target_mid_move_respects_the_acceleration_limit() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(180);
+    for (int i = 0; i < 40; i++) {
+        profile.advance(STEP);
+    }
+    float turnAt = profile.getPosition();
+    TEST_ASSERT_TRUE(profile.getVelocity() > 100.0f);
+    profile.setTarget(10);
+    MoveTrace trace = runMove(profile, 500);
+    TEST_ASSERT_TRUE(trace.steps > 0);
+    TEST_ASSERT_TRUE(trace.maxSpeedChange <= ACCELERATION * STEP + TOLERANCE);
+    TEST_ASSERT_TRUE(trace.maxPosition > turnAt); // Braking carries it past the turning point
+    TEST_ASSERT_TRUE(trace.minPosition >= 10.0f - TOLERANCE);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, profile.getPosition());
+}
+
+void test_uneven_steps_still_arrive_on_the_same_degree() {
+    // Braking assumes the next steps last as long as the current one, so scheduler jitter may
+    // carry the position a fraction past the target, never as far as the next whole degree
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(120);
+    uint32_t state = 3;
+    bool arrived = false;
+    for (int i = 0; i < 500 && !arrived; i++) {
+        state = state * 1664525u + 1013904223u;
+        float step = 0.015f + (state >> 8) % 1000 * 0.00001f; // 15 to 25 ms
+        arrived = profile.advance(step);
+        TEST_ASSERT_TRUE(profile.getPosition() < 120.5f);
+    }
+    TEST_ASSERT_TRUE(arrived);
+    TEST_ASSERT_EQUAL_FLOAT(120.0f, profile.getPosition());
+}
+
+void test_target_at_rest_position_does_not_move() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.reset(30);
+    profile.setTarget(30);
+    TEST_ASSERT_FALSE(profile.isMoving());
+    TEST_ASSERT_FALSE(profile.advance(STEP));
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, profile.getPosition());
+}
+
+void test_zero_elapsed_time_changes_nothing() {
+    MotionProfile profile(MAX_VELOCITY, ACCELERATION);
+    profile.setTarget(90);
+    TEST_ASSERT_FALSE(profile.advance(0));
+    TEST_ASSERT_FALSE(profile.advance(-STEP));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, profile.getPosition());
+    TEST_ASSERT_TRUE(profile.isMoving());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_move_arrives_on_target_without_overshoot);
+    RUN_TEST(test_limits_hold_on_every_step);
+    RUN_TEST(test_move_down_mirrors_the_move_up);
+    RUN_TEST(test_short_move_arrives_without_overshoot);
+    RUN_TEST(test_retarget_further_keeps_moving);
+    RUN_TEST(test_reversing_target_mid_move_respects_the_acceleration_limit);
+    RUN_TEST(test_uneven_steps_still_arrive_on_the_same_degree);
+    RUN_TEST(test_target_at_rest_position_does_not_move);
+    RUN_TEST(test_zero_elapsed_time_changes_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,236 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "Profiler.h"
+
+static Profiler profiler;
+
+void setUp() {
+    profiler.reset();
+}
+
+void tearDown() {}
+
+// Records a run of the given length: on the host the span clock counts nanoseconds
+static void recordRun(int span, uint32_t micros) {
+    profiler.record(span, Profiler::now() - micros * 1000);
+}
+
+void test_buckets_are_log2_of_microseconds() {
+    TEST_ASSERT_EQUAL(0, Profiler::bucketOf(0));
+    TEST_ASSERT_EQUAL(1, Profiler::bucketOf(1));
+    TEST_ASSERT_EQUAL(2, Profiler::bucketOf(2));
+    TEST_ASSERT_EQUAL(2, Profiler::bucketOf(3));
+    TEST_ASSERT_EQUAL(3, Profiler::bucketOf(4));
+    TEST_ASSERT_EQUAL(11, Profiler::bucketOf(1024));
+    TEST_ASSERT_EQUAL(SpanStats::BUCKET_COUNT - 1, Profiler::bucketOf(0xFFFFFFFFu));
+}
+
+void test_registering_a_name_twice_returns_the_same_span() {
+    int span = Profiler::registerSpan("twice");
+    TEST_ASSERT_TRUE(span >= 0);
+    TEST_ASSERT_EQUAL(span, Profiler::registerSpan("twice"));
+    char copy[] = "twice";
+    TEST_ASSERT_EQUAL(span, Profiler::registerSpan(copy));
+}
+
+void test_runs_fill_count_total_max_and_buckets() {
+    int span = Profiler::registerSpan("runs");
+    recordRun(span, 10);
+    recordRun(span, 20);
+    recordRun(span, 300);
+    SpanStats stats;
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_EQUAL_STRING("runs", stats.name);
+    TEST_ASSERT_EQUAL(3, stats.count);
+    // Each run is a little longer than asked, by the time between the two clock reads
+    TEST_ASSERT_TRUE(stats.total >= 330 && stats.total < 430);
+    TEST_ASSERT_TRUE(stats.max >= 300 && stats.max < 400);
+    TEST_ASSERT_EQUAL(1, stats.buckets[Profiler::bucketOf(10)]);
+    TEST_ASSERT_EQUAL(1, stats.buckets[Profiler::bucketOf(20)]);
+    TEST_ASSERT_EQUAL(1, stats.buckets[Profiler::bucketOf(300)]);
+}
+
+void test_total_carries_past_32_bits() {
+    int span = Profiler::registerSpan("long");
+    for (int i = 0; i < 1100; i++) {
+        recordRun(span, 4000000); // 4 s, about the longest run the host clock can measure
+    }
+    SpanStats stats;
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_TRUE(stats.total >= 4400000000ull && stats.total < 4401000000ull);
+    TEST_ASSERT_EQUAL(1100, stats.buckets[SpanStats::BUCKET_COUNT - 2]);
+}
+
+void test_percentiles_are_bucket_upper_bounds_capped_by_max() {
+    SpanStats stats;
+    memset(&stats, 0, sizeof(stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.percentile(50));
+    stats.count = 100;
+    stats.max = 900;
+    stats.buckets[Profiler::bucketOf(5)] = 98;  // 4 to 8 us
+    stats.buckets[Profiler::bucketOf(900)] = 2; // 512 to 1024 us
+    TEST_ASSERT_EQUAL_UINT32(8, stats.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(8, stats.percentile(98));
+    TEST_ASSERT_EQUAL_UINT32(900, stats.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(8, stats.percentile(0));
+}
+
+void test_reset_clears_the_window_and_keeps_the_spans() {
+    int span = Profiler::registerSpan("reset");
+    int count = Profiler::getSpanCount();
+    recordRun(span, 50);
+    profiler.reset();
+    SpanStats stats;
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_EQUAL(0, stats.count);
+    TEST_ASSERT_EQUAL(0, stats.max);
+    TEST_ASSERT_EQUAL(count, Profiler::getSpanCount());
+    TEST_ASSERT_EQUAL(span, Profiler::registerSpan("reset"));
+}
+
+void test_negative_span_and_bad_index_are_ignored() {
+    profiler.record(-1, Profiler::now());
+    SpanStats stats;
+    TEST_ASSERT_FALSE(profiler.getStats(-1, stats));
+    TEST_ASSERT_FALSE(profiler.getStats(Profiler::getSpanCount(), stats));
+}
+
+void test_encode_lists_only_spans_that_ran() {
+    int span = Profiler::registerSpan("encoded");
+    Profiler::registerSpan("idle");
+    for (int i = 0; i < 4; i++) {
+        recordRun(span, 0);
+    }
+    char buffer[512];
+    size_t length = profiler.encode(buffer, sizeof(buffer), 60000);
+    TEST_ASSERT_EQUAL(strlen(buffer), length);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"window\":60000,\"spans\":[{\"name\":\"encoded\",\"count\":4,\"mean\":0,\"p50\":0,\"p99\":0,\"max\":0,\"hist\":[4]}]}",
+        buffer);
+}
+
+void test_encode_reports_a_buffer_too_small() {
+    int span = Profiler::registerSpan("overflow");
+    recordRun(span, 100);
+    char buffer[512];
+    size_t length = profiler.encode(buffer, sizeof(buffer), 1000);
+    TEST_ASSERT_TRUE(length > 0);
+    for (size_t size = 1; size <= length; size++) {
+        TEST_ASSERT_EQUAL(0, profiler.encode(buffer, size, 1000));
+    }
+    TEST_ASSERT_EQUAL(length, profiler.encode(buffer, length + 1, 1000));
+}
+
+void test_concurrent_runs_are_all_counted() {
+    static const int THREADS = 4;
+    static const int RUNS = 50000;
+    int span = Profiler::registerSpan("concurrent");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.push_back(std::thread([span]() {
+            for (int i = 0; i < RUNS; i++) {
+                profiler.record(span, Profiler::now());
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    SpanStats stats;
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_EQUAL(THREADS * RUNS, stats.count);
+    unsigned long bucketed = 0;
+    for (int i = 0; i < SpanStats::BUCKET_COUNT; i++) {
+        bucketed += stats.buckets[i];
+    }
+    TEST_ASSERT_EQUAL(stats.count, bucketed);
+}
+
+void test_profilers_keep_separate_histograms() {
+    int span = Profiler::registerSpan("separate");
+    Profiler other;
+    recordRun(span, 10);
+    other.record(span, Profiler::now());
+    other.record(span, Profiler::now());
+    SpanStats stats;
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_EQUAL(1, stats.count);
+    TEST_ASSERT_TRUE(other.getStats(span, stats));
+    TEST_ASSERT_EQUAL(2, stats.count);
+    other.reset();
+    TEST_ASSERT_TRUE(profiler.getStats(span, stats));
+    TEST_ASSERT_EQUAL(1, stats.count);
+}
+
+static void runScope() {
+    PROFILE_SPAN("scoped");
+}
+
+static unsigned long countOf(const Profiler& owner, const char* name) {
+    SpanStats stats;
+    return owner.getStats(Profiler::registerSpan(name), stats) ? stats.count : 0;
+}
+
+void test_spans_record_into_the_selected_profiler() {
+    Profiler other;
+    TEST_ASSERT_NULL(Profiler::current());
+    runScope(); // Nothing selected: not recorded anywhere
+    {
+        PROFILE_SELECT(profiler);
+        TEST_ASSERT_EQUAL_PTR(&profiler, Profiler::current());
+        runScope();
+        {
+            ProfilerSelection selection(other);
+            runScope();
+            runScope();
+        }
+        TEST_ASSERT_EQUAL_PTR(&profiler, Profiler::current());
+        runScope();
+
+        // Other threads start with no profiler
+        Profiler* seen = &profiler;
+        std::thread thread([&seen]() {
+            seen = Profiler::current();
+            runScope();
+        });
+        thread.join();
+        TEST_ASSERT_NULL(seen);
+    }
+    TEST_ASSERT_NULL(Profiler::current());
+    TEST_ASSERT_EQUAL(2, countOf(profiler, "scoped"));
+    TEST_ASSERT_EQUAL(2, countOf(other, "scoped"));
+}
+
+void test_span_table_is_bounded() {
+    // Last, since spans stay registered for the life of the process; so must their names
+    static char names[Profiler::MAX_SPANS][24];
+    int registered = Profiler::getSpanCount();
+    for (int i = 0; registered < Profiler::MAX_SPANS; i++) {
+        snprintf(names[i], sizeof(names[i]), "filler%d", i);
+        TEST_ASSERT_TRUE(Profiler::registerSpan(names[i]) >= 0);
+        registered++;
+    }
+    TEST_ASSERT_EQUAL(-1, Profiler::registerSpan("one too many"));
+    TEST_ASSERT_EQUAL(Profiler::MAX_SPANS, Profiler::getSpanCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_are_log2_of_microseconds);
+    RUN_TEST(test_registering_a_name_twice_returns_the_same_span);
+    RUN_TEST(test_runs_fill_count_total_max_and_buckets);
+    RUN_TEST(test_total_carries_past_32_bits);
+    RUN_TEST(test_percentiles_are_bucket_upper_bounds_capped_by_max);
+    RUN_TEST(test_reset_clears_the_window_and_keeps_the_spans);
+    RUN_TEST(test_negative_span_and_bad_index_are_ignored);
+    RUN_TEST(test_encode_lists_only_spans_that_ran);
+    RUN_TEST(test_encode_reports_a_buffer_too_small);
+    RUN_TEST(test_concurrent_runs_are_all_counted);
+    RUN_TEST(test_profilers_keep_separate_histograms);
+    RUN_TEST(test_spans_record_into_the_selected_profiler);
+    RUN_TEST(test_span_table_is_bounded);
+    return UNITY_END();
+}
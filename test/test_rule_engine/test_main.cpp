@@ -0,0 +1,361 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "RuleConfig.h"
+#include "RuleEngine.h"
+
+/** @brief Records every action and alert the engine produces. */
+class RecordingHandler : public RuleActionHandler {
+public:
+    std::vector<RuleAction> actions;
+    std::vector<RuleAlert> alerts;
+    std::vector<float> alertValues;
+
+    void applyRuleAction(const RuleAction& action) override {
+        actions.push_back(action);
+    }
+
+    void raiseRuleAlert(const RuleAlert& alert, float value) override {
+        alerts.push_back(alert);
+        alertValues.push_back(value);
+    }
+
+    void reset() {
+        actions.clear();
+        alerts.clear();
+        alertValues.clear();
+    }
+};
+
+static RuleEngine* engine;
+static RecordingHandler* handler;
+
+void setUp() {
+    engine = new RuleEngine();
+    handler = new RecordingHandler();
+}
+
+void tearDown() {
+    delete engine;
+    delete handler;
+}
+
+/** @brief One-term rule switching an LED on while it matches and off otherwise. */
+static Rule makeRule(RuleField field, RuleOperator op, float threshold, uint8_t led) {
+    Rule rule;
+    memset(&rule, 0, sizeof(rule));
+    rule.terms[0].field = field;
+    rule.terms[0].op = op;
+    rule.terms[0].threshold = threshold;
+    rule.termCount = 1;
+    rule.activeActions[0].type = RULE_ACTION_LED;
+    rule.activeActions[0].target = led;
+    rule.activeActions[0].value = 1;
+    rule.activeActionCount = 1;
+    rule.inactiveActions[0] = rule.activeActions[0];
+    rule.inactiveActions[0].value = 0;
+    rule.inactiveActionCount = 1;
+    return rule;
+}
+
+static void assertLastAction(uint8_t led, int16_t value) {
+    TEST_ASSERT_FALSE(handler->actions.empty());
+    TEST_ASSERT_EQUAL(led, handler->actions.back().target);
+    TEST_ASSERT_EQUAL(value, handler->actions.back().value);
+}
+
+void test_only_readers_of_changed_fields_are_checked() {
+    TEST_ASSERT_TRUE(engine->addRule(makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, 30, 0)));
+    TEST_ASSERT_TRUE(engine->addRule(makeRule(RULE_FIELD_HUMIDITY, RULE_GREATER, 70, 1)));
+    TEST_ASSERT_TRUE(engine->addRule(makeRule(RULE_FIELD_SMOKE, RULE_GREATER, 300, 2)));
+    engine->setField(RULE_FIELD_TEMPERATURE, 20);
+    engine->setField(RULE_FIELD_HUMIDITY, 50);
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    TEST_ASSERT_EQUAL(3, engine->evaluate(0, *handler));
+    TEST_ASSERT_EQUAL(3, engine->getCheckCount());
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 21);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(100, *handler));
+    TEST_ASSERT_EQUAL(4, engine->getCheckCount());
+
+    // The same value again, and motion, which no rule reads, check nothing
+    engine->setField(RULE_FIELD_TEMPERATURE, 21);
+    engine->setField(RULE_FIELD_MOTION, 1);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(200, *handler));
+    TEST_ASSERT_EQUAL(4, engine->getCheckCount());
+
+    engine->setField(RULE_FIELD_HUMIDITY, 75);
+    engine->setField(RULE_FIELD_SMOKE, 120);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(300, *handler));
+    TEST_ASSERT_EQUAL(6, engine->getCheckCount());
+    TEST_ASSERT_TRUE(engine->isActive(1));
+    assertLastAction(1, 1);
+}
+
+void test_rule_reading_several_changed_fields_is_checked_once() {
+    Rule rule = makeRule(RULE_FIELD_TEMPERATURE, RULE_LESS, 18, 0);
+    rule.terms[1].field = RULE_FIELD_HUMIDITY;
+    rule.terms[1].op = RULE_LESS;
+    rule.terms[1].threshold = 40;
+    rule.termCount = 2;
+    rule.matchAny = true;
+    TEST_ASSERT_TRUE(engine->addRule(rule));
+    engine->setField(RULE_FIELD_TEMPERATURE, 20);
+    engine->setField(RULE_FIELD_HUMIDITY, 50);
+    engine->evaluate(0, *handler);
+    unsigned long checks = engine->getCheckCount();
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 21);
+    engine->setField(RULE_FIELD_HUMIDITY, 35);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(100, *handler));
+    TEST_ASSERT_EQUAL(checks + 1, engine->getCheckCount());
+    TEST_ASSERT_TRUE(engine->isActive(0));
+}
+
+void test_rule_waits_for_its_fields_to_be_valid() {
+    TEST_ASSERT_TRUE(engine->addRule(makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, 30, 0)));
+    TEST_ASSERT_EQUAL(0, engine->evaluate(0, *handler));
+    TEST_ASSERT_TRUE(handler->actions.empty());
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 35);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(100, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+
+    // An invalid reading keeps the state
+    engine->setField(RULE_FIELD_TEMPERATURE, NAN);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(200, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+}
+
+void test_hysteresis_releases_past_the_band() {
+    Rule rule = makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, 30, 0);
+    rule.hysteresis = 2;
+    TEST_ASSERT_TRUE(engine->addRule(rule));
+    engine->setField(RULE_FIELD_TEMPERATURE, 31);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(0, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+
+    // Below the threshold but inside the band: still active
+    engine->setField(RULE_FIELD_TEMPERATURE, 29);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(100, *handler));
+    engine->setField(RULE_FIELD_TEMPERATURE, 28.5f);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(200, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 27.5f);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(300, *handler));
+    TEST_ASSERT_FALSE(engine->isActive(0));
+    assertLastAction(0, 0);
+
+    // Released, the plain threshold applies again
+    engine->setField(RULE_FIELD_TEMPERATURE, 29.5f);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(400, *handler));
+    engine->setField(RULE_FIELD_TEMPERATURE, 30.5f);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(500, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+}
+
+void test_hold_time_delays_the_change() {
+    Rule rule = makeRule(RULE_FIELD_SMOKE, RULE_GREATER, 300, 4);
+    rule.holdTime = 5000;
+    TEST_ASSERT_TRUE(engine->addRule(rule));
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(0, *handler));
+
+    // The first evaluation does not start a hold
+    engine->setField(RULE_FIELD_SMOKE, 400);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(1000, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(2000, *handler));
+    TEST_ASSERT_EQUAL(0, engine->evaluate(5999, *handler));
+    TEST_ASSERT_TRUE(engine->isActive(0));
+
+    // No new reading needed: the pending rule is re-checked until the hold passes
+    TEST_ASSERT_EQUAL(1, engine->evaluate(6000, *handler));
+    TEST_ASSERT_FALSE(engine->isActive(0));
+    assertLastAction(4, 0);
+}
+
+void test_pending_change_is_cancelled_when_the_value_returns() {
+    Rule rule = makeRule(RULE_FIELD_SMOKE, RULE_GREATER, 300, 4);
+    rule.holdTime = 5000;
+    TEST_ASSERT_TRUE(engine->addRule(rule));
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    engine->evaluate(0, *handler);
+    engine->setField(RULE_FIELD_SMOKE, 400);
+    engine->evaluate(1000, *handler);
+    handler->reset();
+
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(2000, *handler));
+    engine->setField(RULE_FIELD_SMOKE, 400);
+    TEST_ASSERT_EQUAL(0, engine->evaluate(3000, *handler));
+
+    // Nothing is pending any more, so later passes check nothing and change nothing
+    unsigned long checks = engine->getCheckCount();
+    TEST_ASSERT_EQUAL(0, engine->evaluate(7000, *handler));
+    TEST_ASSERT_EQUAL(checks, engine->getCheckCount());
+    TEST_ASSERT_TRUE(engine->isActive(0));
+    TEST_ASSERT_TRUE(handler->actions.empty());
+}
+
+void test_group_keeps_only_the_first_matching_rule_active() {
+    Rule cold = makeRule(RULE_FIELD_TEMPERATURE, RULE_LESS, 18, 0);
+    Rule mild = makeRule(RULE_FIELD_TEMPERATURE, RULE_LESS, 25, 1);
+    Rule fallback = makeRule(RULE_FIELD_TEMPERATURE, RULE_LESS, 0, 3);
+    fallback.termCount = 0; // Always matches
+    cold.group = mild.group = fallback.group = 1;
+    TEST_ASSERT_TRUE(engine->addRule(cold));
+    TEST_ASSERT_TRUE(engine->addRule(mild));
+    TEST_ASSERT_TRUE(engine->addRule(fallback));
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 15);
+    engine->evaluate(0, *handler);
+    TEST_ASSERT_TRUE(engine->isActive(0));
+    TEST_ASSERT_FALSE(engine->isActive(1)); // Matches too, but comes later
+    TEST_ASSERT_FALSE(engine->isActive(2));
+
+    engine->setField(RULE_FIELD_TEMPERATURE, 20);
+    engine->evaluate(100, *handler);
+    TEST_ASSERT_FALSE(engine->isActive(0));
+    TEST_ASSERT_TRUE(engine->isActive(1));
+    TEST_ASSERT_FALSE(engine->isActive(2));
+
+    handler->reset();
+    engine->setField(RULE_FIELD_TEMPERATURE, 30);
+    TEST_ASSERT_EQUAL(2, engine->evaluate(200, *handler));
+    TEST_ASSERT_FALSE(engine->isActive(1));
+    TEST_ASSERT_TRUE(engine->isActive(2));
+    TEST_ASSERT_EQUAL(2, (int)handler->actions.size());
+}
+
+void test_alert_carries_the_first_term_value() {
+    Rule rule = makeRule(RULE_FIELD_SMOKE, RULE_GREATER, 300, 4);
+    rule.hasAlert = true;
+    strcpy(rule.alert.type, "smoke");
+    TEST_ASSERT_TRUE(engine->addRule(rule));
+    engine->setField(RULE_FIELD_SMOKE, 450);
+    engine->evaluate(0, *handler);
+    TEST_ASSERT_EQUAL(1, (int)handler->alertValues.size());
+    TEST_ASSERT_EQUAL_STRING("smoke", handler->alerts[0].type);
+    TEST_ASSERT_EQUAL_FLOAT(450, handler->alertValues[0]);
+
+    // Only on activation
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    engine->evaluate(100, *handler);
+    TEST_ASSERT_EQUAL(1, (int)handler->alertValues.size());
+}
+
+void test_malformed_rules_are_refused() {
+    Rule rule = makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, 30, 0);
+    rule.terms[0].field = RULE_FIELD_COUNT;
+    TEST_ASSERT_FALSE(engine->addRule(rule));
+    rule = makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, NAN, 0);
+    TEST_ASSERT_FALSE(engine->addRule(rule));
+    rule = makeRule(RULE_FIELD_TEMPERATURE, RULE_GREATER, 30, 0);
+    rule.group = Rule::MAX_GROUP + 1;
+    TEST_ASSERT_FALSE(engine->addRule(rule));
+    rule.group = 0;
+    rule.hysteresis = -1;
+    TEST_ASSERT_FALSE(engine->addRule(rule));
+    TEST_ASSERT_EQUAL(0, engine->getRuleCount());
+
+    rule.hysteresis = 0;
+    for (int i = 0; i < RuleEngine::MAX_RULES; i++) {
+        TEST_ASSERT_TRUE(engine->addRule(rule));
+    }
+    TEST_ASSERT_FALSE(engine->addRule(rule));
+}
+
+void test_config_loads_the_default_rules() {
+    TEST_ASSERT_EQUAL(6, RuleConfig::load(RuleConfig::DEFAULT_RULES, strlen(RuleConfig::DEFAULT_RULES), *engine));
+    const Rule& smoke = engine->getRule(4);
+    TEST_ASSERT_EQUAL(RULE_FIELD_SMOKE, smoke.terms[0].field);
+    TEST_ASSERT_EQUAL(RULE_GREATER, smoke.terms[0].op);
+    TEST_ASSERT_EQUAL_FLOAT(300, smoke.terms[0].threshold);
+    TEST_ASSERT_EQUAL_FLOAT(30, smoke.hysteresis);
+    TEST_ASSERT_EQUAL(5000, smoke.holdTime);
+    TEST_ASSERT_EQUAL(2, smoke.activeActionCount);
+    TEST_ASSERT_EQUAL(RULE_ACTION_SERVO, smoke.activeActions[1].type);
+    TEST_ASSERT_EQUAL(2, smoke.activeActions[1].target);
+    TEST_ASSERT_EQUAL(90, smoke.activeActions[1].value);
+    TEST_ASSERT_TRUE(smoke.hasAlert);
+    TEST_ASSERT_EQUAL_STRING("medium", smoke.alert.severity);
+    TEST_ASSERT_EQUAL(1, engine->getRule(0).group);
+    TEST_ASSERT_TRUE(engine->getRule(0).matchAny);
+}
+
+void test_config_rejects_a_malformed_document_and_keeps_the_table() {
+    TEST_ASSERT_EQUAL(6, RuleConfig::load(RuleConfig::DEFAULT_RULES, strlen(RuleConfig::DEFAULT_RULES), *engine));
+    engine->setField(RULE_FIELD_TEMPERATURE, 35);
+    engine->setField(RULE_FIELD_HUMIDITY, 50);
+    engine->setField(RULE_FIELD_SMOKE, 100);
+    engine->evaluate(0, *handler);
+    TEST_ASSERT_TRUE(engine->isActive(3));
+
+    const char* documents[] = {
+        "{\"rules\":[",                                                              // Not JSON
+        "{\"other\":[]}",                                                            // No rules
+        "{\"rules\":[42]}",                                                          // Rule is not an object
+        "{\"rules\":[{\"when\":[[\"pressure\",\">\",1]]}]}",                         // Unknown field
+        "{\"rules\":[{\"when\":[[\"smokeLevel\",\"=\",1]]}]}",                       // Unknown operator
+        "{\"rules\":[{\"when\":[[\"smokeLevel\",\">\",\"high\"]]}]}",                // Threshold not a number
+        "{\"rules\":[{\"when\":[[\"smokeLevel\",\">\",1],[\"humidity\",\">\",1],"
+        "[\"temperature\",\">\",1]]}]}",                                             // Too many terms
+        "{\"rules\":[{\"then\":[{\"led\":\"purple\",\"on\":true}]}]}",               // Unknown LED
+        "{\"rules\":[{\"then\":[{\"servo\":1,\"angle\":200}]}]}",                    // Angle out of range
+        "{\"rules\":[{\"then\":[{\"buzzer\":1}]}]}",                                 // Unknown action
+        "{\"rules\":[{\"group\":40}]}",                                              // Group out of range
+        "{\"rules\":[{\"hysteresis\":-1}]}",                                         // Negative band
+        // A valid rule first: nothing is loaded until the whole document is checked
+        "{\"rules\":[{\"then\":[{\"led\":\"blue\",\"on\":true}]},{\"when\":[[\"humidity\"]]}]}",
+    };
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        TEST_ASSERT_EQUAL_MESSAGE(-1, RuleConfig::load(documents[i], strlen(documents[i]), *engine), documents[i]);
+    }
+
+    std::string oversized = "{\"rules\":[]}";
+    oversized.append(RuleConfig::MAX_JSON_SIZE, ' ');
+    TEST_ASSERT_EQUAL(-1, RuleConfig::load(oversized.c_str(), oversized.size(), *engine));
+
+    // The running table is untouched and keeps its state
+    TEST_ASSERT_EQUAL(6, engine->getRuleCount());
+    TEST_ASSERT_EQUAL_FLOAT(300, engine->getRule(4).terms[0].threshold);
+    TEST_ASSERT_TRUE(engine->isActive(3));
+    handler->reset();
+    TEST_ASSERT_EQUAL(0, engine->evaluate(100, *handler));
+    TEST_ASSERT_TRUE(handler->actions.empty());
+}
+
+void test_config_replaces_the_table() {
+    TEST_ASSERT_EQUAL(6, RuleConfig::load(RuleConfig::DEFAULT_RULES, strlen(RuleConfig::DEFAULT_RULES), *engine));
+    const char document[] = "{\"rules\":[{\"when\":[[\"motionDetected\",\">\",0.5]],"
+                            "\"then\":[{\"led\":\"blue\",\"on\":true}],\"else\":[{\"led\":\"blue\",\"on\":false}]}]}";
+    TEST_ASSERT_EQUAL(1, RuleConfig::load(document, strlen(document), *engine));
+    TEST_ASSERT_EQUAL(1, engine->getRuleCount());
+
+    engine->setField(RULE_FIELD_MOTION, 1);
+    TEST_ASSERT_EQUAL(1, engine->evaluate(0, *handler));
+    assertLastAction(3, 1);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_only_readers_of_changed_fields_are_checked);
+    RUN_TEST(test_rule_reading_several_changed_fields_is_checked_once);
+    RUN_TEST(test_rule_waits_for_its_fields_to_be_valid);
+    RUN_TEST(test_hysteresis_releases_past_the_band);
+    RUN_TEST(test_hold_time_delays_the_change);
+    RUN_TEST(test_pending_change_is_cancelled_when_the_value_returns);
+    RUN_TEST(test_group_keeps_only_the_first_matching_rule_active);
+    RUN_TEST(test_alert_carries_the_first_term_value);
+    RUN_TEST(test_malformed_rules_are_refused);
+    RUN_TEST(test_config_loads_the_default_rules);
+    RUN_TEST(test_config_rejects_a_malformed_document_and_keeps_the_table);
+    RUN_TEST(test_config_replaces_the_table);
+    return UNITY_END();
+}
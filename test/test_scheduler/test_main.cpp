@@ -0,0 +1,254 @@
+#include <unity.h>
+#include "Scheduler.h"
+
+static const int FAST_TASK = 1;
+static const int SLOW_TASK = 2;
+
+static unsigned long now;
+
+static unsigned long fakeClock() {
+    return now;
+}
+
+// Records every job run; a run can take time by moving the fake clock forward
+class RecordingHandler : public EventHandler {
+public:
+    static const int MAX_RUNS = 32;
+    int ids[MAX_RUNS];
+    unsigned long starts[MAX_RUNS];
+    float lateness[MAX_RUNS];
+    int count;
+    unsigned long runTime;
+
+    RecordingHandler() : count(0), runTime(0) {}
+
+    void on(Event event) override {
+        if (count < MAX_RUNS) {
+            ids[count] = event.id;
+            starts[count] = event.timestamp;
+            lateness[count] = event.value;
+            count++;
+        }
+        now += runTime;
+    }
+};
+
+static RecordingHandler* handler;
+static Scheduler* scheduler;
+
+void setUp() {
+    now = 0;
+    handler = new RecordingHandler();
+    scheduler = new Scheduler(handler, fakeClock);
+}
+
+void tearDown() {
+    delete scheduler;
+    delete handler;
+}
+
+// Ticks once at the given time and returns how many jobs ran
+static int tickAt(unsigned long time) {
+    now = time;
+    int before = handler->count;
+    scheduler->tick();
+    return handler->count - before;
+}
+
+void test_first_run_is_released_immediately() {
+    TEST_ASSERT_TRUE(scheduler->addTask(FAST_TASK, 100));
+    TEST_ASSERT_EQUAL(0, scheduler->timeUntilNextTask());
+    TEST_ASSERT_EQUAL(1, tickAt(0));
+    TEST_ASSERT_EQUAL(FAST_TASK, handler->ids[0]);
+    TEST_ASSERT_EQUAL(0, tickAt(99));
+    TEST_ASSERT_EQUAL(1, tickAt(100));
+}
+
+void test_late_release_keeps_the_phase() {
+    scheduler->addTask(FAST_TASK, 100);
+    tickAt(0);
+    TEST_ASSERT_EQUAL(1, tickAt(130));
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, handler->lateness[1]);
+    TEST_ASSERT_EQUAL(130, handler->starts[1]);
+
+    // Next release is still at 200, not 230
+    TEST_ASSERT_EQUAL(70, scheduler->timeUntilNextTask());
+    TEST_ASSERT_EQUAL(0, tickAt(199));
+    TEST_ASSERT_EQUAL(1, tickAt(200));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, handler->lateness[2]);
+
+    const TaskStats* stats = scheduler->getStats(FAST_TASK);
+    TEST_ASSERT_NOT_NULL(stats);
+    TEST_ASSERT_EQUAL(3, stats->runs);
+    TEST_ASSERT_EQUAL(30, stats->maxLateness);
+    TEST_ASSERT_EQUAL(30, stats->totalLateness);
+    TEST_ASSERT_EQUAL(0, stats->overruns);
+}
+
+void test_run_past_its_deadline_is_an_overrun() {
+    scheduler->addTask(FAST_TASK, 100, 50);
+    handler->runTime = 40;
+    tickAt(0);
+    handler->runTime = 60;
+    tickAt(100);
+    const TaskStats* stats = scheduler->getStats(FAST_TASK);
+    TEST_ASSERT_EQUAL(2, stats->runs);
+    TEST_ASSERT_EQUAL(1, stats->overruns);
+    TEST_ASSERT_EQUAL(60, stats->lastRunTime);
+    TEST_ASSERT_EQUAL(60, stats->maxRunTime);
+
+    // The deadline counts from the release, so a late start eats into it
+    handler->runTime = 10;
+    tickAt(245);
+    TEST_ASSERT_EQUAL(2, scheduler->getStats(FAST_TASK)->overruns);
+
+    scheduler->resetStats();
+    TEST_ASSERT_EQUAL(0, scheduler->getStats(FAST_TASK)->runs);
+    TEST_ASSERT_EQUAL(0, scheduler->getStats(FAST_TASK)->overruns);
+}
+
+void test_default_deadline_is_the_period() {
+    scheduler->addTask(FAST_TASK, 100);
+    handler->runTime = 100;
+    tickAt(0);
+    TEST_ASSERT_EQUAL(0, scheduler->getStats(FAST_TASK)->overruns);
+    handler->runTime = 101;
+    tickAt(200);
+    TEST_ASSERT_EQUAL(1, scheduler->getStats(FAST_TASK)->overruns);
+}
+
+void test_missed_periods_resynchronize_without_a_burst() {
+    scheduler->addTask(FAST_TASK, 100);
+    tickAt(0);
+
+    // Three releases missed: one run now, then one period later, not a catch-up per release
+    TEST_ASSERT_EQUAL(1, tickAt(450));
+    TEST_ASSERT_EQUAL_FLOAT(350.0f, handler->lateness[1]);
+    TEST_ASSERT_EQUAL(0, tickAt(450));
+    TEST_ASSERT_EQUAL(100, scheduler->timeUntilNextTask());
+    TEST_ASSERT_EQUAL(0, tickAt(549));
+    TEST_ASSERT_EQUAL(1, tickAt(550));
+    TEST_ASSERT_EQUAL(1, tickAt(650));
+}
+
+void test_run_longer_than_its_period_resynchronizes_from_its_end() {
+    scheduler->addTask(FAST_TASK, 100);
+    handler->runTime = 250;
+    tickAt(0);
+    handler->runTime = 0;
+    TEST_ASSERT_EQUAL(350, now + scheduler->timeUntilNextTask());
+    TEST_ASSERT_EQUAL(0, tickAt(349));
+    TEST_ASSERT_EQUAL(1, tickAt(350));
+}
+
+void test_release_survives_the_clock_wrap() {
+    now = (unsigned long)-150;
+    scheduler->addTask(FAST_TASK, 100);
+    TEST_ASSERT_EQUAL(1, tickAt((unsigned long)-150));
+    TEST_ASSERT_EQUAL(0, tickAt((unsigned long)-51));
+    TEST_ASSERT_EQUAL(1, tickAt((unsigned long)-50));
+
+    // The next release, at 50, lies past the wrap
+    TEST_ASSERT_EQUAL(0, tickAt((unsigned long)-1));
+    TEST_ASSERT_EQUAL(0, tickAt(0));
+    TEST_ASSERT_EQUAL(50, scheduler->timeUntilNextTask());
+    TEST_ASSERT_EQUAL(0, tickAt(49));
+    TEST_ASSERT_EQUAL(1, tickAt(50));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, handler->lateness[2]);
+    TEST_ASSERT_EQUAL(0, scheduler->getStats(FAST_TASK)->maxLateness);
+}
+
+void test_time_until_next_task() {
+    // No jobs, or none enabled: nothing will ever be released
+    TEST_ASSERT_EQUAL((unsigned long)-1, scheduler->timeUntilNextTask());
+    scheduler->addTask(FAST_TASK, 100);
+    scheduler->addTask(SLOW_TASK, 1000);
+    TEST_ASSERT_EQUAL(0, scheduler->timeUntilNextTask());
+    tickAt(0);
+    TEST_ASSERT_EQUAL(100, scheduler->timeUntilNextTask());
+    now = 60;
+    TEST_ASSERT_EQUAL(40, scheduler->timeUntilNextTask());
+    scheduler->setEnabled(FAST_TASK, false);
+    TEST_ASSERT_EQUAL(940, scheduler->timeUntilNextTask());
+    scheduler->setEnabled(SLOW_TASK, false);
+    TEST_ASSERT_EQUAL((unsigned long)-1, scheduler->timeUntilNextTask());
+
+    Scheduler unclocked(handler);
+    unclocked.addTask(FAST_TASK, 100);
+    TEST_ASSERT_EQUAL(0, unclocked.timeUntilNextTask());
+}
+
+void test_disabled_job_is_skipped_and_released_on_enable() {
+    scheduler->addTask(FAST_TASK, 100);
+    tickAt(0);
+    scheduler->setEnabled(FAST_TASK, false);
+    TEST_ASSERT_EQUAL(0, tickAt(100));
+    TEST_ASSERT_EQUAL(0, tickAt(250));
+    now = 270;
+    scheduler->setEnabled(FAST_TASK, true);
+    TEST_ASSERT_EQUAL(1, tickAt(270));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, handler->lateness[1]);
+    TEST_ASSERT_EQUAL(0, tickAt(369));
+    TEST_ASSERT_EQUAL(1, tickAt(370));
+}
+
+void test_set_period_keeps_the_pending_release() {
+    scheduler->addTask(FAST_TASK, 100);
+    tickAt(0);
+    TEST_ASSERT_TRUE(scheduler->setPeriod(FAST_TASK, 500));
+    TEST_ASSERT_FALSE(scheduler->setPeriod(SLOW_TASK, 500));
+    TEST_ASSERT_EQUAL(1, tickAt(100));
+    TEST_ASSERT_EQUAL(0, tickAt(599));
+    TEST_ASSERT_EQUAL(1, tickAt(600));
+}
+
+void test_jobs_run_in_registration_order() {
+    scheduler->addTask(SLOW_TASK, 1000);
+    scheduler->addTask(FAST_TASK, 100);
+    TEST_ASSERT_EQUAL(2, tickAt(0));
+    TEST_ASSERT_EQUAL(SLOW_TASK, handler->ids[0]);
+    TEST_ASSERT_EQUAL(FAST_TASK, handler->ids[1]);
+    TEST_ASSERT_EQUAL(SLOW_TASK, scheduler->getTaskId(0));
+    TEST_ASSERT_EQUAL(-1, scheduler->getTaskId(2));
+}
+
+void test_task_table_is_bounded_and_ids_unique() {
+    TEST_ASSERT_TRUE(scheduler->addTask(0, 100));
+    TEST_ASSERT_FALSE(scheduler->addTask(0, 200));
+    for (int id = 1; id < Scheduler::MAX_TASKS; id++) {
+        TEST_ASSERT_TRUE(scheduler->addTask(id, 100));
+    }
+    TEST_ASSERT_FALSE(scheduler->addTask(Scheduler::MAX_TASKS, 100));
+    TEST_ASSERT_EQUAL(Scheduler::MAX_TASKS, scheduler->getTaskCount());
+    TEST_ASSERT_NULL(scheduler->getStats(Scheduler::MAX_TASKS));
+}
+
+void test_tick_without_clock_runs_nothing() {
+    Scheduler unclocked(handler);
+    unclocked.addTask(FAST_TASK, 100);
+    unclocked.tick();
+    TEST_ASSERT_EQUAL(0, handler->count);
+    unclocked.setClock(fakeClock);
+    unclocked.setEnabled(FAST_TASK, false);
+    unclocked.setEnabled(FAST_TASK, true);
+    unclocked.tick();
+    TEST_ASSERT_EQUAL(1, handler->count);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_run_is_released_immediately);
+    RUN_TEST(test_late_release_keeps_the_phase);
+    RUN_TEST(test_run_past_its_deadline_is_an_overrun);
+    RUN_TEST(test_default_deadline_is_the_period);
+    RUN_TEST(test_missed_periods_resynchronize_without_a_burst);
+    RUN_TEST(test_run_longer_than_its_period_resynchronizes_from_its_end);
+    RUN_TEST(test_release_survives_the_clock_wrap);
+    RUN_TEST(test_time_until_next_task);
+    RUN_TEST(test_disabled_job_is_skipped_and_released_on_enable);
+    RUN_TEST(test_set_period_keeps_the_pending_release);
+    RUN_TEST(test_jobs_run_in_registration_order);
+    RUN_TEST(test_task_table_is_bounded_and_ids_unique);
+    RUN_TEST(test_tick_without_clock_runs_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,107 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "SeqlockSnapshot.h"
+
+// Every field derives from the same counter, so a torn read shows up as a mismatch
+struct Reading {
+    uint32_t counter;
+    float temperature;
+    uint8_t flags;
+    uint32_t check;
+};
+
+static Reading makeReading(uint32_t counter) {
+    Reading reading;
+    memset(&reading, 0, sizeof(reading));
+    reading.counter = counter;
+    reading.temperature = counter * 0.5f;
+    reading.flags = counter & 0xFF;
+    reading.check = counter * 2654435761u;
+    return reading;
+}
+
+static bool isConsistent(const Reading& reading) {
+    return reading.temperature == reading.counter * 0.5f
+        && reading.flags == (reading.counter & 0xFF)
+        && reading.check == reading.counter * 2654435761u;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_read_before_any_write_returns_version_zero() {
+    SeqlockSnapshot<Reading> snapshot;
+    Reading reading;
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.read(reading));
+    TEST_ASSERT_EQUAL_UINT32(0, reading.counter);
+}
+
+void test_read_returns_latest_value_and_version() {
+    SeqlockSnapshot<Reading> snapshot;
+    snapshot.write(makeReading(7));
+    snapshot.write(makeReading(8));
+
+    Reading reading;
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.read(reading));
+    TEST_ASSERT_EQUAL_UINT32(8, reading.counter);
+    TEST_ASSERT_TRUE(isConsistent(reading));
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.getVersion());
+}
+
+void test_odd_sized_values_round_trip() {
+    struct Odd { uint8_t bytes[7]; };
+    SeqlockSnapshot<Odd> snapshot;
+    Odd in = {{1, 2, 3, 4, 5, 6, 7}};
+    Odd out;
+    snapshot.write(in);
+    snapshot.read(out);
+    TEST_ASSERT_EQUAL_MEMORY(in.bytes, out.bytes, sizeof(in.bytes));
+}
+
+void test_readers_never_see_a_torn_value() {
+    static SeqlockSnapshot<Reading> snapshot;
+    const uint32_t writes = 200000;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+
+    std::thread readers[2];
+    for (int r = 0; r < 2; r++) {
+        readers[r] = std::thread([&]() {
+            uint32_t lastVersion = 0;
+            Reading reading;
+            while (!done.load(std::memory_order_acquire)) {
+                uint32_t version = snapshot.read(reading);
+                if (version > 0 && !isConsistent(reading)) {
+                    torn.fetch_add(1);
+                }
+                if (version < lastVersion) {
+                    backwards.fetch_add(1);
+                }
+                lastVersion = version;
+            }
+        });
+    }
+
+    for (uint32_t i = 1; i <= writes; i++) {
+        snapshot.write(makeReading(i));
+    }
+    done.store(true, std::memory_order_release);
+    for (int r = 0; r < 2; r++) {
+        readers[r].join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(writes, snapshot.getVersion());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_before_any_write_returns_version_zero);
+    RUN_TEST(test_read_returns_latest_value_and_version);
+    RUN_TEST(test_odd_sized_values_round_trip);
+    RUN_TEST(test_readers_never_see_a_torn_value);
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <thread>
+#include "SpscRing.h"
+
+struct Record {
+    uint32_t sequence;
+    uint32_t check; ///< ~sequence, to catch torn copies.
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_pop_on_empty_ring_fails() {
+    SpscRing<Record, 4> ring;
+    Record record;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(record));
+}
+
+void test_records_come_out_in_order() {
+    SpscRing<Record, 4> ring;
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(ring.push(Record{i, ~i}));
+    }
+    TEST_ASSERT_EQUAL(3, ring.size());
+    Record record;
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(ring.pop(record));
+        TEST_ASSERT_EQUAL_UINT32(i, record.sequence);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_full_ring_drops_the_new_record() {
+    SpscRing<Record, 4> ring;
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.push(Record{i, ~i}));
+    }
+    TEST_ASSERT_FALSE(ring.push(Record{4, ~4u}));
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getDroppedCount());
+
+    // The oldest records are kept
+    Record record;
+    TEST_ASSERT_TRUE(ring.pop(record));
+    TEST_ASSERT_EQUAL_UINT32(0, record.sequence);
+    TEST_ASSERT_TRUE(ring.push(Record{5, ~5u}));
+}
+
+void test_indices_wrap_around_the_slots() {
+    SpscRing<Record, 4> ring;
+    Record record;
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(ring.push(Record{i, ~i}));
+        TEST_ASSERT_TRUE(ring.pop(record));
+        TEST_ASSERT_EQUAL_UINT32(i, record.sequence);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDroppedCount());
+}
+
+void test_producer_and_consumer_threads_lose_nothing_but_drops() {
+    static SpscRing<Record, 64> ring;
+    const uint32_t total = 200000;
+    uint32_t accepted = 0;
+
+    std::thread producer([&accepted, total]() {
+        for (uint32_t i = 0; i < total; i++) {
+            if (ring.push(Record{i, ~i})) {
+                accepted++;
+            }
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t last = 0;
+    bool ordered = true;
+    bool intact = true;
+    Record record;
+    // Every push has either been received or dropped once the two add up to the total
+    while (received + ring.getDroppedCount() < total) {
+        if (ring.pop(record)) {
+            intact = intact && record.check == ~record.sequence;
+            ordered = ordered && (received == 0 || record.sequence > last);
+            last = record.sequence;
+            received++;
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(intact);
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_UINT32(accepted, received);
+    TEST_ASSERT_EQUAL_UINT32(total, received + ring.getDroppedCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pop_on_empty_ring_fails);
+    RUN_TEST(test_records_come_out_in_order);
+    RUN_TEST(test_full_ring_drops_the_new_record);
+    RUN_TEST(test_indices_wrap_around_the_slots);
+    RUN_TEST(test_producer_and_consumer_threads_lose_nothing_but_drops);
+    return UNITY_END();
+}
@@ -0,0 +1,274 @@
+#include <unity.h>
+#include <vector>
+#include "Actuator.h"
+#include "Sensor.h"
+#include "SubscriberList.h"
+
+typedef SubscriberList<EventHandler, 4> List;
+
+static List* list;
+
+/**
+ * @brief Records the events it receives and runs an optional action from inside on().
+ */
+class Recorder : public EventHandler {
+public:
+    enum Action { NONE, UNSUBSCRIBE_SELF, UNSUBSCRIBE_OTHER, SUBSCRIBE_OTHER, CLEAR, DISPATCH_AGAIN };
+
+    Recorder() : action(NONE), other(nullptr), subscribed(false) {}
+
+    void on(Event event) override {
+        ids.push_back(event.id);
+        Action current = action;
+        action = NONE; // Once, so a nested dispatch does not repeat it
+        switch (current) {
+        case UNSUBSCRIBE_SELF:
+            TEST_ASSERT_TRUE(list->unsubscribe(this));
+            break;
+        case UNSUBSCRIBE_OTHER:
+            TEST_ASSERT_TRUE(list->unsubscribe(other));
+            break;
+        case SUBSCRIBE_OTHER:
+            subscribed = list->subscribe(other);
+            break;
+        case CLEAR:
+            list->clear();
+            break;
+        case DISPATCH_AGAIN:
+            list->dispatch(&EventHandler::on, Event(event.id + 100));
+            break;
+        case NONE:
+            break;
+        }
+    }
+
+    Action action;
+    Recorder* other;
+    bool subscribed; ///< Result of SUBSCRIBE_OTHER.
+    std::vector<int> ids;
+};
+
+static void dispatch(int id) {
+    list->dispatch(&EventHandler::on, Event(id));
+}
+
+void setUp() {
+    list = new List();
+}
+
+void tearDown() {
+    delete list;
+}
+
+void test_filters_select_the_messages() {
+    Recorder all, one;
+    TEST_ASSERT_TRUE(list->subscribe(&all));
+    TEST_ASSERT_TRUE(list->subscribe(&one, 2));
+    TEST_ASSERT_TRUE(list->subscribe(&one, 2)); // Same filter again: no second entry
+    TEST_ASSERT_EQUAL(2, list->getCount());
+    TEST_ASSERT_FALSE(list->subscribe(nullptr));
+
+    TEST_ASSERT_EQUAL(1, list->dispatch(&EventHandler::on, Event(1)));
+    TEST_ASSERT_EQUAL(2, list->dispatch(&EventHandler::on, Event(2)));
+    TEST_ASSERT_EQUAL(2, (int)all.ids.size());
+    TEST_ASSERT_EQUAL(1, (int)one.ids.size());
+    TEST_ASSERT_EQUAL(2, one.ids[0]);
+}
+
+void test_unsubscribe_any_removes_every_filter() {
+    Recorder recorder;
+    list->subscribe(&recorder);
+    list->subscribe(&recorder, 1);
+    list->subscribe(&recorder, 2);
+    TEST_ASSERT_TRUE(list->unsubscribe(&recorder, 1));
+    TEST_ASSERT_EQUAL(2, list->getCount());
+    TEST_ASSERT_FALSE(list->unsubscribe(&recorder, 1));
+    TEST_ASSERT_TRUE(list->unsubscribe(&recorder));
+    TEST_ASSERT_EQUAL(0, list->getCount());
+}
+
+void test_unsubscribe_filter_keeps_the_per_id_subscriptions() {
+    Recorder recorder;
+    list->subscribe(&recorder);
+    list->subscribe(&recorder, 2);
+    TEST_ASSERT_TRUE(list->unsubscribeFilter(&recorder, List::ANY_ID));
+    TEST_ASSERT_FALSE(list->unsubscribeFilter(&recorder, List::ANY_ID));
+    TEST_ASSERT_EQUAL(1, list->getCount());
+
+    dispatch(1);
+    dispatch(2);
+    TEST_ASSERT_EQUAL(1, (int)recorder.ids.size());
+    TEST_ASSERT_EQUAL(2, recorder.ids[0]);
+}
+
+void test_subscriber_removing_itself_is_not_called_again() {
+    Recorder first, second;
+    first.action = Recorder::UNSUBSCRIBE_SELF;
+    list->subscribe(&first);
+    list->subscribe(&first, 1); // Also removed, so not called again by this dispatch
+    list->subscribe(&second);
+
+    TEST_ASSERT_EQUAL(2, list->dispatch(&EventHandler::on, Event(1)));
+    TEST_ASSERT_EQUAL(1, (int)first.ids.size());
+    TEST_ASSERT_EQUAL(1, (int)second.ids.size());
+    TEST_ASSERT_EQUAL(1, list->getCount()); // Compacted once the dispatch returned
+
+    dispatch(2);
+    TEST_ASSERT_EQUAL(1, (int)first.ids.size());
+    TEST_ASSERT_EQUAL(2, (int)second.ids.size());
+}
+
+void test_subscriber_removed_by_an_earlier_one_is_skipped() {
+    Recorder first, second;
+    first.action = Recorder::UNSUBSCRIBE_OTHER;
+    first.other = &second;
+    list->subscribe(&first);
+    list->subscribe(&second);
+
+    dispatch(1);
+    TEST_ASSERT_EQUAL(1, (int)first.ids.size());
+    TEST_ASSERT_EQUAL(0, (int)second.ids.size());
+    TEST_ASSERT_EQUAL(1, list->getCount());
+}
+
+void test_subscriber_added_during_a_dispatch_starts_with_the_next_message() {
+    Recorder first, late;
+    first.action = Recorder::SUBSCRIBE_OTHER;
+    first.other = &late;
+    list->subscribe(&first);
+
+    dispatch(1);
+    TEST_ASSERT_TRUE(first.subscribed);
+    TEST_ASSERT_EQUAL(0, (int)late.ids.size());
+    dispatch(2);
+    TEST_ASSERT_EQUAL(1, (int)late.ids.size());
+    TEST_ASSERT_EQUAL(2, late.ids[0]);
+}
+
+void test_removal_in_a_nested_dispatch_waits_for_the_outermost() {
+    Recorder outer, inner, victim;
+    outer.action = Recorder::DISPATCH_AGAIN;
+    inner.action = Recorder::UNSUBSCRIBE_OTHER;
+    inner.other = &victim;
+    list->subscribe(&outer);
+    list->subscribe(&inner, 101);
+    list->subscribe(&victim);
+
+    dispatch(1);
+    // The nested dispatch of 101 removed the victim before the outer one reached it
+    TEST_ASSERT_EQUAL(2, (int)outer.ids.size());
+    TEST_ASSERT_EQUAL(1, (int)inner.ids.size());
+    TEST_ASSERT_EQUAL(0, (int)victim.ids.size());
+    TEST_ASSERT_EQUAL(2, list->getCount());
+}
+
+void test_full_list_refuses_and_reclaims_removed_entries() {
+    Recorder recorders[5];
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(list->subscribe(&recorders[i]));
+    }
+    TEST_ASSERT_FALSE(list->subscribe(&recorders[4]));
+    TEST_ASSERT_TRUE(list->subscribe(&recorders[0])); // Already there: no room needed
+
+    TEST_ASSERT_TRUE(list->unsubscribe(&recorders[1]));
+    TEST_ASSERT_TRUE(list->subscribe(&recorders[4]));
+    TEST_ASSERT_EQUAL(4, list->getCount());
+}
+
+void test_removed_entries_are_not_reclaimed_during_a_dispatch() {
+    Recorder first, second, third, late;
+    first.action = Recorder::UNSUBSCRIBE_SELF;
+    second.action = Recorder::SUBSCRIBE_OTHER;
+    second.other = &late;
+    list->subscribe(&first);
+    list->subscribe(&second);
+    list->subscribe(&third);
+    list->subscribe(&third, 7);
+
+    // first's entry is only marked while the dispatch walks the list, so the list is still full
+    dispatch(1);
+    TEST_ASSERT_FALSE(second.subscribed);
+    TEST_ASSERT_EQUAL(0, (int)late.ids.size());
+    TEST_ASSERT_EQUAL(3, list->getCount());
+    TEST_ASSERT_TRUE(list->subscribe(&late));
+}
+
+void test_clear_during_a_dispatch_stops_it() {
+    Recorder first, second;
+    first.action = Recorder::CLEAR;
+    list->subscribe(&first);
+    list->subscribe(&second);
+
+    TEST_ASSERT_EQUAL(1, list->dispatch(&EventHandler::on, Event(1)));
+    TEST_ASSERT_EQUAL(0, (int)second.ids.size());
+    TEST_ASSERT_EQUAL(0, list->getCount());
+}
+
+void test_sensor_set_handler_keeps_its_per_id_subscriptions() {
+    Recorder handler, next;
+    Sensor sensor(4, &handler);
+    TEST_ASSERT_TRUE(sensor.subscribe(&handler, 3));
+
+    sensor.setHandler(&next);
+    sensor.on(Event(1));
+    sensor.on(Event(3));
+    TEST_ASSERT_EQUAL(2, (int)next.ids.size());
+    TEST_ASSERT_EQUAL(1, (int)handler.ids.size());
+    TEST_ASSERT_EQUAL(3, handler.ids[0]);
+}
+
+void test_sensor_subscriptions_are_capped() {
+    Recorder handler;
+    Recorder others[Sensor::MAX_SUBSCRIBERS];
+    Sensor sensor(4, &handler);
+    for (int i = 0; i < Sensor::MAX_SUBSCRIBERS - 1; i++) {
+        TEST_ASSERT_TRUE(sensor.subscribe(&others[i]));
+    }
+    TEST_ASSERT_FALSE(sensor.subscribe(&others[Sensor::MAX_SUBSCRIBERS - 1]));
+    sensor.on(Event(1));
+    TEST_ASSERT_EQUAL(1, (int)handler.ids.size());
+    TEST_ASSERT_EQUAL(0, (int)others[Sensor::MAX_SUBSCRIBERS - 1].ids.size());
+}
+
+/**
+ * @brief Records the commands it receives.
+ */
+class CommandRecorder : public CommandHandler {
+public:
+    void handle(Command command) override {
+        ids.push_back(command.id);
+    }
+
+    std::vector<int> ids;
+};
+
+void test_actuator_set_handler_keeps_its_per_id_subscriptions() {
+    CommandRecorder handler, next;
+    Actuator actuator(5, &handler);
+    TEST_ASSERT_TRUE(actuator.subscribe(&handler, 3));
+
+    actuator.setHandler(&next);
+    actuator.handle(Command(1));
+    actuator.handle(Command(3));
+    TEST_ASSERT_EQUAL(2, (int)next.ids.size());
+    TEST_ASSERT_EQUAL(1, (int)handler.ids.size());
+    TEST_ASSERT_EQUAL(3, handler.ids[0]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_filters_select_the_messages);
+    RUN_TEST(test_unsubscribe_any_removes_every_filter);
+    RUN_TEST(test_unsubscribe_filter_keeps_the_per_id_subscriptions);
+    RUN_TEST(test_subscriber_removing_itself_is_not_called_again);
+    RUN_TEST(test_subscriber_removed_by_an_earlier_one_is_skipped);
+    RUN_TEST(test_subscriber_added_during_a_dispatch_starts_with_the_next_message);
+    RUN_TEST(test_removal_in_a_nested_dispatch_waits_for_the_outermost);
+    RUN_TEST(test_full_list_refuses_and_reclaims_removed_entries);
+    RUN_TEST(test_removed_entries_are_not_reclaimed_during_a_dispatch);
+    RUN_TEST(test_clear_during_a_dispatch_stops_it);
+    RUN_TEST(test_sensor_set_handler_keeps_its_per_id_subscriptions);
+    RUN_TEST(test_sensor_subscriptions_are_capped);
+    RUN_TEST(test_actuator_set_handler_keeps_its_per_id_subscriptions);
+    return UNITY_END();
+}
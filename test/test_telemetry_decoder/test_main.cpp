@@ -0,0 +1,225 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "BinaryTelemetryEncoder.h"
+#include "TelemetryDecoder.h"
+
+static BinaryTelemetryEncoder* encoder;
+
+void setUp() {
+    encoder = new BinaryTelemetryEncoder();
+}
+
+void tearDown() {
+    delete encoder;
+}
+
+static SensorSample makeSample() {
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.sequence = 42;
+    sample.timestamp = 123456789;
+    sample.temperature = 21.37f;
+    sample.humidity = 48.5f;
+    sample.smokeLevel = 312.25f;
+    sample.servoPosition = -90;
+    sample.servo2Position = 180;
+    sample.motionDetected = true;
+    return sample;
+}
+
+static AlertRecord makeAlert() {
+    AlertRecord alert;
+    memset(&alert, 0, sizeof(alert));
+    strcpy(alert.type, "smoke");
+    strcpy(alert.severity, "high");
+    strcpy(alert.message, "Smoke level above threshold");
+    alert.timestamp = 98765;
+    return alert;
+}
+
+void test_sample_round_trips_every_field() {
+    SensorSample original = makeSample();
+    TEST_ASSERT_TRUE(encoder->encode(original));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+    TEST_ASSERT_EQUAL(TelemetrySchema::VERSION, payload[0]);
+
+    SensorSample decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, length, decoded));
+    TEST_ASSERT_EQUAL(0, decoded.sequence); // Not part of the payload
+    TEST_ASSERT_EQUAL(original.timestamp, decoded.timestamp);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, original.temperature, decoded.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, original.humidity, decoded.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, original.smokeLevel, decoded.smokeLevel);
+    TEST_ASSERT_EQUAL(original.servoPosition, decoded.servoPosition);
+    TEST_ASSERT_EQUAL(original.servo2Position, decoded.servo2Position);
+    TEST_ASSERT_TRUE(decoded.motionDetected);
+}
+
+void test_missing_readings_round_trip_as_nan() {
+    SensorSample original = makeSample();
+    original.temperature = NAN;
+    original.humidity = NAN;
+    original.motionDetected = false;
+    TEST_ASSERT_TRUE(encoder->encode(original));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+
+    SensorSample decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, length, decoded));
+    TEST_ASSERT_TRUE(isnan(decoded.temperature));
+    TEST_ASSERT_TRUE(isnan(decoded.humidity));
+    TEST_ASSERT_FALSE(decoded.motionDetected);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, original.smokeLevel, decoded.smokeLevel);
+}
+
+void test_out_of_range_readings_are_clamped() {
+    SensorSample original = makeSample();
+    original.temperature = 1e15f;
+    original.humidity = -1e15f;
+    original.smokeLevel = INFINITY;
+    TEST_ASSERT_TRUE(encoder->encode(original));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+
+    SensorSample decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, length, decoded));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 10000000.0f, decoded.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, -10000000.0f, decoded.humidity);
+    TEST_ASSERT_TRUE(isnan(decoded.smokeLevel)); // Not finite goes out as null
+}
+
+void test_alert_round_trips_every_field() {
+    AlertRecord original = makeAlert();
+    TEST_ASSERT_TRUE(encoder->encode(original));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+
+    AlertRecord decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, length, decoded));
+    TEST_ASSERT_EQUAL_STRING(original.type, decoded.type);
+    TEST_ASSERT_EQUAL_STRING(original.severity, decoded.severity);
+    TEST_ASSERT_EQUAL_STRING(original.message, decoded.message);
+    TEST_ASSERT_EQUAL(original.timestamp, decoded.timestamp);
+}
+
+void test_long_text_is_truncated_to_the_record() {
+    // Version, map(1), key 17, text(10) "critical!!"
+    const uint8_t payload[] = {TelemetrySchema::VERSION, 0xA1, 0x11, 0x6A,
+                               'c', 'r', 'i', 't', 'i', 'c', 'a', 'l', '!', '!'};
+    AlertRecord decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, sizeof(payload), decoded));
+    TEST_ASSERT_EQUAL_STRING("critica", decoded.severity);
+}
+
+void test_unknown_keys_are_skipped() {
+    // Version, map(2), key 1: 1000, key 30: "new"
+    const uint8_t payload[] = {TelemetrySchema::VERSION, 0xA2, 0x01, 0x19, 0x03, 0xE8,
+                               0x18, 0x1E, 0x63, 'n', 'e', 'w'};
+    SensorSample decoded;
+    TEST_ASSERT_TRUE(TelemetryDecoder::decode(payload, sizeof(payload), decoded));
+    TEST_ASSERT_EQUAL(1000, decoded.timestamp);
+    TEST_ASSERT_TRUE(isnan(decoded.temperature));
+}
+
+void test_other_schema_version_is_rejected() {
+    TEST_ASSERT_TRUE(encoder->encode(makeSample()));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+    uint8_t copy[BinaryTelemetryEncoder::BUFFER_SIZE];
+    memcpy(copy, payload, length);
+    copy[0] = TelemetrySchema::VERSION + 1;
+    SensorSample decoded;
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(copy, length, decoded));
+}
+
+void test_every_truncation_is_rejected() {
+    SensorSample sample;
+    TEST_ASSERT_TRUE(encoder->encode(makeSample()));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(TelemetryDecoder::decode(payload, cut, sample));
+    }
+
+    AlertRecord alert;
+    TEST_ASSERT_TRUE(encoder->encode(makeAlert()));
+    payload = encoder->payload(length);
+    for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_FALSE(TelemetryDecoder::decode(payload, cut, alert));
+    }
+}
+
+void test_trailing_bytes_are_rejected() {
+    TEST_ASSERT_TRUE(encoder->encode(makeSample()));
+    size_t length;
+    const uint8_t* payload = encoder->payload(length);
+    uint8_t copy[BinaryTelemetryEncoder::BUFFER_SIZE + 1];
+    memcpy(copy, payload, length);
+    copy[length] = 0x00;
+    SensorSample decoded;
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(copy, length + 1, decoded));
+}
+
+void test_malformed_items_are_rejected() {
+    SensorSample sample;
+    // Text claiming 4 GB
+    const uint8_t hugeText[] = {TelemetrySchema::VERSION, 0xA1, 0x10, 0x7A, 0xFF, 0xFF, 0xFF, 0xFF, 'x'};
+    // 64-bit argument, never produced by the encoder
+    const uint8_t wideInteger[] = {TelemetrySchema::VERSION, 0xA1, 0x01, 0x1B, 0, 0, 0, 0, 0, 0, 0, 1};
+    // Nested array as a value
+    const uint8_t nestedArray[] = {TelemetrySchema::VERSION, 0xA1, 0x01, 0x81, 0x01};
+    // Indefinite-length map
+    const uint8_t indefiniteMap[] = {TelemetrySchema::VERSION, 0xBF, 0x01, 0x01, 0xFF};
+    // Text as a key
+    const uint8_t textKey[] = {TelemetrySchema::VERSION, 0xA1, 0x61, 'k', 0x01};
+    // Not a map at all
+    const uint8_t notMap[] = {TelemetrySchema::VERSION, 0x83, 0x01, 0x02, 0x03};
+    // Reserved simple value
+    const uint8_t reserved[] = {TelemetrySchema::VERSION, 0xA1, 0x04, 0xFC};
+
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(hugeText, sizeof(hugeText), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(wideInteger, sizeof(wideInteger), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(nestedArray, sizeof(nestedArray), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(indefiniteMap, sizeof(indefiniteMap), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(textKey, sizeof(textKey), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(notMap, sizeof(notMap), sample));
+    TEST_ASSERT_FALSE(TelemetryDecoder::decode(reserved, sizeof(reserved), sample));
+}
+
+void test_random_garbage_stays_in_bounds() {
+    // Run under AddressSanitizer to check every read stays inside the payload
+    uint32_t seed = 2024;
+    uint8_t data[48];
+    SensorSample sample;
+    AlertRecord alert;
+    SensorSample batch[4];
+    for (int round = 0; round < 20000; round++) {
+        size_t length = 1 + round % sizeof(data);
+        for (size_t i = 0; i < length; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            data[i] = seed >> 24;
+        }
+        data[0] = TelemetrySchema::VERSION;
+        TelemetryDecoder::decode(data, length, sample);
+        TelemetryDecoder::decode(data, length, alert);
+        TelemetryDecoder::decodeBatch(data, length, batch, 4);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_round_trips_every_field);
+    RUN_TEST(test_missing_readings_round_trip_as_nan);
+    RUN_TEST(test_out_of_range_readings_are_clamped);
+    RUN_TEST(test_alert_round_trips_every_field);
+    RUN_TEST(test_long_text_is_truncated_to_the_record);
+    RUN_TEST(test_unknown_keys_are_skipped);
+    RUN_TEST(test_other_schema_version_is_rejected);
+    RUN_TEST(test_every_truncation_is_rejected);
+    RUN_TEST(test_trailing_bytes_are_rejected);
+    RUN_TEST(test_malformed_items_are_rejected);
+    RUN_TEST(test_random_garbage_stays_in_bounds);
+    return UNITY_END();
+}
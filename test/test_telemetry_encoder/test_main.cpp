@@ -0,0 +1,98 @@
+#include <unity.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "TelemetryEncoder.h"
+
+static char text[TelemetryEncoder::NUMBER_SIZE];
+
+void setUp() {
+    memset(text, 'x', sizeof(text));
+}
+
+void tearDown() {}
+
+static void assertInt(long value) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%ld", value);
+    size_t length = TelemetryEncoder::formatInt(text, value);
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+}
+
+static void assertFloat(const char* expected, float value) {
+    size_t length = TelemetryEncoder::formatFloat(text, value);
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+}
+
+void test_int_small_values() {
+    assertInt(0);
+    assertInt(7);
+    assertInt(-7);
+    assertInt(1234567);
+}
+
+void test_int_extremes_fit_the_number_size() {
+    assertInt(LONG_MAX);
+    assertInt(LONG_MIN);
+    assertInt(LONG_MIN + 1);
+}
+
+void test_float_keeps_two_decimals() {
+    assertFloat("21.5", 21.5f);
+    assertFloat("21.25", 21.25f);
+    assertFloat("21", 21.0f);
+    assertFloat("-0.05", -0.05f);
+    assertFloat("0", 0.004f);
+    assertFloat("0", -0.004f);
+}
+
+void test_float_out_of_range_is_clamped() {
+    assertFloat("10000000", 1e15f);
+    assertFloat("-10000000", -1e15f);
+    assertFloat("10000000", FLT_MAX);
+    assertFloat("-10000000", -FLT_MAX);
+}
+
+void test_float_not_finite_is_the_error_value() {
+    assertFloat("-999", NAN);
+    assertFloat("-999", INFINITY);
+    assertFloat("-999", -INFINITY);
+}
+
+void test_sample_with_extremes_fits_the_buffer() {
+    TelemetryEncoder encoder;
+    encoder.setSourceInfo("device-1", "esp32");
+    SensorSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.sequence = 1;
+    sample.timestamp = UINT32_MAX;
+    sample.temperature = NAN;
+    sample.humidity = INFINITY;
+    sample.smokeLevel = -1e15f;
+    sample.servoPosition = INT16_MIN;
+    sample.servo2Position = INT16_MAX;
+    TEST_ASSERT_TRUE(encoder.encode(sample));
+
+    size_t length;
+    const char* payload = encoder.mqttPayload(length);
+    const char expected[] = "{\"temperature\":-999,\"humidity\":-999,\"motionDetected\":false,"
+                            "\"smokeLevel\":-10000000,\"servoPosition\":-32768,\"servo2Position\":32767,"
+                            "\"timestamp\":4294967295}";
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(expected, payload, length));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_int_small_values);
+    RUN_TEST(test_int_extremes_fit_the_number_size);
+    RUN_TEST(test_float_keeps_two_decimals);
+    RUN_TEST(test_float_out_of_range_is_clamped);
+    RUN_TEST(test_float_not_finite_is_the_error_value);
+    RUN_TEST(test_sample_with_extremes_fits_the_buffer);
+    return UNITY_END();
+}
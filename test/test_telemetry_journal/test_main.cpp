@@ -0,0 +1,292 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "TelemetryJournal.h"
+
+/**
+ * @brief NOR-flash-like storage in RAM that can lose power in the middle of a write.
+ */
+class MemoryStorage : public JournalStorage {
+public:
+    static const size_t SECTOR_SIZE = 128; ///< Four records per sector.
+    static const size_t SECTORS = 4;
+
+    uint8_t bytes[SECTOR_SIZE * SECTORS];
+    long writeBudget;  ///< Bytes programmed before the power goes out, or -1 for no limit.
+    int erases;
+
+    MemoryStorage() : writeBudget(-1), erases(0) {
+        memset(bytes, 0xFF, sizeof(bytes));
+    }
+
+    bool begin() override { return true; }
+    size_t size() const override { return sizeof(bytes); }
+    size_t sectorSize() const override { return SECTOR_SIZE; }
+
+    bool read(size_t offset, void* data, size_t length) override {
+        if (offset + length > sizeof(bytes)) {
+            return false;
+        }
+        memcpy(data, bytes + offset, length);
+        return true;
+    }
+
+    bool write(size_t offset, const void* data, size_t length) override {
+        if (offset + length > sizeof(bytes)) {
+            return false;
+        }
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            if (writeBudget == 0) {
+                return false;
+            }
+            if (writeBudget > 0) {
+                writeBudget--;
+            }
+            bytes[offset + i] &= source[i]; // Programming only clears bits
+        }
+        return true;
+    }
+
+    bool eraseSector(size_t sector) override {
+        memset(bytes + sector * SECTOR_SIZE, 0xFF, SECTOR_SIZE);
+        erases++;
+        return true;
+    }
+};
+
+static const size_t SLOTS = MemoryStorage::SECTOR_SIZE * MemoryStorage::SECTORS / TelemetryJournal::RECORD_SIZE;
+static MemoryStorage* storage;
+
+void setUp() {
+    storage = new MemoryStorage();
+}
+
+void tearDown() {
+    delete storage;
+}
+
+static SensorSample makeSample(uint32_t timestamp) {
+    SensorSample sample;
+    sample.sequence = 0;
+    sample.timestamp = timestamp;
+    sample.temperature = 20.0f + timestamp * 0.01f;
+    sample.humidity = 50.5f;
+    sample.smokeLevel = 312.25f;
+    sample.servoPosition = 90;
+    sample.servo2Position = -5;
+    sample.motionDetected = timestamp % 2 == 1;
+    return sample;
+}
+
+static void appendRange(TelemetryJournal& journal, uint32_t first, uint32_t last) {
+    for (uint32_t timestamp = first; timestamp <= last; timestamp++) {
+        TEST_ASSERT_TRUE(journal.append(makeSample(timestamp)));
+    }
+}
+
+static uint32_t peekTimestamp(TelemetryJournal& journal) {
+    SensorSample sample;
+    TEST_ASSERT_TRUE(journal.peek(sample));
+    return sample.timestamp;
+}
+
+void test_storage_too_small_to_wrap_is_rejected() {
+    class OneSector : public MemoryStorage {
+        size_t size() const override { return SECTOR_SIZE; }
+    } small;
+    TelemetryJournal journal(&small);
+    TEST_ASSERT_FALSE(journal.begin());
+    TEST_ASSERT_FALSE(journal.append(makeSample(1)));
+}
+
+void test_samples_round_trip_in_order() {
+    TelemetryJournal journal(storage);
+    TEST_ASSERT_TRUE(journal.begin());
+    appendRange(journal, 1, 3);
+    SensorSample missing = makeSample(4);
+    missing.temperature = NAN;
+    TEST_ASSERT_TRUE(journal.append(missing));
+    TEST_ASSERT_EQUAL(4, journal.getPendingCount());
+
+    SensorSample sample;
+    for (uint32_t timestamp = 1; timestamp <= 4; timestamp++) {
+        TEST_ASSERT_TRUE(journal.peek(sample));
+        SensorSample expected = makeSample(timestamp);
+        TEST_ASSERT_EQUAL(timestamp, sample.sequence);
+        TEST_ASSERT_EQUAL(timestamp, sample.timestamp);
+        if (timestamp == 4) {
+            TEST_ASSERT_TRUE(isnan(sample.temperature));
+        } else {
+            TEST_ASSERT_FLOAT_WITHIN(0.005f, expected.temperature, sample.temperature);
+        }
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, 50.5f, sample.humidity);
+        TEST_ASSERT_FLOAT_WITHIN(0.005f, 312.25f, sample.smokeLevel);
+        TEST_ASSERT_EQUAL(90, sample.servoPosition);
+        TEST_ASSERT_EQUAL(-5, sample.servo2Position);
+        TEST_ASSERT_EQUAL(expected.motionDetected, sample.motionDetected);
+        journal.markReplayed();
+    }
+    TEST_ASSERT_FALSE(journal.peek(sample));
+    TEST_ASSERT_EQUAL(0, journal.getPendingCount());
+}
+
+void test_out_of_range_readings_are_clamped() {
+    TelemetryJournal journal(storage);
+    TEST_ASSERT_TRUE(journal.begin());
+    SensorSample extreme = makeSample(1);
+    extreme.temperature = INFINITY;
+    extreme.humidity = -1e15f;
+    extreme.smokeLevel = 1e15f;
+    TEST_ASSERT_TRUE(journal.append(extreme));
+    extreme.smokeLevel = -5.0f;
+    TEST_ASSERT_TRUE(journal.append(extreme));
+
+    SensorSample sample;
+    TEST_ASSERT_TRUE(journal.peek(sample));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, INT16_MAX / 100.0f, sample.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, (INT16_MIN + 1) / 100.0f, sample.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 10000000.0f, sample.smokeLevel);
+    journal.markReplayed();
+    TEST_ASSERT_TRUE(journal.peek(sample));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sample.smokeLevel);
+}
+
+void test_recover_resumes_after_a_reboot() {
+    TelemetryJournal before(storage);
+    before.begin();
+    appendRange(before, 1, 5);
+    SensorSample sample;
+    before.peek(sample);
+    before.markReplayed();
+    before.peek(sample);
+    before.markReplayed();
+
+    TelemetryJournal after(storage);
+    TEST_ASSERT_TRUE(after.begin());
+    TEST_ASSERT_EQUAL(3, after.getPendingCount());
+    TEST_ASSERT_EQUAL(3, peekTimestamp(after));
+
+    // Sequence numbers carry on from the newest record
+    TEST_ASSERT_TRUE(after.append(makeSample(6)));
+    for (int i = 0; i < 3; i++) {
+        after.peek(sample);
+        after.markReplayed();
+    }
+    TEST_ASSERT_TRUE(after.peek(sample));
+    TEST_ASSERT_EQUAL(6, sample.sequence);
+}
+
+void test_power_loss_during_the_payload_drops_only_that_record() {
+    TelemetryJournal before(storage);
+    before.begin();
+    appendRange(before, 1, 2);
+    storage->writeBudget = 10; // Out mid-payload
+    TEST_ASSERT_FALSE(before.append(makeSample(3)));
+    storage->writeBudget = -1;
+
+    TelemetryJournal after(storage);
+    after.begin();
+    TEST_ASSERT_EQUAL(2, after.getPendingCount());
+    TEST_ASSERT_EQUAL(0, after.getCorruptCount());
+
+    // The dirty slot is skipped, never programmed twice
+    TEST_ASSERT_TRUE(after.append(makeSample(4)));
+    SensorSample sample;
+    uint32_t expected[] = {1, 2, 4};
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(after.peek(sample));
+        TEST_ASSERT_EQUAL(expected[i], sample.timestamp);
+        after.markReplayed();
+    }
+    TEST_ASSERT_FALSE(after.peek(sample));
+}
+
+void test_power_loss_before_the_commit_leaves_the_record_uncommitted() {
+    TelemetryJournal before(storage);
+    before.begin();
+    appendRange(before, 1, 1);
+    storage->writeBudget = TelemetryJournal::RECORD_SIZE; // Payload written, state byte not
+    TEST_ASSERT_FALSE(before.append(makeSample(2)));
+    storage->writeBudget = -1;
+
+    TelemetryJournal after(storage);
+    after.begin();
+    TEST_ASSERT_EQUAL(1, after.getPendingCount());
+    TEST_ASSERT_EQUAL(0, after.getCorruptCount());
+    TEST_ASSERT_TRUE(after.append(makeSample(3)));
+    TEST_ASSERT_EQUAL(2, after.getPendingCount());
+}
+
+void test_corrupted_record_is_counted_and_skipped() {
+    TelemetryJournal before(storage);
+    before.begin();
+    appendRange(before, 1, 3);
+    storage->bytes[TelemetryJournal::RECORD_SIZE + 16] &= 0x0F; // Bit rot in the smoke level of the second record
+
+    TelemetryJournal after(storage);
+    after.begin();
+    TEST_ASSERT_EQUAL(1, after.getCorruptCount());
+    TEST_ASSERT_EQUAL(2, after.getPendingCount());
+    TEST_ASSERT_EQUAL(1, peekTimestamp(after));
+    after.markReplayed();
+    TEST_ASSERT_EQUAL(3, peekTimestamp(after));
+}
+
+void test_full_log_wraps_by_erasing_the_oldest_sector() {
+    const uint32_t perSector = MemoryStorage::SECTOR_SIZE / TelemetryJournal::RECORD_SIZE;
+    TelemetryJournal journal(storage);
+    journal.begin();
+    appendRange(journal, 1, SLOTS);
+    TEST_ASSERT_EQUAL(SLOTS, journal.getPendingCount());
+    TEST_ASSERT_EQUAL(0, journal.getOverwrittenCount());
+
+    int erasesBefore = storage->erases;
+    appendRange(journal, SLOTS + 1, SLOTS + 2);
+    TEST_ASSERT_EQUAL(erasesBefore + 1, storage->erases);
+    TEST_ASSERT_EQUAL(perSector, journal.getOverwrittenCount());
+    TEST_ASSERT_EQUAL(SLOTS - perSector + 2, journal.getPendingCount());
+    TEST_ASSERT_EQUAL(perSector + 1, peekTimestamp(journal));
+
+    // Recovery finds the same oldest and newest records across the wrap
+    TelemetryJournal after(storage);
+    after.begin();
+    TEST_ASSERT_EQUAL(SLOTS - perSector + 2, after.getPendingCount());
+    TEST_ASSERT_EQUAL(perSector + 1, peekTimestamp(after));
+    TEST_ASSERT_TRUE(after.append(makeSample(SLOTS + 3)));
+    SensorSample sample;
+    uint32_t last = 0;
+    while (after.peek(sample)) {
+        last = sample.sequence;
+        after.markReplayed();
+    }
+    TEST_ASSERT_EQUAL(SLOTS + 3, last);
+}
+
+void test_replayed_records_are_not_counted_as_overwritten() {
+    TelemetryJournal journal(storage);
+    journal.begin();
+    appendRange(journal, 1, SLOTS);
+    SensorSample sample;
+    while (journal.peek(sample)) {
+        journal.markReplayed();
+    }
+    appendRange(journal, SLOTS + 1, SLOTS + 1);
+    TEST_ASSERT_EQUAL(0, journal.getOverwrittenCount());
+    TEST_ASSERT_EQUAL(1, journal.getPendingCount());
+    TEST_ASSERT_EQUAL(SLOTS + 1, peekTimestamp(journal));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_storage_too_small_to_wrap_is_rejected);
+    RUN_TEST(test_samples_round_trip_in_order);
+    RUN_TEST(test_out_of_range_readings_are_clamped);
+    RUN_TEST(test_recover_resumes_after_a_reboot);
+    RUN_TEST(test_power_loss_during_the_payload_drops_only_that_record);
+    RUN_TEST(test_power_loss_before_the_commit_leaves_the_record_uncommitted);
+    RUN_TEST(test_corrupted_record_is_counted_and_skipped);
+    RUN_TEST(test_full_log_wraps_by_erasing_the_oldest_sector);
+    RUN_TEST(test_replayed_records_are_not_counted_as_overwritten);
+    return UNITY_END();
+}
@@ -0,0 +1,68 @@
+#include <unity.h>
+#include "TopicRouter.h"
+
+static TopicRouter* router;
+
+void setUp() {
+    router = new TopicRouter();
+}
+
+void tearDown() {
+    delete router;
+}
+
+void test_routes_exact_topics() {
+    TEST_ASSERT_TRUE(router->add("smartsuite/servo/command", 3));
+    TEST_ASSERT_TRUE(router->add("smartsuite/config/rules", 7));
+    TEST_ASSERT_EQUAL(3, router->route("smartsuite/servo/command"));
+    TEST_ASSERT_EQUAL(7, router->route("smartsuite/config/rules"));
+}
+
+void test_unknown_prefix_and_longer_topics_have_no_route() {
+    router->add("smartsuite/servo/command", 3);
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("smartsuite/servo"));
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("smartsuite/servo/command/"));
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("Smartsuite/servo/command"));
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route(""));
+}
+
+void test_hash_collision_is_rejected_by_the_compare() {
+    // "liquid" and "costarring" share their FNV-1a hash
+    TEST_ASSERT_EQUAL_UINT32(TopicRouter::hash("liquid"), TopicRouter::hash("costarring"));
+    router->add("liquid", 1);
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("costarring"));
+    router->add("costarring", 2);
+    TEST_ASSERT_EQUAL(1, router->route("liquid"));
+    TEST_ASSERT_EQUAL(2, router->route("costarring"));
+}
+
+void test_hash_matches_the_reference_values() {
+    TEST_ASSERT_EQUAL_UINT32(2166136261u, TopicRouter::hash(""));
+    TEST_ASSERT_EQUAL_UINT32(0xE40C292Cu, TopicRouter::hash("a"));
+    TEST_ASSERT_EQUAL_UINT32(0xBF9CF968u, TopicRouter::hash("foobar"));
+}
+
+void test_table_is_bounded_and_clear_empties_it() {
+    static const char* const TOPICS[] = {"t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7"};
+    for (int i = 0; i < TopicRouter::MAX_ROUTES; i++) {
+        TEST_ASSERT_TRUE(router->add(TOPICS[i], i));
+    }
+    TEST_ASSERT_FALSE(router->add("overflow", 99));
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("overflow"));
+    TEST_ASSERT_EQUAL(TopicRouter::MAX_ROUTES - 1, router->route("t7"));
+
+    router->clear();
+    TEST_ASSERT_EQUAL(TopicRouter::NO_ROUTE, router->route("t0"));
+    TEST_ASSERT_TRUE(router->add("overflow", 99));
+    TEST_ASSERT_EQUAL(99, router->route("overflow"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_routes_exact_topics);
+    RUN_TEST(test_unknown_prefix_and_longer_topics_have_no_route);
+    RUN_TEST(test_hash_collision_is_rejected_by_the_compare);
+    RUN_TEST(test_hash_matches_the_reference_values);
+    RUN_TEST(test_table_is_bounded_and_clear_empties_it);
+    return UNITY_END();
+}
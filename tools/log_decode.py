@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Decodes the binary log stream written by Logger (src/Logger.h).
+
+Each record names its format string by address; the text is read from the firmware ELF
+that produced it. Bytes outside valid frames (boot ROM output, other prints) are passed
+through as text.
+
+Usage:
+    python tools/log_decode.py .pio/build/esp32dev/firmware.elf capture.bin
+    python tools/log_decode.py .pio/build/esp32dev/firmware.elf --port /dev/ttyUSB0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+HEADER_SIZE = 9  # level, timestamp, 32-bit format address
+LEVEL_NAMES = "-EWID"
+
+ARG_INT, ARG_UINT, ARG_FLOAT, ARG_STRING = 1, 2, 3, 4
+
+SPEC = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXocfFeEgGs%])")
+
+
+class FirmwareImage:
+    """Loaded sections of a 32-bit little-endian ELF, for reading strings by address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf:
+            data = elf.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s is not a 32-bit little-endian ELF file" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for index in range(shnum):
+            _, kind, flags, addr, offset, size = struct.unpack_from("<IIIIII", data, shoff + index * shentsize)
+            if flags & 0x2 and kind != 8 and size > 0:  # SHF_ALLOC, not SHT_NOBITS
+                self.sections.append((addr, data[offset:offset + size]))
+        self.cache = {}
+
+    def string_at(self, address):
+        if address in self.cache:
+            return self.cache[address]
+        text = None
+        for start, content in self.sections:
+            if start <= address < start + len(content):
+                end = content.find(b"\0", address - start)
+                if end >= 0:
+                    text = content[address - start:end].decode("utf-8", "replace")
+                break
+        self.cache[address] = text
+        return text
+
+
+def parse_arguments(body):
+    arguments = []
+    position = HEADER_SIZE
+    while position < len(body):
+        tag = body[position]
+        if tag in (ARG_INT, ARG_UINT, ARG_FLOAT) and position + 5 <= len(body):
+            fmt = {ARG_INT: "<i", ARG_UINT: "<I", ARG_FLOAT: "<f"}[tag]
+            value, = struct.unpack_from(fmt, body, position + 1)
+            arguments.append((tag, value))
+            position += 5
+        elif tag == ARG_STRING and position + 2 <= len(body):
+            count = body[position + 1]
+            if position + 2 + count > len(body):
+                return None
+            arguments.append((tag, body[position + 2:position + 2 + count].decode("utf-8", "replace")))
+            position += 2 + count
+        else:
+            return None
+    return arguments
+
+
+def render(fmt, arguments):
+    remaining = list(arguments)
+
+    def substitute(match):
+        flags, conversion = match.group(1), match.group(2)
+        if conversion == "%":
+            return "%"
+        if not remaining:
+            return "<?>"
+        tag, value = remaining.pop(0)
+        if conversion == "s" and tag == ARG_STRING:
+            return ("%" + flags + "s") % value
+        if conversion in "fFeEgG" and tag == ARG_FLOAT:
+            return ("%" + flags + conversion) % value
+        if conversion in "diuxXoc" and tag in (ARG_INT, ARG_UINT):
+            if conversion in "uxXo" and value < 0:
+                value &= 0xFFFFFFFF
+            return ("%" + flags + ("d" if conversion == "u" else conversion)) % value
+        del remaining[:]
+        return "<?>"
+
+    return SPEC.sub(substitute, fmt)
+
+
+def decode_frame(image, body):
+    """Returns the text of a record, or None if it does not look like one."""
+    if len(body) < HEADER_SIZE or body[0] >= len(LEVEL_NAMES):
+        return None
+    timestamp, address = struct.unpack_from("<II", body, 1)
+    fmt = image.string_at(address)
+    arguments = parse_arguments(body)
+    if fmt is None or arguments is None:
+        return None
+    return "[%s %d] %s" % (LEVEL_NAMES[body[0]], timestamp, render(fmt, arguments))
+
+
+class StreamDecoder:
+    """Splits a byte stream into log frames and plain text."""
+
+    def __init__(self, image, output):
+        self.image = image
+        self.output = output
+        self.buffer = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        self.buffer += data
+        while self.buffer:
+            sync = self.buffer.find(FRAME_SYNC)
+            if sync < 0:
+                self.emit_text(self.buffer)
+                del self.buffer[:]
+                break
+            if sync > 0:
+                self.emit_text(self.buffer[:sync])
+                del self.buffer[:sync]
+            if len(self.buffer) < 2 or len(self.buffer) < self.buffer[1] + 3:
+                break  # Wait for the rest of the frame
+            length = self.buffer[1]
+            body = bytes(self.buffer[2:2 + length])
+            checksum = 0
+            for byte in body:
+                checksum ^= byte
+            line = decode_frame(self.image, body) if checksum == self.buffer[2 + length] else None
+            if line is None:
+                self.emit_text(self.buffer[:1])
+                del self.buffer[:1]
+                continue
+            self.flush_text()
+            self.output.write(line + "\n")
+            del self.buffer[:length + 3]
+        self.output.flush()
+
+    def emit_text(self, data):
+        self.text += data
+        while b"\n" in self.text:
+            line, _, rest = bytes(self.text).partition(b"\n")
+            self.output.write(line.decode("utf-8", "replace").rstrip("\r") + "\n")
+            self.text = bytearray(rest)
+
+    def flush_text(self):
+        if self.text:
+            self.output.write(self.text.decode("utf-8", "replace") + "\n")
+            self.text = bytearray()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode SmartSuite binary logs")
+    parser.add_argument("elf", help="firmware ELF the device is running")
+    parser.add_argument("capture", nargs="?", help="raw capture file; standard input if omitted")
+    parser.add_argument("--port", help="read from a serial port instead (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    options = parser.parse_args()
+
+    decoder = StreamDecoder(FirmwareImage(options.elf), sys.stdout)
+    if options.port:
+        import serial
+        with serial.Serial(options.port, options.baud, timeout=0.1) as port:
+            try:
+                while True:
+                    decoder.feed(port.read(256))
+            except KeyboardInterrupt:
+                pass
+    else:
+        source = open(options.capture, "rb") if options.capture else sys.stdin.buffer
+        with source:
+            while True:
+                chunk = source.read(4096)
+                if not chunk:
+                    break
+                decoder.feed(chunk)
+    decoder.flush_text()
+
+
+if __name__ == "__main__":
+    main()
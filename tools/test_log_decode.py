@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Tests for tools/log_decode.py against frames laid out as Logger writes them.
+
+Usage:
+    python3 -m unittest discover -s tools
+"""
+
+import io
+import os
+import struct
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import log_decode  # noqa: E402
+
+RODATA_ADDRESS = 0x3F400000
+BSS_ADDRESS = 0x3FFB0000
+
+
+def build_elf(strings):
+    """Writes a minimal 32-bit little-endian ELF with the strings in an allocated section.
+
+    Returns the path and the address of each string.
+    """
+    rodata = bytearray()
+    addresses = []
+    for text in strings:
+        addresses.append(RODATA_ADDRESS + len(rodata))
+        rodata += text.encode() + b"\0"
+    header_size, section_size = 52, 40
+    section_offset = header_size + len(rodata)
+    sections = [
+        (0, 0, 0, 0, 0),                                                 # Null section
+        (1, 0x2, RODATA_ADDRESS, header_size, len(rodata)),              # PROGBITS, ALLOC
+        (8, 0x3, BSS_ADDRESS, section_offset, 64),                       # NOBITS: no bytes in the file
+        (1, 0x0, RODATA_ADDRESS + 0x1000, header_size, len(rodata)),     # Not allocated
+    ]
+    elf = bytearray(b"\x7fELF\x01\x01\x01" + b"\0" * 9)
+    elf += struct.pack("<HHIIIIIHHHHHH", 2, 94, 1, 0, 0, section_offset, 0, header_size, 0, 0,
+                       section_size, len(sections), 0)
+    elf += rodata
+    for kind, flags, address, offset, size in sections:
+        elf += struct.pack("<IIIIIIIIII", 0, kind, flags, address, offset, size, 0, 0, 1, 0)
+    handle, path = tempfile.mkstemp(suffix=".elf")
+    with os.fdopen(handle, "wb") as file:
+        file.write(elf)
+    return path, addresses
+
+
+def record(level, timestamp, address, *arguments):
+    """Packs a record as LogRecord does on the ESP32."""
+    body = bytearray(struct.pack("<BII", level, timestamp, address))
+    for tag, value in arguments:
+        if tag == log_decode.ARG_STRING:
+            encoded = value.encode()
+            body += struct.pack("<BB", tag, len(encoded)) + encoded
+        else:
+            body += struct.pack({1: "<Bi", 2: "<BI", 3: "<Bf"}[tag], tag, value)
+    return bytes(body)
+
+
+def frame(body):
+    checksum = 0
+    for byte in body:
+        checksum ^= byte
+    return bytes([log_decode.FRAME_SYNC, len(body)]) + body + bytes([checksum])
+
+
+class LogDecodeTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.path, addresses = build_elf([
+            "Servo %d at %.1f deg, %s",
+            "Heap %u bytes, flags %04x, %%",
+            "Wants %s and %d",
+            "Plain text",
+        ])
+        cls.servo, cls.heap, cls.wants, cls.plain = addresses
+        cls.image = log_decode.FirmwareImage(cls.path)
+
+    @classmethod
+    def tearDownClass(cls):
+        os.remove(cls.path)
+
+    def decode(self, *chunks):
+        output = io.StringIO()
+        decoder = log_decode.StreamDecoder(self.image, output)
+        for chunk in chunks:
+            decoder.feed(chunk)
+        decoder.flush_text()
+        return output.getvalue()
+
+    def test_reads_strings_from_allocated_sections_only(self):
+        self.assertEqual("Plain text", self.image.string_at(self.plain))
+        self.assertEqual("deg, %s", self.image.string_at(self.servo + 17))
+        self.assertIsNone(self.image.string_at(BSS_ADDRESS))
+        self.assertIsNone(self.image.string_at(RODATA_ADDRESS + 0x1000))
+        self.assertIsNone(self.image.string_at(RODATA_ADDRESS - 4))
+
+    def test_rejects_other_files(self):
+        handle, path = tempfile.mkstemp()
+        with os.fdopen(handle, "wb") as file:
+            file.write(b"\x7fELF\x02\x01" + b"\0" * 58)  # 64-bit
+        try:
+            with self.assertRaises(ValueError):
+                log_decode.FirmwareImage(path)
+        finally:
+            os.remove(path)
+
+    def test_decodes_every_argument_type(self):
+        body = record(3, 1234, self.servo, (log_decode.ARG_INT, -2), (log_decode.ARG_FLOAT, 90.5),
+                      (log_decode.ARG_STRING, "moving"))
+        self.assertEqual("[I 1234] Servo -2 at 90.5 deg, moving\n", self.decode(frame(body)))
+
+        body = record(1, 7, self.heap, (log_decode.ARG_UINT, 4000000000), (log_decode.ARG_INT, 255))
+        self.assertEqual("[E 7] Heap 4000000000 bytes, flags 00ff, %\n", self.decode(frame(body)))
+
+    def test_marks_mismatched_and_missing_arguments(self):
+        body = record(2, 0, self.wants, (log_decode.ARG_INT, 3), (log_decode.ARG_STRING, "text"))
+        self.assertEqual("[W 0] Wants <?> and <?>\n", self.decode(frame(body)))
+        body = record(2, 0, self.servo, (log_decode.ARG_INT, 1))
+        self.assertEqual("[W 0] Servo 1 at <?> deg, <?>\n", self.decode(frame(body)))
+
+    def test_passes_other_bytes_through_as_text(self):
+        body = record(3, 5, self.plain)
+        stream = b"rst:0x1 (POWERON_RESET)\r\nboot" + frame(body) + b"tail\n"
+        self.assertEqual("rst:0x1 (POWERON_RESET)\nboot\n[I 5] Plain text\ntail\n", self.decode(stream))
+
+    def test_reassembles_frames_split_across_reads(self):
+        data = frame(record(4, 9, self.plain)) * 2
+        chunks = [data[i:i + 3] for i in range(0, len(data), 3)]
+        self.assertEqual("[D 9] Plain text\n" * 2, self.decode(*chunks))
+
+    def test_skips_corrupt_frames_and_resynchronizes(self):
+        good = frame(record(3, 1, self.plain))
+        bad_checksum = bytearray(good)
+        bad_checksum[-1] ^= 0xFF
+        unknown_address = frame(record(3, 1, RODATA_ADDRESS + 0x8000))
+        bad_level = frame(record(9, 1, self.plain))
+        truncated_string = frame(record(3, 1, self.servo) + bytes([log_decode.ARG_STRING, 10]) + b"abc")
+        for corrupt in (bytes(bad_checksum), unknown_address, bad_level, truncated_string):
+            output = self.decode(corrupt + good)
+            self.assertTrue(output.endswith("[I 1] Plain text\n"), output)
+            self.assertEqual(1, output.count("Plain text"), output)
+
+
+if __name__ == "__main__":
+    unittest.main()